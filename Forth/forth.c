@@ -292,7 +292,7 @@ int forth_dump(struct forth_runtime_context *rctx, const char *addr, forth_cell_
 				}
                 	}
 			rctx->send_cr(rctx);
-			forth_hdot(rctx, (forth_cell_t)addr);
+			forth_hdot(rctx, FORTH_ADDRESS(rctx->arena, addr));
                 	forth_type0(rctx, ": "); 
 			memset(buff,FORTH_CHAR_SPACE, 8);
 	 	}
@@ -414,7 +414,7 @@ static void forth_parse(struct forth_runtime_context *rctx, char delimiter)
 			rctx->to_in++;
 		}
 
-		*--(rctx->sp) = (forth_cell_t)address;
+		*--(rctx->sp) = FORTH_ADDRESS(rctx->arena, address);
 		*--(rctx->sp) = length;
 	}
 	else
@@ -488,12 +488,243 @@ static forth_scell_t forth_query(struct forth_runtime_context *rctx)
 	return len;
 }
 // ---------------------------------------------------------------------------------------
-static forth_cell_t forth_search_wordlist(forth_cell_t dictionary[], const struct forth_wordlist *wl, const char *name, forth_cell_t len)
+#if defined(FORTH_WORDLIST_INDEX) || defined(FORTH_KERNEL_NAME_HASH) || defined(FORTH_FIND_CACHE)
+// FNV-1a of the case folded name.
+static uint32_t forth_name_hash(const char *name, forth_cell_t len)
+{
+	uint32_t hash = FORTH_NAME_HASH_BASIS;
+
+	while (0 != len--)
+	{
+		hash = FORTH_NAME_HASH_STEP(hash, *name++);
+	}
+
+	return hash;
+}
+
+// Is the name of the header at ix name?
+static int forth_header_is(forth_cell_t dictionary[], forth_cell_t ix, const char *name, forth_cell_t len)
+{
+	const struct forth_header *h = (const struct forth_header *)(&dictionary[ix]);
+
+	return (len == ((FORTH_HEADER_FLAGS_NAME_LENGTH_MASK) & h->flags))
+		&& (0 == strncasecmp(name, FORTH_HEADER_NAME(dictionary, ix), len));
+}
+#endif
+
+#if defined(FORTH_KERNEL_NAME_HASH)
+// The name table gen_dict made for wl, 0 if it is not a kernel wordlist.
+static const struct forth_kernel_wordlist *forth_kernel_wordlist(forth_cell_t dictionary[], const struct forth_wordlist *wl)
+{
+	const struct forth_kernel_wordlist *kw;
+
+	for (kw = forth_kernel_wordlists; 0 != kw->slots; kw++)
+	{
+		if ((const forth_cell_t *)wl == &dictionary[kw->wid])
+		{
+			return kw;
+		}
+	}
+
+	return 0;
+}
+
+// Look name up among the kernel headers of a wordlist, one probe.
+static forth_cell_t forth_kernel_search(forth_cell_t dictionary[], const struct forth_kernel_wordlist *kw, const char *name, forth_cell_t len)
+{
+	uint32_t hash = forth_name_hash(name, len);
+	uint32_t d = kw->displacement[hash & (kw->buckets - 1)];
+	forth_cell_t ix = kw->header[FORTH_KERNEL_SLOT(hash, d) & (kw->slots - 1)];
+
+	if ((0 != ix) && forth_header_is(dictionary, ix, name, len))
+	{
+		return ix;
+	}
+
+	return FORTH_TRUE;
+}
+#endif
+
+#if defined(FORTH_WORDLIST_INDEX)
+// The header the index of wl starts from, with FORTH_KERNEL_NAME_HASH the kernel headers are left to their own table.
+static forth_cell_t forth_wordlist_index_bottom(forth_cell_t dictionary[], const struct forth_wordlist *wl)
+{
+#if defined(FORTH_KERNEL_NAME_HASH)
+	const struct forth_kernel_wordlist *kw = forth_kernel_wordlist(dictionary, wl);
+
+	if ((0 != kw) && (wl->latest >= kw->latest))
+	{
+		return kw->latest;
+	}
+#endif
+	return 0;
+}
+
+// Enter the header at ix, a newer header with the same name stays, 0 if the table is full.
+static int forth_wordlist_index_enter(forth_cell_t dictionary[], struct forth_wordlist_index *wi, forth_cell_t ix)
+{
+	const struct forth_header *h = (const struct forth_header *)(&dictionary[ix]);
+	forth_cell_t len = (FORTH_HEADER_FLAGS_NAME_LENGTH_MASK) & h->flags;
+	const char *name = FORTH_HEADER_NAME(dictionary, ix);
+	forth_cell_t mask = wi->slots - 1;
+	forth_cell_t slot = forth_name_hash(name, len) & mask;
+
+	while (0 != wi->entry[slot])
+	{
+		if (forth_header_is(dictionary, wi->entry[slot], name, len))
+		{
+			if (ix > wi->entry[slot])	// The dictionary grows upwards, newer headers are further in.
+			{
+				wi->entry[slot] = ix;
+			}
+
+			return 1;
+		}
+
+		slot = (slot + 1) & mask;
+	}
+
+	if (wi->used >= (wi->slots - (wi->slots >> 2)))	// Keep a quarter of the slots empty so that probing ends.
+	{
+		return 0;
+	}
+
+	wi->entry[slot] = ix;
+	wi->used++;
+	return 1;
+}
+
+// The index of wl with the headers linked since the last lookup entered, 0 if wl has none (or it filled up).
+static struct forth_wordlist_index *forth_wordlist_index_update(forth_cell_t dictionary[], struct forth_wordlist *wl)
+{
+	struct forth_wordlist_index *wi;
+	forth_cell_t ix;
+
+	if (0 == wl->index)
+	{
+		return 0;
+	}
+
+	wi = (struct forth_wordlist_index *)(&dictionary[wl->index]);
+
+	if (wi->indexed == wl->latest)
+	{
+		return wi;
+	}
+
+	// The chain from latest has to lead to the newest header entered, otherwise latest was set back: start over.
+	for (ix = wl->latest; ix > wi->indexed; ix = FORTH_HEADER_NEXT(dictionary, ix))
+	{
+	}
+
+	if (ix != wi->indexed)
+	{
+		memset(wi->entry, 0, wi->slots * sizeof(forth_cell_t));
+		wi->used = 0;
+		wi->indexed = forth_wordlist_index_bottom(dictionary, wl);
+	}
+
+	for (ix = wl->latest; ix > wi->indexed; ix = FORTH_HEADER_NEXT(dictionary, ix))
+	{
+		if (!forth_wordlist_index_enter(dictionary, wi, ix))
+		{
+			break;
+		}
+	}
+
+	if (ix != wi->indexed)	// Full, or the chain does not lead to the kernel headers: back to walking the chain.
+	{
+		wl->index = 0;
+		return 0;
+	}
+
+	wi->indexed = wl->latest;
+	return wi;
+}
+
+// WORDLIST-INDEX ( u wid -- ) Give wid a hash table of u cells (rounded down to a power of two) in the dictionary,
+// u less than 4 takes the index away. Returns a THROW code or 0.
+static forth_cell_t forth_wordlist_index(forth_cell_t dictionary[], forth_cell_t wid, forth_cell_t u)
+{
+	struct forth_wordlist *wl = (struct forth_wordlist *)(&dictionary[wid]);
+	struct forth_wordlist_index *wi;
+	forth_cell_t slots = 4;
+	forth_cell_t dp = FORTH_ALIGN(dictionary[FORTH_DP_LOCATION]);
+	forth_cell_t size;
+
+	if (4 > u)
+	{
+		wl->index = 0;
+		return 0;
+	}
+
+	while (((slots << 1) <= u) && (0 != (slots << 1)))
+	{
+		slots <<= 1;
+	}
+
+	size = sizeof(struct forth_wordlist_index) + (slots - 1) * sizeof(forth_cell_t);
+
+	if ((dictionary[FORTH_DP_MAX_LOCATION] <= dp) || ((dictionary[FORTH_DP_MAX_LOCATION] - dp) <= size)
+		|| !FORTH_DICTIONARY_ROOM(dictionary, dp + size))
+	{
+		return -8;
+	}
+
+	wi = (struct forth_wordlist_index *)(((char *)dictionary) + dp);
+	memset(wi, 0, size);
+	wi->slots = slots;
+	wi->indexed = forth_wordlist_index_bottom(dictionary, wl);
+	dictionary[FORTH_DP_LOCATION] = dp + size;
+	wl->index = dp / sizeof(forth_cell_t);
+	return 0;
+}
+#endif
+
+static forth_cell_t forth_search_wordlist(forth_cell_t dictionary[], struct forth_wordlist *wl, const char *name, forth_cell_t len)
 {
 	forth_cell_t ix = wl->latest;
 	struct forth_header *h = (struct forth_header *)(&dictionary[ix]);
+#if defined(FORTH_NAME_SPACE)
+	const struct forth_name *n;
+	unsigned char first[sizeof(forth_cell_t)] = { 0 };
+	forth_cell_t prefilter;
+	forth_cell_t fold;
+	forth_cell_t i;
+#else
 	forth_cell_t len_aligned = FORTH_ALIGN(len);
 	forth_cell_t name_length;
+#endif
+#if defined(FORTH_KERNEL_NAME_HASH)
+	const struct forth_kernel_wordlist *kw = forth_kernel_wordlist(dictionary, wl);
+#endif
+#if defined(FORTH_WORDLIST_INDEX)
+	struct forth_wordlist_index *wi = forth_wordlist_index_update(dictionary, wl);
+	forth_cell_t slot;
+
+	if (0 != wi)
+	{
+		slot = forth_name_hash(name, len) & (wi->slots - 1);
+
+		while (0 != (ix = wi->entry[slot]))
+		{
+			if (forth_header_is(dictionary, ix, name, len))
+			{
+				return ix;
+			}
+
+			slot = (slot + 1) & (wi->slots - 1);
+		}
+
+#if defined(FORTH_KERNEL_NAME_HASH)
+		if ((0 != kw) && (kw->latest <= wl->latest))	// Only the headers above the kernel are in the index.
+		{
+			return forth_kernel_search(dictionary, kw, name, len);
+		}
+#endif
+		return FORTH_TRUE;
+	}
+#endif
 
 #if defined(DEBUG_SEARCH)
 	int i;
@@ -505,8 +736,47 @@ static forth_cell_t forth_search_wordlist(forth_cell_t dictionary[], const struc
 	putchar('\n');
 	printf("wl=%p wl->latest = 0x%08x wl->parent = 0x%08x wl->link = 0x%08x\n", wl, wl->latest, wl->parent, wl->link);
 #endif
+#if defined(FORTH_NAME_SPACE)
+	// The first cell of the counted string with bit 5 of the characters set, A and a (but also @ and `) look the same.
+	memset(first + 1, 0x20, sizeof(forth_cell_t) - 1);
+	memcpy(&fold, first, sizeof(forth_cell_t));
+	first[0] = len;
+
+	for (i = 0; (i < len) && (i < (sizeof(forth_cell_t) - 1)); i++)
+	{
+		first[i + 1] = name[i] | 0x20;
+	}
+
+	memcpy(&prefilter, first, sizeof(forth_cell_t));
+
+	// Only the first header is looked at in the code space, then the names are walked.
+	ix = (0 != ix) ? h->link : 0;
+
+	while (0 != ix)
+	{
+		n = (const struct forth_name *)(&dictionary[ix]);
+#if defined(FORTH_KERNEL_NAME_HASH)
+		if ((0 != kw) && ((kw->latest + 2) == n->xt))	// The rest of the chain is the kernel.
+		{
+			return forth_kernel_search(dictionary, kw, name, len);
+		}
+#endif
+		if ((prefilter == (fold | *(const forth_cell_t *)(n + 1))) && (0 == strncasecmp(name, ((const char *)(n + 1)) + 1, len)))
+		{
+			return n->xt - 2;
+		}
+
+		ix = n->link;
+	}
+#else
 	while (0 != ix)
 	{
+#if defined(FORTH_KERNEL_NAME_HASH)
+		if ((0 != kw) && (kw->latest == ix))	// The rest of the chain is the kernel.
+		{
+			return forth_kernel_search(dictionary, kw, name, len);
+		}
+#endif
 #if defined(DEBUG_SEARCH)
 		printf("h->link = 0x%08x h->flags=0x%08x\n", h->link, h->flags);
 		printf("ix = 0x%08x h = %p\n", ix, h);
@@ -532,17 +802,18 @@ static forth_cell_t forth_search_wordlist(forth_cell_t dictionary[], const struc
 		ix = h->link;
 		h = (struct forth_header *)(&dictionary[ix]);
 	}
+#endif
 
 	return FORTH_TRUE;
 }
 
-static forth_cell_t forth_find_word(const struct forth_runtime_context *rctx, forth_cell_t dictionary[], const char *name, forth_cell_t len)
+static forth_cell_t forth_search_order(const struct forth_runtime_context *rctx, forth_cell_t dictionary[], const char *name, forth_cell_t len)
 {
 #if 0
-	const struct forth_wordlist *wl = (const struct forth_wordlist *)(&dictionary[FORTH_WID_FORTH_WORDLIST]);
+	struct forth_wordlist *wl = (struct forth_wordlist *)(&dictionary[FORTH_WID_FORTH_WORDLIST]);
 	return forth_search_wordlist(dictionary, wl, name, len);
 #else
-	const struct forth_wordlist *wl;
+	struct forth_wordlist *wl;
 	forth_cell_t xt;
 	forth_cell_t wid;
 	// forth_cell_t i;
@@ -553,7 +824,7 @@ static forth_cell_t forth_find_word(const struct forth_runtime_context *rctx, fo
 	while (0 != cnt)
 	{
 		wid = rctx->wordlists[rctx->wordlist_slots - cnt];
-		wl = (const struct forth_wordlist *)(&dictionary[wid]);
+		wl = (struct forth_wordlist *)(&dictionary[wid]);
 		xt = forth_search_wordlist(dictionary, wl, name, len);
 
 		if (FORTH_TRUE != xt)
@@ -565,7 +836,7 @@ static forth_cell_t forth_find_word(const struct forth_runtime_context *rctx, fo
 	}
 
 	wid = FORTH_WID_Root_WORDLIST;
-	wl = (const struct forth_wordlist *)(&dictionary[wid]);
+	wl = (struct forth_wordlist *)(&dictionary[wid]);
 	xt = forth_search_wordlist(dictionary, wl, name, len);
 	if (FORTH_TRUE != xt)
 	{
@@ -577,6 +848,34 @@ static forth_cell_t forth_find_word(const struct forth_runtime_context *rctx, fo
 #endif
 }
 
+static forth_cell_t forth_find_word(struct forth_runtime_context *rctx, forth_cell_t dictionary[], const char *name, forth_cell_t len)
+{
+#if defined(FORTH_FIND_CACHE)
+	uint32_t hash = forth_name_hash(name, len);
+	struct forth_find_cache_entry *entry = &rctx->find_cache[hash & (FORTH_FIND_CACHE - 1)];
+	forth_cell_t ix;
+
+	if ((entry->generation == rctx->generation) && (entry->hash == hash) && (0 != entry->header)
+		&& forth_header_is(dictionary, entry->header, name, len))
+	{
+		return entry->header;
+	}
+
+	ix = forth_search_order(rctx, dictionary, name, len);
+
+	if (FORTH_TRUE != ix)	// Only hits, a miss could not be told apart from another name with the same hash.
+	{
+		entry->generation = rctx->generation;
+		entry->hash = hash;
+		entry->header = ix;
+	}
+
+	return ix;
+#else
+	return forth_search_order(rctx, dictionary, name, len);
+#endif
+}
+
 // ---------------------------------------------------------------------------------------
 static forth_byte_t map_digit(char c)
 {
@@ -736,7 +1035,7 @@ static int forth_words(forth_cell_t dictionary[], struct forth_runtime_context *
 				return -1;
 			}
 		}
-		if (0 > rctx->write_string(rctx, (const char *)(&dictionary[hx - ((FORTH_ALIGN(name_length)) / sizeof(forth_cell_t))]), name_length))
+		if (0 > rctx->write_string(rctx, FORTH_HEADER_NAME(dictionary, hx), name_length))
 		{
 			return -1;
 		}
@@ -746,7 +1045,7 @@ static int forth_words(forth_cell_t dictionary[], struct forth_runtime_context *
 			return -1;
 		}
 
-		hx = h->link;
+		hx = FORTH_HEADER_NEXT(dictionary, hx);
 	}
 
 	return rctx->send_cr(rctx);
@@ -800,11 +1099,7 @@ void forth_print_error(struct forth_runtime_context *rctx, forth_scell_t code)
 #if defined(FORTH_INCLUDE_FILE_ACCESS_WORDS)
 	if (rctx->source_id > 0)	// FILE
 	{
-		rctx->sp--;
-		rctx->sp[0] = rctx->source_id;
-		forth_map_fid_to_name(rctx);
-		rctx->write_string(rctx, (char *)(rctx->sp[1]), rctx->sp[0]);
-		rctx->sp += 2;
+		forth_type0(rctx, forth_fid_to_name(rctx->source_id));
 		forth_type0(rctx, ": ");
 		forth_dot(rctx, 10, rctx->line_no);
 		forth_type0(rctx, ",");
@@ -821,7 +1116,7 @@ void forth_print_error(struct forth_runtime_context *rctx, forth_scell_t code)
 	case -2:
 		if ((0 != rctx->abort_msg_len) && (0 != rctx->abort_msg_addr))
 		{
-			rctx->write_string(rctx, (char *)(rctx->abort_msg_addr), rctx->abort_msg_len);
+			rctx->write_string(rctx, FORTH_POINTER(rctx->arena, rctx->abort_msg_addr), rctx->abort_msg_len);
 			rctx->abort_msg_addr = 0;
 			rctx->abort_msg_len = 0;
 		}
@@ -915,6 +1210,14 @@ const char *forth_token_name(forth_cell_t token)
 		case FORTH_TOKEN_Comma:		return ",";
 		case FORTH_TOKEN_CComma:	return "c,";
 		case FORTH_TOKEN_Imm_Plus:	return "imm+";
+		case FORTH_TOKEN_Imm_AND:	return "imm-and";
+		case FORTH_TOKEN_Imm_OR:	return "imm-or";
+		case FORTH_TOKEN_Imm_XOR:	return "imm-xor";
+		case FORTH_TOKEN_Imm_LSHIFT:	return "imm-lshift";
+		case FORTH_TOKEN_Imm_RSHIFT:	return "imm-rshift";
+		case FORTH_TOKEN_Imm_Equal:	return "imm=";
+		case FORTH_TOKEN_Imm_Less:	return "imm<";
+		case FORTH_TOKEN_Imm_Fetch:	return "imm+@";
 		case FORTH_TOKEN_CELLS:		return "cells";
 		case FORTH_TOKEN_DROP:		return "drop";
 		case FORTH_TOKEN_DUP:		return "dup";
@@ -940,6 +1243,30 @@ const char *forth_token_name(forth_cell_t token)
 		case FORTH_TOKEN_TIME_DATE:	return "time&date";
 #endif
 
+#if defined(FORTH_AOT)
+		case FORTH_TOKEN_TRANSLATE_C:	return "translate-c";
+#endif
+
+#if defined(FORTH_IMAGE)
+		case FORTH_TOKEN_SAVE_IMAGE:	return "save-image";
+#endif
+
+#if defined(FORTH_STACK_EFFECT)
+		case FORTH_TOKEN_STACK_EFFECT:	return "stack-effect";
+#endif
+
+#if defined(FORTH_WORDLIST_INDEX)
+		case FORTH_TOKEN_WORDLIST_INDEX: return "wordlist-index";
+#endif
+
+#if defined(FORTH_NAME_SPACE)
+		case FORTH_TOKEN_NAME_COMMA:	return "(name,)";
+#endif
+
+#if defined(FORTH_NATIVE_INTERPRET)
+		case FORTH_TOKEN_INTERPRET:	return "(interpret)";
+#endif
+
 		case FORTH_TOKEN_CR:		return "cr";
 		case FORTH_TOKEN_EMIT:		return "emit";
 		case FORTH_TOKEN_DUMP:		return "dump";
@@ -1140,12 +1467,33 @@ const char *forth_token_name(forth_cell_t token)
 		case FORTH_TOKEN_USER_ALLOT:	return "user-allot";
 		case FORTH_TOKEN_douser:	return "douser";
 #endif
+		case FORTH_TOKEN_OVER_Plus:	return "over +";
+		case FORTH_TOKEN_DUP_0Equal:	return "dup 0=";
+		case FORTH_TOKEN_Fetch_Plus:	return "@ +";
+		case FORTH_TOKEN_Rfrom_DROP:	return "r> drop";
+		case FORTH_TOKEN_I_Plus:	return "i +";
+		case FORTH_TOKEN_Equal_0branch:	return "= 0branch";
+		case FORTH_TOKEN_Notequal_0branch:	return "<> 0branch";
+		case FORTH_TOKEN_Less_0branch:	return "< 0branch";
+		case FORTH_TOKEN_Greater_0branch:	return "> 0branch";
+		case FORTH_TOKEN_ULess_0branch:	return "u< 0branch";
+		case FORTH_TOKEN_UGreater_0branch:	return "u> 0branch";
+		case FORTH_TOKEN_0Equal_0branch:	return "0= 0branch";
+		case FORTH_TOKEN_0Notequal_0branch:	return "0<> 0branch";
+		case FORTH_TOKEN_0Less_0branch:	return "0< 0branch";
+		case FORTH_TOKEN_0Greater_0branch:	return "0> 0branch";
+		case FORTH_TOKEN_tailcall:	return "tailcall";
+		case FORTH_TOKEN_inlined:	return "inlined";
+		case FORTH_TOKEN_native:	return "native";
+		case FORTH_TOKEN_compiled:	return "compiled";
+		case FORTH_TOKEN_compact:	return "compact";
 	}
 	return (const char *)0;
 }
 
 static int forth_show_name(struct forth_runtime_context *rctx, forth_cell_t xt)
 {
+	forth_cell_t *dictionary = rctx->dictionary;
 	forth_cell_t token_primitive;
 	forth_cell_t name_length;
 	const struct forth_header *h;
@@ -1173,7 +1521,7 @@ static int forth_show_name(struct forth_runtime_context *rctx, forth_cell_t xt)
 		}
 		else
 		{
-			return rctx->write_string(rctx, (const char *)(&dictionary[(xt - 2) - ((FORTH_ALIGN(name_length)) / sizeof(forth_cell_t))]), name_length);
+			return rctx->write_string(rctx, FORTH_HEADER_NAME(dictionary, xt - 2), name_length);
 		}
 	}
 
@@ -1239,6 +1587,17 @@ static int forth_print_next_symbol(struct forth_runtime_context *rctx, forth_cel
 				forth_show_name(rctx, dictionary[(*ix)++]);
 			break;
 
+			case FORTH_TOKEN_tailcall:
+				forth_show_name(rctx, dictionary[(*ix)++]);
+				forth_type0(rctx, " \\ tail call");
+			break;
+
+			case FORTH_TOKEN_inlined:
+				forth_show_name(rctx, dictionary[(*ix)++]);
+				forth_type0(rctx, " \\ inlined");
+				*ix += FORTH_PARAM_UNSIGNED(xt);
+			break;
+
 			case FORTH_TOKEN_Imm_Plus:
 				offset = FORTH_PARAM_SIGNED(xt);
 				
@@ -1254,8 +1613,58 @@ static int forth_print_next_symbol(struct forth_runtime_context *rctx, forth_cel
 				}
 			break;
 
+			case FORTH_TOKEN_Imm_AND:
+				forth_dot(rctx, rctx->base, FORTH_PARAM_SIGNED(xt));
+				forth_type0(rctx, " and");
+			break;
+
+			case FORTH_TOKEN_Imm_OR:
+				forth_dot(rctx, rctx->base, FORTH_PARAM_SIGNED(xt));
+				forth_type0(rctx, " or");
+			break;
+
+			case FORTH_TOKEN_Imm_XOR:
+				forth_dot(rctx, rctx->base, FORTH_PARAM_SIGNED(xt));
+				forth_type0(rctx, " xor");
+			break;
+
+			case FORTH_TOKEN_Imm_LSHIFT:
+				forth_dot(rctx, rctx->base, FORTH_PARAM_UNSIGNED(xt));
+				forth_type0(rctx, " lshift");
+			break;
+
+			case FORTH_TOKEN_Imm_RSHIFT:
+				forth_dot(rctx, rctx->base, FORTH_PARAM_UNSIGNED(xt));
+				forth_type0(rctx, " rshift");
+			break;
+
+			case FORTH_TOKEN_Imm_Equal:
+				forth_dot(rctx, rctx->base, FORTH_PARAM_SIGNED(xt));
+				forth_type0(rctx, " =");
+			break;
+
+			case FORTH_TOKEN_Imm_Less:
+				forth_dot(rctx, rctx->base, FORTH_PARAM_SIGNED(xt));
+				forth_type0(rctx, " <");
+			break;
+
+			case FORTH_TOKEN_Imm_Fetch:
+				forth_dot(rctx, rctx->base, FORTH_PARAM_SIGNED(xt));
+				forth_type0(rctx, " + @");
+			break;
+
 			case FORTH_TOKEN_branch:
 			case FORTH_TOKEN_0branch:
+			case FORTH_TOKEN_Equal_0branch:
+			case FORTH_TOKEN_Notequal_0branch:
+			case FORTH_TOKEN_Less_0branch:
+			case FORTH_TOKEN_Greater_0branch:
+			case FORTH_TOKEN_ULess_0branch:
+			case FORTH_TOKEN_UGreater_0branch:
+			case FORTH_TOKEN_0Equal_0branch:
+			case FORTH_TOKEN_0Notequal_0branch:
+			case FORTH_TOKEN_0Less_0branch:
+			case FORTH_TOKEN_0Greater_0branch:
 				forth_show_name(rctx, xt);
 				offset = FORTH_PARAM_SIGNED(xt);
 				if (0 <= offset)
@@ -1283,9 +1692,64 @@ static int forth_print_next_symbol(struct forth_runtime_context *rctx, forth_cel
 	return rctx->send_cr(rctx);
 }
 
+#if defined(FORTH_COMPACT_CODE)
+// The body of a compact definition, its cells are put back together for forth_print_next_symbol().
+// Branch offsets are shown as they are, in units.
+static void forth_see_compact(struct forth_runtime_context *rctx, forth_cell_t dictionary[], forth_cell_t xt)
+{
+	const uint16_t *units = FORTH_COMPACT_UNITS(dictionary);
+	const forth_cell_t *table = FORTH_COMPACT_TABLE(dictionary);
+	forth_cell_t ip = FORTH_COMPACT_BODY(xt);
+	forth_cell_t cells[2];
+	forth_cell_t ix;
+	forth_cell_t count;
+
+	while (1)
+	{
+		if (FORTH_COMPACT_ESCAPE == units[ip])
+		{
+			cells[0] = FORTH_COMPACT_CELL(&units[ip + 1]);
+			ip += 1 + FORTH_COMPACT_CELL_UNITS;
+		}
+		else
+		{
+			cells[0] = table[units[ip++]];
+		}
+
+		if (FORTH_PACK_TOKEN(FORTH_TOKEN_unnest) == cells[0])
+		{
+			return;
+		}
+
+		switch (FORTH_IS_TOKEN(cells[0]) ? FORTH_EXTRACT_TOKEN(cells[0]) : FORTH_TOKEN_COUNT)
+		{
+			case FORTH_TOKEN_strlit:
+				count = FORTH_PARAM_UNSIGNED(cells[0]);
+				forth_type0(rctx, "S\" ");
+				rctx->write_string(rctx, (char *)&units[ip], count);
+				forth_type0(rctx, "\"");
+				rctx->send_cr(rctx);
+				ip += (count + 1) / 2;
+			continue;
+
+			case FORTH_TOKEN_lit:
+			case FORTH_TOKEN_xtlit:
+			case FORTH_TOKEN_tailcall:
+				cells[1] = FORTH_COMPACT_CELL(&units[ip]);
+				ip += FORTH_COMPACT_CELL_UNITS;
+			break;
+		}
+
+		ix = 0;
+		forth_print_next_symbol(rctx, cells, &ix);
+	}
+}
+#endif
+
 static int forth_see(struct forth_runtime_context *rctx, forth_cell_t dictionary[], forth_cell_t xt)
 {
 	forth_cell_t ix;
+	forth_cell_t code;
 
 	if (FORTH_IS_TOKEN(xt))
 	{
@@ -1304,7 +1768,13 @@ static int forth_see(struct forth_runtime_context *rctx, forth_cell_t dictionary
 
 	switch(FORTH_EXTRACT_TOKEN(dictionary[xt]))
 	{
+		case FORTH_TOKEN_native:
+		case FORTH_TOKEN_compiled:
+#if defined(FORTH_COMPACT_CODE)
+		case FORTH_TOKEN_compact:
+#endif
 		case FORTH_TOKEN_nest:
+			code = dictionary[xt];
 			if (0 == (dictionary[xt - 1] & (FORTH_HEADER_FLAGS_NAME_LENGTH_MASK)))
 			{
 				forth_type0(rctx, ":NONAME");
@@ -1318,11 +1788,23 @@ static int forth_see(struct forth_runtime_context *rctx, forth_cell_t dictionary
 
 			ix = xt + 1;
 
+#if defined(FORTH_COMPACT_CODE)
+			if (FORTH_PACK_TOKEN(FORTH_TOKEN_compact) == code)
+			{
+				forth_see_compact(rctx, dictionary, xt);
+			}
+			else
+#endif
 			while (FORTH_TOKEN_unnest != FORTH_EXTRACT_TOKEN(xt = dictionary[ix]))
 			{
 				forth_print_next_symbol(rctx, dictionary, &ix);
 			}
 			forth_type0(rctx, ";");
+			if (FORTH_PACK_TOKEN(FORTH_TOKEN_nest) != code)	// Shows how it runs (native, compiled or compact).
+			{
+				forth_type0(rctx, " \\ ");
+				forth_show_name(rctx, code);
+			}
 		break;
 
 		case FORTH_TOKEN_dovar:
@@ -1407,7 +1889,7 @@ forth_scell_t forth_compare_environment(const char *qs, const char *es, forth_ce
 
 static void forth_query_environment(struct forth_runtime_context *rctx)
 {
-	char *s = (char *)(rctx->sp[1]);	
+	const char *s = FORTH_POINTER(rctx->arena, rctx->sp[1]);
 	forth_cell_t len  = rctx->sp[0];
 
 	rctx->sp[0] = FORTH_TRUE;
@@ -1430,7 +1912,7 @@ static void forth_query_environment(struct forth_runtime_context *rctx)
 	}
 	else if (0 == forth_compare_environment(s, "/PAD", len))
 	{
-		rctx->sp[1] = 84;
+		rctx->sp[1] = FORTH_PAD_LENGTH;
 	}
 /*
 	else if (0 == forth_compare_environment(s, "FLOORED", len))
@@ -1483,7 +1965,41 @@ static void forth_query_environment(struct forth_runtime_context *rctx)
 	}
 }
 
-forth_cell_t forth_translate_token(forth_cell_t xt)
+#if defined(FORTH_NAME_SPACE)
+forth_cell_t forth_name_comma(forth_cell_t dictionary[], forth_cell_t wid, const char *name, forth_cell_t len)
+{
+	const struct forth_wordlist *wl = (const struct forth_wordlist *)(&dictionary[wid]);
+	forth_cell_t dp = FORTH_ALIGN(dictionary[FORTH_DP_LOCATION]);
+	forth_cell_t size = sizeof(struct forth_name) + FORTH_ALIGN(len + 1);
+	forth_cell_t header = dp / sizeof(forth_cell_t);
+	forth_cell_t np;
+	struct forth_name *n;
+	unsigned char *counted;
+
+	if ((dictionary[FORTH_DP_MAX_LOCATION] - dp) <= (size + sizeof(struct forth_header)))
+	{
+		return 0;
+	}
+
+	np = dictionary[FORTH_DP_MAX_LOCATION] - size;
+	n = (struct forth_name *)(((char *)dictionary) + np);
+	n->link = (0 != wl->latest) ? dictionary[wl->latest] : 0;
+	n->xt = header + (sizeof(struct forth_header) / sizeof(forth_cell_t));
+	memset(n + 1, 0, FORTH_ALIGN(len + 1));
+	counted = (unsigned char *)(n + 1);
+	counted[0] = len;
+	memcpy(counted + 1, name, len);
+
+	dictionary[FORTH_DP_MAX_LOCATION] = np;
+
+	dictionary[header] = np / sizeof(forth_cell_t);
+	dictionary[header + 1] = len;
+	dictionary[FORTH_DP_LOCATION] = dp + sizeof(struct forth_header);
+	return header;
+}
+#endif
+
+forth_cell_t forth_translate_token(forth_cell_t dictionary[], forth_cell_t xt)
 {
 	const struct forth_header *h;
 
@@ -1501,1683 +2017,799 @@ forth_cell_t forth_translate_token(forth_cell_t xt)
 	return xt;
 }
 
-// =======================================================================================
-int forth(struct forth_runtime_context *rctx, forth_cell_t word_to_exec)
+#if defined(FORTH_PEEPHOLE_OPTIMIZER)
+// Pairs of tokens that have a superinstruction.
+static const forth_cell_t forth_superinstructions[][3] =
 {
-	register forth_index_t ip = rctx->ip;
-	register forth_cell_t  *sp = rctx->sp;
-	register forth_cell_t  *rp = rctx->rp;
-	register forth_cell_t  *dictionary = rctx->dictionary;
-	register forth_cell_t  w = 0;
-	register forth_cell_t  xt = word_to_exec;
-	forth_cell_t token_primitive;
-	register forth_cell_t  tos;
-	forth_dcell_t dtos;
-	forth_scell_t i;
-	// forth_cell_t exception_handler = 0;
-	char c;
-	char *src;
-	char *dest;
-#if defined(FORTH_EXTERNAL_PRIMITIVES)
-	forth_external_primitive ep;
-#endif
+	// First			Second				Fused
+	{ FORTH_TOKEN_OVER,		FORTH_TOKEN_Plus,		FORTH_TOKEN_OVER_Plus },
+	{ FORTH_TOKEN_DUP,		FORTH_TOKEN_0Equal,		FORTH_TOKEN_DUP_0Equal },
+	{ FORTH_TOKEN_Fetch,		FORTH_TOKEN_Plus,		FORTH_TOKEN_Fetch_Plus },
+	{ FORTH_TOKEN_Rfrom,		FORTH_TOKEN_DROP,		FORTH_TOKEN_Rfrom_DROP },
+	{ FORTH_TOKEN_SWAP,		FORTH_TOKEN_DROP,		FORTH_TOKEN_NIP },
+	{ FORTH_TOKEN_I,		FORTH_TOKEN_Plus,		FORTH_TOKEN_I_Plus },
+	{ FORTH_TOKEN_Equal,		FORTH_TOKEN_0branch,		FORTH_TOKEN_Equal_0branch },
+	{ FORTH_TOKEN_Notequal,		FORTH_TOKEN_0branch,		FORTH_TOKEN_Notequal_0branch },
+	{ FORTH_TOKEN_Less,		FORTH_TOKEN_0branch,		FORTH_TOKEN_Less_0branch },
+	{ FORTH_TOKEN_Greater,		FORTH_TOKEN_0branch,		FORTH_TOKEN_Greater_0branch },
+	{ FORTH_TOKEN_ULess,		FORTH_TOKEN_0branch,		FORTH_TOKEN_ULess_0branch },
+	{ FORTH_TOKEN_UGreater,		FORTH_TOKEN_0branch,		FORTH_TOKEN_UGreater_0branch },
+	{ FORTH_TOKEN_0Equal,		FORTH_TOKEN_0branch,		FORTH_TOKEN_0Equal_0branch },
+	{ FORTH_TOKEN_0Notequal,	FORTH_TOKEN_0branch,		FORTH_TOKEN_0Notequal_0branch },
+	{ FORTH_TOKEN_0Less,		FORTH_TOKEN_0branch,		FORTH_TOKEN_0Less_0branch },
+	{ FORTH_TOKEN_0Greater,		FORTH_TOKEN_0branch,		FORTH_TOKEN_0Greater_0branch },
+};
+
+// The token that does what the two do in sequence, or 0.
+static forth_cell_t forth_fuse_tokens(forth_cell_t first, forth_cell_t second)
+{
+	forth_cell_t i;
 
-#define POP() *(sp++)
-#define PUSH(X) *(--sp) = ((forth_cell_t)(X))
-#define THROW(X) PUSH(X); xt = FORTH_PACK_TOKEN(FORTH_TOKEN_THROW); continue
-
-#define RPOP()	*(rp++)
-#define RPUSH(X) *(--rp) = ((forth_cell_t)(X))
-
-// For DO-LOOPs
-#define LOOP_I rp[0]
-#define LOOP_J rp[3]
-#define LOOP_LIMIT   rp[1]
-#define LOOP_ADDRESS_AFTER rp[2]
-#define LOOP_ADJUSTMENT 3
-
-#define SIGNED_PARAMETER   FORTH_PARAM_SIGNED(xt)
-#define UNSIGNED_PARAMETER FORTH_PARAM_UNSIGNED(xt)
-
-	while (1)
+	for (i = 0; i < (sizeof(forth_superinstructions) / sizeof(forth_superinstructions[0])); i++)
 	{
-#if defined(FORTH_STACK_CHECK_ENABLED)
-		if (sp < rctx->sp_min)
-		{
-			*sp = -3;
-			w = 0;
-			xt = FORTH_PACK_TOKEN(FORTH_TOKEN_THROW);
-		} else if (sp > rctx->sp_max)
-		{
-			*sp = -4;
-			w = 0;
-			xt = FORTH_PACK_TOKEN(FORTH_TOKEN_THROW);
-		} else if (rp < rctx->rp_min)
-		{
-			*sp = -5;
-			w = 0;
-			xt = FORTH_PACK_TOKEN(FORTH_TOKEN_THROW);
-		} else if (rp > rctx->rp_max)
-		{
-			*sp = -6;
-			w = 0;
-			xt = FORTH_PACK_TOKEN(FORTH_TOKEN_THROW);
-		}
-#endif
-		if (rctx->trace)
+		if ((FORTH_PACK_TOKEN(forth_superinstructions[i][0]) == first) && (FORTH_PACK_TOKEN(forth_superinstructions[i][1]) == second))
 		{
-			rctx->sp = sp;
-			if (0 > forth_show_executing(rctx, w, xt))
-			{
-				// What to do here?
-				THROW(-57);
-			}
-		}
-		// printf("xt = 0x%08x\n", xt); fflush(stdout);
-		if (FORTH_IS_NOT_TOKEN(xt))
-		{
-			// printf("not token xt = 0x%08x\n", xt); fflush(stdout);
-			w = FORTH_INDEX_EXTRACT(xt);
-			xt = dictionary[w];
-			// printf("new xt = 0x%08x\n", xt); fflush(stdout);
-			continue;
+			return FORTH_PACK_TOKEN(forth_superinstructions[i][2]);
 		}
+	}
 
-		token_primitive = FORTH_EXTRACT_TOKEN(xt);
-
-#if 1
-//		printf("\t[%08X] token xt = 0x%08x: %s [0X%04X]\n", w, xt, forth_token_name(token_primitive), UNSIGNED_PARAMETER); fflush(stdout);
-#endif
-		switch(token_primitive)
-		{
-			case FORTH_TOKEN_NOP:
-			break;
-
-			case FORTH_TOKEN_ACCEPT:
-				tos = POP();
-				tos = forth_accept(rctx, (char *)tos, *sp);
-
-				if (0 > (forth_scell_t)tos)
-				{
-					THROW(-57);
-				}
-
-				PUSH(tos);
-			break;
-
-			case FORTH_TOKEN_KEY:
-				if (0 == rctx->key)
-				{
-					THROW(-21);
-				}
-
-				tos = rctx->key(rctx);
-
-				if (FORTH_TRUE == tos)
-				{
-					THROW(-57);
-				}
-
-				PUSH(tos);
-			break;
-
-			case FORTH_TOKEN_EKEY:
-				if (0 == rctx->ekey)
-				{
-					THROW(-21);
-				}
-
-				tos = rctx->ekey(rctx);
-
-				if (FORTH_TRUE == tos)
-				{
-					THROW(-57);
-				}
-
-				PUSH(tos);
-			break;
-
-			case FORTH_TOKEN_KEYq:		// KEY?
-				if (0 == rctx->key_q)
-				{
-					THROW(-21);
-				}
-
-				tos = rctx->key_q(rctx);
-
-				if (((forth_scell_t) tos) < 0)
-				{
-					THROW(-21);
-				}
-
-				tos = tos ? FORTH_TRUE : FORTH_FALSE;
-				PUSH(tos);
-			break;
-
-			case FORTH_TOKEN_EKEYq:		// EKEY?
-				if (0 == rctx->ekey_q)
-				{
-					THROW(-21);
-				}
-
-				tos = rctx->ekey_q(rctx);
-				if (((forth_scell_t) tos) < 0)
-				{
-					THROW(-21);
-				}
-
-				tos = tos ? FORTH_TRUE : FORTH_FALSE;
-				PUSH(tos);
-			break;
-
-			case FORTH_TOKEN_EKEY2CHAR:	// EKEY>CHAR
-				if (0 == rctx->ekey_to_char)
-				{
-					THROW(-21);
-				}
-
-				tos = rctx->ekey_to_char(rctx, sp[0]);
-
-				if (FORTH_TRUE == tos)
-				{
-					PUSH(FORTH_FALSE);
-				}
-				else
-				{
-					sp[0] = tos;
-					PUSH(FORTH_TRUE);
-				}
-			break;
-
-			case FORTH_TOKEN_ALIGN:
-				// pctx->dp = FORTH_ALIGN((pctx->dp));
-				dictionary[FORTH_DP_LOCATION] = FORTH_ALIGN(dictionary[FORTH_DP_LOCATION]);
-			break;
-
-			case FORTH_TOKEN_ALIGNED:
-				*sp = FORTH_ALIGN(*sp);
-			break;
-
-			case FORTH_TOKEN_ALLOT:
-				tos = POP();
-				if (dictionary[FORTH_DP_MAX_LOCATION] <=  (dictionary[FORTH_DP_LOCATION] + tos))
-				{
-					THROW(-8);
-				}
-				dictionary[FORTH_DP_LOCATION] += tos;
-			break;
-
-			case FORTH_TOKEN_PAD:	// Just use HERE for now.
-			case FORTH_TOKEN_HERE:
-				tos = ((forth_cell_t)dictionary) + dictionary[FORTH_DP_LOCATION];
-				PUSH(tos);
-			break;
-
-			case FORTH_TOKEN_pHERE:
-				tos = (dictionary[FORTH_DP_LOCATION] / sizeof(forth_cell_t));
-				PUSH(tos);
-			break;
-
-			case FORTH_TOKEN_pTRACE:
-				tos = (forth_cell_t)(&(rctx->trace));
-				PUSH(tos);
-			break;
-
-			case FORTH_TOKEN_CompileComma:	// COMPILE,
-				*sp = forth_translate_token(*sp);
-				// FALL THROUGH TO Comma.
-			case FORTH_TOKEN_Comma:		// ,
-				if (dictionary[FORTH_DP_MAX_LOCATION] <=  (dictionary[FORTH_DP_LOCATION] + sizeof(forth_cell_t)))
-				{
-					THROW(-8);
-				}
-				tos = ((forth_cell_t)dictionary) + dictionary[FORTH_DP_LOCATION];
-				*(forth_cell_t *)tos = POP();
-				dictionary[FORTH_DP_LOCATION] += sizeof(forth_cell_t);
-			break;
-
-			case FORTH_TOKEN_CComma:		// C,
-				if (dictionary[FORTH_DP_MAX_LOCATION] <=  (dictionary[FORTH_DP_LOCATION] + sizeof(char)))
-				{
-					THROW(-8);
-				}
-				tos = ((forth_cell_t)dictionary) + dictionary[FORTH_DP_LOCATION];
-				*(char *)tos = POP();
-				dictionary[FORTH_DP_LOCATION] += sizeof(char);
-			break;
+	return 0;
+}
 
-			case FORTH_TOKEN_Imm_Plus:				// imm+
-				*sp += SIGNED_PARAMETER;
-			break;
+// A short literal (uslit or sslit) for value, or 0 if it does not fit into the token parameter.
+static forth_cell_t forth_short_literal(forth_cell_t value)
+{
+	forth_cell_t packed = FORTH_PARAM_PACK(value);
 
-			case FORTH_TOKEN_Subtract:	// -
-				sp[1] -= sp[0];
-				sp++;
-			break;
+	if (FORTH_PARAM_UNSIGNED(packed) == value)
+	{
+		return FORTH_PACK_TOKEN(FORTH_TOKEN_uslit) | packed;
+	}
+	else if (FORTH_PARAM_SIGNED(packed) == value)
+	{
+		return FORTH_PACK_TOKEN(FORTH_TOKEN_sslit) | packed;
+	}
 
-			case FORTH_TOKEN_Divide:	// /
-				tos = POP();
-				sp[0] = (forth_cell_t)((forth_scell_t)sp[0] / (forth_scell_t)tos);
-			break;
+	return 0;
+}
 
-			case FORTH_TOKEN_MOD:
-				tos = POP();
-				sp[0] = (forth_cell_t)((forth_scell_t)sp[0] % (forth_scell_t)tos);
-			break;
+// Fold a short literal (or an imm+) into the operator that follows it, or return 0.
+static forth_cell_t forth_fold_immediate(forth_cell_t first, forth_cell_t second)
+{
+	forth_cell_t value;
+	forth_cell_t packed;
 
-			case FORTH_TOKEN_Slash_MOD:	// /MOD
-				tos = sp[0];
-				sp[0] = (forth_cell_t)((forth_scell_t)sp[1] / (forth_scell_t)tos);
-				sp[1] = (forth_cell_t)((forth_scell_t)sp[1] % (forth_scell_t)tos);
-			break;
+	if (!FORTH_IS_TOKEN(first))
+	{
+		return 0;
+	}
 
-#if !defined(FORTH_NO_DOUBLES)
-			case FORTH_TOKEN_StarSlash:	// */
-				sp[2] = (forth_cell_t)((((forth_sdcell_t)sp[2]) * (forth_scell_t)sp[1]) / (forth_scell_t)sp[0]);
-				sp += 2;
-			break;
+	if (FORTH_PACK_TOKEN(FORTH_TOKEN_Fetch) == second)
+	{
+		// n + @ -- struct fields, CELL+ @ and the like.
+		if (FORTH_TOKEN_Imm_Plus == FORTH_EXTRACT_TOKEN(first))
+		{
+			return FORTH_PACK_TOKEN(FORTH_TOKEN_Imm_Fetch) | FORTH_PARAM_PACK(FORTH_PARAM_SIGNED(first));
+		}
+		return 0;
+	}
 
-			case FORTH_TOKEN_StarSlash_MOD:	// */MOD
-				dtos = (forth_dcell_t)(((forth_sdcell_t)sp[2]) * (forth_scell_t)sp[1]);
-				tos = POP();
-				sp[1] = (forth_cell_t)(((forth_sdcell_t)dtos) % (forth_scell_t)tos);
-				sp[0] = (forth_cell_t)(((forth_sdcell_t)dtos) / (forth_scell_t)tos);
-			break;
+	if (FORTH_TOKEN_uslit == FORTH_EXTRACT_TOKEN(first))
+	{
+		value = FORTH_PARAM_UNSIGNED(first);
+	}
+	else if (FORTH_TOKEN_sslit == FORTH_EXTRACT_TOKEN(first))
+	{
+		value = FORTH_PARAM_SIGNED(first);
+	}
+	else
+	{
+		return 0;
+	}
 
-			case FORTH_TOKEN_UM_Star:	// UM*
-				dtos = (forth_dcell_t)sp[0] * sp[1];
-				sp[1] = FORTH_CELL_LOW(dtos);
-				sp[0] = FORTH_CELL_HIGH(dtos);
-			break;
+	switch (FORTH_EXTRACT_TOKEN(second))
+	{
+		case FORTH_TOKEN_CELLS:		// n CELLS is just a bigger literal, ready for a + to be folded into it.
+			return forth_short_literal(value * sizeof(forth_cell_t));
 
-			case FORTH_TOKEN_M_Star:	// M* ( n1 n2 -- d )
-				dtos = (forth_dcell_t)((forth_sdcell_t)((forth_scell_t)sp[1]) * (forth_scell_t)(sp[0]));
-				sp[1] = FORTH_CELL_LOW(dtos);
-				sp[0] = FORTH_CELL_HIGH(dtos);
-			break;
+		case FORTH_TOKEN_Subtract:
+			value = -value;
+			second = FORTH_PACK_TOKEN(FORTH_TOKEN_Plus);
+		break;
+	}
 
-			case FORTH_TOKEN_M_Plus:	// M+ ( d1 n -- d2 )
-				dtos = FORTH_DCELL(sp[1], sp[2]);
-				dtos = dtos + POP();
-				sp[1] = FORTH_CELL_LOW(dtos);
-				sp[0] = FORTH_CELL_HIGH(dtos);
-			break;
+	// The immediate forms take a signed parameter.
+	packed = FORTH_PARAM_PACK(value);
+	if (FORTH_PARAM_SIGNED(packed) != value)
+	{
+		return 0;
+	}
 
+	switch (FORTH_EXTRACT_TOKEN(second))
+	{
+		case FORTH_TOKEN_Plus:		return FORTH_PACK_TOKEN(FORTH_TOKEN_Imm_Plus) | packed;
+		case FORTH_TOKEN_AND:		return FORTH_PACK_TOKEN(FORTH_TOKEN_Imm_AND) | packed;
+		case FORTH_TOKEN_OR:		return FORTH_PACK_TOKEN(FORTH_TOKEN_Imm_OR) | packed;
+		case FORTH_TOKEN_XOR:		return FORTH_PACK_TOKEN(FORTH_TOKEN_Imm_XOR) | packed;
+		case FORTH_TOKEN_LSHIFT:	return FORTH_PACK_TOKEN(FORTH_TOKEN_Imm_LSHIFT) | packed;
+		case FORTH_TOKEN_RSHIFT:	return FORTH_PACK_TOKEN(FORTH_TOKEN_Imm_RSHIFT) | packed;
+		case FORTH_TOKEN_Equal:		return FORTH_PACK_TOKEN(FORTH_TOKEN_Imm_Equal) | packed;
+		case FORTH_TOKEN_Less:		return FORTH_PACK_TOKEN(FORTH_TOKEN_Imm_Less) | packed;
+	}
 
-			case FORTH_TOKEN_UM_Slash_MOD:	// UM/MOD
-				tos = POP();
-				dtos = FORTH_DCELL(sp[0], sp[1]);
-				sp[1] = (forth_cell_t)(dtos % tos);
-				sp[0] = (forth_cell_t)(dtos / tos);
-			break;
+	return 0;
+}
 #endif
-			case FORTH_TOKEN_Multiply:	// *
-				tos = POP();
-				sp[0] = sp[0] * tos;
-			break;
-
-			case FORTH_TOKEN_NEGATE:
-				sp[0] = -(forth_scell_t)sp[0];
-			break;
-
-			case FORTH_TOKEN_INVERT:
-				sp[0] = ~sp[0];
-			break;
-
-			case FORTH_TOKEN_ABS:
-				if (0 > (forth_scell_t)sp[0])
-				{
-					sp[0] = -(forth_scell_t)sp[0];
-				}
-			break;
-
-			case FORTH_TOKEN_MIN:
-				tos = POP();
-				if ((forth_scell_t)sp[0] > (forth_scell_t)tos)
-				{
-					sp[0] = tos;
-				}
-			break;
 
-			case FORTH_TOKEN_MAX:
-				tos = POP();
-				if ((forth_scell_t)sp[0] < (forth_scell_t)tos)
-				{
-					sp[0] = tos;
-				}
-			break;
+#if defined(FORTH_CONSTANT_FOLDING)
+// The value of the literal (uslit, sslit or lit) compiled at dictionary index ix.
+static forth_cell_t forth_literal_value(const forth_cell_t *dictionary, forth_cell_t ix)
+{
+	switch (FORTH_EXTRACT_TOKEN(dictionary[ix]))
+	{
+		case FORTH_TOKEN_uslit:		return FORTH_PARAM_UNSIGNED(dictionary[ix]);
+		case FORTH_TOKEN_sslit:		return FORTH_PARAM_SIGNED(dictionary[ix]);
+	}
 
-			case FORTH_TOKEN_LSHIFT:
-				tos = POP();
-				sp[0] <<= tos;
-			break;
+	return dictionary[ix + 1];
+}
 
-			case FORTH_TOKEN_RSHIFT:
-				tos = POP();
-				sp[0] >>= tos;
-			break;
+// A literal was just compiled at dp offset at, add it to the window of pending literals.
+// The window only holds literals that follow each other right at the end of the code being compiled,
+// anything else compiled in between (or a branch target) starts a new window.
+static void forth_pending_literal(struct forth_runtime_context *rctx, forth_cell_t at)
+{
+	forth_cell_t i;
 
-			case FORTH_TOKEN_2_Star:	// 2*
-				(*sp) <<= 1;
-			break;
+	if (rctx->peephole != at)
+	{
+		rctx->literal_cnt = 0;
+	}
 
-			case FORTH_TOKEN_2_Slash:	// 2/
-				(*sp) >>= 1;
-			break;
+	if (FORTH_CONSTANT_FOLDING == rctx->literal_cnt)
+	{
+		for (i = 1; i < FORTH_CONSTANT_FOLDING; i++)
+		{
+			rctx->literals[i - 1] = rctx->literals[i];
+		}
+		rctx->literal_cnt--;
+	}
 
-#if !defined(FORTH_NO_DOUBLES)
-			case FORTH_TOKEN_D2_Star:	// d2*
-				dtos = FORTH_DCELL(sp[0], sp[1]);
-				dtos <<= 1;
-				sp[1] = FORTH_CELL_LOW(dtos);
-				sp[0] = FORTH_CELL_HIGH(dtos);
-			break;
+	rctx->literals[rctx->literal_cnt++] = at;
+	rctx->peephole = rctx->dictionary[FORTH_DP_LOCATION];
+}
 
-			case FORTH_TOKEN_D2_Slash:	// d2/
-				dtos = FORTH_DCELL(sp[0], sp[1]);
-				dtos >>= 1;
-				sp[1] = FORTH_CELL_LOW(dtos);
-				sp[0] = FORTH_CELL_HIGH(dtos);
-			break;
+// Evaluate a pure primitive on the pending literals at compile time, the result replaces them.
+// Returns 1 if xt was folded, 0 if it has to be compiled.
+static int forth_fold_constants(struct forth_runtime_context *rctx, forth_cell_t xt)
+{
+	forth_cell_t *dictionary = rctx->dictionary;
+	forth_cell_t cnt = rctx->literal_cnt;
+	forth_cell_t at;
+	forth_cell_t a;
+	forth_cell_t b;
 
+	if ((0 == cnt) || (rctx->peephole != dictionary[FORTH_DP_LOCATION]) || !FORTH_IS_TOKEN(xt))
+	{
+		return 0;
+	}
 
-			case FORTH_TOKEN_DNEGATE:
-				dtos = FORTH_DCELL(sp[0], sp[1]);
-				dtos = -(forth_sdcell_t)dtos;
-				sp[1] = FORTH_CELL_LOW(dtos);
-				sp[0] = FORTH_CELL_HIGH(dtos);
-			break;
+	at = rctx->literals[cnt - 1];
+	b = forth_literal_value(dictionary, at / sizeof(forth_cell_t));
+
+	switch (FORTH_EXTRACT_TOKEN(xt))
+	{
+		case FORTH_TOKEN_NEGATE:	b = 0 - b;					break;
+		case FORTH_TOKEN_INVERT:	b = ~b;						break;
+		case FORTH_TOKEN_ABS:		b = (0 > (forth_scell_t)b) ? (0 - b) : b;	break;
+		case FORTH_TOKEN_CELLS:		b *= sizeof(forth_cell_t);			break;
+		case FORTH_TOKEN_2_Star:	b <<= 1;					break;
+		case FORTH_TOKEN_2_Slash:	b >>= 1;					break;
+		case FORTH_TOKEN_0Equal:	b = (0 == b) ? FORTH_TRUE : FORTH_FALSE;	break;
+		case FORTH_TOKEN_0Notequal:	b = (0 != b) ? FORTH_TRUE : FORTH_FALSE;	break;
+		case FORTH_TOKEN_0Less:		b = (0 > (forth_scell_t)b) ? FORTH_TRUE : FORTH_FALSE;	break;
+		case FORTH_TOKEN_0Greater:	b = (0 < (forth_scell_t)b) ? FORTH_TRUE : FORTH_FALSE;	break;
+		case FORTH_TOKEN_Imm_Plus:	b += FORTH_PARAM_SIGNED(xt);			break;	// 1+ CELL+ etc.
+		case FORTH_TOKEN_Imm_AND:	b &= FORTH_PARAM_SIGNED(xt);			break;
+		case FORTH_TOKEN_Imm_OR:	b |= FORTH_PARAM_SIGNED(xt);			break;
+		case FORTH_TOKEN_Imm_XOR:	b ^= FORTH_PARAM_SIGNED(xt);			break;
+		case FORTH_TOKEN_Imm_Equal:	b = (b == (forth_cell_t)FORTH_PARAM_SIGNED(xt)) ? FORTH_TRUE : FORTH_FALSE;	break;
+		case FORTH_TOKEN_Imm_Less:	b = (((forth_scell_t)b) < FORTH_PARAM_SIGNED(xt)) ? FORTH_TRUE : FORTH_FALSE;	break;
+
+		case FORTH_TOKEN_Imm_LSHIFT:
+		case FORTH_TOKEN_Imm_RSHIFT:
+			if ((8 * sizeof(forth_cell_t)) <= FORTH_PARAM_UNSIGNED(xt))	// Leave what C does not define to run time.
+			{
+				return 0;
+			}
+			b = (FORTH_TOKEN_Imm_LSHIFT == FORTH_EXTRACT_TOKEN(xt)) ? (b << FORTH_PARAM_UNSIGNED(xt)) : (b >> FORTH_PARAM_UNSIGNED(xt));
+		break;
 
-			case FORTH_TOKEN_DABS:
-				if (0 > (forth_scell_t)(sp[0]))
-				{
-					xt = FORTH_PACK_TOKEN(FORTH_TOKEN_DNEGATE);
-					continue;
-				}
-			break;
+		default:	// Binary operators.
+			if (2 > cnt)
+			{
+				return 0;
+			}
 
-			case FORTH_TOKEN_DMIN:
-				dtos = FORTH_DCELL(sp[0], sp[1]);
-				if ((forth_sdcell_t)dtos < (forth_sdcell_t)FORTH_DCELL(sp[2], sp[3]))
-				{
-					sp[0] = sp[2];
-					sp[1] = sp[3];
-				}
-				sp += 2;
-			break;
+			at = rctx->literals[cnt - 2];
+			a = forth_literal_value(dictionary, at / sizeof(forth_cell_t));
 
-			case FORTH_TOKEN_DMAX:
-				dtos = FORTH_DCELL(sp[0], sp[1]);
-				if ((forth_sdcell_t)dtos < (forth_sdcell_t)FORTH_DCELL(sp[2], sp[3]))
-				{
-					sp[0] = sp[2];
-					sp[1] = sp[3];
-				}
-				sp += 2;
-			break;
+			switch (FORTH_EXTRACT_TOKEN(xt))
+			{
+				case FORTH_TOKEN_Plus:		b = a + b;	break;
+				case FORTH_TOKEN_Subtract:	b = a - b;	break;
+				case FORTH_TOKEN_Multiply:	b = a * b;	break;
+				case FORTH_TOKEN_AND:		b = a & b;	break;
+				case FORTH_TOKEN_OR:		b = a | b;	break;
+				case FORTH_TOKEN_XOR:		b = a ^ b;	break;
+				case FORTH_TOKEN_Equal:		b = (a == b) ? FORTH_TRUE : FORTH_FALSE;	break;
+				case FORTH_TOKEN_Notequal:	b = (a != b) ? FORTH_TRUE : FORTH_FALSE;	break;
+				case FORTH_TOKEN_Less:		b = (((forth_scell_t)a) < ((forth_scell_t)b)) ? FORTH_TRUE : FORTH_FALSE;	break;
+				case FORTH_TOKEN_Greater:	b = (((forth_scell_t)a) > ((forth_scell_t)b)) ? FORTH_TRUE : FORTH_FALSE;	break;
+				case FORTH_TOKEN_ULess:		b = (a < b) ? FORTH_TRUE : FORTH_FALSE;	break;
+				case FORTH_TOKEN_UGreater:	b = (a > b) ? FORTH_TRUE : FORTH_FALSE;	break;
+				case FORTH_TOKEN_MAX:		b = (((forth_scell_t)a) < ((forth_scell_t)b)) ? b : a;	break;
+				case FORTH_TOKEN_MIN:		b = (((forth_scell_t)a) > ((forth_scell_t)b)) ? b : a;	break;
+
+				case FORTH_TOKEN_LSHIFT:
+				case FORTH_TOKEN_RSHIFT:
+					if ((8 * sizeof(forth_cell_t)) <= b)
+					{
+						return 0;
+					}
+					b = (FORTH_TOKEN_LSHIFT == FORTH_EXTRACT_TOKEN(xt)) ? (a << b) : (a >> b);
+				break;
 
-			case FORTH_TOKEN_D_Plus:	// d+
-				dtos = FORTH_DCELL(sp[0], sp[1]);
-				sp += 2;
-				dtos += FORTH_DCELL(sp[0], sp[1]);
-				sp[1] = FORTH_CELL_LOW(dtos);
-				sp[0] = FORTH_CELL_HIGH(dtos);
-			break;
+				default:
+					return 0;
+			}
+			cnt--;
+		break;
+	}
 
-			case FORTH_TOKEN_D_Subtract:	// d-
-				dtos = FORTH_DCELL(sp[2], sp[3]);
-				dtos -= FORTH_DCELL(sp[0], sp[1]);
-				sp += 2;
-				sp[1] = FORTH_CELL_LOW(dtos);
-				sp[0] = FORTH_CELL_HIGH(dtos);
-			break;
+	// The result may need a full lit where the operands were short literals.
+	if (!FORTH_DICTIONARY_ROOM(dictionary, at + (2 * sizeof(forth_cell_t))))
+	{
+		return 0;
+	}
 
-			case FORTH_TOKEN_D_Less:	// D<
-				sp[3] = ((forth_sdcell_t)(FORTH_DCELL(sp[0], sp[1])) > (forth_sdcell_t)(FORTH_DCELL(sp[2], sp[3]))) ? FORTH_TRUE : FORTH_FALSE;
-				sp += 3;
-			break;
+	rctx->literal_cnt = cnt;
+	dictionary[FORTH_DP_LOCATION] = at + forth_literal(&dictionary[at / sizeof(forth_cell_t)], b) * sizeof(forth_cell_t);
+	rctx->peephole = dictionary[FORTH_DP_LOCATION];
 
-			case FORTH_TOKEN_D_ULess:	// DU<
-				sp[3] = (FORTH_DCELL(sp[0], sp[1]) > FORTH_DCELL(sp[2], sp[3])) ? FORTH_TRUE : FORTH_FALSE;
-				sp += 3;
-			break;
+	return 1;
+}
 #endif
-			case FORTH_TOKEN_D_Equal:	// D=
-				sp[3] = ((sp[3] == sp[2]) && (sp[1] == sp[0])) ? FORTH_TRUE : FORTH_FALSE;
-				sp += 3;
-			break;
-
-			case FORTH_TOKEN_AND:
-				sp[1] &= sp[0];
-				sp++;
-			break;
-
-			case FORTH_TOKEN_OR:
-				sp[1] |= sp[0];
-				sp++;
-			break;
-
-			case FORTH_TOKEN_XOR:
-				sp[1] ^= sp[0];
-				sp++;
-			break;
-
-			case FORTH_TOKEN_CELLS:
-				*sp = sizeof(forth_cell_t) * (*sp);
-			break;
 
-			case FORTH_TOKEN_DROP:
-				sp++;
-			break;
-
-			case FORTH_TOKEN_2ROT:
-				tos = sp[0];
-				sp[0] = sp[4];
-				sp[4] = sp[2];
-				sp[2] = tos;
-				tos = sp[1];
-				sp[1] = sp[5];
-				sp[5] = sp[3];
-				sp[3] = tos;
-			
-			break;
-
-			case FORTH_TOKEN_2DUP:
-				sp -= 2;
-				sp[1] = sp[3];
-				sp[0] = sp[2];
-			break;
+#if defined(FORTH_INLINE_THRESHOLD) || defined(FORTH_TAIL_CALL_OPTIMIZER)
+// Tokens that get at the return address of the definition they are in, or put something on top of it.
+// EXIT is not one of them, it leaves through that return address the same way unnest does.
+static int forth_uses_return_stack(forth_cell_t token)
+{
+	switch (FORTH_EXTRACT_TOKEN(token))
+	{
+		case FORTH_TOKEN_toR:
+		case FORTH_TOKEN_Rfrom:
+		case FORTH_TOKEN_Rfetch:
+		case FORTH_TOKEN_Rfrom_DROP:
+		case FORTH_TOKEN_2toR:
+		case FORTH_TOKEN_2Rfrom:
+		case FORTH_TOKEN_2Rfetch:
+		case FORTH_TOKEN_NtoR:
+		case FORTH_TOKEN_NRfrom:
+		case FORTH_TOKEN_rp_fetch:
+		case FORTH_TOKEN_rp_store:
+			return 1;
 
-			case FORTH_TOKEN_2DROP:
-				sp += 2;
-			break;
+		default:
+			return 0;
+	}
+}
+#endif
 
-			case FORTH_TOKEN_2OVER:
-				sp -= 2;
-				sp[1] = sp[5];
-				sp[0] = sp[4];
-			break;
+#if defined(FORTH_TAIL_CALL_OPTIMIZER)
+// 1 if the cells of a body from ix up to end leave the return stack alone, a tail call to it cannot take
+// the return address of its caller then. The words it calls get return addresses of their own.
+static int forth_keeps_return_stack(forth_cell_t dictionary[], forth_cell_t ix, forth_cell_t end)
+{
+	for ( ; ix < end; ix++)
+	{
+		if (FORTH_IS_NOT_TOKEN(dictionary[ix]))
+		{
+			continue;
+		}
 
-			case FORTH_TOKEN_2SWAP:
-				tos = sp[0];
-				sp[0] = sp[2];
-				sp[2] = tos;
-				tos = sp[1];
-				sp[1] = sp[3];
-				sp[3] = tos;
-			break;
+		if (forth_uses_return_stack(dictionary[ix]))
+		{
+			return 0;
+		}
 
-			case FORTH_TOKEN_2Store:	// 2!
-				tos = sp[0];
-				((forth_cell_t *)(tos))[0] = sp[1];
-				((forth_cell_t *)(tos))[1] = sp[2];
-				sp += 3;
+		switch (FORTH_EXTRACT_TOKEN(dictionary[ix]))
+		{
+			case FORTH_TOKEN_lit:
+			case FORTH_TOKEN_xtlit:
+			case FORTH_TOKEN_tailcall:
+			case FORTH_TOKEN_inlined:
+				ix++;	// Skip the operand.
 			break;
 
-			case FORTH_TOKEN_2Fetch:	// 2@
-				tos = sp[0];
-				sp--;
-				sp[0] = ((forth_cell_t *)(tos))[0];
-				sp[1] = ((forth_cell_t *)(tos))[1];
+			case FORTH_TOKEN_strlit:
+				ix += FORTH_ALIGN(FORTH_PARAM_UNSIGNED(dictionary[ix])) / sizeof(forth_cell_t);
 			break;
+		}
+	}
 
-			case FORTH_TOKEN_NtoR:		// N>R
-				tos = POP();
-				rp -= tos;
-				for (i = 0; i < tos; i++)
-				{
-					rp[i] = sp[i];
-				}
-				sp += tos;
-				RPUSH(tos);
-			break;
-
-			case FORTH_TOKEN_NRfrom:	// NR>
-				tos = RPOP();
-				sp -= tos;
-				for (i = 0; i < tos; i++)
-				{
-					sp[i] = rp[i];
-				}
-				rp += tos;
-				PUSH(tos);
-			break;
-
-
-			case FORTH_TOKEN_DUP:
-				sp--;
-				sp[0] = sp[1];
-			break;
-
-			case FORTH_TOKEN_qDUP:
-				if (0 != sp[0])
-				{
-					sp--;
-					sp[0] = sp[1];
-				}
-			break;
-
-			case FORTH_TOKEN_PAGE:
-				if (0 == rctx->page)
-				{
-					THROW(-21);
-				}
-
-				if (0 > rctx->page(rctx))
-				{
-					THROW(-57);
-				}
-			break;
-
-#if defined(FORTH_INCLUDE_MS)
-			case FORTH_TOKEN_MS:
-				rctx->sp = sp;
-				forth_ms(rctx);
-				sp = rctx->sp;
-			break;
-#endif
-
-#if defined(FORTH_INCLUDE_TIME_DATE)
-		case FORTH_TOKEN_TIME_DATE:
-			rctx->sp = sp;
-			forth_time_date(rctx);
-			sp = rctx->sp;
-		break;
-#endif
-
-			case FORTH_TOKEN_AT_XY:		// AT-XY ( X Y -- )
-				if (0 == rctx->at_xy)
-				{
-					THROW(-21);
-				}
-
-				if (0 > rctx->at_xy(rctx, sp[1], sp[0]))
-				{
-					THROW(-57);
-				}
-
-				sp += 2;
-			break;
-
-			case FORTH_TOKEN_CR:
-				if (0 > rctx->send_cr(rctx))
-				{
-					THROW(-57);
-				}
-			break;
-
-			case FORTH_TOKEN_EMIT:
-				tos = POP();
-				c = (char) tos;
-				if (0 > rctx->write_string(rctx, &c, 1))
-				{
-					THROW(-57);
-				}
-			break;
-
-			case FORTH_TOKEN_UNUSED:
-				// tos = pctx->dp_max - pctx->dp;
-				tos = dictionary[FORTH_DP_MAX_LOCATION] - dictionary[FORTH_DP_LOCATION];
-				PUSH(tos);
-			break;
-
-			case FORTH_TOKEN_DUMP:
-				if (0 > forth_dump(rctx, (char *)(sp[1]), sp[0]))
-				{
-					THROW(-57);
-				}
-				sp += 2;
-			break;
-
-			case FORTH_TOKEN_handler:
-				tos = (forth_cell_t)&(rctx->handler);
-				PUSH(tos);
-			break;
-
-			case FORTH_TOKEN_LessHash:	// <#
-				rctx->numbuff_ptr = &(rctx->num_buff[FORTH_NUM_BUFF_LENGTH]);
-			break;
-
-#if !defined(FORTH_NO_DOUBLES)
-			case FORTH_TOKEN_Hash:	// #
-				if (0 == rctx->base)
-				{
-					THROW(-10);
-				}
-
-				dtos = FORTH_DCELL(sp[0], sp[1]);
-				*(--(rctx->numbuff_ptr)) = forth_val2digit((forth_byte_t)(dtos % rctx->base));
-				dtos = dtos / rctx->base;
-				sp[1] = FORTH_CELL_LOW(dtos);
-				sp[0] = FORTH_CELL_HIGH(dtos);
-			break;
-#endif
-
-			case FORTH_TOKEN_HashGreater:	// #>
-				sp[1] = (forth_cell_t)(rctx->numbuff_ptr);
-				sp[0] = &(rctx->num_buff[FORTH_NUM_BUFF_LENGTH]) - rctx->numbuff_ptr;
-
-			break;
-
-			case FORTH_TOKEN_HOLD:
-				*(--(rctx->numbuff_ptr)) = POP();
-			break;
-
-
-			case FORTH_TOKEN_Hdot:					// H.
-				tos = POP();
-				if (0 > forth_hdot(rctx, tos))
-				{
-					THROW(-57);
-				}
-			break;
-
-			case FORTH_TOKEN_Udot:
-				tos = POP();
-				if (0 > forth_udot(rctx, rctx->base, tos))
-				{
-					THROW(-57);
-				}
-			break;
-
-			case FORTH_TOKEN_Dot:
-				tos = POP();
-				if (0 > forth_dot(rctx, rctx->base, tos))
-				{
-					THROW(-57);
-				}
-			break;
-
-			case FORTH_TOKEN_DotR:		// .R
-				tos = POP();
-				if (0 > forth_dot_r(rctx, rctx->base, POP(), tos, 1))
-				{
-					THROW(-57);
-				}
-			break;
-
-			case FORTH_TOKEN_UdotR:		// U.R
-				tos = POP();
-				if (0 > forth_dot_r(rctx, rctx->base, POP(), tos, 0))
-				{
-					THROW(-57);
-				}
-			break;
-
-			case FORTH_TOKEN_DotS:
-				rctx->sp = sp;
-				if (0 > forth_dots(rctx))
-				{
-					THROW(-57);
-				}
-			break;
-
-			case FORTH_TOKEN_DotName:	// .name
-				if (0 > forth_show_name(rctx, POP()))
-				{
-					THROW(-57);
-				}
-			break;
-
-			case FORTH_TOKEN_CMOVE:
-				tos = POP();
-				dest = (char *)(POP());
-				src = (char *)(POP());
-				for (i = 0; i < tos; i++)
-				{
-					dest[i] = src[i];
-				}
-			break;
-
-			case FORTH_TOKEN_CMOVE_down:	// cmove>
-				tos = POP();
-				dest = (char *)(POP());
-				src = (char *)(POP());
-				for (i = tos - 1; i  >= 0; i++)
-				{
-					dest[i] = src[i];
-				}
-			break;
-
-			case FORTH_TOKEN_FILL:	// ( addr count char -- )
-				if (0 != sp[1])
-				{
-					memset((void *)(sp[2]), (int)sp[0], sp[1]);
-				}
-				sp += 3;
-			break;
-
-			case FORTH_TOKEN_MOVE:	// src dest count
-				// void *memcpy(void *dest, const void *src, size_t n);
-				if (0 != sp[0])
-				{
-					memmove((char *)(sp[1]), (char *)(sp[2]), sp[0]);
-				}
-				sp += 3;
-			break;
-
-			case FORTH_TOKEN_LATEST:
-				tos = (forth_cell_t)(&((struct forth_wordlist *)(&dictionary[rctx->current]))->latest);
-				PUSH(tos);
-			break;
-
-			case FORTH_TOKEN_pDefining:	// (DEFINING)
-				PUSH(&(rctx->defining));
-			break;
-
-			case FORTH_TOKEN_TUCK:
-				tos = sp[0];
-				sp--;
-				sp[0] = sp[1];
-				sp[1] = sp[2];
-				sp[2] = tos;
-			break;
-
-			case FORTH_TOKEN_PICK:
-				sp[0] = sp[sp[0] + 1];
-			break;
-
-			case FORTH_TOKEN_ROLL:
-				i = POP();
-				if (i)
-				{
-					tos = sp[i];
-					while(i)
-					{
-						sp[i] = sp[i - 1];
-						i--;
-					}
-					sp[0] = tos;
-				}
-			break;
-
-			case FORTH_TOKEN_ROT:
-				tos = sp[2];
-				sp[2] = sp[1];
-				sp[1] = sp[0];
-				sp[0] = tos;
-			break;
-
-			case FORTH_TOKEN_NIP:
-				sp[1] = sp[0];
-				sp++;
-			break;
-
-			case FORTH_TOKEN_OVER:
-				--sp;
-				sp[0] = sp[2];
-			break;
-
-			case FORTH_TOKEN_TYPE:
-				tos = POP();
-				if (0 > rctx->write_string(rctx, (char *)(POP()), tos))
-				{
-					THROW(-57);
-				}
-			break;
-
-			case FORTH_TOKEN_EXECUTE:
-				xt = POP();
-			continue;
-
-			case FORTH_TOKEN_SEARCH_WORDLIST: // SEARCH-WORDLIST
-				// static forth_cell_t forth_search_wordlist(forth_cell_t dictionary[], const struct forth_wordlist *wl, const char *name, forth_cell_t len)
-				tos = forth_search_wordlist(dictionary, (const struct forth_wordlist *)(&dictionary[sp[0]]), (const char *)(sp[2]), sp[1]);
-				sp += 3;
-
-				if (FORTH_TRUE == tos)	// All bits '1'-s.
-				{
-					PUSH(0);
-				}
-				else
-				{
-					PUSH(tos + (sizeof(struct forth_header) / sizeof(forth_cell_t)));
-
-					if (((struct forth_header *)(&dictionary[tos]))->flags & FORTH_HEADER_FLAGS_IMMEDIATE)
-					{
-						PUSH(1);
-					}
-					else
-					{
-						PUSH(-1);
-					}
-					
-				}
-			break;
-
-			case FORTH_TOKEN_COMPARE:
-				sp[3] = forth_compare_strings((const char *)(sp[3]), sp[2], (const char *)(sp[1]), sp[0]);
-				sp += 3;
-			break;
-
-			case FORTH_TOKEN_FIND_WORD:	// FIND-WORD ( caddr count -- 0 | xt 1 | xt -1 )
-				tos = POP();
-				tos = forth_find_word(rctx, dictionary, (const char *)(POP()), tos);
-				if (FORTH_TRUE == tos)	// All bits '1'-s.
-				{
-					PUSH(0);
-				}
-				else
-				{
-					PUSH(tos + (sizeof(struct forth_header) / sizeof(forth_cell_t)));
-
-					if (((struct forth_header *)(&dictionary[tos]))->flags & FORTH_HEADER_FLAGS_IMMEDIATE)
-					{
-						PUSH(1);
-					}
-					else
-					{
-						PUSH(-1);
-					}
-					
-				}
-			break;
-
-			case FORTH_TOKEN_CFetch:				// C@
-				*sp = *((char *)(*sp));
-			break;
-
-			case FORTH_TOKEN_CStore:				// c!
-				*((char *)(*sp)) = (char)(sp[1]);
-				sp+= 2;
-			break;
-
-			case FORTH_TOKEN_PlusStore:				// +!
-				tos = POP();
-				*((forth_cell_t *)tos) += POP();
-			break;
-
-			case FORTH_TOKEN_Fetch:					// @
-				*sp = *((forth_cell_t *)(*sp));
-			break;
-
-			case FORTH_TOKEN_Store:					// !
-				*((forth_cell_t *)(*sp)) = sp[1];
-				sp+= 2;
-			break;
-
-			case FORTH_TOKEN_PARSE:
-				tos = POP();
-				rctx->sp = sp;
-				forth_parse(rctx, tos);
-				sp = rctx->sp;
-			break;
-
-			case FORTH_TOKEN_PARSE_WORD:
-				rctx->sp = sp;
-				forth_parse_word(rctx, FORTH_CHAR_SPACE);
-				sp = rctx->sp;
-			break;
-
-			case FORTH_TOKEN_WORD:
-				tos = POP();
-				rctx->sp = sp;
-				forth_parse_word(rctx, (char)tos);
-				sp = rctx->sp;
-				if (sp[0] > 255)
-				{
-					THROW(-18);
-				}
-				// tos = FORTH_ALIGN(pctx->dp) + 4 * sizeof(forth_cell_t);
-				tos = FORTH_ALIGN(dictionary[FORTH_DP_LOCATION]) + 4 * sizeof(forth_cell_t) + (forth_cell_t)(dictionary);
-				*((unsigned char *)tos) = (unsigned char)(sp[0]);
-				memmove((void *)(tos + 1), (void *)(sp[1]), sp[0]);
-				sp++;
-				sp[0] = tos;
-			break;
-
-			case FORTH_TOKEN_Plus:
-				tos = POP();
-				*sp += tos;
-			break;
-
-			case FORTH_TOKEN_toR:
-				tos = POP();
-				RPUSH(tos);
-			break;
-
-			case FORTH_TOKEN_Rfrom:
-				tos = RPOP();
-				PUSH(tos);
-			break;
-
-			case FORTH_TOKEN_Rfetch:
-				tos = *rp;
-				PUSH(tos);
-			break;
-
-			case FORTH_TOKEN_2toR:
-				RPUSH(sp[1]);
-				RPUSH(sp[0]);
-				sp += 2;
-			break;
-
-			case FORTH_TOKEN_2Rfrom:
-				sp -= 2;
-				sp[0] = RPOP();
-				sp[1] = RPOP();
-			break;
-
-			case FORTH_TOKEN_2Rfetch:
-				sp -= 2;
-				sp[0] = rp[0];	// Check!
-				sp[1] = rp[1];
-			break;
-
-			case FORTH_TOKEN_PROCESS_NUMBER:
-				tos = POP();
-				rctx->sp = sp + 1;
-				tos = (forth_cell_t)forth_process_number(rctx, (char *)(*sp), tos);
-				sp = rctx->sp;
-				if ((forth_scell_t)tos < 0)
-				{
-					THROW(-24);
-				}
-			break;
-
-#if !defined(FORTH_NO_DOUBLES)
-			case FORTH_TOKEN_toNUMBER:	// >NUMBER
-				dtos = FORTH_DCELL(sp[2], sp[3]);
-
-				while(0 != sp[0])
-				{
-					tos = map_digit(*((char *)(sp[1])));
-
-					if (tos >= rctx->base)
-					{
-						break;
-					}
-
-					dtos = (dtos * rctx->base) + tos;
-					sp[0]--;
-					sp[1]++;
-				}
-				sp[3] = FORTH_CELL_LOW(dtos);
-				sp[2] = FORTH_CELL_HIGH(dtos);
-			break;
-#endif
-
-			case FORTH_TOKEN_BLK:		// BLK
-				PUSH(&(rctx->blk));
-			break;
-
-			case FORTH_TOKEN_TIB:		// TIB
-				PUSH(&(rctx->tib));
-			
-			break;
-
-			case FORTH_TOKEN_HashTIB:	// #TIB
-				PUSH(&(rctx->tib_count));
-			break;
-
-			case FORTH_TOKEN_BASE:
-				PUSH(&(rctx->base));
-			break;
-	
-			case FORTH_TOKEN_pSOURCE_ID:	// (SOURCE-ID)
-				PUSH(&(rctx->source_id));
-			break;
-	
-			case FORTH_TOKEN_SOURCE:
-				PUSH(rctx->source_address);
-				PUSH(rctx->source_length);
-			break;
-
-			case FORTH_TOKEN_SOURCE_Store:	// SOURCE!
-				rctx->source_length = POP();
-				rctx->source_address = (char *)(POP());
-			break;
-
-#if defined(FORTH_INCLUDE_FILE_ACCESS_WORDS)
-			case FORTH_TOKEN_LINE_NUMBER:	 // LINE-NUMBER ( line number inside a file).
-				PUSH(&(rctx->line_no));
-			break;
-#endif
-			case FORTH_TOKEN_toIN:	// >IN
-				PUSH(&(rctx->to_in));
-			break;
-
-			case FORTH_TOKEN_SAVE_INPUT:	// SAVE-INPUT
-				if (0 != rctx->blk)
-				{
-					THROW(-21);	// We currently do not implement blocks, so this should never happen.
-				}
-				else if ((0 == rctx->source_id) || (-1 == rctx->source_id))
-				{
-					PUSH(rctx->to_in);
-					PUSH(1);
-				}
-				else
-				{
-					PUSH(rctx->to_in);
-#if defined(FORTH_INCLUDE_FILE_ACCESS_WORDS)
-					PUSH(rctx->line_no);
-					PUSH(FORTH_CELL_LOW(rctx->source_file_position));
-					PUSH(FORTH_CELL_HIGH(rctx->source_file_position));
-					PUSH(4);
-#else
-					PUSH(1);
-#endif
-				}
-			break;
-
-			case FORTH_TOKEN_RESTORE_INPUT: // RESTORE-INPUT
-				// puts("------ RESTORE-INPUT ---------");
-				if (0 != rctx->blk)
-				{
-					THROW(-21);	// We currently do not implement blocks, so this should never happen.
-				}
-				else if ( ((0 == rctx->source_id) || (-1 == rctx->source_id)) && (1 == sp[0]))	// Terminal and EVALUTATE only needs >IN restored.
-				{
-					rctx->to_in = sp[1];
-					sp++;
-					sp[0] = 0;
-					
-				}
-#if defined(FORTH_INCLUDE_FILE_ACCESS_WORDS)
-				else if (((0 != rctx->source_id) && (-1 != rctx->source_id)) && (4 == sp[0]))	// Files have postion line_no and >IN
-				{
-					sp[0] = rctx->source_id;
-					rctx->sp = sp;
-					forth_reposition_file(rctx);
-					sp = rctx->sp;
-					tos = POP();
-
-					if (0 != tos)	// Can't reposition -- RESTORE-INPUT has failed.
-					{
-						sp[0] = FORTH_TRUE;
-					}
-					else
-					{
-						rctx->sp = sp;
-						forth_refill_file(rctx);	// Bring in the correct line and set >IN = 0.
-						sp = rctx->sp;
-						rctx->line_no = sp[1];	// Restore line_no to its saved state.
-						rctx->to_in = sp[2];	// Restore >IN to its saved value.
-						sp[2] = sp[0] ? 0 : FORTH_TRUE;
-						sp += 2;
-					}
-				}
-#endif
-				else	// Don't know what is going on, failed.
-				{
-					sp += sp[0];
-					sp[0] = FORTH_TRUE;
-				}
-
-			break;
-
-
-			case FORTH_TOKEN_STATE:
-				PUSH(&(rctx->state));
-			break;
-
-			case FORTH_TOKEN_QUERY:
-				tos = forth_query(rctx);
-
-				if (0 > (forth_scell_t)tos)
-				{
-					THROW(-57);
-				}
-			break;
-
-			case FORTH_TOKEN_REFILL:
-				if (0 == rctx->source_id)
-				{
-					tos = forth_query(rctx);
-
-					if (0 > (forth_scell_t)tos)
-					{
-						PUSH(0);
-					}
-					else
-					{
-						PUSH(FORTH_TRUE);
-					}
-				}
-				else if (-1 == rctx->source_id)
-				{
-					PUSH(0);
-				}
-				else
-				{
-#if defined(FORTH_INCLUDE_FILE_ACCESS_WORDS)
-					rctx->sp = sp;
-					forth_refill_file(rctx);
-					sp = rctx->sp;
-					if (0 != sp[0])
-					{
-						rctx->line_no++;
-					}
-#else
-					PUSH(0);
+	return 1;
+}
 #endif
-				}
-			break;
-
-			case FORTH_TOKEN_SWAP:
-				// printf("sp=%p\n", sp); fflush(stdout);
-				tos = sp[0];
-				sp[0] = sp[1];
-				sp[1] = tos;
-			break;
-
-			case FORTH_TOKEN_THROW:
-				tos = *sp;
-
-				if (tos)
-				{
-					if (0 == rctx->handler)
-					{
-						rctx->sp = sp;
-						rctx->rp = rp;
-						rctx->ip = ip;
-						return -1;
-					}
-
-					rp = (forth_cell_t *)(rctx->handler);
-					rctx->handler = RPOP();
-					sp = (forth_cell_t *)(RPOP());
-					*sp = tos;
-					ip = RPOP();
-				} 
-				else
-				{
-					sp++;
-				}
-			break;
-
-			case FORTH_TOKEN_DotError:
-				tos = POP();
-				rctx->sp = sp;
-				forth_print_error(rctx, (forth_scell_t)tos);
-				sp = rctx->sp;
-			break;
-
-			case FORTH_TOKEN_BYE:
-				rctx->sp = sp;
-				rctx->rp = rp;
-				rctx->ip = ip;
-				return 0;
-			break;
-
-			case FORTH_TOKEN_WORDS:
-				if (0 > forth_words(dictionary, rctx))
-				{
-					THROW(-57);
-				}
-			break;
-
-			case FORTH_TOKEN_ENVIRONMENTq:	// ENVIRONMENT?
-				rctx->sp = sp;
-				forth_query_environment(rctx);
-				sp = rctx->sp;
-			break;
-
-			case FORTH_TOKEN_pSEE:	// (SEE) ( xt -- )
-				if (0 > forth_see(rctx, dictionary, POP()))
-				{
-					THROW(-57);
-				}
-			break;
-
-			case FORTH_TOKEN_ONLY:
-				rctx->wordlists[rctx->wordlist_slots - 1] = FORTH_WID_Root_WORDLIST;
-				rctx->wordlists[rctx->wordlist_slots - 2] = FORTH_WID_Root_WORDLIST;
-				rctx->wordlist_cnt = 2;
-			break;
-			
-			case FORTH_TOKEN_ALSO:
-				if (rctx->wordlist_cnt == rctx->wordlist_slots)
-				{
-					THROW(-49);
-				}
-
-				rctx->wordlist_cnt++;
-				rctx->wordlists[rctx->wordlist_slots - rctx->wordlist_cnt] = rctx->wordlists[(rctx->wordlist_slots - rctx->wordlist_cnt) + 1];
-			break;
-
-			case FORTH_TOKEN_GET_ORDER:
-				tos = rctx->wordlist_cnt;
-
-				for(i = 1; i <= tos; i++)
-				{
-					PUSH(rctx->wordlists[rctx->wordlist_slots - i]);
-				}
-
-				PUSH(rctx->wordlist_cnt);
-			break;
-
-			case FORTH_TOKEN_SET_ORDER:
-				tos = POP();
-
-				if (-1 == (forth_scell_t)tos)
-				{
-					xt = FORTH_TOKEN_ONLY;
-					continue;
-				}
-
-				if (tos > rctx->wordlist_slots)
-				{
-					THROW(-49);
-				}
-
-				rctx->wordlist_cnt = tos;
-
-				for(i = tos; i >= 1; i--)
-				{
-					rctx->wordlists[rctx->wordlist_slots - i] = POP();
-				}
-			break;
-
-			case FORTH_TOKEN_CURRENT:
-				PUSH(&(rctx->current));
-			break;
-
-			case FORTH_TOKEN_CONTEXT:
-					PUSH(&(rctx->wordlists[rctx->wordlist_slots - rctx->wordlist_cnt]));
-			break;
-
-			case FORTH_TOKEN_Less:		// <
-				tos = POP();
-				sp[0] = (((forth_scell_t)(sp[0])) < ((forth_scell_t)tos)) ? FORTH_TRUE : FORTH_FALSE;
-			break;
-
-			case FORTH_TOKEN_Greater:	// >
-				tos = POP();
-				sp[0] = (((forth_scell_t)(sp[0])) > ((forth_scell_t)tos)) ? FORTH_TRUE : FORTH_FALSE;
-			break;
-
-			case FORTH_TOKEN_ULess:		// u<
-				tos = POP();
-				sp[0] = (sp[0] < tos) ? FORTH_TRUE : FORTH_FALSE;
-			break;
-
-			case FORTH_TOKEN_UGreater:	// u>
-				tos = POP();
-				sp[0] = (sp[0] > tos) ? FORTH_TRUE : FORTH_FALSE;
-			break;
-
-			case FORTH_TOKEN_Equal:		// =
-				tos = POP();
-				sp[0] = (sp[0] == tos) ? FORTH_TRUE : FORTH_FALSE;
-			break;
-
-			case FORTH_TOKEN_Notequal:	// <>
-				tos = POP();
-				sp[0] = (sp[0] != tos) ? FORTH_TRUE : FORTH_FALSE;
-			break;
-
-			case FORTH_TOKEN_0Equal:
-				sp[0] = (0 == sp[0]) ? FORTH_TRUE : FORTH_FALSE;
-			break;
-
-			case FORTH_TOKEN_0Notequal:
-				sp[0] = (0 != sp[0]) ? FORTH_TRUE : FORTH_FALSE;
-			break;
-
-			case FORTH_TOKEN_0Less:		// 0<
-				sp[0] = (((forth_scell_t)(sp[0])) < 0) ? FORTH_TRUE : FORTH_FALSE;
-			break;
-
-			case FORTH_TOKEN_0Greater:	// 0>
-				sp[0] = (((forth_scell_t)(sp[0])) > 0) ? FORTH_TRUE : FORTH_FALSE;
-			break;
-
-
-			case FORTH_TOKEN_LITERAL:
-				tos = POP();
-				// This check is for worst case.
-				if (dictionary[FORTH_DP_MAX_LOCATION] <=  (dictionary[FORTH_DP_LOCATION] + (2 * sizeof(forth_cell_t))))
-				{
-					THROW(-8);
-				}
-				tos = forth_literal((forth_cell_t *)(dictionary[FORTH_DP_LOCATION] + (forth_cell_t)(dictionary)), tos);
-				tos = tos * sizeof(forth_cell_t);
-				dictionary[FORTH_DP_LOCATION] += tos;
-			break;
-
-			case FORTH_TOKEN_sp0:
-				PUSH(rctx->sp0);
-			break;
-
-			case FORTH_TOKEN_sp_fetch:
-				tos = (forth_cell_t)sp;
-				PUSH(tos);
-			break;
-
-			case FORTH_TOKEN_sp_store:
-				tos = POP();
-				sp = (forth_cell_t *)tos;
-			break;
-
-			case FORTH_TOKEN_rp0:
-				PUSH(rctx->rp0);
-			break;
-
-			case FORTH_TOKEN_rp_fetch:
-				PUSH(rp);
-			break;
-
-			case FORTH_TOKEN_rp_store:
-				rp = (forth_cell_t *)(POP());
-			break;
 
-			case FORTH_TOKEN_abort_msg:		// (abort-msg) -- to hold the string for ABORT".
-				PUSH(&(rctx->abort_msg_len));
-			break;
+#if defined(FORTH_INLINE_THRESHOLD)
+// The length in cells of the body of colon definition xt if COMPILE, can copy it inline, -1 otherwise.
+// Only straight line code made of primitives qualifies, a word that calls other words, branches, loops,
+// or uses the return stack (where its return address would be) is still called.
+static forth_scell_t forth_inline_body(forth_cell_t dictionary[], forth_cell_t xt)
+{
+	forth_cell_t ix;
 
-			// This is not in any standard. Intended to be an implementation detail to resolve all branches.
-			case FORTH_TOKEN_resolve_branch:	// resolve-branch ( orig-sys dest -- )
-				tos = sp[1];
-				tos &= FORTH_SYS_ID_MASK;
-				// printf("Before: dictionary[tos = %08x] = %08x\n", tos, dictionary[tos]);
-				// dictionary[tos] |=  FORTH_PARAM_PACK((((pctx->dp - (forth_cell_t)pctx->dictionary) / sizeof(forth_cell_t)) - (tos + 1)));
-				dictionary[tos] |=  FORTH_PARAM_PACK(((sp[0] & FORTH_SYS_ID_MASK) - (tos + 1)));
-				// printf("After:  dictionary[tos = %08x] = %08x\n", tos, dictionary[tos]);
-				sp += 2;
-			break;
+	if (FORTH_IS_TOKEN(xt) || !FORTH_IS_COLON_CODE(dictionary[xt])
+		|| (0 != (FORTH_HEADER_FLAGS_IMMEDIATE & dictionary[xt - 1])))
+	{
+		return -1;
+	}
 
-			case FORTH_TOKEN_ix2address:	// IX>ADDRESS
-				*sp = (forth_cell_t)&(dictionary[*sp]);
-			break;
+	for (ix = xt + 1; ix <= (xt + 1 + FORTH_INLINE_THRESHOLD); ix++)
+	{
+		if (FORTH_IS_NOT_TOKEN(dictionary[ix]))
+		{
+			return -1;
+		}
 
-			case FORTH_TOKEN_toBODY:	// >BODY
-				tos = *sp;
-				if (FORTH_PACK_TOKEN(FORTH_TOKEN_docreate) != dictionary[tos])
-				{
-					THROW(-31);
-				}
+		switch (FORTH_EXTRACT_TOKEN(dictionary[ix]))
+		{
+			case FORTH_TOKEN_unnest:
+				return ix - (xt + 1);
 
-				*sp = (forth_cell_t)(&dictionary[tos + 2]);
-			break;
-/*
-// For DO-LOOPs
-#define LOOP_I rp[0]
-#define LOOP_J rp[3]
-#define LOOP_LIMIT   rp[1]
-#define LOOP_ADDRESS_AFTER rp[2]
-#define LOOP_ADJUSTMENT 3
-*/
-			case FORTH_TOKEN_pDO:		// (DO)
-				tos = ip + SIGNED_PARAMETER;
-				rp -= LOOP_ADJUSTMENT;
-				LOOP_I = POP();
-				LOOP_LIMIT = POP();
-				LOOP_ADDRESS_AFTER = tos;
+			case FORTH_TOKEN_lit:
+			case FORTH_TOKEN_xtlit:
+				ix++;	// Skip the operand.
 			break;
 
-			case FORTH_TOKEN_pqDO:	 	// (?DO)
-				tos = ip + SIGNED_PARAMETER;
+			case FORTH_TOKEN_EXIT:
+			case FORTH_TOKEN_tailcall:
+			case FORTH_TOKEN_inlined:
+			case FORTH_TOKEN_strlit:
+			case FORTH_TOKEN_branch:
+			case FORTH_TOKEN_0branch:
+			case FORTH_TOKEN_Equal_0branch:
+			case FORTH_TOKEN_Notequal_0branch:
+			case FORTH_TOKEN_Less_0branch:
+			case FORTH_TOKEN_Greater_0branch:
+			case FORTH_TOKEN_ULess_0branch:
+			case FORTH_TOKEN_UGreater_0branch:
+			case FORTH_TOKEN_0Equal_0branch:
+			case FORTH_TOKEN_0Notequal_0branch:
+			case FORTH_TOKEN_0Less_0branch:
+			case FORTH_TOKEN_0Greater_0branch:
+			case FORTH_TOKEN_pDO:
+			case FORTH_TOKEN_pqDO:
+			case FORTH_TOKEN_UNLOOP:
+			case FORTH_TOKEN_LEAVE:
+			case FORTH_TOKEN_I:
+			case FORTH_TOKEN_J:
+			case FORTH_TOKEN_I_Plus:
+			case FORTH_TOKEN_pLOOP:
+			case FORTH_TOKEN_pPlusLOOP:
+				return -1;
 
-				if (sp[0] != sp[1])
-				{
-					rp -= LOOP_ADJUSTMENT;
-					LOOP_I = POP();
-					LOOP_LIMIT = POP();
-					LOOP_ADDRESS_AFTER = tos;
-				}
-				else
+			default:
+				if (forth_uses_return_stack(dictionary[ix]))
 				{
-					sp += 2;
-					ip = tos;
+					return -1;
 				}
-			// printf("ip=%08x\n", ip);
-			break;
-
-			case FORTH_TOKEN_UNLOOP:	// UNLOOP
-				rp += LOOP_ADJUSTMENT;
 			break;
+		}
+	}
 
-			case FORTH_TOKEN_LEAVE:		// LEAVE
-				ip = LOOP_ADDRESS_AFTER;
-				rp += LOOP_ADJUSTMENT;
-			break;
+	return -1;
+}
 
-			case FORTH_TOKEN_I:		// I
-				PUSH(LOOP_I);
-			break;
+// forth_inline_body() of a word other than the one being defined.
+static forth_scell_t forth_inline_length(struct forth_runtime_context *rctx, forth_cell_t xt)
+{
+	if ((rctx->defining + 2) == xt)	// RECURSE, the body is not finished yet.
+	{
+		return -1;
+	}
 
-			case FORTH_TOKEN_J:		// J
-				PUSH(LOOP_J);
-			break;
+	return forth_inline_body(rctx->dictionary, xt);
+}
+#endif
 
-			case FORTH_TOKEN_pLOOP:		// (LOOP)
-				LOOP_I += 1;
+// COMPILE, -- returns 0 or a THROW code.
+// With FORTH_PEEPHOLE_OPTIMIZER a token is merged into the one compiled right before it, if the pair has a superinstruction.
+// A short literal compiled by LITERAL is folded into an operator that has an immediate form the same way.
+// That is only done if the previous cell was laid down by COMPILE, or LITERAL with nothing in between (rctx->peephole)
+// and it is not the operand of an xtlit or lit. (HERE) and HERE clear rctx->peephole, so nothing can
+// branch into the middle of a superinstruction.
+// With FORTH_TAIL_CALL_OPTIMIZER the unnest compiled by ; turns a call to a colon definition right before it
+// into a tailcall. The unnest is still compiled, it ends the definition for SEE and it is where a THEN lands.
+// Only a callee that ; has found to leave the return stack alone (FORTH_HEADER_FLAGS_KEEPS_RP) is tail called,
+// one that takes its return address with R> would get the caller's instead. Kernel definitions do not have the flag.
+// DOES> clears (DEFINING) before its ; so the (does>) call is left alone.
+// With FORTH_INLINE_THRESHOLD short colon definitions are copied after an inlined token that records their xt.
+// With FORTH_CONSTANT_FOLDING pure primitives applied to the literals compiled right before them are evaluated here.
+// With FORTH_JIT the unnest compiled by ; also hands the finished definition to the JIT.
+// With FORTH_COMPACT_CODE it is then translated into 16 bit units, unless it went native or is short enough to be inlined.
+static forth_cell_t forth_compile_comma(struct forth_runtime_context *rctx, forth_cell_t xt)
+{
+	forth_cell_t *dictionary = rctx->dictionary;
+	forth_cell_t dp = dictionary[FORTH_DP_LOCATION];
+	forth_cell_t *here = (forth_cell_t *)(((char *)dictionary) + dp);
+#if defined(FORTH_PEEPHOLE_OPTIMIZER)
+	forth_cell_t fused;
+#endif
+#if defined(FORTH_INLINE_THRESHOLD)
+	forth_scell_t length;
+#endif
+#if defined(FORTH_TAIL_CALL_OPTIMIZER)
+	int keeps_rp;
+#endif
+#if defined(FORTH_CONSTANT_FOLDING)
+	int literal;
+#endif
 
-				if (LOOP_I == LOOP_LIMIT)
-				{
-					rp += LOOP_ADJUSTMENT;
-				}
-				else
-				{
-					ip += SIGNED_PARAMETER;
-				}
-			break;
+	xt = forth_translate_token(dictionary, xt);
 
-			case FORTH_TOKEN_pPlusLOOP:	// (+LOOP)
-				tos = POP();
+#if defined(FORTH_CONSTANT_FOLDING)
+	if (forth_fold_constants(rctx, xt))
+	{
+		return 0;
+	}
 
-				LOOP_I += tos;
+	literal = FORTH_IS_TOKEN(xt)	// TRUE , FALSE and the like, but not the operand of ['] .
+		&& ((FORTH_TOKEN_uslit == FORTH_EXTRACT_TOKEN(xt)) || (FORTH_TOKEN_sslit == FORTH_EXTRACT_TOKEN(xt)))
+		&& (FORTH_PACK_TOKEN(FORTH_TOKEN_xtlit) != here[-1]) && (FORTH_PACK_TOKEN(FORTH_TOKEN_lit) != here[-1]);
 
-				if (0 > (forth_scell_t)((LOOP_I - LOOP_LIMIT) ^ tos))	// Some 2's complement's trickery.
-				{
-					ip += SIGNED_PARAMETER;
-				}
-				else
-				{
-					rp += LOOP_ADJUSTMENT;
-				}
-			break;
+	if (!literal)
+	{
+		rctx->literal_cnt = 0;
+	}
+#endif
 
+#if defined(FORTH_INLINE_THRESHOLD)
+	length = forth_inline_length(rctx, xt);
 
+	if ((0 <= length)	// ['] and POSTPONE compile the operand of xtlit with COMPILE, too.
+		&& (FORTH_PACK_TOKEN(FORTH_TOKEN_xtlit) != here[-1]) && (FORTH_PACK_TOKEN(FORTH_TOKEN_lit) != here[-1]))
+	{
+		if (!FORTH_DICTIONARY_ROOM(dictionary, dp + (length + 2) * sizeof(forth_cell_t)))
+		{
+			return -8;
+		}
 
-			case FORTH_TOKEN_branch:
-				ip += SIGNED_PARAMETER;
-			break;
+		here[0] = FORTH_PACK_TOKEN(FORTH_TOKEN_inlined) | FORTH_PARAM_PACK(length);
+		here[1] = xt;
+		memcpy(&here[2], &dictionary[xt + 1], length * sizeof(forth_cell_t));
+		dp += (length + 2) * sizeof(forth_cell_t);
+		dictionary[FORTH_DP_LOCATION] = dp;
+		rctx->peephole = 0;	// Nothing may be fused into the copy, the length in inlined would no longer match.
 
-			case FORTH_TOKEN_0branch:
-				if (0 == POP())
-				{
-					ip += SIGNED_PARAMETER;
-				}
-			break;
+		return 0;
+	}
+#endif
 
-			case FORTH_TOKEN_xtlit:			// eXecution Token literal.
-			case FORTH_TOKEN_lit:			// Full sized literal.
-				PUSH(dictionary[ip++]);
-			break;
+#if defined(FORTH_TAIL_CALL_OPTIMIZER)
+	keeps_rp = (FORTH_PACK_TOKEN(FORTH_TOKEN_unnest) == xt) && (0 != rctx->defining)
+		&& forth_keeps_return_stack(dictionary, rctx->defining + 3, dp / sizeof(forth_cell_t));
 
-			case FORTH_TOKEN_sslit:			// Litaral encoded in the token, signed.
-				PUSH(SIGNED_PARAMETER);
-			break;
+	if ((FORTH_PACK_TOKEN(FORTH_TOKEN_unnest) == xt) && (0 != rctx->defining)
+		&& (dp == rctx->peephole) && FORTH_IS_NOT_TOKEN(here[-1])
+		&& (FORTH_PACK_TOKEN(FORTH_TOKEN_xtlit) != here[-2]) && (FORTH_PACK_TOKEN(FORTH_TOKEN_lit) != here[-2])
+		&& (FORTH_IS_COLON_CODE(dictionary[here[-1]]) || (FORTH_PACK_TOKEN(FORTH_TOKEN_compact) == dictionary[here[-1]]))
+		&& ((0 != (FORTH_HEADER_FLAGS_KEEPS_RP & dictionary[here[-1] - 1]))
+			|| (((rctx->defining + 2) == here[-1]) && keeps_rp)))	// Recursion, ; has not looked at it yet.
+	{
+		if (!FORTH_DICTIONARY_ROOM(dictionary, dp + 2 * sizeof(forth_cell_t)))
+		{
+			return -8;
+		}
 
-			case FORTH_TOKEN_uslit:			// Literal encoded in the token, unsigned.
-				PUSH(UNSIGNED_PARAMETER);
-			break;
+		here[0] = here[-1];
+		here[-1] = FORTH_PACK_TOKEN(FORTH_TOKEN_tailcall);
+		here++;
+		dp += sizeof(forth_cell_t);
+		rctx->peephole = 0;
+	}
+#endif
 
-			case FORTH_TOKEN_strlit:		// String literal, length encoded in the token.
-				PUSH(&dictionary[ip]);
-				tos = UNSIGNED_PARAMETER;
-				PUSH(tos);
-				ip += (tos + (sizeof(forth_cell_t) - 1)) / sizeof(forth_cell_t);
-			break;
+#if defined(FORTH_PEEPHOLE_OPTIMIZER)
+	if ((dp == rctx->peephole) && FORTH_IS_TOKEN(xt)
+		&& (FORTH_PACK_TOKEN(FORTH_TOKEN_xtlit) != here[-2]) && (FORTH_PACK_TOKEN(FORTH_TOKEN_lit) != here[-2]))
+	{
+		fused = forth_fuse_tokens(here[-1], xt);
 
-			case FORTH_TOKEN_nest:
-				RPUSH(ip);
-				ip = w + 1;
-			break;
+		if (0 == fused)
+		{
+			fused = forth_fold_immediate(here[-1], xt);
+		}
 
-			case FORTH_TOKEN_EXIT:	// Same as unnest
-			case FORTH_TOKEN_unnest:
-				ip = RPOP();
-			break;
+		if (0 != fused)
+		{
+			here[-1] = fused;
+			return 0;
+		}
+	}
+#endif
 
-#if defined(FORTH_INCLUDE_FILE_ACCESS_WORDS)
-			case FORTH_TOKEN_FILE_CREATE:		// CREATE-FILE
-				rctx->sp = sp;
-				forth_create_file(rctx);
-				sp = rctx->sp;
-			break;
+	if (!FORTH_DICTIONARY_ROOM(dictionary, dp + sizeof(forth_cell_t)))
+	{
+		return -8;
+	}
 
-			case FORTH_TOKEN_FILE_OPEN:		// OPEN-FILE
-				rctx->sp = sp;
-				forth_open_file(rctx);
-				sp = rctx->sp;
-			break;
+	here[0] = xt;
+	dictionary[FORTH_DP_LOCATION] = dp + sizeof(forth_cell_t);
+#if defined(FORTH_CONSTANT_FOLDING)
+	if (literal)
+	{
+		forth_pending_literal(rctx, dp);
+		return 0;
+	}
+#endif
+	rctx->peephole = dp + sizeof(forth_cell_t);
 
-			case FORTH_TOKEN_FILE_FLUSH:		// FLUSH-FILE
-				rctx->sp = sp;
-				forth_file_flush(rctx);
-				sp = rctx->sp;
-			break;
+#if defined(FORTH_TAIL_CALL_OPTIMIZER)
+	if ((FORTH_PACK_TOKEN(FORTH_TOKEN_unnest) == xt) && (0 != rctx->defining))
+	{
+		dictionary[rctx->defining + 1] &= ~(FORTH_HEADER_FLAGS_KEEPS_RP);	// A new body, look at it again.
+		dictionary[rctx->defining + 1] |= keeps_rp ? FORTH_HEADER_FLAGS_KEEPS_RP : 0;
+	}
+#endif
 
-			case FORTH_TOKEN_FILE_DELETE:		// DELETE-FILE
-				rctx->sp = sp;
-				forth_delete_file(rctx);
-				sp = rctx->sp;
-			break;
+#if defined(FORTH_STACK_EFFECT)
+	if ((FORTH_PACK_TOKEN(FORTH_TOKEN_unnest) == xt) && (0 != rctx->defining))
+	{
+		forth_stack_effect_record(rctx, rctx->defining + 2);
+	}
+#endif
 
-			case FORTH_TOKEN_FILE_REPOSITION: 	// REPOSITION-FILE
-				rctx->sp = sp;
-				forth_reposition_file(rctx);
-				sp = rctx->sp;
-			break;
+#if defined(FORTH_JIT)
+	if ((FORTH_PACK_TOKEN(FORTH_TOKEN_unnest) == xt) && (0 != rctx->defining))
+	{
+		forth_jit_compile(rctx, rctx->defining + 2);
+	}
+#endif
 
-			case FORTH_TOKEN_FILE_POSITION: 	// FILE-POSITION
-				rctx->sp = sp;
-				forth_file_position(rctx);
-				sp = rctx->sp;
-			break;
+#if defined(FORTH_COMPACT_CODE)
+	if ((FORTH_PACK_TOKEN(FORTH_TOKEN_unnest) == xt) && (0 != rctx->defining)
+#	if defined(FORTH_INLINE_THRESHOLD)
+		&& (0 > forth_inline_body(dictionary, rctx->defining + 2))
+#	endif
+		&& (FORTH_PACK_TOKEN(FORTH_TOKEN_nest) == dictionary[rctx->defining + 2]))
+	{
+		forth_compact(rctx, rctx->defining + 2);
+	}
+#endif
 
-			case FORTH_TOKEN_FILE_SIZE:		// FILE-SIZE
-				rctx->sp = sp;
-				forth_file_size(rctx);
-				sp = rctx->sp;
-			break;
+	return 0;
+}
 
-			case FORTH_TOKEN_FILE_READ:		// READ-FILE
-				rctx->sp = sp;
-				forth_read_file(rctx);
-				sp = rctx->sp;
-			break;
+// LITERAL -- returns 0 or a THROW code.
+static forth_cell_t forth_compile_literal(struct forth_runtime_context *rctx, forth_cell_t value)
+{
+	forth_cell_t *dictionary = rctx->dictionary;
+	forth_cell_t length;
 
-			case FORTH_TOKEN_FILE_READ_LINE:	// READ-LINE
-				rctx->sp = sp;
-				forth_read_line(rctx);
-				sp = rctx->sp;
-			break;
+	// This check is for worst case.
+	if (!FORTH_DICTIONARY_ROOM(dictionary, dictionary[FORTH_DP_LOCATION] + (2 * sizeof(forth_cell_t))))
+	{
+		return -8;
+	}
 
-			case FORTH_TOKEN_FILE_WRITE:		// WRITE-FILE
-				rctx->sp = sp;
-				forth_write_file(rctx);
-				sp = rctx->sp;
-			break;
+	length = forth_literal((forth_cell_t *)(((char *)dictionary) + dictionary[FORTH_DP_LOCATION]), value);
+	length = length * sizeof(forth_cell_t);
+	dictionary[FORTH_DP_LOCATION] += length;
+#if defined(FORTH_CONSTANT_FOLDING)
+	forth_pending_literal(rctx, dictionary[FORTH_DP_LOCATION] - length);
+#else
+	rctx->peephole = (sizeof(forth_cell_t) == length) ? dictionary[FORTH_DP_LOCATION] : 0;	// COMPILE, can fold a short literal.
+#endif
 
-			case FORTH_TOKEN_FILE_WRITE_LINE:	// WRITE-LINE
-				rctx->sp = sp;
-				forth_write_line(rctx);
-				sp = rctx->sp;
-			break;
+	return 0;
+}
 
+#if defined(FORTH_NATIVE_INTERPRET)
+// (INTERPRET) ( -- xt true | false ) -- returns 0 or a THROW code.
+// Parses the source up to the next word that has to be executed and leaves it for the engine, false at the end of the source.
+// Numbers and the words to be compiled are taken care of here, the same way the INTERPRET written in Forth would:
+// a word is executed if its flag from FIND-WORD XOR STATE is not 0, an unknown word that is not a number is
+// shown and THROWs -13 with the name under the code.
+static forth_cell_t forth_interpret(struct forth_runtime_context *rctx)
+{
+	forth_cell_t *dictionary = rctx->dictionary;
+	forth_cell_t *sp;
+	forth_cell_t address;
+	forth_cell_t length;
+	forth_cell_t header;
+	forth_cell_t flag;
+	forth_cell_t rv;
+	const char *name;
 
-			case FORTH_TOKEN_FILE_CLOSE:		// CLOSE-FILE
-				rctx->sp = sp;
-				forth_close_file(rctx);
-				sp = rctx->sp;
-			break;
+	while (1)
+	{
+		forth_parse_word(rctx, FORTH_CHAR_SPACE);
+		length = *(rctx->sp++);
+		address = *(rctx->sp++);
 
-#endif
+		if (0 == length)
+		{
+			*--(rctx->sp) = FORTH_FALSE;
+			return 0;
+		}
 
-#if defined(FORTH_INCLUDE_MEMORY_ALLOCATION_WORDS)
-			case FORTH_TOKEN_ALLOCATE:
-				rctx->sp = sp;
-				forth_allocate(rctx);
-				sp = rctx->sp;
-			break;
+		name = FORTH_POINTER(rctx->arena, address);
+		header = forth_find_word(rctx, dictionary, name, length);
 
-			case FORTH_TOKEN_RESIZE:
-				rctx->sp = sp;
-				forth_resize(rctx);
-				sp = rctx->sp;
-			break;
+		if (FORTH_TRUE != header)
+		{
+			flag = (((struct forth_header *)(&dictionary[header]))->flags & FORTH_HEADER_FLAGS_IMMEDIATE) ? 1 : FORTH_TRUE;
+			header += sizeof(struct forth_header) / sizeof(forth_cell_t);	// The xt.
 
-			case FORTH_TOKEN_FREE:
-				rctx->sp = sp;
-				forth_free(rctx);
-				sp = rctx->sp;
-			break;
+			if (0 != (flag ^ rctx->state))
+			{
+				*--(rctx->sp) = header;
+				*--(rctx->sp) = FORTH_TRUE;
+				return 0;
+			}
 
-#endif
-			case FORTH_TOKEN_dovar:
-				PUSH(&dictionary[w + 1]);
-			break;
+			rv = forth_compile_comma(rctx, header);
+		}
+		else
+		{
+			sp = rctx->sp;
 
-			case FORTH_TOKEN_doconst:
-				PUSH(dictionary[w + 1]);
-			break;
+			if (0 > forth_process_number(rctx, name, length))
+			{
+				rctx->sp = sp;
+				*--(rctx->sp) = address;
+				*--(rctx->sp) = length;
 
-#if defined(FORTH_EXTERNAL_PRIMITIVES)
-			case FORTH_TOKEN_doextern:
-				if (0 == rctx->external_primitive_table)
+				if ((0 > rctx->send_cr(rctx)) || (0 > rctx->write_string(rctx, name, length))
+					|| (0 > rctx->write_string(rctx, " ", 1)))
 				{
-					THROW(-21);
+					return -57;
 				}
 
-				ep = rctx->external_primitive_table[dictionary[w + 1]];
+				return -13;
+			}
 
-				if (0 == ep)
-				{
-					THROW(-21);
-				}
+			flag = *(rctx->sp++);
+			rv = 0;
 
-				rctx->sp = sp;
-				tos = ep(rctx);
+			if (0 != rctx->state)
+			{
 				sp = rctx->sp;
+				rctx->sp += (0 != flag) ? 2 : 1;
+				rv = forth_compile_literal(rctx, (0 != flag) ? sp[1] : sp[0]);	// The low cell of a double first.
 
-				if (0 != tos)
+				if ((0 == rv) && (0 != flag))
 				{
-					THROW(tos);
+					rv = forth_compile_literal(rctx, sp[0]);
 				}
-			break;
+			}
+#if defined(FORTH_STACK_CHECK_ENABLED)
+			else if (rctx->sp < rctx->sp_min)
+			{
+				rv = -3;
+			}
 #endif
+		}
 
-#if defined(FORTH_USER_VARIABLES)
-			case FORTH_TOKEN_USER_ALLOT:	// USER-ALLOT ( n -- ix )
-				tos = sp[0];
+		if (0 != rv)
+		{
+			return rv;
+		}
+	}
+}
+#endif
 
-				if ((dictionary[FORTH_UP_LOCATION] + tos) >= dictionary[FORTH_MAX_UP_LOCATION])
-				{
-					THROW(-8);
-				}
+// =======================================================================================
+// Returned by the engines when execution should carry on in the other variant.
+#define FORTH_ENGINE_SWITCH 1
+// Returned when execution should carry on in the variant that runs the other kind of code (cells or compact).
+#define FORTH_ENGINE_SWITCH_CODE 2
+
+#include "forth_engine.h"
+#define FORTH_ENGINE_TRACING 1
+#include "forth_engine.h"
+#undef FORTH_ENGINE_TRACING
+
+#if defined(FORTH_COMPACT_CODE)
+#	define FORTH_ENGINE_COMPACT 1
+#	include "forth_engine.h"
+#	define FORTH_ENGINE_TRACING 1
+#	include "forth_engine.h"
+#	undef FORTH_ENGINE_TRACING
+#	undef FORTH_ENGINE_COMPACT
+#endif
 
-				sp[0] = dictionary[FORTH_UP_LOCATION];
-				dictionary[FORTH_UP_LOCATION] += tos;
-			break;
+int forth(struct forth_runtime_context *rctx, forth_cell_t word_to_exec)
+{
+	forth_cell_t w = 0;
+	forth_cell_t xt = word_to_exec;
+	int tracing = (0 != rctx->trace);
+#if defined(FORTH_COMPACT_CODE)
+	int compact = FORTH_COMPACT_TAGGED(rctx->ip);
+#endif
+	int rv;
 
-			case FORTH_TOKEN_douser:
-				PUSH(&(rctx->user[UNSIGNED_PARAMETER]));
-			break;
+#if defined(FORTH_FORK)
+	if (0 != forth_arena_children(rctx->arena))	// The children still share the pages it has not written.
+	{
+		return -21;
+	}
+#endif
+
+	while (1)
+	{
+#if defined(FORTH_COMPACT_CODE)
+		if (compact)
+		{
+			rv = tracing ? forth_engine_compact_tracing(rctx, &w, &xt) : forth_engine_compact(rctx, &w, &xt);
+		}
+		else
 #endif
+		if (tracing)
+		{
+			rv = forth_engine_tracing(rctx, &w, &xt);
+		}
+		else
+		{
+			rv = forth_engine(rctx, &w, &xt);
+		}
 
-			case FORTH_TOKEN_docreate:
-				PUSH(&dictionary[w + 2]);
-				xt = dictionary[w + 1];
+#if defined(FORTH_COMPACT_CODE)
+		if (FORTH_ENGINE_SWITCH_CODE == rv)
+		{
+			compact = !compact;
 			continue;
+		}
+#endif
 
-			default:
-				forth_type0(rctx, "Unknown token: ");
-				forth_hdot(rctx, xt);
-				rctx->send_cr(rctx);
-				return -1;
-			break;
+		if (FORTH_ENGINE_SWITCH != rv)
+		{
+			return rv;
 		}
 
-		w = ip++;
-		// printf("w=0x%08x\n", w); fflush(stdout);
-		xt = dictionary[w];
+		tracing = !tracing;
+	}
+}
+
+// The word runs with ip pointing at the code field of BYE, so the engine returns when xt does.
+// Exceptions xt does not catch itself come back as the return value rather than going to the caller's CATCH.
+forth_cell_t forth_call(struct forth_runtime_context *rctx, forth_cell_t xt)
+{
+	forth_index_t ip = rctx->ip;
+	forth_cell_t handler = rctx->handler;
+	forth_cell_t rv = 0;
+
+#if defined(FORTH_FORK)
+	if (0 != forth_arena_children(rctx->arena))	// See forth().
+	{
+		return -21;
+	}
+#endif
+
+	rctx->ip = FORTH_XT_BYE;
+	rctx->handler = 0;
+
+	if (0 > forth(rctx, xt))	// The THROW code is still on the stack.
+	{
+		rv = *(rctx->sp++);
 	}
 
+	rctx->ip = ip;
+	rctx->handler = handler;
+	return rv;
 }
 
 // -----------------------------------------------------------------------------
@@ -45,6 +45,15 @@
 
 #endif
 
+// Forth addresses (cells) to C pointers and back, BASE is the char pointer to Forth address 0 (rctx->arena).
+#if defined(FORTH_ARENA)
+#	define FORTH_POINTER(BASE, A)	((BASE) + (forth_cell_t)(A))
+#	define FORTH_ADDRESS(BASE, P)	((forth_cell_t)((const char *)(P) - (BASE)))
+#else
+#	define FORTH_POINTER(BASE, A)	((char *)(uintptr_t)(A))
+#	define FORTH_ADDRESS(BASE, P)	((forth_cell_t)(uintptr_t)(P))
+#endif
+
 enum forth_token_t
 {
 	FORTH_TOKEN_NOP = 0,
@@ -68,6 +77,14 @@ enum forth_token_t
 	FORTH_TOKEN_CompileComma,	// COMPILE,
 	FORTH_TOKEN_Comma,	// ,
 	FORTH_TOKEN_Imm_Plus,	// IMM+
+	FORTH_TOKEN_Imm_AND,	// IMM-AND
+	FORTH_TOKEN_Imm_OR,	// IMM-OR
+	FORTH_TOKEN_Imm_XOR,	// IMM-XOR
+	FORTH_TOKEN_Imm_LSHIFT,	// IMM-LSHIFT
+	FORTH_TOKEN_Imm_RSHIFT,	// IMM-RSHIFT
+	FORTH_TOKEN_Imm_Equal,	// IMM=
+	FORTH_TOKEN_Imm_Less,	// IMM<
+	FORTH_TOKEN_Imm_Fetch,	// IMM+@
 	FORTH_TOKEN_CELLS,
 	FORTH_TOKEN_DROP,
 	FORTH_TOKEN_DUP,
@@ -199,6 +216,30 @@ enum forth_token_t
 	FORTH_TOKEN_TIME_DATE,	// TIME&DATE
 #endif
 
+#if defined(FORTH_AOT)
+	FORTH_TOKEN_TRANSLATE_C,	// TRANSLATE-C
+#endif
+
+#if defined(FORTH_IMAGE)
+	FORTH_TOKEN_SAVE_IMAGE,	// SAVE-IMAGE
+#endif
+
+#if defined(FORTH_STACK_EFFECT)
+	FORTH_TOKEN_STACK_EFFECT,	// STACK-EFFECT
+#endif
+
+#if defined(FORTH_WORDLIST_INDEX)
+	FORTH_TOKEN_WORDLIST_INDEX,	// WORDLIST-INDEX
+#endif
+
+#if defined(FORTH_NAME_SPACE)
+	FORTH_TOKEN_NAME_COMMA,		// (NAME,) used by CREATE-NAME
+#endif
+
+#if defined(FORTH_NATIVE_INTERPRET)
+	FORTH_TOKEN_INTERPRET,		// (INTERPRET) ( -- xt true | false ) the body of INTERPRET
+#endif
+
 	FORTH_TOKEN_CR,
 	FORTH_TOKEN_EMIT,
 	FORTH_TOKEN_TYPE,
@@ -280,6 +321,29 @@ enum forth_token_t
 #if defined(FORTH_USER_VARIABLES)
 	FORTH_TOKEN_douser,
 #endif
+	// Superinstructions, the peephole optimizer of COMPILE, makes them from pairs of tokens.
+	FORTH_TOKEN_OVER_Plus,	// OVER +
+	FORTH_TOKEN_DUP_0Equal,	// DUP 0=
+	FORTH_TOKEN_Fetch_Plus,	// @ +
+	FORTH_TOKEN_Rfrom_DROP,	// R> DROP
+	FORTH_TOKEN_I_Plus,	// I +
+	// Compare and branch, they branch when the comparison is false (like 0branch).
+	FORTH_TOKEN_Equal_0branch,	// = 0branch
+	FORTH_TOKEN_Notequal_0branch,	// <> 0branch
+	FORTH_TOKEN_Less_0branch,	// < 0branch
+	FORTH_TOKEN_Greater_0branch,	// > 0branch
+	FORTH_TOKEN_ULess_0branch,	// u< 0branch
+	FORTH_TOKEN_UGreater_0branch,	// u> 0branch
+	FORTH_TOKEN_0Equal_0branch,	// 0= 0branch
+	FORTH_TOKEN_0Notequal_0branch,	// 0<> 0branch
+	FORTH_TOKEN_0Less_0branch,	// 0< 0branch
+	FORTH_TOKEN_0Greater_0branch,	// 0> 0branch
+	FORTH_TOKEN_tailcall,	// Jumps into the colon definition in the next cell, reusing the caller's return address.
+	FORTH_TOKEN_inlined,	// Skips the xt in the next cell, the body of that word follows (the parameter is its length in cells).
+	FORTH_TOKEN_native,	// Code field of a colon definition compiled to machine code, the parameter selects the code.
+	FORTH_TOKEN_compiled,	// Code field of a colon definition translated to C ahead of time, the parameter indexes aot_table.
+	FORTH_TOKEN_compact,	// Code field of a colon definition whose body is 16 bit units (forth_compact.c).
+	FORTH_TOKEN_COUNT	// Not a token, the number of tokens defined above. Keep it last.
 };
 
 struct forth_persistent_context
@@ -294,29 +358,97 @@ struct forth_wordlist
 	forth_cell_t latest;
 	forth_cell_t parent;
 	forth_cell_t link;
+#if defined(FORTH_WORDLIST_INDEX)
+	forth_cell_t index;	// Dictionary index of a struct forth_wordlist_index, 0 if the wordlist has none.
+#endif
+};
+
+#if defined(FORTH_WORDLIST_INDEX)
+// Open addressing hash table keyed on the case folded names of a wordlist, made by WORDLIST-INDEX.
+// It holds the newest header for each name, up to the header in indexed. Definitions are linked with a plain
+// LATEST ! so a lookup that finds latest moved on enters the new headers first.
+struct forth_wordlist_index
+{
+	forth_cell_t slots;	// A power of two.
+	forth_cell_t used;
+	forth_cell_t indexed;	// The newest header entered.
+	forth_cell_t entry[1];	// Header indices, 0 in empty slots.
+};
+#endif
+
+#if defined(FORTH_KERNEL_NAME_HASH)
+// A perfect hash of the names in a wordlist generated by gen_dict (forth_kernel_wordlists[] in forth_dict.c).
+// A name hashes to a bucket, the displacement of the bucket picks its slot.
+struct forth_kernel_wordlist
+{
+	forth_cell_t wid;
+	forth_cell_t latest;		// The newest kernel header in the wordlist, every header from here on is in the table.
+	forth_cell_t buckets;		// A power of two.
+	forth_cell_t slots;		// A power of two, 0 ends forth_kernel_wordlists[].
+	const uint16_t *displacement;
+	const forth_cell_t *header;	// Header indices, 0 in empty slots.
 };
+#endif
 
 #define FORTH_HEADER_FLAGS_NAME_LENGTH_MASK	0x0000FFFF
 #define FORTH_HEADER_FLAGS_IMMEDIATE		0x80000000
 #define FORTH_HEADER_FLAGS_TOKEN		0x20000000
+#define FORTH_HEADER_FLAGS_KEEPS_RP		0x40000000	// ; found that the body leaves the return stack alone (FORTH_TAIL_CALL_OPTIMIZER).
+
+// The stack effect of a colon definition as worked out by ; (FORTH_STACK_EFFECT).
+// MAX is the most cells it has on the data stack counting its inputs, 15 also stands for more, or unbounded (recursion).
+#define FORTH_HEADER_FLAGS_EFFECT_KNOWN		0x10000000
+#define FORTH_HEADER_FLAGS_EFFECT_UNKNOWN	0x0FFF0000	// Looked at, but could not be worked out.
+#define FORTH_HEADER_FLAGS_EFFECT_MASK		0x1FFF0000
+#define FORTH_HEADER_FLAGS_EFFECT(IN, OUT, MAX)	(FORTH_HEADER_FLAGS_EFFECT_KNOWN | ((IN) << 16) | ((OUT) << 20) | ((MAX) << 24))
+#define FORTH_HEADER_FLAGS_EFFECT_IN(F)		(((F) >> 16) & 0xF)
+#define FORTH_HEADER_FLAGS_EFFECT_OUT(F)	(((F) >> 20) & 0xF)
+#define FORTH_HEADER_FLAGS_EFFECT_MAX(F)	(((F) >> 24) & 0xF)
 
 #define FORTH_COLON_SYS				0x55aa4884
 
 struct forth_header
 {
-	forth_cell_t link;
+	forth_cell_t link;	// With FORTH_NAME_SPACE the index of the struct forth_name of the header instead, 0 if it has none.
 	forth_cell_t flags;
 };
 
+#if defined(FORTH_NAME_SPACE)
+// A name in the name space, followed by the name as a counted string (a length byte and the characters as they were
+// spelled). The first cell of the counted string is the length and the first characters, compared (with the case of
+// letters ignored) before anything else.
+struct forth_name
+{
+	forth_cell_t link;	// The name of the definition before it in the wordlist, 0 at the end.
+	forth_cell_t xt;
+};
+#endif
+
+#if defined(FORTH_FIND_CACHE)
+struct forth_find_cache_entry
+{
+	forth_cell_t generation;
+	forth_cell_t hash;
+	forth_cell_t header;	// What the search order gave for the name, 0 in unused entries.
+};
+#endif
+
 typedef struct forth_runtime_context *forth_runtime_context_p;
 
 #if defined(FORTH_EXTERNAL_PRIMITIVES)
 typedef forth_cell_t (*forth_external_primitive)(forth_runtime_context_p rctx);
 #endif
 
+#if defined(FORTH_AOT)
+typedef forth_cell_t (*forth_aot_function)(forth_runtime_context_p rctx);	// Returns 0 or a THROW code.
+#endif
+
 struct forth_runtime_context
 {
 	forth_cell_t	*dictionary;
+#if defined(FORTH_ARENA)
+	char		*arena;		// Forth address 0, everything Forth can address has to be in the 4GB above it.
+#endif
 	forth_cell_t	*sp_max;
 	forth_cell_t	*sp_min;
 	forth_cell_t	*sp0;
@@ -343,13 +475,32 @@ struct forth_runtime_context
 #endif
 #if defined(FORTH_EXTERNAL_PRIMITIVES)
 	forth_external_primitive *external_primitive_table;
+#endif
+#if defined(FORTH_AOT)
+	const forth_aot_function *aot_table;	// Colon definitions translated to C (see forth_aot.h).
+#endif
+#if defined(FORTH_ARENA) && defined(FORTH_INCLUDE_MEMORY_ALLOCATION_WORDS)
+	forth_cell_t	heap;		// ALLOCATE takes memory from here (a Forth address), the memory has to be zeroed at first.
+	forth_cell_t	heap_size;	// Bytes.
+#endif
+#if defined(FORTH_FORK)
+	char		*forked;	// The arena of the parent for a copy made by forth_fork(), 0 in other contexts.
 #endif
 	forth_cell_t	*wordlists;	// Wordlists in the search order.
 	forth_cell_t	wordlist_slots;	// The number of slots in the search order.
 	forth_cell_t	wordlist_cnt;	// The number of workdlists in the search order.
 	forth_cell_t	current;	// The current wordlist (where definitions are appended).
+#if defined(FORTH_FIND_CACHE)
+	forth_cell_t	generation;	// Cache entries of older generations are stale.
+	struct forth_find_cache_entry find_cache[FORTH_FIND_CACHE];
+#endif
 	forth_cell_t	defining;	// The word being defined.
 	forth_cell_t	trace;		// Enabled execution trace.
+	forth_cell_t	peephole;	// Data space pointer right after the last cell compiled by COMPILE, (0 if none).
+#if defined(FORTH_CONSTANT_FOLDING)
+	forth_cell_t	literals[FORTH_CONSTANT_FOLDING];	// Where the pending literals were compiled (data space pointers).
+	forth_cell_t	literal_cnt;	// The number of pending literals.
+#endif
 	forth_cell_t	terminal_width;
 	forth_cell_t	terminal_height;
 	forth_cell_t	terminal_col;
@@ -378,5 +529,8 @@ struct forth_runtime_context
 
 extern int forth(struct forth_runtime_context *rctx, forth_cell_t word_to_exec);
 
+// Execute a single word and return when it does, the result is 0 or the THROW code that was not caught.
+extern forth_cell_t forth_call(struct forth_runtime_context *rctx, forth_cell_t xt);
+
 #endif
 
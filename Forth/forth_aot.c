@@ -0,0 +1,1184 @@
+/*
+* Copyright (c) 2026 The Embeddable Forth Command Interpreter contributors
+*
+* Permission is hereby granted, free of charge, to any person obtaining a copy
+* of this software and associated documentation files (the "Software"), to deal
+* in the Software without restriction, including without limitation the rights
+* to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+* copies of the Software, and to permit persons to whom the Software is
+* furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in
+* all copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+* AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+* THE SOFTWARE.
+*
+*/
+
+// http://forth.teleonomix.com/
+
+// Ahead of time translation of colon definitions to C (TRANSLATE-C) and installing the result (forth_aot_install()).
+// Uses stdio to write the C file -- meant to run on the development host, the generated code only needs forth_aot.h.
+//
+// The body of each definition is walked the same way SEE does. Within straight line code the stack is kept in C locals
+// (t0, t1...), so DUP * 1 + becomes a few assignments for the C compiler to put in registers. The locals are written
+// back to the stack at labels, branches, calls, and before anything the translator does not know, which is then run
+// by the inner interpreter through forth_call(). Loop frames are kept on the return stack exactly as (DO) does it.
+//
+// Definitions that use RP@ or RP!, take from the return stack what they have not put there (e.g. R> DROP to return
+// from the caller), or call such definitions, stay in the inner interpreter: a C function has no return address
+// on the return stack.
+
+#include <stdio.h>
+#include <stdarg.h>
+#include <stdlib.h>
+#include <string.h>
+#include <ctype.h>
+#include <inttypes.h>
+#include "forth.h"
+#include "forth_internal.h"
+#include "forth_dict.h"
+#include "forth_aot.h"
+
+#if defined(FORTH_AOT)
+
+#define POP() *(rctx->sp++)
+#define PUSH(X) *(--(rctx->sp)) = (forth_cell_t)(X)
+
+#define FORTH_AOT_MAX_BODY	4096	// Cells, longer definitions are not translated.
+#define FORTH_AOT_MAX_STACK	32	// Stack items kept in C locals, the rest is written to the stack.
+#define FORTH_AOT_MAX_LOCALS	(4 * FORTH_AOT_MAX_BODY)	// Remembered where they came from, so unchanged ones are not written back.
+
+#define FORTH_AOT_TRANSLATE	1	// Flags of the words found.
+#define FORTH_AOT_UNSAFE	2	// Must run in the inner interpreter, and so must its callers.
+
+// A whole cell as an unsigned C constant.
+#if defined(FORTH_64BIT)
+#	define FORTH_AOT_HEX	"0x%016" PRIX64 "U"
+#else
+#	define FORTH_AOT_HEX	"0x%08" PRIX32 "U"
+#endif
+
+struct forth_aot
+{
+	FILE		*out;		// 0 while counting the locals a definition needs.
+	forth_cell_t	*dictionary;
+	forth_cell_t	*xts;		// Colon definitions found, in the order they were defined.
+	forth_cell_t	*lengths;
+	unsigned char	*flags;
+	forth_cell_t	*index;		// Of the C function of each translated word.
+	forth_cell_t	count;
+	forth_cell_t	translated;
+
+	forth_cell_t	xt;		// The definition being translated.
+	forth_cell_t	length;
+	unsigned char	target[FORTH_AOT_MAX_BODY + 1];	// Cells that are branched to.
+	unsigned char	jumped[FORTH_AOT_MAX_BODY + 1];	// Labels a goto is written for, known after the first pass.
+	forth_cell_t	leave_to[FORTH_AOT_MAX_BODY];	// Where LEAVE goes from the innermost DO-loop.
+	int		loops;
+	int		stack[FORTH_AOT_MAX_STACK];	// The locals that hold the top of the stack, the last one is the top.
+	int		depth;
+	int		consumed;	// Cells taken from the in memory stack.
+	int		epoch;		// Changes when the in memory stack may have changed.
+	int		loaded_from[FORTH_AOT_MAX_LOCALS];	// The cell of the stack a local was read from,
+	int		loaded_in[FORTH_AOT_MAX_LOCALS];	// and the epoch it was read in.
+	unsigned char	read[FORTH_AOT_MAX_LOCALS];	// Locals the code reads, known after the first pass.
+	int		locals;
+	int		rc;		// The code needs rc.
+};
+
+static struct forth_aot aot;
+
+static void forth_aot_printf(struct forth_aot *a, const char *format, ...)
+{
+	va_list ap;
+	char line[256];
+	char *c;
+	int t;
+
+	if (0 == a->out)	// Note the locals that are read, the ones only set get a (void) so the C compiler does not warn.
+	{
+		va_start(ap, format);
+		vsnprintf(line, sizeof(line), format, ap);
+		va_end(ap);
+		c = line;
+		if (('\t' == c[0]) && ('t' == c[1]) && isdigit((unsigned char)c[2]))
+		{
+			c += 2;		// Set, not read.
+			while (isdigit((unsigned char)*c))
+			{
+				c++;
+			}
+		}
+		for (; *c; c++)
+		{
+			if (('t' == *c) && isdigit((unsigned char)c[1]) && ((c == line) || !(isalnum((unsigned char)c[-1]) || ('_' == c[-1]))))
+			{
+				t = atoi(c + 1);
+				if (FORTH_AOT_MAX_LOCALS > t)
+				{
+					a->read[t] = 1;
+				}
+			}
+		}
+		return;
+	}
+
+	va_start(ap, format);
+	vfprintf(a->out, format, ap);
+	va_end(ap);
+}
+
+static forth_cell_t forth_aot_name_length(forth_cell_t dictionary[], forth_cell_t xt)
+{
+	return dictionary[xt - 1] & (FORTH_HEADER_FLAGS_NAME_LENGTH_MASK);
+}
+
+static const char *forth_aot_name(forth_cell_t dictionary[], forth_cell_t xt)
+{
+	return FORTH_HEADER_NAME(dictionary, xt - 2);
+}
+
+// The name as a comment, anything that could upset the C compiler is replaced.
+static void forth_aot_comment(struct forth_aot *a, forth_cell_t xt)
+{
+	forth_cell_t len = forth_aot_name_length(a->dictionary, xt);
+	const char *name = forth_aot_name(a->dictionary, xt);
+	forth_cell_t i;
+
+	forth_aot_printf(a, "\t// ");
+	for (i = 0; i < len; i++)
+	{
+		forth_aot_printf(a, "%c", ((' ' < name[i]) && ('\\' != name[i]) && ('?' != name[i]) && (0x7F > name[i])) ? name[i] : '_');
+	}
+	forth_aot_printf(a, "\n");
+}
+
+static forth_cell_t forth_aot_checksum(forth_cell_t dictionary[], forth_cell_t xt, forth_cell_t length)
+{
+	forth_cell_t sum = 0;
+	forth_cell_t ix;
+
+	for (ix = xt + 1; ix <= (xt + length); ix++)
+	{
+		sum = (sum << 5) + sum + dictionary[ix];
+	}
+
+	return sum;
+}
+
+// The number of cells used by the token at ix of a body.
+static forth_cell_t forth_aot_cells(forth_cell_t dictionary[], forth_cell_t ix)
+{
+	forth_cell_t xt = dictionary[ix];
+
+	if (FORTH_IS_NOT_TOKEN(xt))
+	{
+		return 1;
+	}
+
+	switch (FORTH_EXTRACT_TOKEN(xt))
+	{
+		case FORTH_TOKEN_lit:
+		case FORTH_TOKEN_xtlit:
+		case FORTH_TOKEN_tailcall:
+		case FORTH_TOKEN_inlined:	// The body follows the xt.
+			return 2;
+
+		case FORTH_TOKEN_strlit:
+			return 1 + (FORTH_ALIGN(FORTH_PARAM_UNSIGNED(xt)) / sizeof(forth_cell_t));
+
+		default:
+			return 1;
+	}
+}
+
+// Find the end of the body and its branch targets, returns the flags of the word.
+static int forth_aot_scan(struct forth_aot *a, forth_cell_t xt)
+{
+	forth_cell_t *dictionary = a->dictionary;
+	forth_cell_t start = xt + 1;
+	forth_cell_t ix;
+	forth_cell_t cell;
+	forth_scell_t target;
+	forth_scell_t rdepth = 0;	// Cells this word has put on the return stack (not counting DO-loops).
+	unsigned char begins[FORTH_AOT_MAX_BODY + 1];
+	int flags = FORTH_AOT_TRANSLATE;
+
+	memset(a->target, 0, sizeof(a->target));
+	memset(begins, 0, sizeof(begins));
+
+	for (ix = 0; FORTH_PACK_TOKEN(FORTH_TOKEN_unnest) != (cell = dictionary[start + ix]); ix += forth_aot_cells(dictionary, start + ix))
+	{
+		if (FORTH_AOT_MAX_BODY <= ix)
+		{
+			return 0;
+		}
+
+		begins[ix] = 1;
+
+		if (FORTH_IS_NOT_TOKEN(cell))
+		{
+			continue;
+		}
+
+		target = ix + 1 + FORTH_PARAM_SIGNED(cell);
+
+		switch (FORTH_EXTRACT_TOKEN(cell))
+		{
+			case FORTH_TOKEN_branch:
+			case FORTH_TOKEN_0branch:
+			case FORTH_TOKEN_Equal_0branch:
+			case FORTH_TOKEN_Notequal_0branch:
+			case FORTH_TOKEN_Less_0branch:
+			case FORTH_TOKEN_Greater_0branch:
+			case FORTH_TOKEN_ULess_0branch:
+			case FORTH_TOKEN_UGreater_0branch:
+			case FORTH_TOKEN_0Equal_0branch:
+			case FORTH_TOKEN_0Notequal_0branch:
+			case FORTH_TOKEN_0Less_0branch:
+			case FORTH_TOKEN_0Greater_0branch:
+			case FORTH_TOKEN_pDO:
+			case FORTH_TOKEN_pqDO:
+			case FORTH_TOKEN_pLOOP:
+			case FORTH_TOKEN_pPlusLOOP:
+				if ((0 > target) || (FORTH_AOT_MAX_BODY < target))
+				{
+					return 0;
+				}
+				a->target[target] = 1;
+			break;
+
+			case FORTH_TOKEN_tailcall:
+				if (xt == dictionary[start + ix + 1])
+				{
+					a->target[0] = 1;
+				}
+			break;
+
+			case FORTH_TOKEN_toR:		rdepth += 1;	break;
+			case FORTH_TOKEN_2toR:		rdepth += 2;	break;
+			case FORTH_TOKEN_Rfrom:
+			case FORTH_TOKEN_Rfetch:
+			case FORTH_TOKEN_Rfrom_DROP:
+				rdepth -= (FORTH_TOKEN_Rfetch == FORTH_EXTRACT_TOKEN(cell)) ? 0 : 1;
+				if ((0 > rdepth) || ((FORTH_TOKEN_Rfetch == FORTH_EXTRACT_TOKEN(cell)) && (0 == rdepth)))
+				{
+					flags = FORTH_AOT_UNSAFE;
+				}
+			break;
+			case FORTH_TOKEN_2Rfrom:
+			case FORTH_TOKEN_2Rfetch:
+				rdepth -= (FORTH_TOKEN_2Rfetch == FORTH_EXTRACT_TOKEN(cell)) ? 0 : 2;
+				if ((0 > rdepth) || ((FORTH_TOKEN_2Rfetch == FORTH_EXTRACT_TOKEN(cell)) && (2 > rdepth)))
+				{
+					flags = FORTH_AOT_UNSAFE;
+				}
+			break;
+
+			case FORTH_TOKEN_rp_fetch:
+			case FORTH_TOKEN_rp_store:
+			case FORTH_TOKEN_NtoR:
+			case FORTH_TOKEN_NRfrom:
+				flags = FORTH_AOT_UNSAFE;
+			break;
+		}
+	}
+
+	a->length = ix;
+	begins[ix] = 1;
+
+	for (ix = 0; ix <= a->length; ix++)
+	{
+		if (a->target[ix] && !begins[ix])	// Into an operand, or out of the body.
+		{
+			return 0;
+		}
+	}
+
+	return flags;
+}
+
+static int forth_aot_find(struct forth_aot *a, forth_cell_t xt)
+{
+	forth_scell_t low = 0;
+	forth_scell_t high = (forth_scell_t)(a->count) - 1;
+	forth_scell_t mid;
+
+	while (low <= high)
+	{
+		mid = (low + high) / 2;
+		if (a->xts[mid] == xt)
+		{
+			return mid;
+		}
+		if (a->xts[mid] < xt)
+		{
+			low = mid + 1;
+		}
+		else
+		{
+			high = mid - 1;
+		}
+	}
+
+	return -1;
+}
+
+// -----------------------------------------------------------------------------
+// The stack of locals.
+
+// Write the locals back to the stack, CHECK checks the bounds before that (it is done on backward branches).
+static void forth_aot_sync(struct forth_aot *a, int check)
+{
+	int moved = a->consumed - a->depth;
+	int i;
+	int t;
+
+	if (0 < moved)
+	{
+		forth_aot_printf(a, "\tsp += %d;\n", moved);
+	}
+	else if (0 > moved)
+	{
+		forth_aot_printf(a, "\tsp -= %d;\n", -moved);
+	}
+
+	if (check)
+	{
+		forth_aot_printf(a, "\tFORTH_AOT_CHECK_STACKS();\n");
+	}
+
+	for (i = 0; i < a->depth; i++)
+	{
+		t = a->stack[i];
+		if ((FORTH_AOT_MAX_LOCALS > t) && (a->epoch == a->loaded_in[t]) && ((a->depth - 1 - i + moved) == a->loaded_from[t]))
+		{
+			continue;	// Still there.
+		}
+		forth_aot_printf(a, "\tsp[%d] = t%d;\n", a->depth - 1 - i, t);
+	}
+
+	a->depth = 0;
+	a->consumed = 0;
+	a->epoch++;
+}
+
+static void forth_aot_flush(struct forth_aot *a)
+{
+	forth_aot_sync(a, 0);
+}
+
+static int forth_aot_pop(struct forth_aot *a)
+{
+	if (0 < a->depth)
+	{
+		return a->stack[--(a->depth)];
+	}
+
+	if (FORTH_AOT_MAX_LOCALS > a->locals)
+	{
+		a->loaded_from[a->locals] = a->consumed;
+		a->loaded_in[a->locals] = a->epoch;
+	}
+	forth_aot_printf(a, "\tt%d = sp[%d];\n", a->locals, a->consumed++);
+	return a->locals++;
+}
+
+static void forth_aot_drop(struct forth_aot *a)
+{
+	if (0 < a->depth)
+	{
+		a->depth--;
+	}
+	else
+	{
+		a->consumed++;
+	}
+}
+
+static void forth_aot_keep(struct forth_aot *a, int t)
+{
+	if (FORTH_AOT_MAX_STACK == a->depth)
+	{
+		forth_aot_flush(a);
+	}
+
+	a->stack[a->depth++] = t;
+}
+
+// A new local on the top of the stack, the caller assigns it.
+static int forth_aot_push(struct forth_aot *a)
+{
+	if (FORTH_AOT_MAX_LOCALS > a->locals)
+	{
+		a->loaded_in[a->locals] = -1;
+	}
+	forth_aot_keep(a, a->locals);
+	return a->locals++;
+}
+
+static void forth_aot_literal(struct forth_aot *a, forth_cell_t value)
+{
+	int r = forth_aot_push(a);
+
+	if (0x7FFF >= value)
+	{
+		forth_aot_printf(a, "\tt%d = %u;\n", r, (unsigned)value);
+	}
+	else if (-0x8000 <= (forth_scell_t)value)
+	{
+		forth_aot_printf(a, "\tt%d = (forth_cell_t)%d;\n", r, (int)(forth_scell_t)value);
+	}
+	else
+	{
+		forth_aot_printf(a, "\tt%d = " FORTH_AOT_HEX ";\n", r, value);
+	}
+}
+
+// The address of a dictionary cell, the dictionary does not have to be at the same place when the code runs.
+static void forth_aot_address(struct forth_aot *a, forth_cell_t ix)
+{
+	forth_aot_printf(a, "\tt%d = FORTH_ADDRESS(rctx->arena, &rctx->dictionary[%u]);\n", forth_aot_push(a), (unsigned)ix);
+}
+
+// PREFIX x SUFFIX
+static void forth_aot_unary(struct forth_aot *a, const char *prefix, const char *suffix)
+{
+	int x = forth_aot_pop(a);
+	forth_aot_printf(a, "\tt%d = %st%d%s;\n", forth_aot_push(a), prefix, x, suffix);
+}
+
+// x OP y, CAST is applied to both operands.
+static void forth_aot_binary(struct forth_aot *a, const char *op, const char *cast)
+{
+	int y = forth_aot_pop(a);
+	int x = forth_aot_pop(a);
+	forth_aot_printf(a, "\tt%d = %st%d %s %st%d;\n", forth_aot_push(a), cast, x, op, cast, y);
+}
+
+static void forth_aot_compare(struct forth_aot *a, const char *op, const char *cast)
+{
+	int y = forth_aot_pop(a);
+	int x = forth_aot_pop(a);
+	forth_aot_printf(a, "\tt%d = (%st%d %s %st%d) ? FORTH_TRUE : FORTH_FALSE;\n", forth_aot_push(a), cast, x, op, cast, y);
+}
+
+static void forth_aot_immediate(struct forth_aot *a, const char *format, forth_scell_t param)
+{
+	int x = forth_aot_pop(a);
+	int r = forth_aot_push(a);
+
+	forth_aot_printf(a, "\tt%d = ", r);
+	forth_aot_printf(a, format, x, (int)param);
+	forth_aot_printf(a, ";\n");
+}
+
+// -----------------------------------------------------------------------------
+// Control flow, the stack of locals is empty at every label.
+
+// Branch when the condition (a C expression with %d for the local x and y) is true.
+static void forth_aot_branch_if(struct forth_aot *a, forth_cell_t ix, forth_cell_t target, const char *condition, int x, int y)
+{
+	forth_aot_sync(a, target <= ix);	// Backward, check the stacks like the engine does on branches.
+	forth_aot_printf(a, "\tif (");
+	forth_aot_printf(a, condition, x, y);
+	forth_aot_printf(a, ")\n\t{\n\t\tgoto l%u;\n\t}\n", (unsigned)target);
+	a->jumped[target] = 1;
+}
+
+static void forth_aot_goto(struct forth_aot *a, forth_cell_t ix, forth_cell_t target)
+{
+	forth_aot_sync(a, target <= ix);
+	forth_aot_printf(a, "\tgoto l%u;\n", (unsigned)target);
+	a->jumped[target] = 1;
+}
+
+static void forth_aot_compare_branch(struct forth_aot *a, forth_cell_t ix, forth_cell_t target, const char *condition)
+{
+	int y = forth_aot_pop(a);
+	int x = forth_aot_pop(a);
+	forth_aot_branch_if(a, ix, target, condition, x, y);
+}
+
+// Call the word xt, or push what it would push.
+static void forth_aot_word(struct forth_aot *a, forth_cell_t xt)
+{
+	forth_cell_t *dictionary = a->dictionary;
+	forth_cell_t code = dictionary[xt];
+	int found = forth_aot_find(a, xt);
+
+	if ((0 <= found) && (FORTH_AOT_TRANSLATE & a->flags[found]))
+	{
+		forth_aot_flush(a);
+		a->rc = 1;
+		forth_aot_printf(a, "\tFORTH_AOT_CALL(forth_aot_%u);", (unsigned)a->index[found]);
+		forth_aot_comment(a, xt);
+		return;
+	}
+
+	if (FORTH_PACK_TOKEN(FORTH_TOKEN_doconst) == code)
+	{
+		forth_aot_literal(a, dictionary[xt + 1]);
+		return;
+	}
+
+	if (FORTH_PACK_TOKEN(FORTH_TOKEN_dovar) == code)
+	{
+		forth_aot_address(a, xt + 1);
+		return;
+	}
+
+	if ((FORTH_PACK_TOKEN(FORTH_TOKEN_docreate) == code) && (FORTH_PACK_TOKEN(FORTH_TOKEN_NOP) == dictionary[xt + 1]))
+	{
+		forth_aot_address(a, xt + 2);
+		return;
+	}
+
+	forth_aot_flush(a);
+	a->rc = 1;
+	forth_aot_printf(a, "\tFORTH_AOT_FORTH(" FORTH_AOT_HEX ");", xt);
+	forth_aot_comment(a, xt);
+}
+
+// Translate the cell at ix of the body, returns the number of cells used.
+static forth_cell_t forth_aot_cell(struct forth_aot *a, forth_cell_t ix)
+{
+	forth_cell_t *dictionary = a->dictionary;
+	forth_cell_t start = a->xt + 1;
+	forth_cell_t cell = dictionary[start + ix];
+	forth_scell_t param = FORTH_PARAM_SIGNED(cell);
+	forth_cell_t target = ix + 1 + param;
+	int x;
+	int y;
+	int z;
+
+	if (FORTH_IS_NOT_TOKEN(cell))
+	{
+		forth_aot_word(a, cell);
+		return 1;
+	}
+
+	switch (FORTH_EXTRACT_TOKEN(cell))
+	{
+		case FORTH_TOKEN_NOP:
+		break;
+
+		case FORTH_TOKEN_lit:
+		case FORTH_TOKEN_xtlit:
+			forth_aot_literal(a, dictionary[start + ix + 1]);
+		break;
+
+		case FORTH_TOKEN_uslit:		forth_aot_literal(a, FORTH_PARAM_UNSIGNED(cell));	break;
+		case FORTH_TOKEN_sslit:		forth_aot_literal(a, (forth_cell_t)param);		break;
+
+		case FORTH_TOKEN_strlit:
+			forth_aot_address(a, start + ix + 1);
+			forth_aot_literal(a, FORTH_PARAM_UNSIGNED(cell));
+		break;
+
+		case FORTH_TOKEN_inlined:	// The body that follows is translated as it is.
+		break;
+
+		case FORTH_TOKEN_tailcall:
+			if (a->xt == dictionary[start + ix + 1])
+			{
+				forth_aot_goto(a, ix, 0);
+			}
+			else
+			{
+				forth_aot_word(a, dictionary[start + ix + 1]);
+				forth_aot_flush(a);
+				forth_aot_printf(a, "\tFORTH_AOT_RETURN();\n");
+			}
+		break;
+
+		case FORTH_TOKEN_EXIT:
+			forth_aot_flush(a);
+			forth_aot_printf(a, "\tFORTH_AOT_RETURN();\n");
+		break;
+
+		// Stack, only the locals are shuffled.
+		case FORTH_TOKEN_DUP:
+			x = forth_aot_pop(a);
+			forth_aot_keep(a, x);
+			forth_aot_keep(a, x);
+		break;
+
+		case FORTH_TOKEN_DROP:
+			forth_aot_drop(a);
+		break;
+
+		case FORTH_TOKEN_2DROP:
+			forth_aot_drop(a);
+			forth_aot_drop(a);
+		break;
+
+		case FORTH_TOKEN_NIP:
+			y = forth_aot_pop(a);
+			forth_aot_drop(a);
+			forth_aot_keep(a, y);
+		break;
+
+		case FORTH_TOKEN_SWAP:
+			y = forth_aot_pop(a);
+			x = forth_aot_pop(a);
+			forth_aot_keep(a, y);
+			forth_aot_keep(a, x);
+		break;
+
+		case FORTH_TOKEN_OVER:
+			y = forth_aot_pop(a);
+			x = forth_aot_pop(a);
+			forth_aot_keep(a, x);
+			forth_aot_keep(a, y);
+			forth_aot_keep(a, x);
+		break;
+
+		case FORTH_TOKEN_TUCK:
+			y = forth_aot_pop(a);
+			x = forth_aot_pop(a);
+			forth_aot_keep(a, y);
+			forth_aot_keep(a, x);
+			forth_aot_keep(a, y);
+		break;
+
+		case FORTH_TOKEN_2DUP:
+			y = forth_aot_pop(a);
+			x = forth_aot_pop(a);
+			forth_aot_keep(a, x);
+			forth_aot_keep(a, y);
+			forth_aot_keep(a, x);
+			forth_aot_keep(a, y);
+		break;
+
+		case FORTH_TOKEN_ROT:
+			z = forth_aot_pop(a);
+			y = forth_aot_pop(a);
+			x = forth_aot_pop(a);
+			forth_aot_keep(a, y);
+			forth_aot_keep(a, z);
+			forth_aot_keep(a, x);
+		break;
+
+		case FORTH_TOKEN_qDUP:
+			x = forth_aot_pop(a);
+			forth_aot_flush(a);
+			forth_aot_printf(a, "\tif (0 != t%d)\n\t{\n\t\t*(--sp) = t%d;\n\t}\n", x, x);
+			forth_aot_keep(a, x);
+		break;
+
+		// Arithmetic and logic.
+		case FORTH_TOKEN_Plus:		forth_aot_binary(a, "+", "");	break;
+		case FORTH_TOKEN_Subtract:	forth_aot_binary(a, "-", "");	break;
+		case FORTH_TOKEN_Multiply:	forth_aot_binary(a, "*", "");	break;
+		case FORTH_TOKEN_AND:		forth_aot_binary(a, "&", "");	break;
+		case FORTH_TOKEN_OR:		forth_aot_binary(a, "|", "");	break;
+		case FORTH_TOKEN_XOR:		forth_aot_binary(a, "^", "");	break;
+		case FORTH_TOKEN_LSHIFT:	forth_aot_binary(a, "<<", "");	break;
+		case FORTH_TOKEN_RSHIFT:	forth_aot_binary(a, ">>", "");	break;
+		case FORTH_TOKEN_NEGATE:	forth_aot_unary(a, "-", "");	break;
+		case FORTH_TOKEN_INVERT:	forth_aot_unary(a, "~", "");	break;
+		case FORTH_TOKEN_2_Star:	forth_aot_unary(a, "", " << 1");	break;
+		case FORTH_TOKEN_2_Slash:	forth_aot_unary(a, "", " >> 1");	break;
+		case FORTH_TOKEN_CELLS:		forth_aot_unary(a, "", " * sizeof(forth_cell_t)");	break;
+
+		case FORTH_TOKEN_ABS:
+			x = forth_aot_pop(a);
+			forth_aot_printf(a, "\tt%d = (0 > (forth_scell_t)t%d) ? -t%d : t%d;\n", forth_aot_push(a), x, x, x);
+		break;
+
+		case FORTH_TOKEN_MIN:
+		case FORTH_TOKEN_MAX:
+			y = forth_aot_pop(a);
+			x = forth_aot_pop(a);
+			forth_aot_printf(a, "\tt%d = ((forth_scell_t)t%d %s (forth_scell_t)t%d) ? t%d : t%d;\n", forth_aot_push(a),
+				x, (FORTH_TOKEN_MIN == FORTH_EXTRACT_TOKEN(cell)) ? "<" : ">", y, x, y);
+		break;
+
+		// Comparisons.
+		case FORTH_TOKEN_Equal:		forth_aot_compare(a, "==", "");	break;
+		case FORTH_TOKEN_Notequal:	forth_aot_compare(a, "!=", "");	break;
+		case FORTH_TOKEN_Less:		forth_aot_compare(a, "<", "(forth_scell_t)");	break;
+		case FORTH_TOKEN_Greater:	forth_aot_compare(a, ">", "(forth_scell_t)");	break;
+		case FORTH_TOKEN_ULess:		forth_aot_compare(a, "<", "");	break;
+		case FORTH_TOKEN_UGreater:	forth_aot_compare(a, ">", "");	break;
+		case FORTH_TOKEN_0Equal:	forth_aot_unary(a, "(0 == ", ") ? FORTH_TRUE : FORTH_FALSE");	break;
+		case FORTH_TOKEN_0Notequal:	forth_aot_unary(a, "(0 != ", ") ? FORTH_TRUE : FORTH_FALSE");	break;
+		case FORTH_TOKEN_0Less:		forth_aot_unary(a, "(0 > (forth_scell_t)", ") ? FORTH_TRUE : FORTH_FALSE");	break;
+		case FORTH_TOKEN_0Greater:	forth_aot_unary(a, "(0 < (forth_scell_t)", ") ? FORTH_TRUE : FORTH_FALSE");	break;
+
+		// Memory.
+		case FORTH_TOKEN_Fetch:		forth_aot_unary(a, "FORTH_AOT_CELL(", ")");	break;
+		case FORTH_TOKEN_CFetch:	forth_aot_unary(a, "FORTH_AOT_CHAR(", ")");	break;
+
+		case FORTH_TOKEN_Store:
+		case FORTH_TOKEN_PlusStore:
+		case FORTH_TOKEN_CStore:
+			y = forth_aot_pop(a);
+			x = forth_aot_pop(a);
+			forth_aot_printf(a, "\t%s(t%d) %s t%d;\n", (FORTH_TOKEN_CStore == FORTH_EXTRACT_TOKEN(cell)) ? "FORTH_AOT_CHAR" : "FORTH_AOT_CELL",
+				y, (FORTH_TOKEN_PlusStore == FORTH_EXTRACT_TOKEN(cell)) ? "+=" : "=", x);
+			a->epoch++;	// It might have been the stack.
+		break;
+
+		// Immediate operands.
+		case FORTH_TOKEN_Imm_Plus:	forth_aot_immediate(a, "t%d + (forth_cell_t)%d", param);	break;
+		case FORTH_TOKEN_Imm_AND:	forth_aot_immediate(a, "t%d & (forth_cell_t)%d", param);	break;
+		case FORTH_TOKEN_Imm_OR:	forth_aot_immediate(a, "t%d | (forth_cell_t)%d", param);	break;
+		case FORTH_TOKEN_Imm_XOR:	forth_aot_immediate(a, "t%d ^ (forth_cell_t)%d", param);	break;
+		case FORTH_TOKEN_Imm_LSHIFT:	forth_aot_immediate(a, "t%d << %d", FORTH_PARAM_UNSIGNED(cell));	break;
+		case FORTH_TOKEN_Imm_RSHIFT:	forth_aot_immediate(a, "t%d >> %d", FORTH_PARAM_UNSIGNED(cell));	break;
+		case FORTH_TOKEN_Imm_Equal:	forth_aot_immediate(a, "(t%d == (forth_cell_t)%d) ? FORTH_TRUE : FORTH_FALSE", param);	break;
+		case FORTH_TOKEN_Imm_Less:	forth_aot_immediate(a, "((forth_scell_t)t%d < %d) ? FORTH_TRUE : FORTH_FALSE", param);	break;
+		case FORTH_TOKEN_Imm_Fetch:	forth_aot_immediate(a, "FORTH_AOT_CELL(t%d + (forth_cell_t)%d)", param);	break;
+
+		// Superinstructions.
+		case FORTH_TOKEN_OVER_Plus:
+			y = forth_aot_pop(a);
+			x = forth_aot_pop(a);
+			forth_aot_keep(a, x);
+			forth_aot_printf(a, "\tt%d = t%d + t%d;\n", forth_aot_push(a), x, y);
+		break;
+
+		case FORTH_TOKEN_DUP_0Equal:
+			x = forth_aot_pop(a);
+			forth_aot_keep(a, x);
+			forth_aot_printf(a, "\tt%d = (0 == t%d) ? FORTH_TRUE : FORTH_FALSE;\n", forth_aot_push(a), x);
+		break;
+
+		case FORTH_TOKEN_Fetch_Plus:
+			y = forth_aot_pop(a);
+			x = forth_aot_pop(a);
+			forth_aot_printf(a, "\tt%d = t%d + FORTH_AOT_CELL(t%d);\n", forth_aot_push(a), x, y);
+		break;
+
+		// The return stack.
+		case FORTH_TOKEN_toR:
+			forth_aot_printf(a, "\t*(--rp) = t%d;\n", forth_aot_pop(a));
+		break;
+
+		case FORTH_TOKEN_Rfrom:
+			forth_aot_printf(a, "\tt%d = *(rp++);\n", forth_aot_push(a));
+		break;
+
+		case FORTH_TOKEN_Rfetch:
+		case FORTH_TOKEN_I:
+			forth_aot_printf(a, "\tt%d = rp[0];\n", forth_aot_push(a));
+		break;
+
+		case FORTH_TOKEN_J:
+			forth_aot_printf(a, "\tt%d = rp[3];\n", forth_aot_push(a));
+		break;
+
+		case FORTH_TOKEN_I_Plus:
+			forth_aot_unary(a, "", " + rp[0]");
+		break;
+
+		case FORTH_TOKEN_Rfrom_DROP:
+			forth_aot_printf(a, "\trp++;\n");
+		break;
+
+		// Branches.
+		case FORTH_TOKEN_branch:
+			forth_aot_goto(a, ix, target);
+		break;
+
+		case FORTH_TOKEN_0branch:
+			x = forth_aot_pop(a);
+			forth_aot_branch_if(a, ix, target, "0 == t%d", x, 0);
+		break;
+
+		case FORTH_TOKEN_0Equal_0branch:	x = forth_aot_pop(a);	forth_aot_branch_if(a, ix, target, "0 != t%d", x, 0);	break;
+		case FORTH_TOKEN_0Notequal_0branch:	x = forth_aot_pop(a);	forth_aot_branch_if(a, ix, target, "0 == t%d", x, 0);	break;
+		case FORTH_TOKEN_0Less_0branch:		x = forth_aot_pop(a);	forth_aot_branch_if(a, ix, target, "0 <= (forth_scell_t)t%d", x, 0);	break;
+		case FORTH_TOKEN_0Greater_0branch:	x = forth_aot_pop(a);	forth_aot_branch_if(a, ix, target, "0 >= (forth_scell_t)t%d", x, 0);	break;
+		case FORTH_TOKEN_Equal_0branch:		forth_aot_compare_branch(a, ix, target, "t%d != t%d");	break;
+		case FORTH_TOKEN_Notequal_0branch:	forth_aot_compare_branch(a, ix, target, "t%d == t%d");	break;
+		case FORTH_TOKEN_Less_0branch:		forth_aot_compare_branch(a, ix, target, "(forth_scell_t)t%d >= (forth_scell_t)t%d");	break;
+		case FORTH_TOKEN_Greater_0branch:	forth_aot_compare_branch(a, ix, target, "(forth_scell_t)t%d <= (forth_scell_t)t%d");	break;
+		case FORTH_TOKEN_ULess_0branch:		forth_aot_compare_branch(a, ix, target, "t%d >= t%d");	break;
+		case FORTH_TOKEN_UGreater_0branch:	forth_aot_compare_branch(a, ix, target, "t%d <= t%d");	break;
+
+		// DO-loops, the frame on the return stack is the same as the engine's.
+		case FORTH_TOKEN_pDO:
+		case FORTH_TOKEN_pqDO:
+			x = forth_aot_pop(a);	// Index.
+			y = forth_aot_pop(a);	// Limit.
+			if (FORTH_TOKEN_pqDO == FORTH_EXTRACT_TOKEN(cell))
+			{
+				forth_aot_branch_if(a, ix, target, "t%d == t%d", x, y);
+			}
+			forth_aot_printf(a, "\trp -= 3;\n\tFORTH_AOT_CHECK_RETURN_STACK();\n");
+			forth_aot_printf(a, "\trp[0] = t%d;\n\trp[1] = t%d;\n\trp[2] = %u;\n", x, y, (unsigned)(start + target));
+			a->leave_to[a->loops++] = target;
+		break;
+
+		case FORTH_TOKEN_pLOOP:
+			forth_aot_branch_if(a, ix, target, "++rp[0] != rp[1]", 0, 0);
+			forth_aot_printf(a, "\trp += 3;\n\tFORTH_AOT_CHECK_RETURN_STACK();\n");
+		break;
+
+		case FORTH_TOKEN_pPlusLOOP:
+			x = forth_aot_pop(a);
+			forth_aot_flush(a);
+			forth_aot_printf(a, "\trp[0] += t%d;\n", x);
+			forth_aot_branch_if(a, ix, target, "0 > (forth_scell_t)((rp[0] - rp[1]) ^ t%d)", x, 0);
+			forth_aot_printf(a, "\trp += 3;\n\tFORTH_AOT_CHECK_RETURN_STACK();\n");
+		break;
+
+		case FORTH_TOKEN_UNLOOP:
+			forth_aot_printf(a, "\trp += 3;\n\tFORTH_AOT_CHECK_RETURN_STACK();\n");
+		break;
+
+		case FORTH_TOKEN_LEAVE:
+			while ((0 < a->loops) && (a->leave_to[a->loops - 1] <= ix))	// Loops that have ended already.
+			{
+				a->loops--;
+			}
+			forth_aot_flush(a);
+			forth_aot_printf(a, "\trp += 3;\n\tFORTH_AOT_CHECK_RETURN_STACK();\n");
+			if (0 == a->loops)	// Not in a loop of this word, do what the engine would.
+			{
+				forth_aot_printf(a, "\tFORTH_AOT_RETURN();\n");
+				break;
+			}
+			forth_aot_goto(a, ix, a->leave_to[a->loops - 1]);
+		break;
+
+		default:	// Run by the inner interpreter.
+			forth_aot_flush(a);
+			a->rc = 1;
+			forth_aot_printf(a, "\tFORTH_AOT_FORTH(" FORTH_AOT_HEX ");\n", cell);
+		break;
+	}
+
+	return forth_aot_cells(dictionary, start + ix);
+}
+
+static void forth_aot_body(struct forth_aot *a)
+{
+	forth_cell_t ix;
+
+	a->depth = 0;
+	a->consumed = 0;
+	a->locals = 0;
+	a->epoch = 0;
+	a->loops = 0;
+	a->rc = 0;
+
+	for (ix = 0; ix < a->length; ix += forth_aot_cell(a, ix))
+	{
+		if (a->target[ix])
+		{
+			forth_aot_flush(a);
+			if (a->jumped[ix])	// Not for the end of a loop that has no LEAVE, the C compiler would warn.
+			{
+				forth_aot_printf(a, "l%u:\n", (unsigned)ix);
+			}
+		}
+	}
+
+	forth_aot_flush(a);
+	if (a->jumped[a->length])
+	{
+		forth_aot_printf(a, "l%u:\n", (unsigned)a->length);
+	}
+	forth_aot_printf(a, "\tFORTH_AOT_RETURN();\n");
+}
+
+static void forth_aot_define(struct forth_aot *a, forth_cell_t i)
+{
+	FILE *out = a->out;
+	int t;
+
+	a->xt = a->xts[i];
+	forth_aot_scan(a, a->xt);
+	memset(a->jumped, 0, sizeof(a->jumped));
+	memset(a->read, 0, sizeof(a->read));
+
+	a->out = 0;			// Count the locals first.
+	forth_aot_body(a);
+	a->out = out;
+
+	forth_aot_printf(a, "\nstatic forth_cell_t forth_aot_%u(forth_runtime_context_p rctx)", (unsigned)a->index[i]);
+	forth_aot_comment(a, a->xt);
+	forth_aot_printf(a, "{\n\tforth_cell_t *sp = rctx->sp;\n\tforth_cell_t *rp = rctx->rp;\n");
+	if (a->rc)
+	{
+		forth_aot_printf(a, "\tforth_cell_t rc;\n");
+	}
+	for (t = 0; t < a->locals; t++)
+	{
+		forth_aot_printf(a, "%s t%d%s", (0 == (t % 16)) ? "\tforth_cell_t" : "", t, ((t == (a->locals - 1)) || (15 == (t % 16))) ? ";\n" : ",");
+	}
+	for (t = 0; (t < a->locals) && (FORTH_AOT_MAX_LOCALS > t); t++)
+	{
+		if (!a->read[t])
+		{
+			forth_aot_printf(a, "\t(void)t%d;\n", t);
+		}
+	}
+	forth_aot_printf(a, "\n\tFORTH_AOT_CHECK_STACKS();\n");
+
+	forth_aot_body(a);
+	forth_aot_printf(a, "}\n");
+}
+
+static void forth_aot_string(struct forth_aot *a, const char *s, forth_cell_t len)
+{
+	forth_cell_t i;
+
+	forth_aot_printf(a, "\"");
+	for (i = 0; i < len; i++)
+	{
+		if ((' ' <= s[i]) && (0x7F > s[i]) && ('"' != s[i]) && ('\\' != s[i]) && ('?' != s[i]))
+		{
+			forth_aot_printf(a, "%c", s[i]);
+		}
+		else
+		{
+			forth_aot_printf(a, "\\%03o", (unsigned char)s[i]);
+		}
+	}
+	forth_aot_printf(a, "\"");
+}
+
+static void forth_aot_file(struct forth_aot *a)
+{
+	forth_cell_t i;
+
+	forth_aot_printf(a, "// Generated by TRANSLATE-C, do *NOT* edit. See forth_aot.h for how to install it.\n\n");
+	forth_aot_printf(a, "#include <stdint.h>\n#include \"forth_aot.h\"\n\n");
+	forth_aot_printf(a, "#define FORTH_AOT_WORD_COUNT\t%u\n\n", (unsigned)a->translated);
+
+	for (i = 0; i < a->count; i++)
+	{
+		if (FORTH_AOT_TRANSLATE & a->flags[i])
+		{
+			forth_aot_printf(a, "static forth_cell_t forth_aot_%u(forth_runtime_context_p rctx);\n", (unsigned)a->index[i]);
+		}
+	}
+
+	for (i = 0; i < a->count; i++)
+	{
+		if (FORTH_AOT_TRANSLATE & a->flags[i])
+		{
+			forth_aot_define(a, i);
+		}
+	}
+
+	forth_aot_printf(a, "\nconst forth_aot_function forth_aot_functions[FORTH_AOT_WORD_COUNT] =\n{\n");
+	for (i = 0; i < a->count; i++)
+	{
+		if (FORTH_AOT_TRANSLATE & a->flags[i])
+		{
+			forth_aot_printf(a, "\tforth_aot_%u,\n", (unsigned)a->index[i]);
+		}
+	}
+	forth_aot_printf(a, "};\n\nconst struct forth_aot_word forth_aot_words[FORTH_AOT_WORD_COUNT] =\n{\n");
+	for (i = 0; i < a->count; i++)
+	{
+		if (FORTH_AOT_TRANSLATE & a->flags[i])
+		{
+			forth_aot_printf(a, "\t{ " FORTH_AOT_HEX ", %u, " FORTH_AOT_HEX ", ", a->xts[i], (unsigned)a->lengths[i],
+				forth_aot_checksum(a->dictionary, a->xts[i], a->lengths[i]));
+			forth_aot_string(a, forth_aot_name(a->dictionary, a->xts[i]), forth_aot_name_length(a->dictionary, a->xts[i]));
+			forth_aot_printf(a, " },\n");
+		}
+	}
+	forth_aot_printf(a, "};\n");
+}
+
+// Collect the colon definitions of the current wordlist from xt to the latest one and decide which ones to translate.
+static forth_cell_t forth_aot_prepare(struct forth_aot *a, struct forth_runtime_context *rctx, forth_cell_t xt)
+{
+	forth_cell_t *dictionary = rctx->dictionary;
+	forth_cell_t latest = ((struct forth_wordlist *)(&dictionary[rctx->current]))->latest;
+	forth_cell_t header;
+	forth_cell_t i;
+	forth_cell_t j;
+	int changed;
+
+	a->dictionary = dictionary;
+	a->count = 0;
+
+	for (header = latest; (0 != header) && ((header + 2) != xt); header = FORTH_HEADER_NEXT(dictionary, header))
+	{
+		a->count++;
+	}
+
+	if (0 == header)
+	{
+		return -13;	// Not in the current wordlist.
+	}
+	a->count++;
+
+	a->xts = malloc(a->count * sizeof(forth_cell_t));
+	a->lengths = malloc(a->count * sizeof(forth_cell_t));
+	a->index = malloc(a->count * sizeof(forth_cell_t));
+	a->flags = malloc(a->count);
+
+	if ((0 == a->xts) || (0 == a->lengths) || (0 == a->index) || (0 == a->flags))
+	{
+		return -59;	// ALLOCATE
+	}
+
+	i = a->count;
+	for (header = latest; i > 0; header = FORTH_HEADER_NEXT(dictionary, header))
+	{
+		a->xts[--i] = header + 2;	// Oldest first, so the xts are sorted.
+	}
+
+	for (i = 0; i < a->count; i++)
+	{
+		a->flags[i] = FORTH_IS_COLON_CODE(dictionary[a->xts[i]]) ? forth_aot_scan(a, a->xts[i]) : 0;
+		a->lengths[i] = a->length;
+	}
+
+	do	// Callers of words that cannot run as C cannot run as C either.
+	{
+		changed = 0;
+		for (i = 0; i < a->count; i++)
+		{
+			if (FORTH_AOT_TRANSLATE != a->flags[i])
+			{
+				continue;
+			}
+
+			for (j = a->xts[i] + 1; j <= (a->xts[i] + a->lengths[i]); j += forth_aot_cells(dictionary, j))
+			{
+				forth_cell_t callee = dictionary[j];
+				int found;
+
+				if (FORTH_PACK_TOKEN(FORTH_TOKEN_tailcall) == callee)
+				{
+					callee = dictionary[j + 1];
+				}
+
+				found = FORTH_IS_NOT_TOKEN(callee) ? forth_aot_find(a, callee) : -1;
+
+				if ((0 <= found) && (FORTH_AOT_UNSAFE & a->flags[found]))
+				{
+					a->flags[i] = FORTH_AOT_UNSAFE;
+					changed = 1;
+					break;
+				}
+			}
+		}
+	} while (changed);
+
+	a->translated = 0;
+	for (i = 0; i < a->count; i++)
+	{
+		a->index[i] = a->translated;
+		if (FORTH_AOT_TRANSLATE & a->flags[i])
+		{
+			a->translated++;
+		}
+	}
+
+	if ((0 == a->translated) || ((FORTH_PARAM_MAX + 1) < a->translated))
+	{
+		return -13;
+	}
+
+	return 0;
+}
+
+static void forth_aot_release(struct forth_aot *a)
+{
+	free(a->xts);
+	free(a->lengths);
+	free(a->index);
+	free(a->flags);
+	a->xts = 0;
+	a->lengths = 0;
+	a->index = 0;
+	a->flags = 0;
+}
+
+// TRANSLATE-C ( xt c-addr u -- ior )
+void forth_translate_c(struct forth_runtime_context *rctx)
+{
+	forth_cell_t cnt = POP();
+	char *fname = FORTH_POINTER(rctx->arena, POP());
+	forth_cell_t xt = POP();
+	forth_cell_t ior;
+	char *cname;
+
+	ior = forth_aot_prepare(&aot, rctx, xt);
+
+	if (0 == ior)
+	{
+		cname = FORTH_ALLOCATE_CNAME(fname, cnt);
+		aot.out = (0 != cname) ? fopen(cname, "w") : 0;
+		FORTH_FREE_CNAME(cname);
+
+		if (0 == aot.out)
+		{
+			ior = -37;
+		}
+		else
+		{
+			forth_aot_file(&aot);
+			if (ferror(aot.out))
+			{
+				ior = -37;
+			}
+			if (EOF == fclose(aot.out))
+			{
+				ior = -37;
+			}
+			aot.out = 0;
+		}
+	}
+
+	forth_aot_release(&aot);
+	PUSH(ior);
+}
+
+// Point the code fields of the translated words to the C functions if the dictionary has the same definitions.
+forth_cell_t forth_aot_install(struct forth_runtime_context *rctx, const struct forth_aot_word *words, forth_cell_t count,
+	const forth_aot_function *functions)
+{
+	forth_cell_t *dictionary = rctx->dictionary;
+	forth_cell_t here = dictionary[FORTH_DP_LOCATION] / sizeof(forth_cell_t);
+	forth_cell_t i;
+	forth_cell_t xt;
+	forth_cell_t len;
+
+	if ((FORTH_PARAM_MAX + 1) < count)
+	{
+		return -13;
+	}
+
+	for (i = 0; i < count; i++)
+	{
+		xt = words[i].xt;
+		len = strlen(words[i].name);
+
+		if ((2 > xt) || (here <= (xt + words[i].length + 1)) || !FORTH_IS_COLON_CODE(dictionary[xt])
+			|| (FORTH_PACK_TOKEN(FORTH_TOKEN_unnest) != dictionary[xt + 1 + words[i].length])
+			|| (words[i].checksum != forth_aot_checksum(dictionary, xt, words[i].length))
+			|| (len != forth_aot_name_length(dictionary, xt)) || (0 != memcmp(words[i].name, forth_aot_name(dictionary, xt), len)))
+		{
+			return -13;	// Not the dictionary that was translated.
+		}
+	}
+
+	for (i = 0; i < count; i++)
+	{
+		dictionary[words[i].xt] = FORTH_PACK_TOKEN(FORTH_TOKEN_compiled) | FORTH_PARAM_PACK(i);
+	}
+
+	rctx->aot_table = functions;
+	return 0;
+}
+#endif
@@ -0,0 +1,96 @@
+#ifndef FORTH_AOT_H
+#define FORTH_AOT_H
+/*
+* Copyright (c) 2026 The Embeddable Forth Command Interpreter contributors
+*
+* Permission is hereby granted, free of charge, to any person obtaining a copy
+* of this software and associated documentation files (the "Software"), to deal
+* in the Software without restriction, including without limitation the rights
+* to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+* copies of the Software, and to permit persons to whom the Software is
+* furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in
+* all copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+* AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+* THE SOFTWARE.
+*
+*/
+
+// http://forth.teleonomix.com/
+
+#include "forth.h"
+
+#if defined(FORTH_AOT)
+/*
+* Ahead of time translation of colon definitions to C.
+*
+* Once the application's source has been INCLUDED,
+*	' FIRST-WORD S" words.c" TRANSLATE-C THROW
+* writes every colon definition of the current wordlist from FIRST-WORD up to the latest one into words.c as a C function.
+* Stack items live in C locals within straight line code, primitives without a C equivalent and words that have not been
+* translated are run by the inner interpreter through forth_call().
+*
+* words.c is compiled with the application, which has to load the same source into the same kernel at start up
+* and then call
+*	forth_aot_install(rctx, forth_aot_words, FORTH_AOT_WORD_COUNT, forth_aot_functions);
+* This checks that every translated word is still there with the same body and then points their code fields at the C functions.
+* If anything differs nothing is installed and the words keep running in the inner interpreter.
+*
+* Like external primitives, the table of functions is referred to by index from the dictionary,
+* so every thread's run time context must have the aot_table field set (forth_aot_install() does it for the one passed to it).
+*/
+
+struct forth_aot_word
+{
+	forth_cell_t	xt;
+	forth_cell_t	length;		// Cells in the body, up to the unnest compiled by ;
+	forth_cell_t	checksum;	// Of the body.
+	const char	*name;
+};
+
+// The generated code keeps sp and rp in locals, and stores them back before anything that can see them.
+#define FORTH_AOT_SAVE()	rctx->sp = sp; rctx->rp = rp
+#define FORTH_AOT_LOAD()	sp = rctx->sp; rp = rctx->rp
+#define FORTH_AOT_RETURN()	do { FORTH_AOT_SAVE(); return 0; } while (0)
+
+// Call another translated word, it takes a return stack cell like nest would so runaway recursion is caught.
+#define FORTH_AOT_CALL(F)	do { rp--; FORTH_AOT_SAVE(); if (0 != (rc = (F)(rctx))) { return rc; } FORTH_AOT_LOAD(); rp++; } while (0)
+
+// Memory access through Forth addresses (cells).
+#define FORTH_AOT_CELL(A)	(*(forth_cell_t *)FORTH_POINTER(rctx->arena, (A)))
+#define FORTH_AOT_CHAR(A)	(*FORTH_POINTER(rctx->arena, (A)))
+
+// Run xt in the inner interpreter.
+#define FORTH_AOT_FORTH(XT)	do { FORTH_AOT_SAVE(); if (0 != (rc = forth_call(rctx, (XT)))) { return rc; } FORTH_AOT_LOAD(); } while (0)
+
+#if defined(FORTH_STACK_CHECK_ENABLED)
+#	define FORTH_AOT_CHECK_STACKS() \
+		if ((sp < rctx->sp_min) || (sp > rctx->sp_max) || (rp < rctx->rp_min) || (rp > rctx->rp_max)) \
+		{ \
+			FORTH_AOT_SAVE(); \
+			return (sp < rctx->sp_min) ? -3 : ((sp > rctx->sp_max) ? -4 : ((rp < rctx->rp_min) ? -5 : -6)); \
+		}
+// DO-loops check the return stack where they move rp, as (DO), UNLOOP, LEAVE and the loop ends do in the engine.
+#	define FORTH_AOT_CHECK_RETURN_STACK() \
+		if ((rp < rctx->rp_min) || (rp > rctx->rp_max)) \
+		{ \
+			FORTH_AOT_SAVE(); \
+			return (rp < rctx->rp_min) ? -5 : -6; \
+		}
+#else
+#	define FORTH_AOT_CHECK_STACKS()
+#	define FORTH_AOT_CHECK_RETURN_STACK()
+#endif
+
+extern forth_cell_t forth_aot_install(struct forth_runtime_context *rctx, const struct forth_aot_word *words, forth_cell_t count,
+	const forth_aot_function *functions);
+#endif
+
+#endif
@@ -0,0 +1,322 @@
+/*
+* Copyright (c) 2026 The Embeddable Forth Command Interpreter contributors
+*
+* Permission is hereby granted, free of charge, to any person obtaining a copy
+* of this software and associated documentation files (the "Software"), to deal
+* in the Software without restriction, including without limitation the rights
+* to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+* copies of the Software, and to permit persons to whom the Software is
+* furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in
+* all copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+* AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+* THE SOFTWARE.
+*
+*/
+
+// http://forth.teleonomix.com/
+
+// Compact code: colon definitions translated by ; into 16 bit units.
+//
+// The table is FORTH_COMPACT_CODE cells in the dictionary, made at HERE by the first definition that is translated
+// (FORTH_COMPACT_TABLE_LOCATION holds the index of its count, the entries follow). Every distinct cell of the bodies
+// (an xt, a token with its parameter) gets an entry the first time it is seen, a unit is the index of the entry.
+// Once the table is full, cells that are not in it are written as FORTH_COMPACT_ESCAPE and the whole cell.
+// The operands of lit, xtlit and tailcall are whole cells too, the bytes of strlit are copied as they are.
+// inlined and the xt after it only matter to SEE, they are dropped. Branch and loop offsets are rewritten to count
+// units, a definition with a branch that cannot get an entry stays cell threaded, so does one that would not get shorter.
+// The body is moved down to xt + 1 and HERE follows it.
+
+#include <string.h>
+#include "forth.h"
+#include "forth_internal.h"
+#include "forth_dict.h"
+
+#if defined(FORTH_COMPACT_CODE)
+
+#define FORTH_COMPACT_MAX_BODY	1024	// Cells, longer definitions stay cell threaded.
+#define FORTH_COMPACT_NO_UNIT	((forth_cell_t)-1)
+
+struct forth_compact
+{
+	forth_cell_t	length;					// Cells of the body, the unnest included.
+	forth_cell_t	units;					// Units written so far.
+	forth_cell_t	*unit;					// Where the cells of the body start in units (or NO_UNIT), length + 1 of them.
+	uint16_t	*code;					// Up to length * (1 + FORTH_COMPACT_CELL_UNITS) units.
+};
+
+// The work space of forth_compact() is past the end of the dictionary like the buffer of WORD, each context has its own.
+#define FORTH_COMPACT_WORK_SPACE(LENGTH)	((((LENGTH) + 1) * sizeof(forth_cell_t)) + ((LENGTH) * (1 + FORTH_COMPACT_CELL_UNITS) * sizeof(uint16_t)))
+
+// The index of cell in the table, it is added if there is room. FORTH_COMPACT_ESCAPE if the table is full.
+static forth_cell_t forth_compact_intern(forth_cell_t table[], forth_cell_t cell)
+{
+	forth_cell_t count = table[-1];
+	forth_cell_t ix;
+
+	for (ix = 0; ix < count; ix++)
+	{
+		if (cell == table[ix])
+		{
+			return ix;
+		}
+	}
+
+	if (FORTH_COMPACT_CODE <= count)
+	{
+		return FORTH_COMPACT_ESCAPE;
+	}
+
+	table[count] = cell;
+	table[-1] = count + 1;
+	return count;
+}
+
+static void forth_compact_cell(struct forth_compact *c, forth_cell_t cell)
+{
+	forth_cell_t i;
+
+	for (i = 0; i < FORTH_COMPACT_CELL_UNITS; i++)
+	{
+		c->code[c->units++] = (uint16_t)(cell >> (16 * i));
+	}
+}
+
+// A cell of the thread: its entry, or the escape and the cell.
+static void forth_compact_token(struct forth_compact *c, forth_cell_t table[], forth_cell_t cell)
+{
+	forth_cell_t ix = forth_compact_intern(table, cell);
+
+	c->code[c->units++] = (uint16_t)ix;
+
+	if (FORTH_COMPACT_ESCAPE == ix)
+	{
+		forth_compact_cell(c, cell);
+	}
+}
+
+static int forth_compact_is_branch(forth_cell_t cell)
+{
+	if (FORTH_IS_NOT_TOKEN(cell))
+	{
+		return 0;
+	}
+
+	switch (FORTH_EXTRACT_TOKEN(cell))
+	{
+		case FORTH_TOKEN_branch:
+		case FORTH_TOKEN_0branch:
+		case FORTH_TOKEN_Equal_0branch:
+		case FORTH_TOKEN_Notequal_0branch:
+		case FORTH_TOKEN_Less_0branch:
+		case FORTH_TOKEN_Greater_0branch:
+		case FORTH_TOKEN_ULess_0branch:
+		case FORTH_TOKEN_UGreater_0branch:
+		case FORTH_TOKEN_0Equal_0branch:
+		case FORTH_TOKEN_0Notequal_0branch:
+		case FORTH_TOKEN_0Less_0branch:
+		case FORTH_TOKEN_0Greater_0branch:
+		case FORTH_TOKEN_pDO:
+		case FORTH_TOKEN_pqDO:
+		case FORTH_TOKEN_pLOOP:
+		case FORTH_TOKEN_pPlusLOOP:
+			return 1;
+
+		default:
+			return 0;
+	}
+}
+
+// Lay the body from start down in units, branches get a place holder. Returns 0 if it cannot be done.
+static int forth_compact_layout(struct forth_compact *c, forth_cell_t dictionary[], forth_cell_t table[], forth_cell_t start)
+{
+	forth_cell_t ix;
+	forth_cell_t cell;
+	forth_cell_t bytes;
+
+	for (ix = 0; ix < c->length; ix++)
+	{
+		c->unit[ix] = FORTH_COMPACT_NO_UNIT;
+	}
+
+	for (ix = 0; ix < c->length; )
+	{
+		cell = dictionary[start + ix];
+		c->unit[ix] = c->units;
+
+		if (FORTH_PACK_TOKEN(FORTH_TOKEN_unnest) == cell)
+		{
+			if ((ix + 1) != c->length)	// The does part of DOES> follows, it is entered in the middle.
+			{
+				return 0;
+			}
+			forth_compact_token(c, table, cell);
+			ix++;
+			continue;
+		}
+
+		if (forth_compact_is_branch(cell))
+		{
+			c->code[c->units++] = FORTH_COMPACT_ESCAPE;	// forth_compact_branches() fills it in.
+			ix++;
+			continue;
+		}
+
+		switch (FORTH_IS_TOKEN(cell) ? FORTH_EXTRACT_TOKEN(cell) : FORTH_TOKEN_COUNT)
+		{
+			case FORTH_TOKEN_lit:
+			case FORTH_TOKEN_xtlit:
+			case FORTH_TOKEN_tailcall:
+				forth_compact_token(c, table, cell);
+				forth_compact_cell(c, dictionary[start + ix + 1]);
+				ix += 2;
+			break;
+
+			case FORTH_TOKEN_inlined:	// The body follows the xt.
+				ix += 2;
+			break;
+
+			case FORTH_TOKEN_strlit:
+				bytes = FORTH_PARAM_UNSIGNED(cell);
+				forth_compact_token(c, table, cell);
+				c->code[c->units + (bytes / 2)] = 0;	// Padding of an odd length.
+				memcpy(&c->code[c->units], &dictionary[start + ix + 1], bytes);
+				c->units += (bytes + 1) / 2;
+				ix += 1 + (FORTH_ALIGN(bytes) / sizeof(forth_cell_t));
+			break;
+
+			default:
+				forth_compact_token(c, table, cell);
+				ix++;
+			break;
+		}
+	}
+
+	return ix == c->length;
+}
+
+// Point the branches at the units of their targets. Returns 0 if one of them cannot be done.
+static int forth_compact_branches(struct forth_compact *c, forth_cell_t dictionary[], forth_cell_t table[], forth_cell_t start)
+{
+	forth_cell_t ix;
+	forth_cell_t cell;
+	forth_cell_t target;
+	forth_scell_t offset;
+	forth_cell_t entry;
+
+	for (ix = 0; ix < c->length; ix++)
+	{
+		cell = dictionary[start + ix];
+
+		if ((FORTH_COMPACT_NO_UNIT == c->unit[ix]) || !forth_compact_is_branch(cell))
+		{
+			continue;
+		}
+
+		target = ix + 1 + FORTH_PARAM_SIGNED(cell);
+
+		if ((c->length <= target) || (FORTH_COMPACT_NO_UNIT == c->unit[target]))
+		{
+			return 0;
+		}
+
+		offset = (forth_scell_t)c->unit[target] - (forth_scell_t)(c->unit[ix] + 1);
+
+		if (FORTH_PARAM_SIGNED(FORTH_PARAM_PACK(offset)) != offset)
+		{
+			return 0;
+		}
+
+		entry = forth_compact_intern(table, FORTH_PACK_TOKEN(FORTH_EXTRACT_TOKEN(cell)) | FORTH_PARAM_PACK(offset));
+
+		if (FORTH_COMPACT_ESCAPE == entry)
+		{
+			return 0;
+		}
+
+		c->code[c->unit[ix]] = (uint16_t)entry;
+	}
+
+	return 1;
+}
+
+void forth_compact(struct forth_runtime_context *rctx, forth_cell_t xt)
+{
+	struct forth_compact compact;
+	struct forth_compact *c = &compact;
+	forth_cell_t *dictionary = rctx->dictionary;
+	forth_cell_t dp = dictionary[FORTH_DP_LOCATION];
+	forth_cell_t start = xt + 1;
+	forth_cell_t *table;
+	forth_cell_t end;
+
+	if ((FORTH_PACK_TOKEN(FORTH_TOKEN_nest) != dictionary[xt]) || (dp <= (start * sizeof(forth_cell_t)))
+		|| (FORTH_PACK_TOKEN(FORTH_TOKEN_unnest) != dictionary[(dp / sizeof(forth_cell_t)) - 1]))
+	{
+		return;
+	}
+
+	c->length = (dp / sizeof(forth_cell_t)) - start;
+	c->units = 0;
+
+	if (FORTH_COMPACT_MAX_BODY < c->length)
+	{
+		return;
+	}
+
+	end = dp;
+
+	if (0 == dictionary[FORTH_COMPACT_TABLE_LOCATION])	// The first one makes the table right after its body.
+	{
+		end = dp + (1 + FORTH_COMPACT_CODE) * sizeof(forth_cell_t);
+
+		if (!FORTH_DICTIONARY_ROOM(dictionary, end))
+		{
+			return;
+		}
+
+		dictionary[dp / sizeof(forth_cell_t)] = 0;
+		dictionary[FORTH_COMPACT_TABLE_LOCATION] = dp / sizeof(forth_cell_t);
+		dictionary[FORTH_DP_LOCATION] = end;
+	}
+
+	table = FORTH_COMPACT_TABLE(dictionary);
+
+	if (!FORTH_DICTIONARY_ROOM(dictionary, end + FORTH_COMPACT_WORK_SPACE(c->length)))
+	{
+		return;
+	}
+
+	c->unit = &dictionary[end / sizeof(forth_cell_t)];
+	c->code = (uint16_t *)&c->unit[c->length + 1];
+
+	if (!forth_compact_layout(c, dictionary, table, start) || !forth_compact_branches(c, dictionary, table, start)
+		|| ((c->units * sizeof(uint16_t)) >= (c->length * sizeof(forth_cell_t))))
+	{
+		return;
+	}
+
+	memset(&dictionary[start], 0, FORTH_ALIGN(c->units * sizeof(uint16_t)));
+	memcpy(&dictionary[start], c->code, c->units * sizeof(uint16_t));
+	dictionary[xt] = FORTH_PACK_TOKEN(FORTH_TOKEN_compact);
+
+	if (end == dp)	// Otherwise the table is in the way.
+	{
+		dp = FORTH_ALIGN(start * sizeof(forth_cell_t) + c->units * sizeof(uint16_t));
+		dictionary[FORTH_DP_LOCATION] = dp;
+	}
+
+	rctx->peephole = 0;
+#if defined(FORTH_CONSTANT_FOLDING)
+	rctx->literal_cnt = 0;
+#endif
+}
+
+#endif
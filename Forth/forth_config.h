@@ -27,8 +27,11 @@
 
 #include <stdint.h>
 
-#define FORTH_32BIT 1
-#undef  FORTH_64BIT
+// Cells are 32 bits wide unless FORTH_64BIT is defined on the compiler's command line (make CFLAGS=-DFORTH_64BIT),
+// it has to be the same for gen_dict and the rest of the system.
+#if !defined(FORTH_64BIT)
+#	define FORTH_32BIT 1
+#endif
 
 typedef uint8_t	forth_byte_t;
 
@@ -71,12 +74,50 @@ typedef uint8_t	forth_byte_t;
 #	define FORTH_DO_SYS_ID		0x4C000000
 #	define FORTH_SYS_ID_MASK	0x00FFFFFF
 
+#elif defined(FORTH_64BIT)
+
+#	if !defined(__SIZEOF_INT128__)
+#		error 64bit cells need a compiler with 128bit integers (__int128) for the double cells.
+#	endif
+
+	typedef uint64_t forth_cell_t;
+	typedef int64_t  forth_scell_t;
+	typedef unsigned __int128 forth_dcell_t;
+	typedef __int128 forth_sdcell_t;
+	typedef forth_cell_t forth_xt_t;
+#	define FORTH_CELL_HEX_DIGITS 16
+#	define FORTH_NUM_BUFF_LENGTH (256 + 4)
+
+#	define	FORTH_CELL_LOW(X) ((forth_cell_t)(0xFFFFFFFFFFFFFFFFULL & (X)))
+#	define	FORTH_CELL_HIGH(X) ((forth_cell_t)(0xFFFFFFFFFFFFFFFFULL & ((X)>> 64)))
+#	define  FORTH_DCELL(H, L)  ((((forth_dcell_t)(H)) << 64) + (L))
+	typedef forth_cell_t forth_index_t;
+
+#	define FORTH_ALIGN(X) ((((forth_cell_t)(X)) + (sizeof(forth_cell_t) - 1)) & ~(sizeof(forth_cell_t) - 1))
+
+// Same layout as with 32 bits, but the token number is above a 32 bit parameter.
+#	define FORTH_MASK_TOKEN_INDICATOR 0x8000000000000000ULL
+#	define FORTH_IS_NOT_TOKEN(X)	(0 == ((X) & (FORTH_MASK_TOKEN_INDICATOR )))
+#	define FORTH_IS_TOKEN(X)	(((X) & (FORTH_MASK_TOKEN_INDICATOR )))
+#	define FORTH_MASK_TOKEN_MASK   	0x00007FFF
+
+#	define FORTH_BITSHIFT_for_TOKEN	32
+#	define FORTH_EXTRACT_TOKEN(X)	(((X) >> FORTH_BITSHIFT_for_TOKEN) & (FORTH_MASK_TOKEN_MASK))
+#	define FORTH_PACK_TOKEN(X)	((((forth_cell_t)(X)) << FORTH_BITSHIFT_for_TOKEN) | FORTH_MASK_TOKEN_INDICATOR)
+
+#	define FORTH_PARAM_MAX		0xFFFFFFFFULL
+#	define FORTH_PARAM_PACK(X)	((forth_cell_t)((X) & 0xFFFFFFFF))
+#	define FORTH_PARAM_EXTRACT(X)	((X) & 0xFFFFFFFF)
+#	define FORTH_PARAM_SIGNED(X)	((int32_t)(FORTH_PARAM_EXTRACT(X)))
+#	define FORTH_PARAM_UNSIGNED(X)	((uint32_t)(FORTH_PARAM_EXTRACT(X)))
+#	define FORTH_INDEX_EXTRACT(X)	((X) & 0x7FFFFFFFFFFFFFFFULL)
+#	define FORTH_ORIG_SYS_ID	0x4F00000000000000ULL
+#	define FORTH_DEST_SYS_ID	0x4400000000000000ULL
+#	define FORTH_DO_SYS_ID		0x4C00000000000000ULL
+#	define FORTH_SYS_ID_MASK	0x00FFFFFFFFFFFFFFULL
+
 #else
-#		if defined(FORTH_64BIT)
-#		error 64bit systems are not supported yet.
-#		else
-#		error Either 32 or 64 bit must be selected.
-#		endif
+#	error Either 32 or 64 bit must be selected.
 #endif
 
 // For implementing well-formed flags in Forth
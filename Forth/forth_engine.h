@@ -0,0 +1,3282 @@
+/*
+* Copyright (c) 2014-2015 Andras Zsoter
+*
+* Permission is hereby granted, free of charge, to any person obtaining a copy
+* of this software and associated documentation files (the "Software"), to deal
+* in the Software without restriction, including without limitation the rights
+* to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+* copies of the Software, and to permit persons to whom the Software is
+* furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in
+* all copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+* AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+* THE SOFTWARE.
+*
+*/
+
+// http://forth.teleonomix.com/
+
+// The inner interpreter. This file is included twice by forth.c: once as forth_engine() without
+// the trace hook, and once with FORTH_ENGINE_TRACING defined as forth_engine_tracing().
+// forth() runs whichever matches rctx->trace and moves between them when SWITCH_ENGINE() returns.
+// With FORTH_COMPACT_CODE both are included again with FORTH_ENGINE_COMPACT defined, as forth_engine_compact() and
+// forth_engine_compact_tracing(), which run threaded code of 16 bit units (forth_compact.c). Calls and returns move
+// between the two kinds with SWITCH_CODE(), return addresses into compact code are tagged with FORTH_COMPACT_IP_TAG.
+
+#if defined(FORTH_ENGINE_COMPACT) && defined(FORTH_ENGINE_TRACING)
+static int forth_engine_compact_tracing(struct forth_runtime_context *rctx, forth_cell_t *resume_w, forth_cell_t *resume_xt)
+#elif defined(FORTH_ENGINE_COMPACT)
+static int forth_engine_compact(struct forth_runtime_context *rctx, forth_cell_t *resume_w, forth_cell_t *resume_xt)
+#elif defined(FORTH_ENGINE_TRACING)
+static int forth_engine_tracing(struct forth_runtime_context *rctx, forth_cell_t *resume_w, forth_cell_t *resume_xt)
+#else
+static int forth_engine(struct forth_runtime_context *rctx, forth_cell_t *resume_w, forth_cell_t *resume_xt)
+#endif
+{
+#if defined(FORTH_ENGINE_COMPACT)
+	register forth_index_t ip = FORTH_COMPACT_UNTAG(rctx->ip);
+#else
+	register forth_index_t ip = rctx->ip;
+#endif
+	register forth_cell_t  *sp = rctx->sp;
+	register forth_cell_t  *rp = rctx->rp;
+	register forth_cell_t  *dictionary = rctx->dictionary;
+#if defined(FORTH_ARENA)
+	register char *arena = rctx->arena;
+#endif
+	register forth_cell_t  w = *resume_w;
+	register forth_cell_t  xt = *resume_xt;
+	forth_cell_t token_primitive;
+	register forth_cell_t  tos;
+	forth_dcell_t dtos;
+	forth_scell_t i;
+	// forth_cell_t exception_handler = 0;
+	char c;
+	char *src;
+	char *dest;
+#if defined(FORTH_EXTERNAL_PRIMITIVES)
+	forth_external_primitive ep;
+#endif
+#if defined(FORTH_COMPACT_CODE)
+	const forth_cell_t *compact_table = FORTH_COMPACT_TABLE(dictionary);	// The cell engine reloads it in SWITCH_CODE().
+#endif
+#if defined(FORTH_TOS_CACHING)
+	register forth_cell_t  nos;
+#endif
+
+#if defined(FORTH_TOS_CACHING)
+// The top of the data stack is kept in tos, sp points to the second item.
+// Primitives that are not written with that in mind see the usual in memory stack:
+// the engine spills tos before running them and reloads it afterwards.
+#	define SPILL()			*(--sp) = tos
+#	define RELOAD()			tos = *(sp++)
+#	define STACK_TOP		tos
+#	define STACK_TOP_ADDRESS	(sp - 1)
+#else
+#	define SPILL()
+#	define RELOAD()
+#	define STACK_TOP		(*sp)
+#	define STACK_TOP_ADDRESS	sp
+#endif
+
+#if defined(FORTH_ENGINE_TRACING)
+#	define TRACING()		(rctx->trace)
+#else
+#	define TRACING()		0
+#endif
+
+// Fetch the next cell of the thread into xt, w is where it came from.
+#define FETCH_CELL()	do { w = ip++; xt = dictionary[w]; } while (0)
+
+#if defined(FORTH_COMPACT_CODE)
+// A unit of compact code indexes the table, FORTH_COMPACT_ESCAPE is followed by the whole cell.
+#	define FETCH_COMPACT() \
+	do { \
+		w = ip; \
+		xt = FORTH_COMPACT_UNITS(dictionary)[ip++]; \
+		if (FORTH_COMPACT_ESCAPE == xt) \
+		{ \
+			xt = FORTH_COMPACT_CELL(&FORTH_COMPACT_UNITS(dictionary)[ip]); \
+			ip += FORTH_COMPACT_CELL_UNITS; \
+		} \
+		else \
+		{ \
+			xt = compact_table[xt]; \
+		} \
+	} while (0)
+#endif
+
+// Reading the thread: the next cell, the operands that follow a token (the cell of lit, the bytes of strlit),
+// the return address nest pushes and the ip kept in rctx->ip.
+#if defined(FORTH_ENGINE_COMPACT)
+#	define FETCH()			FETCH_COMPACT()
+#	define INLINE_CELL()		(ip += FORTH_COMPACT_CELL_UNITS, FORTH_COMPACT_CELL(&FORTH_COMPACT_UNITS(dictionary)[ip - FORTH_COMPACT_CELL_UNITS]))
+#	define INLINE_ADDRESS()		ADDRESS(&FORTH_COMPACT_UNITS(dictionary)[ip])
+#	define INLINE_SKIP(BYTES)	(ip += ((BYTES) + 1) / 2)
+#	define RETURN_ADDRESS		FORTH_COMPACT_TAG(ip)
+#else
+#	define FETCH()			FETCH_CELL()
+#	define INLINE_CELL()		dictionary[ip++]
+#	define INLINE_ADDRESS()		ADDRESS(&dictionary[ip])
+#	define INLINE_SKIP(BYTES)	(ip += ((BYTES) + (sizeof(forth_cell_t) - 1)) / sizeof(forth_cell_t))
+#	define RETURN_ADDRESS		ip
+#endif
+
+// Leave for the other variant of the engine, with the stack in memory.
+// forth() calls that with the next cell of the thread already fetched, as if nothing had happened.
+#define SWITCH_ENGINE() \
+	do { \
+		FETCH(); \
+		rctx->sp = sp; \
+		rctx->rp = rp; \
+		rctx->ip = RETURN_ADDRESS; \
+		*resume_w = w; \
+		*resume_xt = xt; \
+		return FORTH_ENGINE_SWITCH; \
+	} while (0)
+
+#if defined(FORTH_COMPACT_CODE)
+// Leave for the variant that runs the other kind of code, the next cell is fetched the way that one reads it.
+// ip is the untagged address in the other kind of code.
+#	if defined(FORTH_ENGINE_COMPACT)
+#		define SWITCH_CODE() \
+	do { \
+		FETCH_CELL(); \
+		rctx->ip = ip; \
+		rctx->sp = sp; \
+		rctx->rp = rp; \
+		*resume_w = w; \
+		*resume_xt = xt; \
+		return FORTH_ENGINE_SWITCH_CODE; \
+	} while (0)
+#	else
+#		define SWITCH_CODE() \
+	do { \
+		compact_table = FORTH_COMPACT_TABLE(dictionary); \
+		FETCH_COMPACT(); \
+		rctx->ip = FORTH_COMPACT_TAG(ip); \
+		rctx->sp = sp; \
+		rctx->rp = rp; \
+		*resume_w = w; \
+		*resume_xt = xt; \
+		return FORTH_ENGINE_SWITCH_CODE; \
+	} while (0)
+#	endif
+#	define TOS_SWITCH_CODE()	SPILL(); SWITCH_CODE()
+#endif
+
+// ip is now in cell code (RUN_CELLS) or in compact code (RUN_COMPACT), or it was just popped by a return (RETURNED):
+// LEAVE if that is the other kind.
+#if defined(FORTH_ENGINE_COMPACT)
+#	define RUN_CELLS(LEAVE)		LEAVE
+#	define RUN_COMPACT(LEAVE)
+#	define RETURNED(LEAVE)		if (FORTH_COMPACT_TAGGED(ip)) { ip = FORTH_COMPACT_UNTAG(ip); } else { LEAVE; }
+#elif defined(FORTH_COMPACT_CODE)
+#	define RUN_CELLS(LEAVE)
+#	define RUN_COMPACT(LEAVE)		LEAVE
+#	define RETURNED(LEAVE)		if (FORTH_COMPACT_TAGGED(ip)) { ip = FORTH_COMPACT_UNTAG(ip); LEAVE; }
+#else
+#	define RUN_CELLS(LEAVE)
+#	define RETURNED(LEAVE)
+#endif
+
+#if defined(FORTH_COMPUTED_GOTO_ENGINE)
+// Each primitive is a label and ends with its own copy of the dispatch code below,
+// so the CPU gets a separate indirect jump (and branch history) for every primitive.
+// Anything out of the ordinary (tracing on, a cell that does not
+// lead to a valid token) goes back to the top of the loop, which handles it exactly as the switch engine does.
+#	define PRIMITIVE(X)		primitive_##X
+#	define DEFAULT_PRIMITIVE	primitive_unknown
+#	define PRIMITIVE_ADDRESS(X)	[X] = &&primitive_##X
+
+// Token number relative to the token indicator bit, non-tokens become huge unsigned numbers.
+#	define TOKEN_INDEX(X)	(((X) >> FORTH_BITSHIFT_for_TOKEN) - (FORTH_MASK_TOKEN_INDICATOR >> FORTH_BITSHIFT_for_TOKEN))
+
+#	if defined(FORTH_TOS_CACHING)
+#		define TOS_PRIMITIVE(X)		tos_primitive_##X
+#		define TOS_PRIMITIVE_ADDRESS(X)	[X] = &&tos_primitive_##X
+#		define DISPATCH_TABLE		tos_primitive_table
+#	else
+#		define DISPATCH_TABLE		primitive_table
+#	endif
+
+// TOS_DISPATCH() and TOS_NEXT expect the stack in its cached form, DISPATCH() and NEXT in memory.
+// Without FORTH_TOS_CACHING there is no difference.
+#	define TOS_DISPATCH() \
+	do { \
+		if (!TRACING()) \
+		{ \
+			if (FORTH_IS_NOT_TOKEN(xt)) \
+			{ \
+				w = FORTH_INDEX_EXTRACT(xt); \
+				xt = dictionary[w]; \
+			} \
+			token_primitive = TOKEN_INDEX(xt); \
+			if (token_primitive < FORTH_TOKEN_COUNT) \
+			{ \
+				goto *DISPATCH_TABLE[token_primitive]; \
+			} \
+		} \
+		goto dispatch; \
+	} while (0)
+
+#	define TOS_NEXT		do { FETCH(); TOS_DISPATCH(); } while (0)
+#	define DISPATCH()	do { RELOAD(); TOS_DISPATCH(); } while (0)
+#	define NEXT		do { RELOAD(); TOS_NEXT; } while (0)
+#else
+#	define PRIMITIVE(X)		case X
+#	define DEFAULT_PRIMITIVE	default
+#	define TOS_PRIMITIVE(X)		case X
+#	define TOS_DISPATCH()		continue
+#	define TOS_NEXT			FETCH(); continue
+#	define DISPATCH()		RELOAD(); continue
+#	define NEXT			break
+#endif
+
+#if defined(FORTH_STACK_CHECK_ENABLED)
+// The stacks are not checked before every primitive, only where they can grow or shrink without limit:
+// calls, returns, branches, loop entries and ends, EXECUTE and the primitives that move a stack pointer by a computed amount.
+// Straight line code in between can go past sp_min/sp_max or rp_min/rp_max by as many cells as it pushes or pops
+// before that is noticed, so hosts should keep some slack beyond those limits (the longer such stretches of
+// code in a definition, the more).
+// TOS_CHECK_STACKS() expects the stack in its cached form, CHECK_STACKS() in memory.
+#	define STACKS_IN_BOUNDS(TOP)	(((TOP) >= rctx->sp_min) && ((TOP) <= rctx->sp_max) && (rp >= rctx->rp_min) && (rp <= rctx->rp_max))
+#	define TOS_CHECK_STACKS()	if (!STACKS_IN_BOUNDS(STACK_TOP_ADDRESS)) { goto stack_error; }
+#	define CHECK_STACKS()		if (!STACKS_IN_BOUNDS(sp)) { RELOAD(); goto stack_error; }
+#else
+#	define TOS_CHECK_STACKS()
+#	define CHECK_STACKS()
+#endif
+
+#define POP() *(sp++)
+#define PUSH(X) *(--sp) = ((forth_cell_t)(X))
+#define THROW(X) PUSH(X); xt = FORTH_PACK_TOKEN(FORTH_TOKEN_THROW); DISPATCH()
+
+#define RPOP()	*(rp++)
+#define RPUSH(X) *(--rp) = ((forth_cell_t)(X))
+
+// Forth addresses and C pointers.
+#define POINTER(A)	FORTH_POINTER(arena, (A))
+#define ADDRESS(P)	FORTH_ADDRESS(arena, (P))
+#define CELL_AT(A)	(*(forth_cell_t *)POINTER(A))
+#define CHAR_AT(A)	(*POINTER(A))
+
+// For DO-LOOPs
+#define LOOP_I rp[0]
+#define LOOP_J rp[3]
+#define LOOP_LIMIT   rp[1]
+#define LOOP_ADDRESS_AFTER rp[2]
+#define LOOP_ADJUSTMENT 3
+
+#define SIGNED_PARAMETER   FORTH_PARAM_SIGNED(xt)
+#define UNSIGNED_PARAMETER FORTH_PARAM_UNSIGNED(xt)
+
+#if defined(FORTH_COMPUTED_GOTO_ENGINE)
+	// Tokens without a primitive end up at the same place as the default case of the switch.
+	static const void *const primitive_table[FORTH_TOKEN_COUNT] =
+	{
+		[0 ... (FORTH_TOKEN_COUNT - 1)] = &&DEFAULT_PRIMITIVE,
+		PRIMITIVE_ADDRESS(FORTH_TOKEN_NOP),
+		PRIMITIVE_ADDRESS(FORTH_TOKEN_ACCEPT),
+		PRIMITIVE_ADDRESS(FORTH_TOKEN_KEY),
+		PRIMITIVE_ADDRESS(FORTH_TOKEN_EKEY),
+		PRIMITIVE_ADDRESS(FORTH_TOKEN_KEYq),
+		PRIMITIVE_ADDRESS(FORTH_TOKEN_EKEYq),
+		PRIMITIVE_ADDRESS(FORTH_TOKEN_EKEY2CHAR),
+		PRIMITIVE_ADDRESS(FORTH_TOKEN_ALIGN),
+		PRIMITIVE_ADDRESS(FORTH_TOKEN_ALIGNED),
+		PRIMITIVE_ADDRESS(FORTH_TOKEN_ALLOT),
+		PRIMITIVE_ADDRESS(FORTH_TOKEN_PAD),
+		PRIMITIVE_ADDRESS(FORTH_TOKEN_HERE),
+		PRIMITIVE_ADDRESS(FORTH_TOKEN_pHERE),
+		PRIMITIVE_ADDRESS(FORTH_TOKEN_pTRACE),
+		PRIMITIVE_ADDRESS(FORTH_TOKEN_CompileComma),
+		PRIMITIVE_ADDRESS(FORTH_TOKEN_Comma),
+		PRIMITIVE_ADDRESS(FORTH_TOKEN_CComma),
+		PRIMITIVE_ADDRESS(FORTH_TOKEN_Imm_Plus),
+		PRIMITIVE_ADDRESS(FORTH_TOKEN_Imm_AND),
+		PRIMITIVE_ADDRESS(FORTH_TOKEN_Imm_OR),
+		PRIMITIVE_ADDRESS(FORTH_TOKEN_Imm_XOR),
+		PRIMITIVE_ADDRESS(FORTH_TOKEN_Imm_LSHIFT),
+		PRIMITIVE_ADDRESS(FORTH_TOKEN_Imm_RSHIFT),
+		PRIMITIVE_ADDRESS(FORTH_TOKEN_Imm_Equal),
+		PRIMITIVE_ADDRESS(FORTH_TOKEN_Imm_Less),
+		PRIMITIVE_ADDRESS(FORTH_TOKEN_Imm_Fetch),
+		PRIMITIVE_ADDRESS(FORTH_TOKEN_Subtract),
+		PRIMITIVE_ADDRESS(FORTH_TOKEN_Divide),
+		PRIMITIVE_ADDRESS(FORTH_TOKEN_MOD),
+		PRIMITIVE_ADDRESS(FORTH_TOKEN_Slash_MOD),
+#if !defined(FORTH_NO_DOUBLES)
+		PRIMITIVE_ADDRESS(FORTH_TOKEN_StarSlash),
+		PRIMITIVE_ADDRESS(FORTH_TOKEN_StarSlash_MOD),
+		PRIMITIVE_ADDRESS(FORTH_TOKEN_UM_Star),
+		PRIMITIVE_ADDRESS(FORTH_TOKEN_M_Star),
+		PRIMITIVE_ADDRESS(FORTH_TOKEN_M_Plus),
+		PRIMITIVE_ADDRESS(FORTH_TOKEN_UM_Slash_MOD),
+#endif
+		PRIMITIVE_ADDRESS(FORTH_TOKEN_Multiply),
+		PRIMITIVE_ADDRESS(FORTH_TOKEN_NEGATE),
+		PRIMITIVE_ADDRESS(FORTH_TOKEN_INVERT),
+		PRIMITIVE_ADDRESS(FORTH_TOKEN_ABS),
+		PRIMITIVE_ADDRESS(FORTH_TOKEN_MIN),
+		PRIMITIVE_ADDRESS(FORTH_TOKEN_MAX),
+		PRIMITIVE_ADDRESS(FORTH_TOKEN_LSHIFT),
+		PRIMITIVE_ADDRESS(FORTH_TOKEN_RSHIFT),
+		PRIMITIVE_ADDRESS(FORTH_TOKEN_2_Star),
+		PRIMITIVE_ADDRESS(FORTH_TOKEN_2_Slash),
+#if !defined(FORTH_NO_DOUBLES)
+		PRIMITIVE_ADDRESS(FORTH_TOKEN_D2_Star),
+		PRIMITIVE_ADDRESS(FORTH_TOKEN_D2_Slash),
+		PRIMITIVE_ADDRESS(FORTH_TOKEN_DNEGATE),
+		PRIMITIVE_ADDRESS(FORTH_TOKEN_DABS),
+		PRIMITIVE_ADDRESS(FORTH_TOKEN_DMIN),
+		PRIMITIVE_ADDRESS(FORTH_TOKEN_DMAX),
+		PRIMITIVE_ADDRESS(FORTH_TOKEN_D_Plus),
+		PRIMITIVE_ADDRESS(FORTH_TOKEN_D_Subtract),
+		PRIMITIVE_ADDRESS(FORTH_TOKEN_D_Less),
+		PRIMITIVE_ADDRESS(FORTH_TOKEN_D_ULess),
+#endif
+		PRIMITIVE_ADDRESS(FORTH_TOKEN_D_Equal),
+		PRIMITIVE_ADDRESS(FORTH_TOKEN_AND),
+		PRIMITIVE_ADDRESS(FORTH_TOKEN_OR),
+		PRIMITIVE_ADDRESS(FORTH_TOKEN_XOR),
+		PRIMITIVE_ADDRESS(FORTH_TOKEN_CELLS),
+		PRIMITIVE_ADDRESS(FORTH_TOKEN_DROP),
+		PRIMITIVE_ADDRESS(FORTH_TOKEN_2ROT),
+		PRIMITIVE_ADDRESS(FORTH_TOKEN_2DUP),
+		PRIMITIVE_ADDRESS(FORTH_TOKEN_2DROP),
+		PRIMITIVE_ADDRESS(FORTH_TOKEN_2OVER),
+		PRIMITIVE_ADDRESS(FORTH_TOKEN_2SWAP),
+		PRIMITIVE_ADDRESS(FORTH_TOKEN_2Store),
+		PRIMITIVE_ADDRESS(FORTH_TOKEN_2Fetch),
+		PRIMITIVE_ADDRESS(FORTH_TOKEN_NtoR),
+		PRIMITIVE_ADDRESS(FORTH_TOKEN_NRfrom),
+		PRIMITIVE_ADDRESS(FORTH_TOKEN_DUP),
+		PRIMITIVE_ADDRESS(FORTH_TOKEN_qDUP),
+		PRIMITIVE_ADDRESS(FORTH_TOKEN_PAGE),
+#if defined(FORTH_INCLUDE_MS)
+		PRIMITIVE_ADDRESS(FORTH_TOKEN_MS),
+#endif
+#if defined(FORTH_INCLUDE_TIME_DATE)
+		PRIMITIVE_ADDRESS(FORTH_TOKEN_TIME_DATE),
+#endif
+#if defined(FORTH_AOT)
+		PRIMITIVE_ADDRESS(FORTH_TOKEN_TRANSLATE_C),
+#endif
+#if defined(FORTH_IMAGE)
+		PRIMITIVE_ADDRESS(FORTH_TOKEN_SAVE_IMAGE),
+#endif
+#if defined(FORTH_STACK_EFFECT)
+		PRIMITIVE_ADDRESS(FORTH_TOKEN_STACK_EFFECT),
+#endif
+#if defined(FORTH_WORDLIST_INDEX)
+		PRIMITIVE_ADDRESS(FORTH_TOKEN_WORDLIST_INDEX),
+#endif
+#if defined(FORTH_NAME_SPACE)
+		PRIMITIVE_ADDRESS(FORTH_TOKEN_NAME_COMMA),
+#endif
+#if defined(FORTH_NATIVE_INTERPRET)
+		PRIMITIVE_ADDRESS(FORTH_TOKEN_INTERPRET),
+#endif
+		PRIMITIVE_ADDRESS(FORTH_TOKEN_AT_XY),
+		PRIMITIVE_ADDRESS(FORTH_TOKEN_CR),
+		PRIMITIVE_ADDRESS(FORTH_TOKEN_EMIT),
+		PRIMITIVE_ADDRESS(FORTH_TOKEN_UNUSED),
+		PRIMITIVE_ADDRESS(FORTH_TOKEN_DUMP),
+		PRIMITIVE_ADDRESS(FORTH_TOKEN_handler),
+		PRIMITIVE_ADDRESS(FORTH_TOKEN_LessHash),
+#if !defined(FORTH_NO_DOUBLES)
+		PRIMITIVE_ADDRESS(FORTH_TOKEN_Hash),
+#endif
+		PRIMITIVE_ADDRESS(FORTH_TOKEN_HashGreater),
+		PRIMITIVE_ADDRESS(FORTH_TOKEN_HOLD),
+		PRIMITIVE_ADDRESS(FORTH_TOKEN_Hdot),
+		PRIMITIVE_ADDRESS(FORTH_TOKEN_Udot),
+		PRIMITIVE_ADDRESS(FORTH_TOKEN_Dot),
+		PRIMITIVE_ADDRESS(FORTH_TOKEN_DotR),
+		PRIMITIVE_ADDRESS(FORTH_TOKEN_UdotR),
+		PRIMITIVE_ADDRESS(FORTH_TOKEN_DotS),
+		PRIMITIVE_ADDRESS(FORTH_TOKEN_DotName),
+		PRIMITIVE_ADDRESS(FORTH_TOKEN_CMOVE),
+		PRIMITIVE_ADDRESS(FORTH_TOKEN_CMOVE_down),
+		PRIMITIVE_ADDRESS(FORTH_TOKEN_FILL),
+		PRIMITIVE_ADDRESS(FORTH_TOKEN_MOVE),
+		PRIMITIVE_ADDRESS(FORTH_TOKEN_LATEST),
+		PRIMITIVE_ADDRESS(FORTH_TOKEN_pDefining),
+		PRIMITIVE_ADDRESS(FORTH_TOKEN_TUCK),
+		PRIMITIVE_ADDRESS(FORTH_TOKEN_PICK),
+		PRIMITIVE_ADDRESS(FORTH_TOKEN_ROLL),
+		PRIMITIVE_ADDRESS(FORTH_TOKEN_ROT),
+		PRIMITIVE_ADDRESS(FORTH_TOKEN_NIP),
+		PRIMITIVE_ADDRESS(FORTH_TOKEN_OVER),
+		PRIMITIVE_ADDRESS(FORTH_TOKEN_TYPE),
+		PRIMITIVE_ADDRESS(FORTH_TOKEN_EXECUTE),
+		PRIMITIVE_ADDRESS(FORTH_TOKEN_SEARCH_WORDLIST),
+		PRIMITIVE_ADDRESS(FORTH_TOKEN_COMPARE),
+		PRIMITIVE_ADDRESS(FORTH_TOKEN_FIND_WORD),
+		PRIMITIVE_ADDRESS(FORTH_TOKEN_CFetch),
+		PRIMITIVE_ADDRESS(FORTH_TOKEN_CStore),
+		PRIMITIVE_ADDRESS(FORTH_TOKEN_PlusStore),
+		PRIMITIVE_ADDRESS(FORTH_TOKEN_Fetch),
+		PRIMITIVE_ADDRESS(FORTH_TOKEN_Store),
+		PRIMITIVE_ADDRESS(FORTH_TOKEN_PARSE),
+		PRIMITIVE_ADDRESS(FORTH_TOKEN_PARSE_WORD),
+		PRIMITIVE_ADDRESS(FORTH_TOKEN_WORD),
+		PRIMITIVE_ADDRESS(FORTH_TOKEN_Plus),
+		PRIMITIVE_ADDRESS(FORTH_TOKEN_toR),
+		PRIMITIVE_ADDRESS(FORTH_TOKEN_Rfrom),
+		PRIMITIVE_ADDRESS(FORTH_TOKEN_Rfetch),
+		PRIMITIVE_ADDRESS(FORTH_TOKEN_2toR),
+		PRIMITIVE_ADDRESS(FORTH_TOKEN_2Rfrom),
+		PRIMITIVE_ADDRESS(FORTH_TOKEN_2Rfetch),
+		PRIMITIVE_ADDRESS(FORTH_TOKEN_PROCESS_NUMBER),
+#if !defined(FORTH_NO_DOUBLES)
+		PRIMITIVE_ADDRESS(FORTH_TOKEN_toNUMBER),
+#endif
+		PRIMITIVE_ADDRESS(FORTH_TOKEN_BLK),
+		PRIMITIVE_ADDRESS(FORTH_TOKEN_TIB),
+		PRIMITIVE_ADDRESS(FORTH_TOKEN_HashTIB),
+		PRIMITIVE_ADDRESS(FORTH_TOKEN_BASE),
+		PRIMITIVE_ADDRESS(FORTH_TOKEN_pSOURCE_ID),
+		PRIMITIVE_ADDRESS(FORTH_TOKEN_SOURCE),
+		PRIMITIVE_ADDRESS(FORTH_TOKEN_SOURCE_Store),
+#if defined(FORTH_INCLUDE_FILE_ACCESS_WORDS)
+		PRIMITIVE_ADDRESS(FORTH_TOKEN_LINE_NUMBER),
+#endif
+		PRIMITIVE_ADDRESS(FORTH_TOKEN_toIN),
+		PRIMITIVE_ADDRESS(FORTH_TOKEN_SAVE_INPUT),
+		PRIMITIVE_ADDRESS(FORTH_TOKEN_RESTORE_INPUT),
+		PRIMITIVE_ADDRESS(FORTH_TOKEN_STATE),
+		PRIMITIVE_ADDRESS(FORTH_TOKEN_QUERY),
+		PRIMITIVE_ADDRESS(FORTH_TOKEN_REFILL),
+		PRIMITIVE_ADDRESS(FORTH_TOKEN_SWAP),
+		PRIMITIVE_ADDRESS(FORTH_TOKEN_THROW),
+		PRIMITIVE_ADDRESS(FORTH_TOKEN_DotError),
+		PRIMITIVE_ADDRESS(FORTH_TOKEN_BYE),
+		PRIMITIVE_ADDRESS(FORTH_TOKEN_WORDS),
+		PRIMITIVE_ADDRESS(FORTH_TOKEN_ENVIRONMENTq),
+		PRIMITIVE_ADDRESS(FORTH_TOKEN_pSEE),
+		PRIMITIVE_ADDRESS(FORTH_TOKEN_ONLY),
+		PRIMITIVE_ADDRESS(FORTH_TOKEN_ALSO),
+		PRIMITIVE_ADDRESS(FORTH_TOKEN_GET_ORDER),
+		PRIMITIVE_ADDRESS(FORTH_TOKEN_SET_ORDER),
+		PRIMITIVE_ADDRESS(FORTH_TOKEN_CURRENT),
+		PRIMITIVE_ADDRESS(FORTH_TOKEN_CONTEXT),
+		PRIMITIVE_ADDRESS(FORTH_TOKEN_Less),
+		PRIMITIVE_ADDRESS(FORTH_TOKEN_Greater),
+		PRIMITIVE_ADDRESS(FORTH_TOKEN_ULess),
+		PRIMITIVE_ADDRESS(FORTH_TOKEN_UGreater),
+		PRIMITIVE_ADDRESS(FORTH_TOKEN_Equal),
+		PRIMITIVE_ADDRESS(FORTH_TOKEN_Notequal),
+		PRIMITIVE_ADDRESS(FORTH_TOKEN_0Equal),
+		PRIMITIVE_ADDRESS(FORTH_TOKEN_0Notequal),
+		PRIMITIVE_ADDRESS(FORTH_TOKEN_0Less),
+		PRIMITIVE_ADDRESS(FORTH_TOKEN_0Greater),
+		PRIMITIVE_ADDRESS(FORTH_TOKEN_LITERAL),
+		PRIMITIVE_ADDRESS(FORTH_TOKEN_sp0),
+		PRIMITIVE_ADDRESS(FORTH_TOKEN_sp_fetch),
+		PRIMITIVE_ADDRESS(FORTH_TOKEN_sp_store),
+		PRIMITIVE_ADDRESS(FORTH_TOKEN_rp0),
+		PRIMITIVE_ADDRESS(FORTH_TOKEN_rp_fetch),
+		PRIMITIVE_ADDRESS(FORTH_TOKEN_rp_store),
+		PRIMITIVE_ADDRESS(FORTH_TOKEN_abort_msg),
+		PRIMITIVE_ADDRESS(FORTH_TOKEN_resolve_branch),
+		PRIMITIVE_ADDRESS(FORTH_TOKEN_ix2address),
+		PRIMITIVE_ADDRESS(FORTH_TOKEN_toBODY),
+		PRIMITIVE_ADDRESS(FORTH_TOKEN_pDO),
+		PRIMITIVE_ADDRESS(FORTH_TOKEN_pqDO),
+		PRIMITIVE_ADDRESS(FORTH_TOKEN_UNLOOP),
+		PRIMITIVE_ADDRESS(FORTH_TOKEN_LEAVE),
+		PRIMITIVE_ADDRESS(FORTH_TOKEN_I),
+		PRIMITIVE_ADDRESS(FORTH_TOKEN_J),
+		PRIMITIVE_ADDRESS(FORTH_TOKEN_pLOOP),
+		PRIMITIVE_ADDRESS(FORTH_TOKEN_pPlusLOOP),
+		PRIMITIVE_ADDRESS(FORTH_TOKEN_branch),
+		PRIMITIVE_ADDRESS(FORTH_TOKEN_0branch),
+		PRIMITIVE_ADDRESS(FORTH_TOKEN_xtlit),
+		PRIMITIVE_ADDRESS(FORTH_TOKEN_lit),
+		PRIMITIVE_ADDRESS(FORTH_TOKEN_sslit),
+		PRIMITIVE_ADDRESS(FORTH_TOKEN_uslit),
+		PRIMITIVE_ADDRESS(FORTH_TOKEN_strlit),
+		PRIMITIVE_ADDRESS(FORTH_TOKEN_nest),
+		PRIMITIVE_ADDRESS(FORTH_TOKEN_EXIT),
+		PRIMITIVE_ADDRESS(FORTH_TOKEN_unnest),
+#if defined(FORTH_INCLUDE_FILE_ACCESS_WORDS)
+		PRIMITIVE_ADDRESS(FORTH_TOKEN_FILE_CREATE),
+		PRIMITIVE_ADDRESS(FORTH_TOKEN_FILE_OPEN),
+		PRIMITIVE_ADDRESS(FORTH_TOKEN_FILE_FLUSH),
+		PRIMITIVE_ADDRESS(FORTH_TOKEN_FILE_DELETE),
+		PRIMITIVE_ADDRESS(FORTH_TOKEN_FILE_REPOSITION),
+		PRIMITIVE_ADDRESS(FORTH_TOKEN_FILE_POSITION),
+		PRIMITIVE_ADDRESS(FORTH_TOKEN_FILE_SIZE),
+		PRIMITIVE_ADDRESS(FORTH_TOKEN_FILE_READ),
+		PRIMITIVE_ADDRESS(FORTH_TOKEN_FILE_READ_LINE),
+		PRIMITIVE_ADDRESS(FORTH_TOKEN_FILE_WRITE),
+		PRIMITIVE_ADDRESS(FORTH_TOKEN_FILE_WRITE_LINE),
+		PRIMITIVE_ADDRESS(FORTH_TOKEN_FILE_CLOSE),
+#endif
+#if defined(FORTH_INCLUDE_MEMORY_ALLOCATION_WORDS)
+		PRIMITIVE_ADDRESS(FORTH_TOKEN_ALLOCATE),
+		PRIMITIVE_ADDRESS(FORTH_TOKEN_RESIZE),
+		PRIMITIVE_ADDRESS(FORTH_TOKEN_FREE),
+#endif
+		PRIMITIVE_ADDRESS(FORTH_TOKEN_dovar),
+		PRIMITIVE_ADDRESS(FORTH_TOKEN_doconst),
+#if defined(FORTH_EXTERNAL_PRIMITIVES)
+		PRIMITIVE_ADDRESS(FORTH_TOKEN_doextern),
+#endif
+#if defined(FORTH_USER_VARIABLES)
+		PRIMITIVE_ADDRESS(FORTH_TOKEN_USER_ALLOT),
+		PRIMITIVE_ADDRESS(FORTH_TOKEN_douser),
+#endif
+		PRIMITIVE_ADDRESS(FORTH_TOKEN_docreate),
+		PRIMITIVE_ADDRESS(FORTH_TOKEN_OVER_Plus),
+		PRIMITIVE_ADDRESS(FORTH_TOKEN_DUP_0Equal),
+		PRIMITIVE_ADDRESS(FORTH_TOKEN_Fetch_Plus),
+		PRIMITIVE_ADDRESS(FORTH_TOKEN_Rfrom_DROP),
+		PRIMITIVE_ADDRESS(FORTH_TOKEN_I_Plus),
+		PRIMITIVE_ADDRESS(FORTH_TOKEN_Equal_0branch),
+		PRIMITIVE_ADDRESS(FORTH_TOKEN_Notequal_0branch),
+		PRIMITIVE_ADDRESS(FORTH_TOKEN_Less_0branch),
+		PRIMITIVE_ADDRESS(FORTH_TOKEN_Greater_0branch),
+		PRIMITIVE_ADDRESS(FORTH_TOKEN_ULess_0branch),
+		PRIMITIVE_ADDRESS(FORTH_TOKEN_UGreater_0branch),
+		PRIMITIVE_ADDRESS(FORTH_TOKEN_0Equal_0branch),
+		PRIMITIVE_ADDRESS(FORTH_TOKEN_0Notequal_0branch),
+		PRIMITIVE_ADDRESS(FORTH_TOKEN_0Less_0branch),
+		PRIMITIVE_ADDRESS(FORTH_TOKEN_0Greater_0branch),
+		PRIMITIVE_ADDRESS(FORTH_TOKEN_tailcall),
+		PRIMITIVE_ADDRESS(FORTH_TOKEN_inlined),
+		PRIMITIVE_ADDRESS(FORTH_TOKEN_native),
+		PRIMITIVE_ADDRESS(FORTH_TOKEN_compiled),
+#if defined(FORTH_COMPACT_CODE)
+		PRIMITIVE_ADDRESS(FORTH_TOKEN_compact),
+#endif
+	};
+
+#	if defined(FORTH_TOS_CACHING)
+	// Tokens without a primitive that works on the cached top of stack are run after a spill.
+	static const void *const tos_primitive_table[FORTH_TOKEN_COUNT] =
+	{
+		[0 ... (FORTH_TOKEN_COUNT - 1)] = &&spill_primitive,
+		TOS_PRIMITIVE_ADDRESS(FORTH_TOKEN_NOP),
+		TOS_PRIMITIVE_ADDRESS(FORTH_TOKEN_DROP),
+		TOS_PRIMITIVE_ADDRESS(FORTH_TOKEN_DUP),
+		TOS_PRIMITIVE_ADDRESS(FORTH_TOKEN_qDUP),
+		TOS_PRIMITIVE_ADDRESS(FORTH_TOKEN_SWAP),
+		TOS_PRIMITIVE_ADDRESS(FORTH_TOKEN_OVER),
+		TOS_PRIMITIVE_ADDRESS(FORTH_TOKEN_NIP),
+		TOS_PRIMITIVE_ADDRESS(FORTH_TOKEN_TUCK),
+		TOS_PRIMITIVE_ADDRESS(FORTH_TOKEN_ROT),
+		TOS_PRIMITIVE_ADDRESS(FORTH_TOKEN_2DUP),
+		TOS_PRIMITIVE_ADDRESS(FORTH_TOKEN_2DROP),
+		TOS_PRIMITIVE_ADDRESS(FORTH_TOKEN_Plus),
+		TOS_PRIMITIVE_ADDRESS(FORTH_TOKEN_Subtract),
+		TOS_PRIMITIVE_ADDRESS(FORTH_TOKEN_Multiply),
+		TOS_PRIMITIVE_ADDRESS(FORTH_TOKEN_Divide),
+		TOS_PRIMITIVE_ADDRESS(FORTH_TOKEN_MOD),
+		TOS_PRIMITIVE_ADDRESS(FORTH_TOKEN_NEGATE),
+		TOS_PRIMITIVE_ADDRESS(FORTH_TOKEN_INVERT),
+		TOS_PRIMITIVE_ADDRESS(FORTH_TOKEN_ABS),
+		TOS_PRIMITIVE_ADDRESS(FORTH_TOKEN_MIN),
+		TOS_PRIMITIVE_ADDRESS(FORTH_TOKEN_MAX),
+		TOS_PRIMITIVE_ADDRESS(FORTH_TOKEN_AND),
+		TOS_PRIMITIVE_ADDRESS(FORTH_TOKEN_OR),
+		TOS_PRIMITIVE_ADDRESS(FORTH_TOKEN_XOR),
+		TOS_PRIMITIVE_ADDRESS(FORTH_TOKEN_LSHIFT),
+		TOS_PRIMITIVE_ADDRESS(FORTH_TOKEN_RSHIFT),
+		TOS_PRIMITIVE_ADDRESS(FORTH_TOKEN_2_Star),
+		TOS_PRIMITIVE_ADDRESS(FORTH_TOKEN_2_Slash),
+		TOS_PRIMITIVE_ADDRESS(FORTH_TOKEN_CELLS),
+		TOS_PRIMITIVE_ADDRESS(FORTH_TOKEN_Imm_Plus),
+		TOS_PRIMITIVE_ADDRESS(FORTH_TOKEN_Imm_AND),
+		TOS_PRIMITIVE_ADDRESS(FORTH_TOKEN_Imm_OR),
+		TOS_PRIMITIVE_ADDRESS(FORTH_TOKEN_Imm_XOR),
+		TOS_PRIMITIVE_ADDRESS(FORTH_TOKEN_Imm_LSHIFT),
+		TOS_PRIMITIVE_ADDRESS(FORTH_TOKEN_Imm_RSHIFT),
+		TOS_PRIMITIVE_ADDRESS(FORTH_TOKEN_Imm_Equal),
+		TOS_PRIMITIVE_ADDRESS(FORTH_TOKEN_Imm_Less),
+		TOS_PRIMITIVE_ADDRESS(FORTH_TOKEN_Imm_Fetch),
+		TOS_PRIMITIVE_ADDRESS(FORTH_TOKEN_Less),
+		TOS_PRIMITIVE_ADDRESS(FORTH_TOKEN_Greater),
+		TOS_PRIMITIVE_ADDRESS(FORTH_TOKEN_ULess),
+		TOS_PRIMITIVE_ADDRESS(FORTH_TOKEN_UGreater),
+		TOS_PRIMITIVE_ADDRESS(FORTH_TOKEN_Equal),
+		TOS_PRIMITIVE_ADDRESS(FORTH_TOKEN_Notequal),
+		TOS_PRIMITIVE_ADDRESS(FORTH_TOKEN_0Equal),
+		TOS_PRIMITIVE_ADDRESS(FORTH_TOKEN_0Notequal),
+		TOS_PRIMITIVE_ADDRESS(FORTH_TOKEN_0Less),
+		TOS_PRIMITIVE_ADDRESS(FORTH_TOKEN_0Greater),
+		TOS_PRIMITIVE_ADDRESS(FORTH_TOKEN_Fetch),
+		TOS_PRIMITIVE_ADDRESS(FORTH_TOKEN_Store),
+		TOS_PRIMITIVE_ADDRESS(FORTH_TOKEN_CFetch),
+		TOS_PRIMITIVE_ADDRESS(FORTH_TOKEN_CStore),
+		TOS_PRIMITIVE_ADDRESS(FORTH_TOKEN_PlusStore),
+		TOS_PRIMITIVE_ADDRESS(FORTH_TOKEN_toR),
+		TOS_PRIMITIVE_ADDRESS(FORTH_TOKEN_Rfrom),
+		TOS_PRIMITIVE_ADDRESS(FORTH_TOKEN_Rfetch),
+		TOS_PRIMITIVE_ADDRESS(FORTH_TOKEN_pDO),
+		TOS_PRIMITIVE_ADDRESS(FORTH_TOKEN_pqDO),
+		TOS_PRIMITIVE_ADDRESS(FORTH_TOKEN_UNLOOP),
+		TOS_PRIMITIVE_ADDRESS(FORTH_TOKEN_LEAVE),
+		TOS_PRIMITIVE_ADDRESS(FORTH_TOKEN_I),
+		TOS_PRIMITIVE_ADDRESS(FORTH_TOKEN_J),
+		TOS_PRIMITIVE_ADDRESS(FORTH_TOKEN_pLOOP),
+		TOS_PRIMITIVE_ADDRESS(FORTH_TOKEN_pPlusLOOP),
+		TOS_PRIMITIVE_ADDRESS(FORTH_TOKEN_branch),
+		TOS_PRIMITIVE_ADDRESS(FORTH_TOKEN_0branch),
+		TOS_PRIMITIVE_ADDRESS(FORTH_TOKEN_xtlit),
+		TOS_PRIMITIVE_ADDRESS(FORTH_TOKEN_lit),
+		TOS_PRIMITIVE_ADDRESS(FORTH_TOKEN_sslit),
+		TOS_PRIMITIVE_ADDRESS(FORTH_TOKEN_uslit),
+		TOS_PRIMITIVE_ADDRESS(FORTH_TOKEN_strlit),
+		TOS_PRIMITIVE_ADDRESS(FORTH_TOKEN_nest),
+#if defined(FORTH_COMPACT_CODE)
+		TOS_PRIMITIVE_ADDRESS(FORTH_TOKEN_compact),
+#endif
+		TOS_PRIMITIVE_ADDRESS(FORTH_TOKEN_EXIT),
+		TOS_PRIMITIVE_ADDRESS(FORTH_TOKEN_unnest),
+		TOS_PRIMITIVE_ADDRESS(FORTH_TOKEN_dovar),
+		TOS_PRIMITIVE_ADDRESS(FORTH_TOKEN_doconst),
+#	if defined(FORTH_USER_VARIABLES)
+		TOS_PRIMITIVE_ADDRESS(FORTH_TOKEN_douser),
+#	endif
+		TOS_PRIMITIVE_ADDRESS(FORTH_TOKEN_docreate),
+		TOS_PRIMITIVE_ADDRESS(FORTH_TOKEN_EXECUTE),
+		TOS_PRIMITIVE_ADDRESS(FORTH_TOKEN_OVER_Plus),
+		TOS_PRIMITIVE_ADDRESS(FORTH_TOKEN_DUP_0Equal),
+		TOS_PRIMITIVE_ADDRESS(FORTH_TOKEN_Fetch_Plus),
+		TOS_PRIMITIVE_ADDRESS(FORTH_TOKEN_Rfrom_DROP),
+		TOS_PRIMITIVE_ADDRESS(FORTH_TOKEN_I_Plus),
+		TOS_PRIMITIVE_ADDRESS(FORTH_TOKEN_Equal_0branch),
+		TOS_PRIMITIVE_ADDRESS(FORTH_TOKEN_Notequal_0branch),
+		TOS_PRIMITIVE_ADDRESS(FORTH_TOKEN_Less_0branch),
+		TOS_PRIMITIVE_ADDRESS(FORTH_TOKEN_Greater_0branch),
+		TOS_PRIMITIVE_ADDRESS(FORTH_TOKEN_ULess_0branch),
+		TOS_PRIMITIVE_ADDRESS(FORTH_TOKEN_UGreater_0branch),
+		TOS_PRIMITIVE_ADDRESS(FORTH_TOKEN_0Equal_0branch),
+		TOS_PRIMITIVE_ADDRESS(FORTH_TOKEN_0Notequal_0branch),
+		TOS_PRIMITIVE_ADDRESS(FORTH_TOKEN_0Less_0branch),
+		TOS_PRIMITIVE_ADDRESS(FORTH_TOKEN_0Greater_0branch),
+		TOS_PRIMITIVE_ADDRESS(FORTH_TOKEN_tailcall),
+		TOS_PRIMITIVE_ADDRESS(FORTH_TOKEN_inlined),
+	};
+#	endif
+#endif
+
+	RELOAD();
+
+	while (1)
+	{
+#if defined(FORTH_COMPUTED_GOTO_ENGINE)
+	dispatch:
+#endif
+		if (TRACING())
+		{
+			SPILL();
+			rctx->sp = sp;
+			if (0 > forth_show_executing(rctx, w, xt))
+			{
+				// What to do here?
+				THROW(-57);
+			}
+			RELOAD();
+		}
+		// printf("xt = 0x%08x\n", xt); fflush(stdout);
+		if (FORTH_IS_NOT_TOKEN(xt))
+		{
+			// printf("not token xt = 0x%08x\n", xt); fflush(stdout);
+			w = FORTH_INDEX_EXTRACT(xt);
+			xt = dictionary[w];
+			// printf("new xt = 0x%08x\n", xt); fflush(stdout);
+			continue;
+		}
+
+		token_primitive = FORTH_EXTRACT_TOKEN(xt);
+
+#if 1
+//		printf("\t[%08X] token xt = 0x%08x: %s [0X%04X]\n", w, xt, forth_token_name(token_primitive), UNSIGNED_PARAMETER); fflush(stdout);
+#endif
+#if defined(FORTH_COMPUTED_GOTO_ENGINE)
+		if (token_primitive < FORTH_TOKEN_COUNT)
+		{
+			goto *DISPATCH_TABLE[token_primitive];
+		}
+		SPILL();
+		goto DEFAULT_PRIMITIVE;
+#endif
+
+#if defined(FORTH_TOS_CACHING)
+		// The most frequently used primitives, written to work on the cached top of stack.
+		// Everything else is reached through the spill below and runs on the in memory stack.
+#	if !defined(FORTH_COMPUTED_GOTO_ENGINE)
+		switch(token_primitive)
+		{
+#	endif
+			TOS_PRIMITIVE(FORTH_TOKEN_NOP):
+			TOS_NEXT;
+
+			TOS_PRIMITIVE(FORTH_TOKEN_DROP):
+				RELOAD();
+			TOS_NEXT;
+
+			TOS_PRIMITIVE(FORTH_TOKEN_DUP):
+				SPILL();
+			TOS_NEXT;
+
+			TOS_PRIMITIVE(FORTH_TOKEN_qDUP):
+				if (0 != tos)
+				{
+					SPILL();
+				}
+			TOS_NEXT;
+
+			TOS_PRIMITIVE(FORTH_TOKEN_SWAP):
+				nos = sp[0];
+				sp[0] = tos;
+				tos = nos;
+			TOS_NEXT;
+
+			TOS_PRIMITIVE(FORTH_TOKEN_OVER):
+				SPILL();
+				tos = sp[1];
+			TOS_NEXT;
+
+			TOS_PRIMITIVE(FORTH_TOKEN_NIP):
+				sp++;
+			TOS_NEXT;
+
+			TOS_PRIMITIVE(FORTH_TOKEN_TUCK):
+				sp--;
+				sp[0] = sp[1];
+				sp[1] = tos;
+			TOS_NEXT;
+
+			TOS_PRIMITIVE(FORTH_TOKEN_ROT):
+				nos = sp[1];
+				sp[1] = sp[0];
+				sp[0] = tos;
+				tos = nos;
+			TOS_NEXT;
+
+			TOS_PRIMITIVE(FORTH_TOKEN_2DUP):
+				sp -= 2;
+				sp[1] = tos;
+				sp[0] = sp[2];
+			TOS_NEXT;
+
+			TOS_PRIMITIVE(FORTH_TOKEN_2DROP):
+				tos = sp[1];
+				sp += 2;
+			TOS_NEXT;
+
+			TOS_PRIMITIVE(FORTH_TOKEN_Plus):
+				tos += POP();
+			TOS_NEXT;
+
+			TOS_PRIMITIVE(FORTH_TOKEN_Subtract):	// -
+				tos = POP() - tos;
+			TOS_NEXT;
+
+			TOS_PRIMITIVE(FORTH_TOKEN_Multiply):	// *
+				tos *= POP();
+			TOS_NEXT;
+
+			TOS_PRIMITIVE(FORTH_TOKEN_Divide):	// /
+				tos = (forth_cell_t)((forth_scell_t)POP() / (forth_scell_t)tos);
+			TOS_NEXT;
+
+			TOS_PRIMITIVE(FORTH_TOKEN_MOD):
+				tos = (forth_cell_t)((forth_scell_t)POP() % (forth_scell_t)tos);
+			TOS_NEXT;
+
+			TOS_PRIMITIVE(FORTH_TOKEN_NEGATE):
+				tos = -(forth_scell_t)tos;
+			TOS_NEXT;
+
+			TOS_PRIMITIVE(FORTH_TOKEN_INVERT):
+				tos = ~tos;
+			TOS_NEXT;
+
+			TOS_PRIMITIVE(FORTH_TOKEN_ABS):
+				if (0 > (forth_scell_t)tos)
+				{
+					tos = -(forth_scell_t)tos;
+				}
+			TOS_NEXT;
+
+			TOS_PRIMITIVE(FORTH_TOKEN_MIN):
+				nos = POP();
+				if ((forth_scell_t)nos < (forth_scell_t)tos)
+				{
+					tos = nos;
+				}
+			TOS_NEXT;
+
+			TOS_PRIMITIVE(FORTH_TOKEN_MAX):
+				nos = POP();
+				if ((forth_scell_t)nos > (forth_scell_t)tos)
+				{
+					tos = nos;
+				}
+			TOS_NEXT;
+
+			TOS_PRIMITIVE(FORTH_TOKEN_AND):
+				tos &= POP();
+			TOS_NEXT;
+
+			TOS_PRIMITIVE(FORTH_TOKEN_OR):
+				tos |= POP();
+			TOS_NEXT;
+
+			TOS_PRIMITIVE(FORTH_TOKEN_XOR):
+				tos ^= POP();
+			TOS_NEXT;
+
+			TOS_PRIMITIVE(FORTH_TOKEN_LSHIFT):
+				tos = POP() << tos;
+			TOS_NEXT;
+
+			TOS_PRIMITIVE(FORTH_TOKEN_RSHIFT):
+				tos = POP() >> tos;
+			TOS_NEXT;
+
+			TOS_PRIMITIVE(FORTH_TOKEN_2_Star):	// 2*
+				tos <<= 1;
+			TOS_NEXT;
+
+			TOS_PRIMITIVE(FORTH_TOKEN_2_Slash):	// 2/
+				tos >>= 1;
+			TOS_NEXT;
+
+			TOS_PRIMITIVE(FORTH_TOKEN_CELLS):
+				tos *= sizeof(forth_cell_t);
+			TOS_NEXT;
+
+			TOS_PRIMITIVE(FORTH_TOKEN_Imm_Plus):	// imm+
+				tos += SIGNED_PARAMETER;
+			TOS_NEXT;
+
+			TOS_PRIMITIVE(FORTH_TOKEN_Imm_AND):		// imm-and
+				tos &= SIGNED_PARAMETER;
+			TOS_NEXT;
+
+			TOS_PRIMITIVE(FORTH_TOKEN_Imm_OR):		// imm-or
+				tos |= SIGNED_PARAMETER;
+			TOS_NEXT;
+
+			TOS_PRIMITIVE(FORTH_TOKEN_Imm_XOR):		// imm-xor
+				tos ^= SIGNED_PARAMETER;
+			TOS_NEXT;
+
+			TOS_PRIMITIVE(FORTH_TOKEN_Imm_LSHIFT):	// imm-lshift
+				tos <<= UNSIGNED_PARAMETER;
+			TOS_NEXT;
+
+			TOS_PRIMITIVE(FORTH_TOKEN_Imm_RSHIFT):	// imm-rshift
+				tos >>= UNSIGNED_PARAMETER;
+			TOS_NEXT;
+
+			TOS_PRIMITIVE(FORTH_TOKEN_Imm_Equal):	// imm=
+				tos = (tos == (forth_cell_t)SIGNED_PARAMETER) ? FORTH_TRUE : FORTH_FALSE;
+			TOS_NEXT;
+
+			TOS_PRIMITIVE(FORTH_TOKEN_Imm_Less):		// imm<
+				tos = (((forth_scell_t)tos) < SIGNED_PARAMETER) ? FORTH_TRUE : FORTH_FALSE;
+			TOS_NEXT;
+
+			TOS_PRIMITIVE(FORTH_TOKEN_Imm_Fetch):	// imm+@
+				tos = CELL_AT(tos + SIGNED_PARAMETER);
+			TOS_NEXT;
+
+			TOS_PRIMITIVE(FORTH_TOKEN_Less):	// <
+				tos = (((forth_scell_t)POP()) < ((forth_scell_t)tos)) ? FORTH_TRUE : FORTH_FALSE;
+			TOS_NEXT;
+
+			TOS_PRIMITIVE(FORTH_TOKEN_Greater):	// >
+				tos = (((forth_scell_t)POP()) > ((forth_scell_t)tos)) ? FORTH_TRUE : FORTH_FALSE;
+			TOS_NEXT;
+
+			TOS_PRIMITIVE(FORTH_TOKEN_ULess):	// u<
+				tos = (POP() < tos) ? FORTH_TRUE : FORTH_FALSE;
+			TOS_NEXT;
+
+			TOS_PRIMITIVE(FORTH_TOKEN_UGreater):	// u>
+				tos = (POP() > tos) ? FORTH_TRUE : FORTH_FALSE;
+			TOS_NEXT;
+
+			TOS_PRIMITIVE(FORTH_TOKEN_Equal):	// =
+				tos = (POP() == tos) ? FORTH_TRUE : FORTH_FALSE;
+			TOS_NEXT;
+
+			TOS_PRIMITIVE(FORTH_TOKEN_Notequal):	// <>
+				tos = (POP() != tos) ? FORTH_TRUE : FORTH_FALSE;
+			TOS_NEXT;
+
+			TOS_PRIMITIVE(FORTH_TOKEN_0Equal):
+				tos = (0 == tos) ? FORTH_TRUE : FORTH_FALSE;
+			TOS_NEXT;
+
+			TOS_PRIMITIVE(FORTH_TOKEN_0Notequal):
+				tos = (0 != tos) ? FORTH_TRUE : FORTH_FALSE;
+			TOS_NEXT;
+
+			TOS_PRIMITIVE(FORTH_TOKEN_0Less):	// 0<
+				tos = (((forth_scell_t)tos) < 0) ? FORTH_TRUE : FORTH_FALSE;
+			TOS_NEXT;
+
+			TOS_PRIMITIVE(FORTH_TOKEN_0Greater):	// 0>
+				tos = (((forth_scell_t)tos) > 0) ? FORTH_TRUE : FORTH_FALSE;
+			TOS_NEXT;
+
+			TOS_PRIMITIVE(FORTH_TOKEN_Fetch):	// @
+				tos = CELL_AT(tos);
+			TOS_NEXT;
+
+			TOS_PRIMITIVE(FORTH_TOKEN_Store):	// !
+				CELL_AT(tos) = sp[0];
+				tos = sp[1];
+				sp += 2;
+			TOS_NEXT;
+
+			TOS_PRIMITIVE(FORTH_TOKEN_CFetch):	// C@
+				tos = CHAR_AT(tos);
+			TOS_NEXT;
+
+			TOS_PRIMITIVE(FORTH_TOKEN_CStore):	// c!
+				CHAR_AT(tos) = (char)(sp[0]);
+				tos = sp[1];
+				sp += 2;
+			TOS_NEXT;
+
+			TOS_PRIMITIVE(FORTH_TOKEN_PlusStore):	// +!
+				CELL_AT(tos) += sp[0];
+				tos = sp[1];
+				sp += 2;
+			TOS_NEXT;
+
+			TOS_PRIMITIVE(FORTH_TOKEN_toR):
+				RPUSH(tos);
+				RELOAD();
+			TOS_NEXT;
+
+			TOS_PRIMITIVE(FORTH_TOKEN_Rfrom):
+				SPILL();
+				tos = RPOP();
+			TOS_NEXT;
+
+			TOS_PRIMITIVE(FORTH_TOKEN_Rfetch):
+				SPILL();
+				tos = *rp;
+			TOS_NEXT;
+
+			TOS_PRIMITIVE(FORTH_TOKEN_pDO):		// (DO)
+				rp -= LOOP_ADJUSTMENT;
+				LOOP_I = tos;
+				LOOP_LIMIT = sp[0];
+				LOOP_ADDRESS_AFTER = ip + SIGNED_PARAMETER;
+				tos = sp[1];
+				sp += 2;
+				TOS_CHECK_STACKS();
+			TOS_NEXT;
+
+			TOS_PRIMITIVE(FORTH_TOKEN_pqDO):	// (?DO)
+				if (sp[0] != tos)
+				{
+					rp -= LOOP_ADJUSTMENT;
+					LOOP_I = tos;
+					LOOP_LIMIT = sp[0];
+					LOOP_ADDRESS_AFTER = ip + SIGNED_PARAMETER;
+				}
+				else
+				{
+					ip += SIGNED_PARAMETER;
+				}
+				tos = sp[1];
+				sp += 2;
+				TOS_CHECK_STACKS();
+			TOS_NEXT;
+
+			TOS_PRIMITIVE(FORTH_TOKEN_UNLOOP):	// UNLOOP
+				rp += LOOP_ADJUSTMENT;
+				TOS_CHECK_STACKS();
+			TOS_NEXT;
+
+			TOS_PRIMITIVE(FORTH_TOKEN_LEAVE):	// LEAVE
+				ip = LOOP_ADDRESS_AFTER;
+				rp += LOOP_ADJUSTMENT;
+				TOS_CHECK_STACKS();
+			TOS_NEXT;
+
+			TOS_PRIMITIVE(FORTH_TOKEN_I):		// I
+				SPILL();
+				tos = LOOP_I;
+			TOS_NEXT;
+
+			TOS_PRIMITIVE(FORTH_TOKEN_J):		// J
+				SPILL();
+				tos = LOOP_J;
+			TOS_NEXT;
+
+			TOS_PRIMITIVE(FORTH_TOKEN_pLOOP):	// (LOOP)
+				LOOP_I += 1;
+
+				if (LOOP_I == LOOP_LIMIT)
+				{
+					rp += LOOP_ADJUSTMENT;
+				}
+				else
+				{
+					ip += SIGNED_PARAMETER;
+				}
+				TOS_CHECK_STACKS();
+			TOS_NEXT;
+
+			TOS_PRIMITIVE(FORTH_TOKEN_pPlusLOOP):	// (+LOOP)
+				nos = tos;
+				RELOAD();
+
+				LOOP_I += nos;
+
+				if (0 > (forth_scell_t)((LOOP_I - LOOP_LIMIT) ^ nos))	// Some 2's complement's trickery.
+				{
+					ip += SIGNED_PARAMETER;
+				}
+				else
+				{
+					rp += LOOP_ADJUSTMENT;
+				}
+				TOS_CHECK_STACKS();
+			TOS_NEXT;
+
+			TOS_PRIMITIVE(FORTH_TOKEN_branch):
+				ip += SIGNED_PARAMETER;
+				TOS_CHECK_STACKS();
+			TOS_NEXT;
+
+			TOS_PRIMITIVE(FORTH_TOKEN_0branch):
+				nos = tos;
+				RELOAD();
+				if (0 == nos)
+				{
+					ip += SIGNED_PARAMETER;
+				}
+				TOS_CHECK_STACKS();
+			TOS_NEXT;
+
+			TOS_PRIMITIVE(FORTH_TOKEN_xtlit):	// eXecution Token literal.
+			TOS_PRIMITIVE(FORTH_TOKEN_lit):		// Full sized literal.
+				SPILL();
+				tos = INLINE_CELL();
+			TOS_NEXT;
+
+			TOS_PRIMITIVE(FORTH_TOKEN_sslit):	// Litaral encoded in the token, signed.
+				SPILL();
+				tos = SIGNED_PARAMETER;
+			TOS_NEXT;
+
+			TOS_PRIMITIVE(FORTH_TOKEN_uslit):	// Literal encoded in the token, unsigned.
+				SPILL();
+				tos = UNSIGNED_PARAMETER;
+			TOS_NEXT;
+
+			TOS_PRIMITIVE(FORTH_TOKEN_strlit):	// String literal, length encoded in the token.
+				SPILL();
+				PUSH(INLINE_ADDRESS());
+				tos = UNSIGNED_PARAMETER;
+				INLINE_SKIP(tos);
+			TOS_NEXT;
+
+			TOS_PRIMITIVE(FORTH_TOKEN_nest):
+				RPUSH(RETURN_ADDRESS);
+				ip = w + 1;
+				TOS_CHECK_STACKS();
+				RUN_CELLS(TOS_SWITCH_CODE());
+			TOS_NEXT;
+
+#	if defined(FORTH_COMPACT_CODE)
+			TOS_PRIMITIVE(FORTH_TOKEN_compact):	// nest into a body of 16 bit units.
+				RPUSH(RETURN_ADDRESS);
+				ip = FORTH_COMPACT_BODY(w);
+				TOS_CHECK_STACKS();
+				RUN_COMPACT(TOS_SWITCH_CODE());
+			TOS_NEXT;
+#	endif
+
+			TOS_PRIMITIVE(FORTH_TOKEN_EXIT):	// Same as unnest
+			TOS_PRIMITIVE(FORTH_TOKEN_unnest):
+				ip = RPOP();
+				TOS_CHECK_STACKS();
+				RETURNED(TOS_SWITCH_CODE());
+#	if defined(FORTH_ENGINE_TRACING)
+				if (!rctx->trace)	// Tracing was turned off, returns are safe points to go back to the fast engine.
+				{
+					SPILL();
+					SWITCH_ENGINE();
+				}
+#	endif
+			TOS_NEXT;
+
+			TOS_PRIMITIVE(FORTH_TOKEN_dovar):
+				SPILL();
+				tos = ADDRESS(&dictionary[w + 1]);
+			TOS_NEXT;
+
+			TOS_PRIMITIVE(FORTH_TOKEN_doconst):
+				SPILL();
+				tos = dictionary[w + 1];
+			TOS_NEXT;
+
+#	if defined(FORTH_USER_VARIABLES)
+			TOS_PRIMITIVE(FORTH_TOKEN_douser):
+				SPILL();
+				tos = ADDRESS(&(rctx->user[UNSIGNED_PARAMETER]));
+			TOS_NEXT;
+#	endif
+
+			TOS_PRIMITIVE(FORTH_TOKEN_docreate):
+				SPILL();
+				tos = ADDRESS(&dictionary[w + 2]);
+				xt = dictionary[w + 1];
+				TOS_CHECK_STACKS();
+			TOS_DISPATCH();
+
+			TOS_PRIMITIVE(FORTH_TOKEN_EXECUTE):
+				xt = tos;
+				RELOAD();
+				TOS_CHECK_STACKS();
+			TOS_DISPATCH();
+
+			TOS_PRIMITIVE(FORTH_TOKEN_OVER_Plus):	// OVER +
+				tos += sp[0];
+			TOS_NEXT;
+
+			TOS_PRIMITIVE(FORTH_TOKEN_DUP_0Equal):	// DUP 0=
+				SPILL();
+				tos = (0 == tos) ? FORTH_TRUE : FORTH_FALSE;
+			TOS_NEXT;
+
+			TOS_PRIMITIVE(FORTH_TOKEN_Fetch_Plus):	// @ +
+				tos = CELL_AT(tos);
+				tos += POP();
+			TOS_NEXT;
+
+			TOS_PRIMITIVE(FORTH_TOKEN_Rfrom_DROP):	// R> DROP
+				rp++;
+			TOS_NEXT;
+
+			TOS_PRIMITIVE(FORTH_TOKEN_I_Plus):	// I +
+				tos += LOOP_I;
+			TOS_NEXT;
+
+			TOS_PRIMITIVE(FORTH_TOKEN_Equal_0branch):	// = 0branch
+				if (POP() != tos)
+				{
+					ip += SIGNED_PARAMETER;
+				}
+				RELOAD();
+				TOS_CHECK_STACKS();
+			TOS_NEXT;
+
+			TOS_PRIMITIVE(FORTH_TOKEN_Notequal_0branch):	// <> 0branch
+				if (POP() == tos)
+				{
+					ip += SIGNED_PARAMETER;
+				}
+				RELOAD();
+				TOS_CHECK_STACKS();
+			TOS_NEXT;
+
+			TOS_PRIMITIVE(FORTH_TOKEN_Less_0branch):	// < 0branch
+				if (((forth_scell_t)POP()) >= ((forth_scell_t)tos))
+				{
+					ip += SIGNED_PARAMETER;
+				}
+				RELOAD();
+				TOS_CHECK_STACKS();
+			TOS_NEXT;
+
+			TOS_PRIMITIVE(FORTH_TOKEN_Greater_0branch):	// > 0branch
+				if (((forth_scell_t)POP()) <= ((forth_scell_t)tos))
+				{
+					ip += SIGNED_PARAMETER;
+				}
+				RELOAD();
+				TOS_CHECK_STACKS();
+			TOS_NEXT;
+
+			TOS_PRIMITIVE(FORTH_TOKEN_ULess_0branch):	// u< 0branch
+				if (POP() >= tos)
+				{
+					ip += SIGNED_PARAMETER;
+				}
+				RELOAD();
+				TOS_CHECK_STACKS();
+			TOS_NEXT;
+
+			TOS_PRIMITIVE(FORTH_TOKEN_UGreater_0branch):	// u> 0branch
+				if (POP() <= tos)
+				{
+					ip += SIGNED_PARAMETER;
+				}
+				RELOAD();
+				TOS_CHECK_STACKS();
+			TOS_NEXT;
+
+			TOS_PRIMITIVE(FORTH_TOKEN_0Equal_0branch):	// 0= 0branch
+				if (0 != tos)
+				{
+					ip += SIGNED_PARAMETER;
+				}
+				RELOAD();
+				TOS_CHECK_STACKS();
+			TOS_NEXT;
+
+			TOS_PRIMITIVE(FORTH_TOKEN_0Notequal_0branch):	// 0<> 0branch
+				if (0 == tos)
+				{
+					ip += SIGNED_PARAMETER;
+				}
+				RELOAD();
+				TOS_CHECK_STACKS();
+			TOS_NEXT;
+
+			TOS_PRIMITIVE(FORTH_TOKEN_0Less_0branch):	// 0< 0branch
+				if (((forth_scell_t)tos) >= 0)
+				{
+					ip += SIGNED_PARAMETER;
+				}
+				RELOAD();
+				TOS_CHECK_STACKS();
+			TOS_NEXT;
+
+			TOS_PRIMITIVE(FORTH_TOKEN_0Greater_0branch):	// 0> 0branch
+				if (((forth_scell_t)tos) <= 0)
+				{
+					ip += SIGNED_PARAMETER;
+				}
+				RELOAD();
+				TOS_CHECK_STACKS();
+			TOS_NEXT;
+
+			TOS_PRIMITIVE(FORTH_TOKEN_tailcall):	// nest without the RPUSH, unnest of the callee returns to our caller.
+				w = INLINE_CELL();
+#	if defined(FORTH_COMPACT_CODE)
+				if (FORTH_PACK_TOKEN(FORTH_TOKEN_compact) == dictionary[w])
+				{
+					ip = FORTH_COMPACT_BODY(w);
+					TOS_CHECK_STACKS();
+					RUN_COMPACT(TOS_SWITCH_CODE());
+					TOS_NEXT;
+				}
+#	endif
+				ip = w + 1;
+				TOS_CHECK_STACKS();
+				RUN_CELLS(TOS_SWITCH_CODE());
+			TOS_NEXT;
+
+			TOS_PRIMITIVE(FORTH_TOKEN_inlined):	// The xt is only there for SEE.
+				(void)INLINE_CELL();
+			TOS_NEXT;
+
+#	if defined(FORTH_COMPUTED_GOTO_ENGINE)
+		spill_primitive:
+			SPILL();
+			goto *primitive_table[token_primitive];
+#	else
+			default:
+			break;
+		}
+
+		SPILL();
+#	endif
+#endif
+
+#if defined(FORTH_COMPUTED_GOTO_ENGINE)
+		{
+#else
+		switch(token_primitive)
+		{
+#endif
+			PRIMITIVE(FORTH_TOKEN_NOP):
+			NEXT;
+
+			PRIMITIVE(FORTH_TOKEN_ACCEPT):
+				tos = POP();
+				tos = forth_accept(rctx, POINTER(tos), *sp);
+
+				if (0 > (forth_scell_t)tos)
+				{
+					THROW(-57);
+				}
+
+				PUSH(tos);
+			NEXT;
+
+			PRIMITIVE(FORTH_TOKEN_KEY):
+				if (0 == rctx->key)
+				{
+					THROW(-21);
+				}
+
+				tos = rctx->key(rctx);
+
+				if (FORTH_TRUE == tos)
+				{
+					THROW(-57);
+				}
+
+				PUSH(tos);
+			NEXT;
+
+			PRIMITIVE(FORTH_TOKEN_EKEY):
+				if (0 == rctx->ekey)
+				{
+					THROW(-21);
+				}
+
+				tos = rctx->ekey(rctx);
+
+				if (FORTH_TRUE == tos)
+				{
+					THROW(-57);
+				}
+
+				PUSH(tos);
+			NEXT;
+
+			PRIMITIVE(FORTH_TOKEN_KEYq):		// KEY?
+				if (0 == rctx->key_q)
+				{
+					THROW(-21);
+				}
+
+				tos = rctx->key_q(rctx);
+
+				if (((forth_scell_t) tos) < 0)
+				{
+					THROW(-21);
+				}
+
+				tos = tos ? FORTH_TRUE : FORTH_FALSE;
+				PUSH(tos);
+			NEXT;
+
+			PRIMITIVE(FORTH_TOKEN_EKEYq):		// EKEY?
+				if (0 == rctx->ekey_q)
+				{
+					THROW(-21);
+				}
+
+				tos = rctx->ekey_q(rctx);
+				if (((forth_scell_t) tos) < 0)
+				{
+					THROW(-21);
+				}
+
+				tos = tos ? FORTH_TRUE : FORTH_FALSE;
+				PUSH(tos);
+			NEXT;
+
+			PRIMITIVE(FORTH_TOKEN_EKEY2CHAR):	// EKEY>CHAR
+				if (0 == rctx->ekey_to_char)
+				{
+					THROW(-21);
+				}
+
+				tos = rctx->ekey_to_char(rctx, sp[0]);
+
+				if (FORTH_TRUE == tos)
+				{
+					PUSH(FORTH_FALSE);
+				}
+				else
+				{
+					sp[0] = tos;
+					PUSH(FORTH_TRUE);
+				}
+			NEXT;
+
+			PRIMITIVE(FORTH_TOKEN_ALIGN):
+				// pctx->dp = FORTH_ALIGN((pctx->dp));
+				dictionary[FORTH_DP_LOCATION] = FORTH_ALIGN(dictionary[FORTH_DP_LOCATION]);
+			NEXT;
+
+			PRIMITIVE(FORTH_TOKEN_ALIGNED):
+				*sp = FORTH_ALIGN(*sp);
+			NEXT;
+
+			PRIMITIVE(FORTH_TOKEN_ALLOT):
+				tos = POP();
+				if (!FORTH_DICTIONARY_ROOM(dictionary, dictionary[FORTH_DP_LOCATION] + tos))
+				{
+					THROW(-8);
+				}
+				dictionary[FORTH_DP_LOCATION] += tos;
+			NEXT;
+
+			PRIMITIVE(FORTH_TOKEN_PAD):	// Just use HERE for now, the room for it is committed with the dictionary.
+			PRIMITIVE(FORTH_TOKEN_HERE):
+				rctx->peephole = 0;
+				tos = ADDRESS(((char *)dictionary) + dictionary[FORTH_DP_LOCATION]);
+				PUSH(tos);
+			NEXT;
+
+			PRIMITIVE(FORTH_TOKEN_pHERE):
+				rctx->peephole = 0;	// The next cell may be a branch target.
+				tos = (dictionary[FORTH_DP_LOCATION] / sizeof(forth_cell_t));
+				PUSH(tos);
+			NEXT;
+
+			PRIMITIVE(FORTH_TOKEN_pTRACE):
+				tos = ADDRESS(&(rctx->trace));
+				PUSH(tos);
+#if !defined(FORTH_ENGINE_TRACING)
+				// The flag is about to be looked at or changed, carry on in the engine that can trace.
+				SWITCH_ENGINE();
+#endif
+			NEXT;
+
+			PRIMITIVE(FORTH_TOKEN_CompileComma):	// COMPILE,
+				tos = forth_compile_comma(rctx, POP());
+				if (0 != tos)
+				{
+					THROW(tos);
+				}
+			NEXT;
+
+			PRIMITIVE(FORTH_TOKEN_Comma):		// ,
+				if (!FORTH_DICTIONARY_ROOM(dictionary, dictionary[FORTH_DP_LOCATION] + sizeof(forth_cell_t)))
+				{
+					THROW(-8);
+				}
+				tos = ADDRESS(((char *)dictionary) + dictionary[FORTH_DP_LOCATION]);
+				CELL_AT(tos) = POP();
+				dictionary[FORTH_DP_LOCATION] += sizeof(forth_cell_t);
+			NEXT;
+
+			PRIMITIVE(FORTH_TOKEN_CComma):		// C,
+				if (!FORTH_DICTIONARY_ROOM(dictionary, dictionary[FORTH_DP_LOCATION] + sizeof(char)))
+				{
+					THROW(-8);
+				}
+				tos = ADDRESS(((char *)dictionary) + dictionary[FORTH_DP_LOCATION]);
+				CHAR_AT(tos) = POP();
+				dictionary[FORTH_DP_LOCATION] += sizeof(char);
+			NEXT;
+
+			PRIMITIVE(FORTH_TOKEN_Imm_Plus):				// imm+
+				*sp += SIGNED_PARAMETER;
+			NEXT;
+
+			PRIMITIVE(FORTH_TOKEN_Imm_AND):				// imm-and
+				sp[0] &= SIGNED_PARAMETER;
+			NEXT;
+
+			PRIMITIVE(FORTH_TOKEN_Imm_OR):				// imm-or
+				sp[0] |= SIGNED_PARAMETER;
+			NEXT;
+
+			PRIMITIVE(FORTH_TOKEN_Imm_XOR):				// imm-xor
+				sp[0] ^= SIGNED_PARAMETER;
+			NEXT;
+
+			PRIMITIVE(FORTH_TOKEN_Imm_LSHIFT):			// imm-lshift
+				sp[0] <<= UNSIGNED_PARAMETER;
+			NEXT;
+
+			PRIMITIVE(FORTH_TOKEN_Imm_RSHIFT):			// imm-rshift
+				sp[0] >>= UNSIGNED_PARAMETER;
+			NEXT;
+
+			PRIMITIVE(FORTH_TOKEN_Imm_Equal):			// imm=
+				sp[0] = (sp[0] == (forth_cell_t)SIGNED_PARAMETER) ? FORTH_TRUE : FORTH_FALSE;
+			NEXT;
+
+			PRIMITIVE(FORTH_TOKEN_Imm_Less):				// imm<
+				sp[0] = (((forth_scell_t)(sp[0])) < SIGNED_PARAMETER) ? FORTH_TRUE : FORTH_FALSE;
+			NEXT;
+
+			PRIMITIVE(FORTH_TOKEN_Imm_Fetch):			// imm+@
+				sp[0] = CELL_AT(sp[0] + SIGNED_PARAMETER);
+			NEXT;
+
+			PRIMITIVE(FORTH_TOKEN_Subtract):	// -
+				sp[1] -= sp[0];
+				sp++;
+			NEXT;
+
+			PRIMITIVE(FORTH_TOKEN_Divide):	// /
+				tos = POP();
+				sp[0] = (forth_cell_t)((forth_scell_t)sp[0] / (forth_scell_t)tos);
+			NEXT;
+
+			PRIMITIVE(FORTH_TOKEN_MOD):
+				tos = POP();
+				sp[0] = (forth_cell_t)((forth_scell_t)sp[0] % (forth_scell_t)tos);
+			NEXT;
+
+			PRIMITIVE(FORTH_TOKEN_Slash_MOD):	// /MOD
+				tos = sp[0];
+				sp[0] = (forth_cell_t)((forth_scell_t)sp[1] / (forth_scell_t)tos);
+				sp[1] = (forth_cell_t)((forth_scell_t)sp[1] % (forth_scell_t)tos);
+			NEXT;
+
+#if !defined(FORTH_NO_DOUBLES)
+			PRIMITIVE(FORTH_TOKEN_StarSlash):	// */
+				sp[2] = (forth_cell_t)((((forth_sdcell_t)sp[2]) * (forth_scell_t)sp[1]) / (forth_scell_t)sp[0]);
+				sp += 2;
+			NEXT;
+
+			PRIMITIVE(FORTH_TOKEN_StarSlash_MOD):	// */MOD
+				dtos = (forth_dcell_t)(((forth_sdcell_t)sp[2]) * (forth_scell_t)sp[1]);
+				tos = POP();
+				sp[1] = (forth_cell_t)(((forth_sdcell_t)dtos) % (forth_scell_t)tos);
+				sp[0] = (forth_cell_t)(((forth_sdcell_t)dtos) / (forth_scell_t)tos);
+			NEXT;
+
+			PRIMITIVE(FORTH_TOKEN_UM_Star):	// UM*
+				dtos = (forth_dcell_t)sp[0] * sp[1];
+				sp[1] = FORTH_CELL_LOW(dtos);
+				sp[0] = FORTH_CELL_HIGH(dtos);
+			NEXT;
+
+			PRIMITIVE(FORTH_TOKEN_M_Star):	// M* ( n1 n2 -- d )
+				dtos = (forth_dcell_t)((forth_sdcell_t)((forth_scell_t)sp[1]) * (forth_scell_t)(sp[0]));
+				sp[1] = FORTH_CELL_LOW(dtos);
+				sp[0] = FORTH_CELL_HIGH(dtos);
+			NEXT;
+
+			PRIMITIVE(FORTH_TOKEN_M_Plus):	// M+ ( d1 n -- d2 )
+				dtos = FORTH_DCELL(sp[1], sp[2]);
+				dtos = dtos + POP();
+				sp[1] = FORTH_CELL_LOW(dtos);
+				sp[0] = FORTH_CELL_HIGH(dtos);
+			NEXT;
+
+
+			PRIMITIVE(FORTH_TOKEN_UM_Slash_MOD):	// UM/MOD
+				tos = POP();
+				dtos = FORTH_DCELL(sp[0], sp[1]);
+				sp[1] = (forth_cell_t)(dtos % tos);
+				sp[0] = (forth_cell_t)(dtos / tos);
+			NEXT;
+#endif
+			PRIMITIVE(FORTH_TOKEN_Multiply):	// *
+				tos = POP();
+				sp[0] = sp[0] * tos;
+			NEXT;
+
+			PRIMITIVE(FORTH_TOKEN_NEGATE):
+				sp[0] = -(forth_scell_t)sp[0];
+			NEXT;
+
+			PRIMITIVE(FORTH_TOKEN_INVERT):
+				sp[0] = ~sp[0];
+			NEXT;
+
+			PRIMITIVE(FORTH_TOKEN_ABS):
+				if (0 > (forth_scell_t)sp[0])
+				{
+					sp[0] = -(forth_scell_t)sp[0];
+				}
+			NEXT;
+
+			PRIMITIVE(FORTH_TOKEN_MIN):
+				tos = POP();
+				if ((forth_scell_t)sp[0] > (forth_scell_t)tos)
+				{
+					sp[0] = tos;
+				}
+			NEXT;
+
+			PRIMITIVE(FORTH_TOKEN_MAX):
+				tos = POP();
+				if ((forth_scell_t)sp[0] < (forth_scell_t)tos)
+				{
+					sp[0] = tos;
+				}
+			NEXT;
+
+			PRIMITIVE(FORTH_TOKEN_LSHIFT):
+				tos = POP();
+				sp[0] <<= tos;
+			NEXT;
+
+			PRIMITIVE(FORTH_TOKEN_RSHIFT):
+				tos = POP();
+				sp[0] >>= tos;
+			NEXT;
+
+			PRIMITIVE(FORTH_TOKEN_2_Star):	// 2*
+				(*sp) <<= 1;
+			NEXT;
+
+			PRIMITIVE(FORTH_TOKEN_2_Slash):	// 2/
+				(*sp) >>= 1;
+			NEXT;
+
+#if !defined(FORTH_NO_DOUBLES)
+			PRIMITIVE(FORTH_TOKEN_D2_Star):	// d2*
+				dtos = FORTH_DCELL(sp[0], sp[1]);
+				dtos <<= 1;
+				sp[1] = FORTH_CELL_LOW(dtos);
+				sp[0] = FORTH_CELL_HIGH(dtos);
+			NEXT;
+
+			PRIMITIVE(FORTH_TOKEN_D2_Slash):	// d2/
+				dtos = FORTH_DCELL(sp[0], sp[1]);
+				dtos >>= 1;
+				sp[1] = FORTH_CELL_LOW(dtos);
+				sp[0] = FORTH_CELL_HIGH(dtos);
+			NEXT;
+
+
+			PRIMITIVE(FORTH_TOKEN_DNEGATE):
+				dtos = FORTH_DCELL(sp[0], sp[1]);
+				dtos = -(forth_sdcell_t)dtos;
+				sp[1] = FORTH_CELL_LOW(dtos);
+				sp[0] = FORTH_CELL_HIGH(dtos);
+			NEXT;
+
+			PRIMITIVE(FORTH_TOKEN_DABS):
+				if (0 > (forth_scell_t)(sp[0]))
+				{
+					xt = FORTH_PACK_TOKEN(FORTH_TOKEN_DNEGATE);
+					DISPATCH();
+				}
+			NEXT;
+
+			PRIMITIVE(FORTH_TOKEN_DMIN):
+				dtos = FORTH_DCELL(sp[0], sp[1]);
+				if ((forth_sdcell_t)dtos < (forth_sdcell_t)FORTH_DCELL(sp[2], sp[3]))
+				{
+					sp[0] = sp[2];
+					sp[1] = sp[3];
+				}
+				sp += 2;
+			NEXT;
+
+			PRIMITIVE(FORTH_TOKEN_DMAX):
+				dtos = FORTH_DCELL(sp[0], sp[1]);
+				if ((forth_sdcell_t)dtos < (forth_sdcell_t)FORTH_DCELL(sp[2], sp[3]))
+				{
+					sp[0] = sp[2];
+					sp[1] = sp[3];
+				}
+				sp += 2;
+			NEXT;
+
+			PRIMITIVE(FORTH_TOKEN_D_Plus):	// d+
+				dtos = FORTH_DCELL(sp[0], sp[1]);
+				sp += 2;
+				dtos += FORTH_DCELL(sp[0], sp[1]);
+				sp[1] = FORTH_CELL_LOW(dtos);
+				sp[0] = FORTH_CELL_HIGH(dtos);
+			NEXT;
+
+			PRIMITIVE(FORTH_TOKEN_D_Subtract):	// d-
+				dtos = FORTH_DCELL(sp[2], sp[3]);
+				dtos -= FORTH_DCELL(sp[0], sp[1]);
+				sp += 2;
+				sp[1] = FORTH_CELL_LOW(dtos);
+				sp[0] = FORTH_CELL_HIGH(dtos);
+			NEXT;
+
+			PRIMITIVE(FORTH_TOKEN_D_Less):	// D<
+				sp[3] = ((forth_sdcell_t)(FORTH_DCELL(sp[0], sp[1])) > (forth_sdcell_t)(FORTH_DCELL(sp[2], sp[3]))) ? FORTH_TRUE : FORTH_FALSE;
+				sp += 3;
+			NEXT;
+
+			PRIMITIVE(FORTH_TOKEN_D_ULess):	// DU<
+				sp[3] = (FORTH_DCELL(sp[0], sp[1]) > FORTH_DCELL(sp[2], sp[3])) ? FORTH_TRUE : FORTH_FALSE;
+				sp += 3;
+			NEXT;
+#endif
+			PRIMITIVE(FORTH_TOKEN_D_Equal):	// D=
+				sp[3] = ((sp[3] == sp[2]) && (sp[1] == sp[0])) ? FORTH_TRUE : FORTH_FALSE;
+				sp += 3;
+			NEXT;
+
+			PRIMITIVE(FORTH_TOKEN_AND):
+				sp[1] &= sp[0];
+				sp++;
+			NEXT;
+
+			PRIMITIVE(FORTH_TOKEN_OR):
+				sp[1] |= sp[0];
+				sp++;
+			NEXT;
+
+			PRIMITIVE(FORTH_TOKEN_XOR):
+				sp[1] ^= sp[0];
+				sp++;
+			NEXT;
+
+			PRIMITIVE(FORTH_TOKEN_CELLS):
+				*sp = sizeof(forth_cell_t) * (*sp);
+			NEXT;
+
+			PRIMITIVE(FORTH_TOKEN_DROP):
+				sp++;
+			NEXT;
+
+			PRIMITIVE(FORTH_TOKEN_2ROT):
+				tos = sp[0];
+				sp[0] = sp[4];
+				sp[4] = sp[2];
+				sp[2] = tos;
+				tos = sp[1];
+				sp[1] = sp[5];
+				sp[5] = sp[3];
+				sp[3] = tos;
+			
+			NEXT;
+
+			PRIMITIVE(FORTH_TOKEN_2DUP):
+				sp -= 2;
+				sp[1] = sp[3];
+				sp[0] = sp[2];
+			NEXT;
+
+			PRIMITIVE(FORTH_TOKEN_2DROP):
+				sp += 2;
+			NEXT;
+
+			PRIMITIVE(FORTH_TOKEN_2OVER):
+				sp -= 2;
+				sp[1] = sp[5];
+				sp[0] = sp[4];
+			NEXT;
+
+			PRIMITIVE(FORTH_TOKEN_2SWAP):
+				tos = sp[0];
+				sp[0] = sp[2];
+				sp[2] = tos;
+				tos = sp[1];
+				sp[1] = sp[3];
+				sp[3] = tos;
+			NEXT;
+
+			PRIMITIVE(FORTH_TOKEN_2Store):	// 2!
+				tos = sp[0];
+				((forth_cell_t *)POINTER(tos))[0] = sp[1];
+				((forth_cell_t *)POINTER(tos))[1] = sp[2];
+				sp += 3;
+			NEXT;
+
+			PRIMITIVE(FORTH_TOKEN_2Fetch):	// 2@
+				tos = sp[0];
+				sp--;
+				sp[0] = ((forth_cell_t *)POINTER(tos))[0];
+				sp[1] = ((forth_cell_t *)POINTER(tos))[1];
+			NEXT;
+
+			PRIMITIVE(FORTH_TOKEN_NtoR):		// N>R
+				tos = POP();
+				rp -= tos;
+				for (i = 0; i < tos; i++)
+				{
+					rp[i] = sp[i];
+				}
+				sp += tos;
+				RPUSH(tos);
+				CHECK_STACKS();
+			NEXT;
+
+			PRIMITIVE(FORTH_TOKEN_NRfrom):	// NR>
+				tos = RPOP();
+				sp -= tos;
+				for (i = 0; i < tos; i++)
+				{
+					sp[i] = rp[i];
+				}
+				rp += tos;
+				PUSH(tos);
+				CHECK_STACKS();
+			NEXT;
+
+
+			PRIMITIVE(FORTH_TOKEN_DUP):
+				sp--;
+				sp[0] = sp[1];
+			NEXT;
+
+			PRIMITIVE(FORTH_TOKEN_qDUP):
+				if (0 != sp[0])
+				{
+					sp--;
+					sp[0] = sp[1];
+				}
+			NEXT;
+
+			PRIMITIVE(FORTH_TOKEN_PAGE):
+				if (0 == rctx->page)
+				{
+					THROW(-21);
+				}
+
+				if (0 > rctx->page(rctx))
+				{
+					THROW(-57);
+				}
+			NEXT;
+
+#if defined(FORTH_INCLUDE_MS)
+			PRIMITIVE(FORTH_TOKEN_MS):
+				rctx->sp = sp;
+				forth_ms(rctx);
+				sp = rctx->sp;
+			NEXT;
+#endif
+
+#if defined(FORTH_INCLUDE_TIME_DATE)
+		PRIMITIVE(FORTH_TOKEN_TIME_DATE):
+			rctx->sp = sp;
+			forth_time_date(rctx);
+			sp = rctx->sp;
+		NEXT;
+#endif
+
+#if defined(FORTH_AOT)
+			PRIMITIVE(FORTH_TOKEN_TRANSLATE_C):	// TRANSLATE-C ( xt c-addr u -- ior )
+				rctx->sp = sp;
+				forth_translate_c(rctx);
+				sp = rctx->sp;
+			NEXT;
+#endif
+
+#if defined(FORTH_IMAGE)
+			PRIMITIVE(FORTH_TOKEN_SAVE_IMAGE):	// SAVE-IMAGE ( c-addr u -- ior )
+				rctx->sp = sp;
+				forth_save_image(rctx);
+				sp = rctx->sp;
+			NEXT;
+#endif
+
+#if defined(FORTH_STACK_EFFECT)
+			PRIMITIVE(FORTH_TOKEN_STACK_EFFECT):	// STACK-EFFECT ( xt -- in out flag )
+				tos = forth_stack_effect(rctx, sp[0]);
+				sp -= 2;
+				sp[2] = FORTH_HEADER_FLAGS_EFFECT_IN(tos);
+				sp[1] = FORTH_HEADER_FLAGS_EFFECT_OUT(tos);
+				sp[0] = (0 != tos) ? FORTH_TRUE : FORTH_FALSE;
+			NEXT;
+#endif
+
+#if defined(FORTH_WORDLIST_INDEX)
+			PRIMITIVE(FORTH_TOKEN_WORDLIST_INDEX):	// WORDLIST-INDEX ( u wid -- )
+				tos = forth_wordlist_index(dictionary, sp[0], sp[1]);
+				sp += 2;
+				if (0 != tos)
+				{
+					THROW(tos);
+				}
+			NEXT;
+#endif
+
+#if defined(FORTH_NAME_SPACE)
+			PRIMITIVE(FORTH_TOKEN_NAME_COMMA):	// (NAME,) ( c-addr len -- ix )
+				tos = forth_name_comma(dictionary, rctx->current, POINTER(sp[1]), sp[0]);
+				if (0 == tos)
+				{
+					THROW(-8);
+				}
+				sp++;
+				sp[0] = tos;
+			NEXT;
+#endif
+
+#if defined(FORTH_NATIVE_INTERPRET)
+			PRIMITIVE(FORTH_TOKEN_INTERPRET):	// (INTERPRET) ( -- xt true | false )
+				rctx->sp = sp;
+				tos = forth_interpret(rctx);
+				sp = rctx->sp;
+				if (0 != tos)
+				{
+					THROW(tos);
+				}
+			NEXT;
+#endif
+
+			PRIMITIVE(FORTH_TOKEN_AT_XY):		// AT-XY ( X Y -- )
+				if (0 == rctx->at_xy)
+				{
+					THROW(-21);
+				}
+
+				if (0 > rctx->at_xy(rctx, sp[1], sp[0]))
+				{
+					THROW(-57);
+				}
+
+				sp += 2;
+			NEXT;
+
+			PRIMITIVE(FORTH_TOKEN_CR):
+				if (0 > rctx->send_cr(rctx))
+				{
+					THROW(-57);
+				}
+			NEXT;
+
+			PRIMITIVE(FORTH_TOKEN_EMIT):
+				tos = POP();
+				c = (char) tos;
+				if (0 > rctx->write_string(rctx, &c, 1))
+				{
+					THROW(-57);
+				}
+			NEXT;
+
+			PRIMITIVE(FORTH_TOKEN_UNUSED):
+				// tos = pctx->dp_max - pctx->dp;
+				tos = dictionary[FORTH_DP_MAX_LOCATION] - dictionary[FORTH_DP_LOCATION];
+				PUSH(tos);
+			NEXT;
+
+			PRIMITIVE(FORTH_TOKEN_DUMP):
+				if (0 > forth_dump(rctx, POINTER(sp[1]), sp[0]))
+				{
+					THROW(-57);
+				}
+				sp += 2;
+			NEXT;
+
+			PRIMITIVE(FORTH_TOKEN_handler):
+				tos = ADDRESS(&(rctx->handler));
+				PUSH(tos);
+			NEXT;
+
+			PRIMITIVE(FORTH_TOKEN_LessHash):	// <#
+				rctx->numbuff_ptr = &(rctx->num_buff[FORTH_NUM_BUFF_LENGTH]);
+			NEXT;
+
+#if !defined(FORTH_NO_DOUBLES)
+			PRIMITIVE(FORTH_TOKEN_Hash):	// #
+				if (0 == rctx->base)
+				{
+					THROW(-10);
+				}
+
+				dtos = FORTH_DCELL(sp[0], sp[1]);
+				*(--(rctx->numbuff_ptr)) = forth_val2digit((forth_byte_t)(dtos % rctx->base));
+				dtos = dtos / rctx->base;
+				sp[1] = FORTH_CELL_LOW(dtos);
+				sp[0] = FORTH_CELL_HIGH(dtos);
+			NEXT;
+#endif
+
+			PRIMITIVE(FORTH_TOKEN_HashGreater):	// #>
+				sp[1] = ADDRESS(rctx->numbuff_ptr);
+				sp[0] = &(rctx->num_buff[FORTH_NUM_BUFF_LENGTH]) - rctx->numbuff_ptr;
+
+			NEXT;
+
+			PRIMITIVE(FORTH_TOKEN_HOLD):
+				*(--(rctx->numbuff_ptr)) = POP();
+			NEXT;
+
+
+			PRIMITIVE(FORTH_TOKEN_Hdot):					// H.
+				tos = POP();
+				if (0 > forth_hdot(rctx, tos))
+				{
+					THROW(-57);
+				}
+			NEXT;
+
+			PRIMITIVE(FORTH_TOKEN_Udot):
+				tos = POP();
+				if (0 > forth_udot(rctx, rctx->base, tos))
+				{
+					THROW(-57);
+				}
+			NEXT;
+
+			PRIMITIVE(FORTH_TOKEN_Dot):
+				tos = POP();
+				if (0 > forth_dot(rctx, rctx->base, tos))
+				{
+					THROW(-57);
+				}
+			NEXT;
+
+			PRIMITIVE(FORTH_TOKEN_DotR):		// .R
+				tos = POP();
+				if (0 > forth_dot_r(rctx, rctx->base, POP(), tos, 1))
+				{
+					THROW(-57);
+				}
+			NEXT;
+
+			PRIMITIVE(FORTH_TOKEN_UdotR):		// U.R
+				tos = POP();
+				if (0 > forth_dot_r(rctx, rctx->base, POP(), tos, 0))
+				{
+					THROW(-57);
+				}
+			NEXT;
+
+			PRIMITIVE(FORTH_TOKEN_DotS):
+				rctx->sp = sp;
+				if (0 > forth_dots(rctx))
+				{
+					THROW(-57);
+				}
+			NEXT;
+
+			PRIMITIVE(FORTH_TOKEN_DotName):	// .name
+				if (0 > forth_show_name(rctx, POP()))
+				{
+					THROW(-57);
+				}
+			NEXT;
+
+			PRIMITIVE(FORTH_TOKEN_CMOVE):
+				tos = POP();
+				dest = POINTER(POP());
+				src = POINTER(POP());
+				for (i = 0; i < tos; i++)
+				{
+					dest[i] = src[i];
+				}
+			NEXT;
+
+			PRIMITIVE(FORTH_TOKEN_CMOVE_down):	// cmove>
+				tos = POP();
+				dest = POINTER(POP());
+				src = POINTER(POP());
+				for (i = tos - 1; i  >= 0; i++)
+				{
+					dest[i] = src[i];
+				}
+			NEXT;
+
+			PRIMITIVE(FORTH_TOKEN_FILL):	// ( addr count char -- )
+				if (0 != sp[1])
+				{
+					memset(POINTER(sp[2]), (int)sp[0], sp[1]);
+				}
+				sp += 3;
+			NEXT;
+
+			PRIMITIVE(FORTH_TOKEN_MOVE):	// src dest count
+				// void *memcpy(void *dest, const void *src, size_t n);
+				if (0 != sp[0])
+				{
+					memmove(POINTER(sp[1]), POINTER(sp[2]), sp[0]);
+				}
+				sp += 3;
+			NEXT;
+
+			PRIMITIVE(FORTH_TOKEN_LATEST):
+				FORTH_FIND_CACHE_INVALIDATE(rctx);	// Headers are linked and made IMMEDIATE through LATEST.
+				tos = ADDRESS(&((struct forth_wordlist *)(&dictionary[rctx->current]))->latest);
+				PUSH(tos);
+			NEXT;
+
+			PRIMITIVE(FORTH_TOKEN_pDefining):	// (DEFINING)
+				PUSH(ADDRESS(&(rctx->defining)));
+			NEXT;
+
+			PRIMITIVE(FORTH_TOKEN_TUCK):
+				tos = sp[0];
+				sp--;
+				sp[0] = sp[1];
+				sp[1] = sp[2];
+				sp[2] = tos;
+			NEXT;
+
+			PRIMITIVE(FORTH_TOKEN_PICK):
+				sp[0] = sp[sp[0] + 1];
+			NEXT;
+
+			PRIMITIVE(FORTH_TOKEN_ROLL):
+				i = POP();
+				if (i)
+				{
+					tos = sp[i];
+					while(i)
+					{
+						sp[i] = sp[i - 1];
+						i--;
+					}
+					sp[0] = tos;
+				}
+			NEXT;
+
+			PRIMITIVE(FORTH_TOKEN_ROT):
+				tos = sp[2];
+				sp[2] = sp[1];
+				sp[1] = sp[0];
+				sp[0] = tos;
+			NEXT;
+
+			PRIMITIVE(FORTH_TOKEN_NIP):
+				sp[1] = sp[0];
+				sp++;
+			NEXT;
+
+			PRIMITIVE(FORTH_TOKEN_OVER):
+				--sp;
+				sp[0] = sp[2];
+			NEXT;
+
+			PRIMITIVE(FORTH_TOKEN_TYPE):
+				tos = POP();
+				if (0 > rctx->write_string(rctx, POINTER(POP()), tos))
+				{
+					THROW(-57);
+				}
+			NEXT;
+
+			PRIMITIVE(FORTH_TOKEN_EXECUTE):
+				xt = POP();
+				CHECK_STACKS();
+			DISPATCH();
+
+			PRIMITIVE(FORTH_TOKEN_SEARCH_WORDLIST): // SEARCH-WORDLIST
+				// static forth_cell_t forth_search_wordlist(forth_cell_t dictionary[], struct forth_wordlist *wl, const char *name, forth_cell_t len)
+				tos = forth_search_wordlist(dictionary, (struct forth_wordlist *)(&dictionary[sp[0]]), POINTER(sp[2]), sp[1]);
+				sp += 3;
+
+				if (FORTH_TRUE == tos)	// All bits '1'-s.
+				{
+					PUSH(0);
+				}
+				else
+				{
+					PUSH(tos + (sizeof(struct forth_header) / sizeof(forth_cell_t)));
+
+					if (((struct forth_header *)(&dictionary[tos]))->flags & FORTH_HEADER_FLAGS_IMMEDIATE)
+					{
+						PUSH(1);
+					}
+					else
+					{
+						PUSH(-1);
+					}
+					
+				}
+			NEXT;
+
+			PRIMITIVE(FORTH_TOKEN_COMPARE):
+				sp[3] = forth_compare_strings(POINTER(sp[3]), sp[2], POINTER(sp[1]), sp[0]);
+				sp += 3;
+			NEXT;
+
+			PRIMITIVE(FORTH_TOKEN_FIND_WORD):	// FIND-WORD ( caddr count -- 0 | xt 1 | xt -1 )
+				tos = POP();
+				tos = forth_find_word(rctx, dictionary, POINTER(POP()), tos);
+				if (FORTH_TRUE == tos)	// All bits '1'-s.
+				{
+					PUSH(0);
+				}
+				else
+				{
+					PUSH(tos + (sizeof(struct forth_header) / sizeof(forth_cell_t)));
+
+					if (((struct forth_header *)(&dictionary[tos]))->flags & FORTH_HEADER_FLAGS_IMMEDIATE)
+					{
+						PUSH(1);
+					}
+					else
+					{
+						PUSH(-1);
+					}
+					
+				}
+			NEXT;
+
+			PRIMITIVE(FORTH_TOKEN_CFetch):				// C@
+				*sp = CHAR_AT(*sp);
+			NEXT;
+
+			PRIMITIVE(FORTH_TOKEN_CStore):				// c!
+				CHAR_AT(*sp) = (char)(sp[1]);
+				sp+= 2;
+			NEXT;
+
+			PRIMITIVE(FORTH_TOKEN_PlusStore):				// +!
+				tos = POP();
+				CELL_AT(tos) += POP();
+			NEXT;
+
+			PRIMITIVE(FORTH_TOKEN_Fetch):					// @
+				*sp = CELL_AT(*sp);
+			NEXT;
+
+			PRIMITIVE(FORTH_TOKEN_Store):					// !
+				CELL_AT(*sp) = sp[1];
+				sp+= 2;
+			NEXT;
+
+			PRIMITIVE(FORTH_TOKEN_PARSE):
+				tos = POP();
+				rctx->sp = sp;
+				forth_parse(rctx, tos);
+				sp = rctx->sp;
+			NEXT;
+
+			PRIMITIVE(FORTH_TOKEN_PARSE_WORD):
+				rctx->sp = sp;
+				forth_parse_word(rctx, FORTH_CHAR_SPACE);
+				sp = rctx->sp;
+			NEXT;
+
+			PRIMITIVE(FORTH_TOKEN_WORD):
+				tos = POP();
+				rctx->sp = sp;
+				forth_parse_word(rctx, (char)tos);
+				sp = rctx->sp;
+				if (sp[0] > 255)
+				{
+					THROW(-18);
+				}
+				// tos = FORTH_ALIGN(pctx->dp) + 4 * sizeof(forth_cell_t);
+				tos = ADDRESS(((char *)dictionary) + FORTH_ALIGN(dictionary[FORTH_DP_LOCATION]) + 4 * sizeof(forth_cell_t));
+				CHAR_AT(tos) = (char)(sp[0]);
+				memmove(POINTER(tos + 1), POINTER(sp[1]), sp[0]);
+				sp++;
+				sp[0] = tos;
+			NEXT;
+
+			PRIMITIVE(FORTH_TOKEN_Plus):
+				tos = POP();
+				*sp += tos;
+			NEXT;
+
+			PRIMITIVE(FORTH_TOKEN_toR):
+				tos = POP();
+				RPUSH(tos);
+			NEXT;
+
+			PRIMITIVE(FORTH_TOKEN_Rfrom):
+				tos = RPOP();
+				PUSH(tos);
+			NEXT;
+
+			PRIMITIVE(FORTH_TOKEN_Rfetch):
+				tos = *rp;
+				PUSH(tos);
+			NEXT;
+
+			PRIMITIVE(FORTH_TOKEN_2toR):
+				RPUSH(sp[1]);
+				RPUSH(sp[0]);
+				sp += 2;
+			NEXT;
+
+			PRIMITIVE(FORTH_TOKEN_2Rfrom):
+				sp -= 2;
+				sp[0] = RPOP();
+				sp[1] = RPOP();
+			NEXT;
+
+			PRIMITIVE(FORTH_TOKEN_2Rfetch):
+				sp -= 2;
+				sp[0] = rp[0];	// Check!
+				sp[1] = rp[1];
+			NEXT;
+
+			PRIMITIVE(FORTH_TOKEN_PROCESS_NUMBER):
+				tos = POP();
+				rctx->sp = sp + 1;
+				tos = (forth_cell_t)forth_process_number(rctx, POINTER(*sp), tos);
+				sp = rctx->sp;
+				if ((forth_scell_t)tos < 0)
+				{
+					THROW(-24);
+				}
+			NEXT;
+
+#if !defined(FORTH_NO_DOUBLES)
+			PRIMITIVE(FORTH_TOKEN_toNUMBER):	// >NUMBER
+				dtos = FORTH_DCELL(sp[2], sp[3]);
+
+				while(0 != sp[0])
+				{
+					tos = map_digit(CHAR_AT(sp[1]));
+
+					if (tos >= rctx->base)
+					{
+						break;
+					}
+
+					dtos = (dtos * rctx->base) + tos;
+					sp[0]--;
+					sp[1]++;
+				}
+				sp[3] = FORTH_CELL_LOW(dtos);
+				sp[2] = FORTH_CELL_HIGH(dtos);
+			NEXT;
+#endif
+
+			PRIMITIVE(FORTH_TOKEN_BLK):		// BLK
+				PUSH(ADDRESS(&(rctx->blk)));
+			NEXT;
+
+			PRIMITIVE(FORTH_TOKEN_TIB):		// TIB
+				PUSH(ADDRESS(&(rctx->tib)));
+			
+			NEXT;
+
+			PRIMITIVE(FORTH_TOKEN_HashTIB):	// #TIB
+				PUSH(ADDRESS(&(rctx->tib_count)));
+			NEXT;
+
+			PRIMITIVE(FORTH_TOKEN_BASE):
+				PUSH(ADDRESS(&(rctx->base)));
+			NEXT;
+	
+			PRIMITIVE(FORTH_TOKEN_pSOURCE_ID):	// (SOURCE-ID)
+				PUSH(ADDRESS(&(rctx->source_id)));
+			NEXT;
+	
+			PRIMITIVE(FORTH_TOKEN_SOURCE):
+				PUSH(ADDRESS(rctx->source_address));
+				PUSH(rctx->source_length);
+			NEXT;
+
+			PRIMITIVE(FORTH_TOKEN_SOURCE_Store):	// SOURCE!
+				rctx->source_length = POP();
+				rctx->source_address = POINTER(POP());
+			NEXT;
+
+#if defined(FORTH_INCLUDE_FILE_ACCESS_WORDS)
+			PRIMITIVE(FORTH_TOKEN_LINE_NUMBER):	 // LINE-NUMBER ( line number inside a file).
+				PUSH(ADDRESS(&(rctx->line_no)));
+			NEXT;
+#endif
+			PRIMITIVE(FORTH_TOKEN_toIN):	// >IN
+				PUSH(ADDRESS(&(rctx->to_in)));
+			NEXT;
+
+			PRIMITIVE(FORTH_TOKEN_SAVE_INPUT):	// SAVE-INPUT
+				if (0 != rctx->blk)
+				{
+					THROW(-21);	// We currently do not implement blocks, so this should never happen.
+				}
+				else if ((0 == rctx->source_id) || (-1 == rctx->source_id))
+				{
+					PUSH(rctx->to_in);
+					PUSH(1);
+				}
+				else
+				{
+					PUSH(rctx->to_in);
+#if defined(FORTH_INCLUDE_FILE_ACCESS_WORDS)
+					PUSH(rctx->line_no);
+					PUSH(FORTH_CELL_LOW(rctx->source_file_position));
+					PUSH(FORTH_CELL_HIGH(rctx->source_file_position));
+					PUSH(4);
+#else
+					PUSH(1);
+#endif
+				}
+			NEXT;
+
+			PRIMITIVE(FORTH_TOKEN_RESTORE_INPUT): // RESTORE-INPUT
+				// puts("------ RESTORE-INPUT ---------");
+				if (0 != rctx->blk)
+				{
+					THROW(-21);	// We currently do not implement blocks, so this should never happen.
+				}
+				else if ( ((0 == rctx->source_id) || (-1 == rctx->source_id)) && (1 == sp[0]))	// Terminal and EVALUTATE only needs >IN restored.
+				{
+					rctx->to_in = sp[1];
+					sp++;
+					sp[0] = 0;
+					
+				}
+#if defined(FORTH_INCLUDE_FILE_ACCESS_WORDS)
+				else if (((0 != rctx->source_id) && (-1 != rctx->source_id)) && (4 == sp[0]))	// Files have postion line_no and >IN
+				{
+					sp[0] = rctx->source_id;
+					rctx->sp = sp;
+					forth_reposition_file(rctx);
+					sp = rctx->sp;
+					tos = POP();
+
+					if (0 != tos)	// Can't reposition -- RESTORE-INPUT has failed.
+					{
+						sp[0] = FORTH_TRUE;
+					}
+					else
+					{
+						rctx->sp = sp;
+						forth_refill_file(rctx);	// Bring in the correct line and set >IN = 0.
+						sp = rctx->sp;
+						rctx->line_no = sp[1];	// Restore line_no to its saved state.
+						rctx->to_in = sp[2];	// Restore >IN to its saved value.
+						sp[2] = sp[0] ? 0 : FORTH_TRUE;
+						sp += 2;
+					}
+				}
+#endif
+				else	// Don't know what is going on, failed.
+				{
+					sp += sp[0];
+					sp[0] = FORTH_TRUE;
+				}
+
+			NEXT;
+
+
+			PRIMITIVE(FORTH_TOKEN_STATE):
+				PUSH(ADDRESS(&(rctx->state)));
+			NEXT;
+
+			PRIMITIVE(FORTH_TOKEN_QUERY):
+				tos = forth_query(rctx);
+
+				if (0 > (forth_scell_t)tos)
+				{
+					THROW(-57);
+				}
+			NEXT;
+
+			PRIMITIVE(FORTH_TOKEN_REFILL):
+				if (0 == rctx->source_id)
+				{
+					tos = forth_query(rctx);
+
+					if (0 > (forth_scell_t)tos)
+					{
+						PUSH(0);
+					}
+					else
+					{
+						PUSH(FORTH_TRUE);
+					}
+				}
+				else if (-1 == rctx->source_id)
+				{
+					PUSH(0);
+				}
+				else
+				{
+#if defined(FORTH_INCLUDE_FILE_ACCESS_WORDS)
+					rctx->sp = sp;
+					forth_refill_file(rctx);
+					sp = rctx->sp;
+					if (0 != sp[0])
+					{
+						rctx->line_no++;
+					}
+#else
+					PUSH(0);
+#endif
+				}
+			NEXT;
+
+			PRIMITIVE(FORTH_TOKEN_SWAP):
+				// printf("sp=%p\n", sp); fflush(stdout);
+				tos = sp[0];
+				sp[0] = sp[1];
+				sp[1] = tos;
+			NEXT;
+
+			PRIMITIVE(FORTH_TOKEN_THROW):
+				tos = *sp;
+
+				if (tos)
+				{
+					if (0 == rctx->handler)
+					{
+						rctx->sp = sp;
+						rctx->rp = rp;
+						rctx->ip = RETURN_ADDRESS;
+						return -1;
+					}
+
+					rp = (forth_cell_t *)POINTER(rctx->handler);
+					rctx->handler = RPOP();
+					sp = (forth_cell_t *)POINTER(RPOP());
+					*sp = tos;
+					ip = RPOP();
+					RETURNED(SWITCH_CODE());
+				} 
+				else
+				{
+					sp++;
+				}
+			NEXT;
+
+			PRIMITIVE(FORTH_TOKEN_DotError):
+				tos = POP();
+				rctx->sp = sp;
+				forth_print_error(rctx, (forth_scell_t)tos);
+				sp = rctx->sp;
+			NEXT;
+
+			PRIMITIVE(FORTH_TOKEN_BYE):
+				rctx->sp = sp;
+				rctx->rp = rp;
+				rctx->ip = RETURN_ADDRESS;
+				return 0;
+			NEXT;
+
+			PRIMITIVE(FORTH_TOKEN_WORDS):
+				if (0 > forth_words(dictionary, rctx))
+				{
+					THROW(-57);
+				}
+			NEXT;
+
+			PRIMITIVE(FORTH_TOKEN_ENVIRONMENTq):	// ENVIRONMENT?
+				rctx->sp = sp;
+				forth_query_environment(rctx);
+				sp = rctx->sp;
+			NEXT;
+
+			PRIMITIVE(FORTH_TOKEN_pSEE):	// (SEE) ( xt -- )
+				if (0 > forth_see(rctx, dictionary, POP()))
+				{
+					THROW(-57);
+				}
+			NEXT;
+
+			PRIMITIVE(FORTH_TOKEN_ONLY):
+				FORTH_FIND_CACHE_INVALIDATE(rctx);
+				rctx->wordlists[rctx->wordlist_slots - 1] = FORTH_WID_Root_WORDLIST;
+				rctx->wordlists[rctx->wordlist_slots - 2] = FORTH_WID_Root_WORDLIST;
+				rctx->wordlist_cnt = 2;
+			NEXT;
+			
+			PRIMITIVE(FORTH_TOKEN_ALSO):
+				if (rctx->wordlist_cnt == rctx->wordlist_slots)
+				{
+					THROW(-49);
+				}
+
+				FORTH_FIND_CACHE_INVALIDATE(rctx);
+				rctx->wordlist_cnt++;
+				rctx->wordlists[rctx->wordlist_slots - rctx->wordlist_cnt] = rctx->wordlists[(rctx->wordlist_slots - rctx->wordlist_cnt) + 1];
+			NEXT;
+
+			PRIMITIVE(FORTH_TOKEN_GET_ORDER):
+				tos = rctx->wordlist_cnt;
+
+				for(i = 1; i <= tos; i++)
+				{
+					PUSH(rctx->wordlists[rctx->wordlist_slots - i]);
+				}
+
+				PUSH(rctx->wordlist_cnt);
+				CHECK_STACKS();
+			NEXT;
+
+			PRIMITIVE(FORTH_TOKEN_SET_ORDER):
+				tos = POP();
+
+				if (-1 == (forth_scell_t)tos)
+				{
+					xt = FORTH_TOKEN_ONLY;
+					DISPATCH();
+				}
+
+				if (tos > rctx->wordlist_slots)
+				{
+					THROW(-49);
+				}
+
+				FORTH_FIND_CACHE_INVALIDATE(rctx);
+				rctx->wordlist_cnt = tos;
+
+				for(i = tos; i >= 1; i--)
+				{
+					rctx->wordlists[rctx->wordlist_slots - i] = POP();
+				}
+			NEXT;
+
+			PRIMITIVE(FORTH_TOKEN_CURRENT):
+				FORTH_FIND_CACHE_INVALIDATE(rctx);	// SET-CURRENT
+				PUSH(ADDRESS(&(rctx->current)));
+			NEXT;
+
+			PRIMITIVE(FORTH_TOKEN_CONTEXT):
+					FORTH_FIND_CACHE_INVALIDATE(rctx);
+					PUSH(ADDRESS(&(rctx->wordlists[rctx->wordlist_slots - rctx->wordlist_cnt])));
+			NEXT;
+
+			PRIMITIVE(FORTH_TOKEN_Less):		// <
+				tos = POP();
+				sp[0] = (((forth_scell_t)(sp[0])) < ((forth_scell_t)tos)) ? FORTH_TRUE : FORTH_FALSE;
+			NEXT;
+
+			PRIMITIVE(FORTH_TOKEN_Greater):	// >
+				tos = POP();
+				sp[0] = (((forth_scell_t)(sp[0])) > ((forth_scell_t)tos)) ? FORTH_TRUE : FORTH_FALSE;
+			NEXT;
+
+			PRIMITIVE(FORTH_TOKEN_ULess):		// u<
+				tos = POP();
+				sp[0] = (sp[0] < tos) ? FORTH_TRUE : FORTH_FALSE;
+			NEXT;
+
+			PRIMITIVE(FORTH_TOKEN_UGreater):	// u>
+				tos = POP();
+				sp[0] = (sp[0] > tos) ? FORTH_TRUE : FORTH_FALSE;
+			NEXT;
+
+			PRIMITIVE(FORTH_TOKEN_Equal):		// =
+				tos = POP();
+				sp[0] = (sp[0] == tos) ? FORTH_TRUE : FORTH_FALSE;
+			NEXT;
+
+			PRIMITIVE(FORTH_TOKEN_Notequal):	// <>
+				tos = POP();
+				sp[0] = (sp[0] != tos) ? FORTH_TRUE : FORTH_FALSE;
+			NEXT;
+
+			PRIMITIVE(FORTH_TOKEN_0Equal):
+				sp[0] = (0 == sp[0]) ? FORTH_TRUE : FORTH_FALSE;
+			NEXT;
+
+			PRIMITIVE(FORTH_TOKEN_0Notequal):
+				sp[0] = (0 != sp[0]) ? FORTH_TRUE : FORTH_FALSE;
+			NEXT;
+
+			PRIMITIVE(FORTH_TOKEN_0Less):		// 0<
+				sp[0] = (((forth_scell_t)(sp[0])) < 0) ? FORTH_TRUE : FORTH_FALSE;
+			NEXT;
+
+			PRIMITIVE(FORTH_TOKEN_0Greater):	// 0>
+				sp[0] = (((forth_scell_t)(sp[0])) > 0) ? FORTH_TRUE : FORTH_FALSE;
+			NEXT;
+
+
+			PRIMITIVE(FORTH_TOKEN_LITERAL):
+				tos = forth_compile_literal(rctx, POP());
+				if (0 != tos)
+				{
+					THROW(tos);
+				}
+			NEXT;
+
+			PRIMITIVE(FORTH_TOKEN_sp0):
+				PUSH(ADDRESS(rctx->sp0));
+			NEXT;
+
+			PRIMITIVE(FORTH_TOKEN_sp_fetch):
+				tos = ADDRESS(sp);
+				PUSH(tos);
+			NEXT;
+
+			PRIMITIVE(FORTH_TOKEN_sp_store):
+				tos = POP();
+				sp = (forth_cell_t *)POINTER(tos);
+				CHECK_STACKS();
+			NEXT;
+
+			PRIMITIVE(FORTH_TOKEN_rp0):
+				PUSH(ADDRESS(rctx->rp0));
+			NEXT;
+
+			PRIMITIVE(FORTH_TOKEN_rp_fetch):
+				PUSH(ADDRESS(rp));
+			NEXT;
+
+			PRIMITIVE(FORTH_TOKEN_rp_store):
+				rp = (forth_cell_t *)POINTER(POP());
+				CHECK_STACKS();
+			NEXT;
+
+			PRIMITIVE(FORTH_TOKEN_abort_msg):		// (abort-msg) -- to hold the string for ABORT".
+				PUSH(ADDRESS(&(rctx->abort_msg_len)));
+			NEXT;
+
+			// This is not in any standard. Intended to be an implementation detail to resolve all branches.
+			PRIMITIVE(FORTH_TOKEN_resolve_branch):	// resolve-branch ( orig-sys dest -- )
+				tos = sp[1];
+				tos &= FORTH_SYS_ID_MASK;
+				// printf("Before: dictionary[tos = %08x] = %08x\n", tos, dictionary[tos]);
+				// dictionary[tos] |=  FORTH_PARAM_PACK((((pctx->dp - (forth_cell_t)pctx->dictionary) / sizeof(forth_cell_t)) - (tos + 1)));
+				dictionary[tos] |=  FORTH_PARAM_PACK(((sp[0] & FORTH_SYS_ID_MASK) - (tos + 1)));
+				// printf("After:  dictionary[tos = %08x] = %08x\n", tos, dictionary[tos]);
+				sp += 2;
+			NEXT;
+
+			PRIMITIVE(FORTH_TOKEN_ix2address):	// IX>ADDRESS
+				*sp = ADDRESS(&(dictionary[*sp]));
+			NEXT;
+
+			PRIMITIVE(FORTH_TOKEN_toBODY):	// >BODY
+				tos = *sp;
+				if (FORTH_PACK_TOKEN(FORTH_TOKEN_docreate) != dictionary[tos])
+				{
+					THROW(-31);
+				}
+
+				*sp = ADDRESS(&dictionary[tos + 2]);
+			NEXT;
+/*
+// For DO-LOOPs
+#define LOOP_I rp[0]
+#define LOOP_J rp[3]
+#define LOOP_LIMIT   rp[1]
+#define LOOP_ADDRESS_AFTER rp[2]
+#define LOOP_ADJUSTMENT 3
+*/
+			PRIMITIVE(FORTH_TOKEN_pDO):		// (DO)
+				tos = ip + SIGNED_PARAMETER;
+				rp -= LOOP_ADJUSTMENT;
+				LOOP_I = POP();
+				LOOP_LIMIT = POP();
+				LOOP_ADDRESS_AFTER = tos;
+				CHECK_STACKS();
+			NEXT;
+
+			PRIMITIVE(FORTH_TOKEN_pqDO):	 	// (?DO)
+				tos = ip + SIGNED_PARAMETER;
+
+				if (sp[0] != sp[1])
+				{
+					rp -= LOOP_ADJUSTMENT;
+					LOOP_I = POP();
+					LOOP_LIMIT = POP();
+					LOOP_ADDRESS_AFTER = tos;
+				}
+				else
+				{
+					sp += 2;
+					ip = tos;
+				}
+			// printf("ip=%08x\n", ip);
+				CHECK_STACKS();
+			NEXT;
+
+			PRIMITIVE(FORTH_TOKEN_UNLOOP):	// UNLOOP
+				rp += LOOP_ADJUSTMENT;
+				CHECK_STACKS();
+			NEXT;
+
+			PRIMITIVE(FORTH_TOKEN_LEAVE):		// LEAVE
+				ip = LOOP_ADDRESS_AFTER;
+				rp += LOOP_ADJUSTMENT;
+				CHECK_STACKS();
+			NEXT;
+
+			PRIMITIVE(FORTH_TOKEN_I):		// I
+				PUSH(LOOP_I);
+			NEXT;
+
+			PRIMITIVE(FORTH_TOKEN_J):		// J
+				PUSH(LOOP_J);
+			NEXT;
+
+			PRIMITIVE(FORTH_TOKEN_pLOOP):		// (LOOP)
+				LOOP_I += 1;
+
+				if (LOOP_I == LOOP_LIMIT)
+				{
+					rp += LOOP_ADJUSTMENT;
+				}
+				else
+				{
+					ip += SIGNED_PARAMETER;
+				}
+				CHECK_STACKS();
+			NEXT;
+
+			PRIMITIVE(FORTH_TOKEN_pPlusLOOP):	// (+LOOP)
+				tos = POP();
+
+				LOOP_I += tos;
+
+				if (0 > (forth_scell_t)((LOOP_I - LOOP_LIMIT) ^ tos))	// Some 2's complement's trickery.
+				{
+					ip += SIGNED_PARAMETER;
+				}
+				else
+				{
+					rp += LOOP_ADJUSTMENT;
+				}
+				CHECK_STACKS();
+			NEXT;
+
+
+
+			PRIMITIVE(FORTH_TOKEN_branch):
+				ip += SIGNED_PARAMETER;
+				CHECK_STACKS();
+			NEXT;
+
+			PRIMITIVE(FORTH_TOKEN_0branch):
+				if (0 == POP())
+				{
+					ip += SIGNED_PARAMETER;
+				}
+				CHECK_STACKS();
+			NEXT;
+
+			PRIMITIVE(FORTH_TOKEN_xtlit):			// eXecution Token literal.
+			PRIMITIVE(FORTH_TOKEN_lit):			// Full sized literal.
+				PUSH(INLINE_CELL());
+			NEXT;
+
+			PRIMITIVE(FORTH_TOKEN_sslit):			// Litaral encoded in the token, signed.
+				PUSH(SIGNED_PARAMETER);
+			NEXT;
+
+			PRIMITIVE(FORTH_TOKEN_uslit):			// Literal encoded in the token, unsigned.
+				PUSH(UNSIGNED_PARAMETER);
+			NEXT;
+
+			PRIMITIVE(FORTH_TOKEN_strlit):		// String literal, length encoded in the token.
+				PUSH(INLINE_ADDRESS());
+				tos = UNSIGNED_PARAMETER;
+				PUSH(tos);
+				INLINE_SKIP(tos);
+			NEXT;
+
+			PRIMITIVE(FORTH_TOKEN_nest):
+				RPUSH(RETURN_ADDRESS);
+				ip = w + 1;
+				CHECK_STACKS();
+				RUN_CELLS(SWITCH_CODE());
+			NEXT;
+
+#if defined(FORTH_COMPACT_CODE)
+			PRIMITIVE(FORTH_TOKEN_compact):		// nest into a body of 16 bit units.
+				RPUSH(RETURN_ADDRESS);
+				ip = FORTH_COMPACT_BODY(w);
+				CHECK_STACKS();
+				RUN_COMPACT(SWITCH_CODE());
+			NEXT;
+#endif
+
+			PRIMITIVE(FORTH_TOKEN_EXIT):	// Same as unnest
+			PRIMITIVE(FORTH_TOKEN_unnest):
+				ip = RPOP();
+				CHECK_STACKS();
+				RETURNED(SWITCH_CODE());
+#if defined(FORTH_ENGINE_TRACING)
+				if (!rctx->trace)	// Tracing was turned off, returns are safe points to go back to the fast engine.
+				{
+					SWITCH_ENGINE();
+				}
+#endif
+			NEXT;
+
+#if defined(FORTH_INCLUDE_FILE_ACCESS_WORDS)
+			PRIMITIVE(FORTH_TOKEN_FILE_CREATE):		// CREATE-FILE
+				rctx->sp = sp;
+				forth_create_file(rctx);
+				sp = rctx->sp;
+			NEXT;
+
+			PRIMITIVE(FORTH_TOKEN_FILE_OPEN):		// OPEN-FILE
+				rctx->sp = sp;
+				forth_open_file(rctx);
+				sp = rctx->sp;
+			NEXT;
+
+			PRIMITIVE(FORTH_TOKEN_FILE_FLUSH):		// FLUSH-FILE
+				rctx->sp = sp;
+				forth_file_flush(rctx);
+				sp = rctx->sp;
+			NEXT;
+
+			PRIMITIVE(FORTH_TOKEN_FILE_DELETE):		// DELETE-FILE
+				rctx->sp = sp;
+				forth_delete_file(rctx);
+				sp = rctx->sp;
+			NEXT;
+
+			PRIMITIVE(FORTH_TOKEN_FILE_REPOSITION): 	// REPOSITION-FILE
+				rctx->sp = sp;
+				forth_reposition_file(rctx);
+				sp = rctx->sp;
+			NEXT;
+
+			PRIMITIVE(FORTH_TOKEN_FILE_POSITION): 	// FILE-POSITION
+				rctx->sp = sp;
+				forth_file_position(rctx);
+				sp = rctx->sp;
+			NEXT;
+
+			PRIMITIVE(FORTH_TOKEN_FILE_SIZE):		// FILE-SIZE
+				rctx->sp = sp;
+				forth_file_size(rctx);
+				sp = rctx->sp;
+			NEXT;
+
+			PRIMITIVE(FORTH_TOKEN_FILE_READ):		// READ-FILE
+				rctx->sp = sp;
+				forth_read_file(rctx);
+				sp = rctx->sp;
+			NEXT;
+
+			PRIMITIVE(FORTH_TOKEN_FILE_READ_LINE):	// READ-LINE
+				rctx->sp = sp;
+				forth_read_line(rctx);
+				sp = rctx->sp;
+			NEXT;
+
+			PRIMITIVE(FORTH_TOKEN_FILE_WRITE):		// WRITE-FILE
+				rctx->sp = sp;
+				forth_write_file(rctx);
+				sp = rctx->sp;
+			NEXT;
+
+			PRIMITIVE(FORTH_TOKEN_FILE_WRITE_LINE):	// WRITE-LINE
+				rctx->sp = sp;
+				forth_write_line(rctx);
+				sp = rctx->sp;
+			NEXT;
+
+
+			PRIMITIVE(FORTH_TOKEN_FILE_CLOSE):		// CLOSE-FILE
+				rctx->sp = sp;
+				forth_close_file(rctx);
+				sp = rctx->sp;
+			NEXT;
+
+#endif
+
+#if defined(FORTH_INCLUDE_MEMORY_ALLOCATION_WORDS)
+			PRIMITIVE(FORTH_TOKEN_ALLOCATE):
+				rctx->sp = sp;
+				forth_allocate(rctx);
+				sp = rctx->sp;
+			NEXT;
+
+			PRIMITIVE(FORTH_TOKEN_RESIZE):
+				rctx->sp = sp;
+				forth_resize(rctx);
+				sp = rctx->sp;
+			NEXT;
+
+			PRIMITIVE(FORTH_TOKEN_FREE):
+				rctx->sp = sp;
+				forth_free(rctx);
+				sp = rctx->sp;
+			NEXT;
+
+#endif
+			PRIMITIVE(FORTH_TOKEN_dovar):
+				PUSH(ADDRESS(&dictionary[w + 1]));
+			NEXT;
+
+			PRIMITIVE(FORTH_TOKEN_doconst):
+				PUSH(dictionary[w + 1]);
+			NEXT;
+
+#if defined(FORTH_EXTERNAL_PRIMITIVES)
+			PRIMITIVE(FORTH_TOKEN_doextern):
+				if (0 == rctx->external_primitive_table)
+				{
+					THROW(-21);
+				}
+
+				ep = rctx->external_primitive_table[dictionary[w + 1]];
+
+				if (0 == ep)
+				{
+					THROW(-21);
+				}
+
+				rctx->sp = sp;
+				tos = ep(rctx);
+				sp = rctx->sp;
+
+				if (0 != tos)
+				{
+					THROW(tos);
+				}
+				CHECK_STACKS();
+			NEXT;
+#endif
+
+#if defined(FORTH_USER_VARIABLES)
+			PRIMITIVE(FORTH_TOKEN_USER_ALLOT):	// USER-ALLOT ( n -- ix )
+				tos = sp[0];
+
+				if ((dictionary[FORTH_UP_LOCATION] + tos) >= dictionary[FORTH_MAX_UP_LOCATION])
+				{
+					THROW(-8);
+				}
+
+				sp[0] = dictionary[FORTH_UP_LOCATION];
+				dictionary[FORTH_UP_LOCATION] += tos;
+			NEXT;
+
+			PRIMITIVE(FORTH_TOKEN_douser):
+				PUSH(ADDRESS(&(rctx->user[UNSIGNED_PARAMETER])));
+			NEXT;
+#endif
+
+			PRIMITIVE(FORTH_TOKEN_docreate):
+				PUSH(ADDRESS(&dictionary[w + 2]));
+				xt = dictionary[w + 1];
+				CHECK_STACKS();
+			DISPATCH();
+
+			// Superinstructions.
+			PRIMITIVE(FORTH_TOKEN_OVER_Plus):	// OVER +
+				sp[0] += sp[1];
+			NEXT;
+
+			PRIMITIVE(FORTH_TOKEN_DUP_0Equal):	// DUP 0=
+				sp--;
+				sp[0] = (0 == sp[1]) ? FORTH_TRUE : FORTH_FALSE;
+			NEXT;
+
+			PRIMITIVE(FORTH_TOKEN_Fetch_Plus):	// @ +
+				tos = CELL_AT(POP());
+				sp[0] += tos;
+			NEXT;
+
+			PRIMITIVE(FORTH_TOKEN_Rfrom_DROP):	// R> DROP
+				rp++;
+			NEXT;
+
+			PRIMITIVE(FORTH_TOKEN_I_Plus):		// I +
+				sp[0] += LOOP_I;
+			NEXT;
+
+			// Compare and branch.
+			PRIMITIVE(FORTH_TOKEN_Equal_0branch):	// = 0branch
+				tos = POP();
+				if (POP() != tos)
+				{
+					ip += SIGNED_PARAMETER;
+				}
+				CHECK_STACKS();
+			NEXT;
+
+			PRIMITIVE(FORTH_TOKEN_Notequal_0branch):	// <> 0branch
+				tos = POP();
+				if (POP() == tos)
+				{
+					ip += SIGNED_PARAMETER;
+				}
+				CHECK_STACKS();
+			NEXT;
+
+			PRIMITIVE(FORTH_TOKEN_Less_0branch):	// < 0branch
+				tos = POP();
+				if (((forth_scell_t)POP()) >= ((forth_scell_t)tos))
+				{
+					ip += SIGNED_PARAMETER;
+				}
+				CHECK_STACKS();
+			NEXT;
+
+			PRIMITIVE(FORTH_TOKEN_Greater_0branch):	// > 0branch
+				tos = POP();
+				if (((forth_scell_t)POP()) <= ((forth_scell_t)tos))
+				{
+					ip += SIGNED_PARAMETER;
+				}
+				CHECK_STACKS();
+			NEXT;
+
+			PRIMITIVE(FORTH_TOKEN_ULess_0branch):	// u< 0branch
+				tos = POP();
+				if (POP() >= tos)
+				{
+					ip += SIGNED_PARAMETER;
+				}
+				CHECK_STACKS();
+			NEXT;
+
+			PRIMITIVE(FORTH_TOKEN_UGreater_0branch):	// u> 0branch
+				tos = POP();
+				if (POP() <= tos)
+				{
+					ip += SIGNED_PARAMETER;
+				}
+				CHECK_STACKS();
+			NEXT;
+
+			PRIMITIVE(FORTH_TOKEN_0Equal_0branch):	// 0= 0branch
+				tos = POP();
+				if (0 != tos)
+				{
+					ip += SIGNED_PARAMETER;
+				}
+				CHECK_STACKS();
+			NEXT;
+
+			PRIMITIVE(FORTH_TOKEN_0Notequal_0branch):	// 0<> 0branch
+				tos = POP();
+				if (0 == tos)
+				{
+					ip += SIGNED_PARAMETER;
+				}
+				CHECK_STACKS();
+			NEXT;
+
+			PRIMITIVE(FORTH_TOKEN_0Less_0branch):	// 0< 0branch
+				tos = POP();
+				if (((forth_scell_t)tos) >= 0)
+				{
+					ip += SIGNED_PARAMETER;
+				}
+				CHECK_STACKS();
+			NEXT;
+
+			PRIMITIVE(FORTH_TOKEN_0Greater_0branch):	// 0> 0branch
+				tos = POP();
+				if (((forth_scell_t)tos) <= 0)
+				{
+					ip += SIGNED_PARAMETER;
+				}
+				CHECK_STACKS();
+			NEXT;
+
+			PRIMITIVE(FORTH_TOKEN_tailcall):		// nest without the RPUSH, unnest of the callee returns to our caller.
+				w = INLINE_CELL();
+#if defined(FORTH_COMPACT_CODE)
+				if (FORTH_PACK_TOKEN(FORTH_TOKEN_compact) == dictionary[w])
+				{
+					ip = FORTH_COMPACT_BODY(w);
+					CHECK_STACKS();
+					RUN_COMPACT(SWITCH_CODE());
+					NEXT;
+				}
+#endif
+				ip = w + 1;
+				CHECK_STACKS();
+				RUN_CELLS(SWITCH_CODE());
+			NEXT;
+
+			PRIMITIVE(FORTH_TOKEN_inlined):		// The xt is only there for SEE.
+				(void)INLINE_CELL();
+			NEXT;
+
+			PRIMITIVE(FORTH_TOKEN_native):		// The body of w has been compiled to machine code.
+#if defined(FORTH_JIT)
+				rctx->sp = sp;
+				rctx->rp = rp;
+				forth_jit_run(rctx, UNSIGNED_PARAMETER);
+				sp = rctx->sp;
+				rp = rctx->rp;
+#else
+				RPUSH(RETURN_ADDRESS);	// Never compiled without the JIT, run the body like nest.
+				ip = w + 1;
+				RUN_CELLS(SWITCH_CODE());
+#endif
+				CHECK_STACKS();
+			NEXT;
+
+			PRIMITIVE(FORTH_TOKEN_compiled):	// The body of w has been translated to C by TRANSLATE-C.
+#if defined(FORTH_AOT)
+				if (0 == rctx->aot_table)
+				{
+					THROW(-21);
+				}
+
+				rctx->sp = sp;
+				rctx->rp = rp;
+				tos = rctx->aot_table[UNSIGNED_PARAMETER](rctx);
+				sp = rctx->sp;
+				rp = rctx->rp;
+
+				if (0 != tos)
+				{
+					THROW(tos);
+				}
+#else
+				RPUSH(RETURN_ADDRESS);	// Never installed without FORTH_AOT, run the body like nest.
+				ip = w + 1;
+				RUN_CELLS(SWITCH_CODE());
+#endif
+				CHECK_STACKS();
+			NEXT;
+
+			DEFAULT_PRIMITIVE:
+				forth_type0(rctx, "Unknown token: ");
+				forth_hdot(rctx, xt);
+				rctx->send_cr(rctx);
+				return -1;
+			NEXT;
+		}
+
+		RELOAD();
+		FETCH();
+		// printf("w=0x%08x\n", w); fflush(stdout);
+#if defined(FORTH_STACK_CHECK_ENABLED)
+		continue;
+
+	stack_error:	// From TOS_CHECK_STACKS() and CHECK_STACKS(), the stack is in its cached form.
+		if (STACK_TOP_ADDRESS < rctx->sp_min)
+		{
+			STACK_TOP = -3;
+		} else if (STACK_TOP_ADDRESS > rctx->sp_max)
+		{
+			STACK_TOP = -4;
+		} else if (rp < rctx->rp_min)
+		{
+			STACK_TOP = -5;
+		} else
+		{
+			STACK_TOP = -6;
+		}
+		w = 0;
+		xt = FORTH_PACK_TOKEN(FORTH_TOKEN_THROW);
+#endif
+	}
+
+}
+
+// Everything below is defined again for the other variant.
+#undef ADDRESS
+#undef CELL_AT
+#undef CHAR_AT
+#undef CHECK_STACKS
+#undef DEFAULT_PRIMITIVE
+#undef DISPATCH
+#undef DISPATCH_TABLE
+#undef LOOP_ADDRESS_AFTER
+#undef LOOP_ADJUSTMENT
+#undef LOOP_I
+#undef LOOP_J
+#undef LOOP_LIMIT
+#undef NEXT
+#undef POP
+#undef POINTER
+#undef PRIMITIVE
+#undef PRIMITIVE_ADDRESS
+#undef PUSH
+#undef RELOAD
+#undef RPOP
+#undef RPUSH
+#undef SIGNED_PARAMETER
+#undef SPILL
+#undef STACKS_IN_BOUNDS
+#undef STACK_TOP
+#undef STACK_TOP_ADDRESS
+#undef THROW
+#undef TOKEN_INDEX
+#undef TOS_CHECK_STACKS
+#undef TOS_DISPATCH
+#undef TOS_NEXT
+#undef TOS_PRIMITIVE
+#undef TOS_PRIMITIVE_ADDRESS
+#undef UNSIGNED_PARAMETER
+#undef TRACING
+#undef SWITCH_ENGINE
+#undef FETCH
+#undef FETCH_CELL
+#undef FETCH_COMPACT
+#undef INLINE_ADDRESS
+#undef INLINE_CELL
+#undef INLINE_SKIP
+#undef RETURN_ADDRESS
+#undef RETURNED
+#undef RUN_CELLS
+#undef RUN_COMPACT
+#undef SWITCH_CODE
+#undef TOS_SWITCH_CODE
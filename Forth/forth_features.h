@@ -52,6 +52,128 @@
 #	endif
 #endif
 
+// Dispatch primitives with GCC's labels as values (computed goto) instead of one big switch statement.
+// The switch based engine is used with other compilers, or when this is undefined.
+// #undef FORTH_COMPUTED_GOTO_ENGINE
+#if defined(__GNUC__)
+#	define FORTH_COMPUTED_GOTO_ENGINE 1
+#endif
+
+// Keep the top of the data stack in a register in the inner interpreter.
+// #undef FORTH_TOS_CACHING
+#define FORTH_TOS_CACHING 1
+
+// Let COMPILE, fuse frequent pairs of tokens (OVER + , DUP 0= , etc.) into single tokens.
+// #undef FORTH_PEEPHOLE_OPTIMIZER
+#define FORTH_PEEPHOLE_OPTIMIZER 1
+
+// Let ; turn a call to a colon definition right before it into a jump (tailcall) that does not grow the return stack.
+// #undef FORTH_TAIL_CALL_OPTIMIZER
+#define FORTH_TAIL_CALL_OPTIMIZER 1
+
+// COMPILE, copies colon definitions made of at most this many primitives (cells) inline instead of calling them.
+// #undef FORTH_INLINE_THRESHOLD
+#define FORTH_INLINE_THRESHOLD 4
+
+// Evaluate pure primitives applied to literals while compiling, 4 CELLS + becomes a single imm+ 16.
+// The value is the number of pending literals remembered.
+// #undef FORTH_CONSTANT_FOLDING
+#define FORTH_CONSTANT_FOLDING 4
+
+// Let ; translate colon definitions into x86-64 machine code (forth_jit_x86_64.c), needs memfd_create() and mmap() for the code.
+// Words using anything without a machine code template stay token threaded. The templates work on 32 bit cells.
+// #undef FORTH_JIT
+#if defined(__x86_64__) && defined(__GNUC__) && defined(__linux__) && !defined(FORTH_64BIT)
+#	define FORTH_JIT 1
+#endif
+
+// TRANSLATE-C writes colon definitions out as C functions (forth_aot.c) that can be linked back into the application.
+// #undef FORTH_AOT
+#if defined(FORTH_INCLUDE_FILE_ACCESS_WORDS)
+#	define FORTH_AOT 1
+#endif
+
+// INTERPRET is a loop around (INTERPRET), a primitive that parses, looks words up, converts numbers and compiles in C,
+// only the words to be executed go back to the engine. Without it INTERPRET is written in Forth (gen_dict.c).
+// #undef FORTH_NATIVE_INTERPRET
+#define FORTH_NATIVE_INTERPRET 1
+
+// Let ; work out the stack effect of colon definitions and keep it in the header, STACK-EFFECT ( xt -- in out flag ) shows it.
+// #undef FORTH_STACK_EFFECT
+#define FORTH_STACK_EFFECT 1
+
+// Forth addresses are byte offsets from rctx->arena instead of C pointers, so 32 bit cells work in a 64 bit process.
+// The host has to put everything Forth can address in one arena: the run time context (TIB, BASE, USER variables...),
+// the dictionary, the stacks, the search order and the ALLOCATE heap (see main_test_stdio.c).
+// #undef FORTH_ARENA
+#if defined(__LP64__) && !defined(FORTH_64BIT)
+#	define FORTH_ARENA 1
+#endif
+
+// SAVE-IMAGE writes the dictionary and the search order to a file, forth_load_image() (forth_image.c) maps it back into
+// the dictionary of a host built the same way with one mmap(MAP_PRIVATE), or reads it if the dictionary is not page aligned.
+// #undef FORTH_IMAGE
+#if defined(FORTH_INCLUDE_FILE_ACCESS_WORDS) && defined(__linux__)
+#	define FORTH_IMAGE 1
+#endif
+
+// Let WORDLIST-INDEX ( u wid -- ) give a wordlist a hash table of u cells in the dictionary, SEARCH-WORDLIST and FIND-WORD
+// look names up in it instead of walking the chain of headers (forth.c).
+// #undef FORTH_WORDLIST_INDEX
+#define FORTH_WORDLIST_INDEX 1
+
+// Let gen_dict make a perfect hash of the names in ROOT-WORDLIST and FORTH-WORDLIST, so that finding a kernel word
+// takes one probe once the words defined at run time have been looked at.
+// #undef FORTH_KERNEL_NAME_HASH
+#define FORTH_KERNEL_NAME_HASH 1
+
+// Keep the names of definitions and the links between them in a name space at the top of the
+// dictionary that grows down towards the code (FORTH_DP_MAX_LOCATION is its bottom). Headers in the code space are just the
+// index of the name and the flags, looking a name up only touches the densely packed names.
+// Every definition takes two more cells than in the classic layout.
+#undef FORTH_NAME_SPACE
+// #define FORTH_NAME_SPACE 1
+
+// The host may reserve a large dictionary (FORTH_DP_MAX_LOCATION) of which only the first FORTH_DP_COMMIT_LOCATION bytes
+// are backed by memory, ALLOT , C, and the compiler call forth_dictionary_commit() (forth_posix.c) to commit more as HERE
+// grows past it. main_test_stdio.c reserves 1 GB with mmap(PROT_NONE). Does not work with the name space at the top.
+// #undef FORTH_GROWABLE_DICTIONARY
+#if defined(__linux__) && !defined(FORTH_NAME_SPACE)
+#	define FORTH_GROWABLE_DICTIONARY 1
+#endif
+
+// gen_dict lays the kernel down as const data (forth_kernel[], whole pages of FORTH_KERNEL_PAGE bytes) and moves the cells the
+// kernel changes at run time (HERE, the kernel wordlists, WID-LINK, USER-VARIABLES) to the start of a RAM overlay
+// (forth_kernel_ram[]) that follows it in the dictionary, definitions go after that. forth_kernel_share() (forth_posix.c)
+// maps the kernel read only into a page aligned dictionary, so processes and contexts share its pages,
+// forth_kernel_copy() (forth_interface.c) copies it into any dictionary. The last page of the kernel is padded, so it is only
+// on by default with the mmap()-ed dictionaries of FORTH_GROWABLE_DICTIONARY.
+// #undef FORTH_KERNEL_ROM
+#if defined(__GNUC__) && defined(FORTH_GROWABLE_DICTIONARY)
+#	define FORTH_KERNEL_ROM 1
+#	define FORTH_KERNEL_PAGE 4096
+#endif
+
+// forth_arena_create() (forth_posix.c) backs the arena with a memfd, forth_fork() maps it again copy-on-write and returns
+// a copy of the run time context in it, so short lived contexts can define words without changing the dictionary they
+// started from and are thrown away with forth_fork_release().
+// #undef FORTH_FORK
+#if defined(FORTH_ARENA) && defined(__linux__)
+#	define FORTH_FORK 1
+#endif
+
+// ; translates colon definitions into 16 bit units (forth_compact.c) that index a table of this many cells in the
+// dictionary, cells that do not fit in the table are escaped, branch offsets count units. The kernel stays cell threaded,
+// the engine is included twice more to run compact code. Return addresses into compact code are tagged, words that
+// change their return address with R> and >R only work in cell threaded code. Saves memory when the JIT is off.
+#undef FORTH_COMPACT_CODE
+// #define FORTH_COMPACT_CODE 1024
+
+// FIND-WORD remembers the headers it found in a direct mapped cache of this many (a power of two) entries in the run time
+// context. Linking headers (LATEST), IMMEDIATE and changes to the search order or CURRENT start a new generation of it.
+// #undef FORTH_FIND_CACHE
+#define FORTH_FIND_CACHE 256
+
 #undef FORTH_DISABLE_COMPILER
 // #define FORTH_DISABLE_COMPILER 1
 
@@ -69,6 +191,7 @@
 // #undef FORTH_EXTERNAL_PRIMITIVES
 #define FORTH_EXTERNAL_PRIMITIVES 1
 
+// Check the stack bounds on calls, returns, branches and loops (not before every primitive), THROW-ing -3 .. -6.
 #define FORTH_STACK_CHECK_ENABLED
 
 #undef FORTH_APPLICATION_DEFINED_CONTEXT_FIELDS 
@@ -128,7 +128,7 @@ static void forth_open_or_create_file(struct forth_runtime_context *rctx, forth_
 
 	fam = POP();
 	cnt = POP();
-	fname = (char *)(POP());
+	fname = FORTH_POINTER(rctx->arena, POP());
 	mode = map_fam2map(fam, create);
 
 	int slot;
@@ -192,7 +192,7 @@ void forth_delete_file(struct forth_runtime_context *rctx)
 	char *cname;
 
 	cnt = POP();
-	fname = (char *)(POP());
+	fname = FORTH_POINTER(rctx->arena, POP());
 	cname = FORTH_ALLOCATE_CNAME(fname, cnt);
 	if (0 > remove(cname))
 	{
@@ -354,7 +354,7 @@ void forth_read_line(struct forth_runtime_context *rctx)
 	struct forth_file *f = get_slot(POP());
 	forth_cell_t cnt = POP();
 	forth_cell_t read;
-	char *addr = (char *)(POP());
+	char *addr = FORTH_POINTER(rctx->arena, POP());
 	char *res;
 
 	if (0 == f)
@@ -385,7 +385,7 @@ void forth_read_file(struct forth_runtime_context *rctx)
 	struct forth_file *f = get_slot(POP());
 	forth_cell_t cnt = POP();
 	forth_scell_t read;
-	char *addr = (char *)(POP());
+	char *addr = FORTH_POINTER(rctx->arena, POP());
 
 	if (0 == f)
 	{
@@ -416,7 +416,7 @@ void forth_write_file(struct forth_runtime_context *rctx)
 	forth_scell_t res;
 	struct forth_file *f = get_slot(POP());
 	forth_cell_t cnt = POP();
-	char *addr = (char *)(POP());
+	char *addr = FORTH_POINTER(rctx->arena, POP());
 
 	if (0 == f)
 	{
@@ -434,7 +434,7 @@ void forth_write_line(struct forth_runtime_context *rctx)
 	forth_cell_t i;
 	struct forth_file *f = get_slot(POP());
 	forth_cell_t cnt = POP();
-	char *addr = (char *)(POP());
+	char *addr = FORTH_POINTER(rctx->arena, POP());
 
 	if (0 == f)
 	{
@@ -475,19 +475,12 @@ void forth_close_file(struct forth_runtime_context *rctx)
 	}
 }
 	
-// Map the FID to a file name. If there is no such FID return 0 0, otherwise return c-addr len.
-void forth_map_fid_to_name(struct forth_runtime_context *rctx)
+// Map the FID to the file name it was opened with, 0 if there is no such FID.
+const char *forth_fid_to_name(forth_cell_t fid)
 {
-	struct forth_file *f = get_slot(POP());
+	struct forth_file *f = get_slot(fid);
 
-	if ((0 == f) || (0 == f->name))
-	{
-		PUSH(0);
-		PUSH(0);
-	}
-	
-	PUSH(f->name);
-	PUSH(strlen(f->name));
+	return (0 == f) ? 0 : f->name;
 }
 
 #endif
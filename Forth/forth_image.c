@@ -0,0 +1,430 @@
+/*
+* Copyright (c) 2026 The Embeddable Forth Command Interpreter contributors
+*
+* Permission is hereby granted, free of charge, to any person obtaining a copy
+* of this software and associated documentation files (the "Software"), to deal
+* in the Software without restriction, including without limitation the rights
+* to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+* copies of the Software, and to permit persons to whom the Software is
+* furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in
+* all copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+* AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+* THE SOFTWARE.
+*
+*/
+
+// http://forth.teleonomix.com/
+
+// SAVE-IMAGE and forth_load_image() (FORTH_IMAGE).
+//
+// An image file is a header in the first page(s), then the dictionary from cell 0 (from the RAM overlay with
+// FORTH_KERNEL_ROM, the kernel is left where it is) up to HERE (or all of it with FORTH_NAME_SPACE) at a page aligned
+// offset, padded to whole pages, then the xts of the words that were compiled to machine code. The code fields of those
+// are saved as nest, the loader compiles them again. The checksum covers the dictionary and the xts.
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include "forth.h"
+#include "forth_internal.h"
+#include "forth_interface.h"
+#include "forth_dict.h"
+
+#if defined(FORTH_IMAGE)
+
+#define POP() *(rctx->sp++)
+#define PUSH(X) *(--(rctx->sp)) = (forth_cell_t)(X)
+
+#define FORTH_IMAGE_MAGIC	"EFCIIMG"	// With the terminating 0 it fills magic[].
+#define FORTH_IMAGE_VERSION	1		// Change it if the layout of the file changes.
+#define FORTH_IMAGE_ORDER	16		// Wordlists in the search order that an image can hold.
+#define FORTH_IMAGE_BUFFER	4096		// Bytes read at a time to work out the checksum.
+
+#if defined(FORTH_USER_VARIABLES)
+#	define FORTH_IMAGE_USER_VARIABLES	FORTH_USER_VARIABLES
+#else
+#	define FORTH_IMAGE_USER_VARIABLES	0
+#endif
+
+// Round SIZE up to whole pages of PAGE bytes (a power of two).
+#define FORTH_IMAGE_PAGES(SIZE, PAGE)	(((SIZE) + (PAGE) - 1) & ~((forth_cell_t)(PAGE) - 1))
+
+// Bytes of the dictionary in the image with header H.
+#define FORTH_IMAGE_BYTES(H)		((H)->extent - (H)->base)
+
+// Is the arena of RCTX a memfd that forth_fork() maps? Mapping the image over it would hide it from the forks.
+#if defined(FORTH_FORK)
+#	define FORTH_IMAGE_SHARED(RCTX)	forth_arena_shared((RCTX)->arena)
+#else
+#	define FORTH_IMAGE_SHARED(RCTX)	0
+#endif
+
+struct forth_image_header
+{
+	char		magic[8];		// FORTH_IMAGE_MAGIC
+	uint32_t	version;		// FORTH_IMAGE_VERSION
+	uint32_t	cell_size;		// sizeof(forth_cell_t)
+	uint32_t	checksum;		// FNV-1a of the dictionary and the xts after it.
+	uint32_t	reserved;
+	forth_cell_t	engine;			// FORTH_ENGINE_VERSION
+	forth_cell_t	tokens;			// FORTH_TOKEN_COUNT
+	forth_cell_t	dictionary_size;	// FORTH_DICTIONARY_SIZE
+	forth_cell_t	kernel_dp;		// FORTH_DP_VALUE and FORTH_LATEST_VALUE, the kernel has to be the same.
+	forth_cell_t	kernel_latest;
+	forth_cell_t	user_variables;		// FORTH_USER_VARIABLES
+	forth_cell_t	address;		// The Forth address of the dictionary, addresses in it are only right there.
+	forth_cell_t	base;			// The first byte of the dictionary in the file.
+	forth_cell_t	extent;			// The dictionary is in the file up to here (bytes).
+	forth_cell_t	offset;			// The dictionary starts here in the file, a multiple of the page size.
+	forth_cell_t	native;			// The number of xts after the dictionary.
+	forth_cell_t	current;		// CURRENT
+	forth_cell_t	order_cnt;		// The search order, the bottom first.
+	forth_cell_t	order[FORTH_IMAGE_ORDER];
+};
+
+// FNV-1a, the same hash as the names.
+static uint32_t forth_image_hash(uint32_t hash, const void *p, size_t len)
+{
+	const unsigned char *c = (const unsigned char *)p;
+
+	while (0 != len--)
+	{
+		hash = FORTH_HASH_STEP(hash, *c++);
+	}
+
+	return hash;
+}
+
+// Write len bytes to out and fold them into the checksum.
+static void forth_image_write(FILE *out, uint32_t *hash, const void *p, size_t len)
+{
+	*hash = forth_image_hash(*hash, p, len);
+	fwrite(p, 1, len, out);
+}
+
+// Write zeros up to position to in the file.
+static void forth_image_pad(FILE *out, forth_cell_t to)
+{
+	long pos = ftell(out);
+
+	while ((0 <= pos) && (pos++ < (long)to))
+	{
+		fputc(0, out);
+	}
+}
+
+// Fill in the signature of this system, the host's dictionary and search order.
+static void forth_image_header(struct forth_runtime_context *rctx, struct forth_image_header *h)
+{
+	memset(h, 0, sizeof(*h));
+	memcpy(h->magic, FORTH_IMAGE_MAGIC, sizeof(h->magic));
+	h->version = FORTH_IMAGE_VERSION;
+	h->cell_size = sizeof(forth_cell_t);
+	h->engine = FORTH_ENGINE_VERSION;
+	h->tokens = FORTH_TOKEN_COUNT;
+	h->dictionary_size = FORTH_DICTIONARY_SIZE;
+	h->kernel_dp = FORTH_DP_VALUE;
+	h->kernel_latest = FORTH_LATEST_VALUE;
+	h->user_variables = FORTH_IMAGE_USER_VARIABLES;
+	h->address = FORTH_ADDRESS(rctx->arena, rctx->dictionary);
+	h->offset = FORTH_IMAGE_PAGES(sizeof(*h), sysconf(_SC_PAGESIZE));
+#if defined(FORTH_KERNEL_ROM)
+	h->base = FORTH_KERNEL_ROM_CELLS * sizeof(forth_cell_t);
+#endif
+}
+
+#if defined(FORTH_JIT)
+// Turn the code fields of the words compiled to machine code back into nest, returns how many there were.
+static forth_cell_t forth_image_unjit(forth_cell_t dictionary[])
+{
+	forth_cell_t cnt = 0;
+	forth_cell_t ix;
+	forth_cell_t xt;
+
+	for (ix = 0; 0 != (xt = forth_jit_xt(ix)); ix++)
+	{
+		if ((FORTH_PACK_TOKEN(FORTH_TOKEN_native) | FORTH_PARAM_PACK(ix)) == dictionary[xt])
+		{
+			dictionary[xt] = FORTH_PACK_TOKEN(FORTH_TOKEN_nest);
+			cnt++;
+		}
+	}
+
+	return cnt;
+}
+
+// Write the xts that forth_image_unjit() changed and make them native again.
+static void forth_image_rejit(FILE *out, uint32_t *hash, forth_cell_t dictionary[])
+{
+	forth_cell_t ix;
+	forth_cell_t xt;
+
+	for (ix = 0; 0 != (xt = forth_jit_xt(ix)); ix++)
+	{
+		if (FORTH_PACK_TOKEN(FORTH_TOKEN_nest) == dictionary[xt])
+		{
+			forth_image_write(out, hash, &xt, sizeof(xt));
+			dictionary[xt] = FORTH_PACK_TOKEN(FORTH_TOKEN_native) | FORTH_PARAM_PACK(ix);
+		}
+	}
+}
+#endif
+
+// SAVE-IMAGE ( c-addr u -- ior )
+void forth_save_image(struct forth_runtime_context *rctx)
+{
+	forth_cell_t cnt = POP();
+	char *fname = FORTH_POINTER(rctx->arena, POP());
+	forth_cell_t *dictionary = rctx->dictionary;
+	forth_cell_t page = sysconf(_SC_PAGESIZE);
+	struct forth_image_header h;
+	uint32_t hash = FORTH_NAME_HASH_BASIS;
+	forth_cell_t ior = 0;
+	forth_cell_t i;
+	FILE *out;
+	char *cname;
+
+	if (FORTH_IMAGE_ORDER < rctx->wordlist_cnt)
+	{
+		PUSH(-50);	// Search-order overflow.
+		return;
+	}
+
+	forth_image_header(rctx, &h);
+#if defined(FORTH_NAME_SPACE)
+	h.extent = FORTH_DICTIONARY_SIZE * sizeof(forth_cell_t);
+#else
+	h.extent = FORTH_ALIGN(dictionary[FORTH_DP_LOCATION]);
+#endif
+	h.current = rctx->current;
+	h.order_cnt = rctx->wordlist_cnt;
+	for (i = 0; i < h.order_cnt; i++)
+	{
+		h.order[i] = rctx->wordlists[rctx->wordlist_slots - 1 - i];
+	}
+
+	cname = FORTH_ALLOCATE_CNAME(fname, cnt);
+	out = (0 != cname) ? fopen(cname, "wb") : 0;
+	FORTH_FREE_CNAME(cname);
+
+	if (0 == out)
+	{
+		PUSH(-37);
+		return;
+	}
+
+	forth_image_pad(out, h.offset);
+#if defined(FORTH_JIT)
+	h.native = forth_image_unjit(dictionary);
+#endif
+	forth_image_write(out, &hash, ((char *)dictionary) + h.base, FORTH_IMAGE_BYTES(&h));
+	forth_image_pad(out, h.offset + FORTH_IMAGE_PAGES(FORTH_IMAGE_BYTES(&h), page));
+#if defined(FORTH_JIT)
+	forth_image_rejit(out, &hash, dictionary);
+#endif
+	h.checksum = hash;
+
+	if ((0 != fseek(out, 0, SEEK_SET)) || (1 != fwrite(&h, sizeof(h), 1, out)) || ferror(out))
+	{
+		ior = -37;
+	}
+	if (EOF == fclose(out))
+	{
+		ior = -37;
+	}
+
+	PUSH(ior);
+}
+
+// Bytes of the host's dictionary that an image may fill.
+static forth_cell_t forth_image_room(forth_cell_t dictionary[])
+{
+#if defined(FORTH_NAME_SPACE)
+	return FORTH_DICTIONARY_SIZE * sizeof(forth_cell_t);
+#elif defined(FORTH_GROWABLE_DICTIONARY)
+	return FORTH_IMAGE_PAGES(dictionary[FORTH_DP_MAX_LOCATION], sysconf(_SC_PAGESIZE));
+#else
+	return dictionary[FORTH_DP_MAX_LOCATION];
+#endif
+}
+
+// Is the image made by the same kernel for a dictionary at the same place, does it fit?
+static int forth_image_valid(struct forth_runtime_context *rctx, const struct forth_image_header *h)
+{
+	struct forth_image_header ours;
+
+	forth_image_header(rctx, &ours);
+
+	return (0 == memcmp(h->magic, ours.magic, sizeof(ours.magic)))
+		&& (h->version == ours.version)
+		&& (h->cell_size == ours.cell_size)
+		&& (h->engine == ours.engine)
+		&& (h->tokens == ours.tokens)
+		&& (h->dictionary_size == ours.dictionary_size)
+		&& (h->kernel_dp == ours.kernel_dp)
+		&& (h->kernel_latest == ours.kernel_latest)
+		&& (h->user_variables == ours.user_variables)
+		&& (h->address == ours.address)
+		&& (h->offset >= sizeof(*h))
+		&& (h->base == ours.base)
+		&& (h->extent >= (FORTH_DP_VALUE * sizeof(forth_cell_t)))
+		&& (h->extent <= forth_image_room(rctx->dictionary))
+		&& (h->order_cnt <= FORTH_IMAGE_ORDER)
+		&& (h->order_cnt <= rctx->wordlist_slots);
+}
+
+// Fold len bytes of the file from position at into the checksum, returns 0 if they could not be read.
+static int forth_image_read_hash(int fd, uint32_t *hash, off_t at, forth_cell_t len)
+{
+	char buffer[FORTH_IMAGE_BUFFER];
+	ssize_t got;
+
+	while (0 != len)
+	{
+		got = pread(fd, buffer, (len < sizeof(buffer)) ? len : sizeof(buffer), at);
+		if (0 >= got)
+		{
+			return 0;
+		}
+		*hash = forth_image_hash(*hash, buffer, got);
+		at += got;
+		len -= got;
+	}
+
+	return 1;
+}
+
+// Does the checksum match what is in the file?
+static int forth_image_checked(int fd, const struct forth_image_header *h)
+{
+	forth_cell_t page = sysconf(_SC_PAGESIZE);
+	uint32_t hash = FORTH_NAME_HASH_BASIS;
+
+	return forth_image_read_hash(fd, &hash, h->offset, FORTH_IMAGE_BYTES(h))
+		&& forth_image_read_hash(fd, &hash, h->offset + FORTH_IMAGE_PAGES(FORTH_IMAGE_BYTES(h), page), h->native * sizeof(forth_cell_t))
+		&& (hash == h->checksum);
+}
+
+// Bring the dictionary in from the file, with one mmap() if it is page aligned and whole pages of it fit, unless it is
+// shared with forks (FORTH_FORK). FORTH_DP_MAX_LOCATION (and FORTH_DP_COMMIT_LOCATION) keep the host's values.
+static int forth_image_map(forth_cell_t dictionary[], int fd, const struct forth_image_header *h, int shared)
+{
+	forth_cell_t page = sysconf(_SC_PAGESIZE);
+	forth_cell_t length = FORTH_IMAGE_PAGES(FORTH_IMAGE_BYTES(h), page);
+	char *at = ((char *)dictionary) + h->base;
+#if !defined(FORTH_NAME_SPACE)
+	forth_cell_t dp_max = dictionary[FORTH_DP_MAX_LOCATION];
+#endif
+#if defined(FORTH_GROWABLE_DICTIONARY)
+	forth_cell_t commit = dictionary[FORTH_DP_COMMIT_LOCATION];
+#endif
+	forth_cell_t done;
+	ssize_t got;
+
+	if (!shared && (0 == ((uintptr_t)at & (page - 1))) && (0 == (h->offset & (page - 1))) && ((h->base + length) <= forth_image_room(dictionary)))
+	{
+		if ((void *)at != mmap(at, length, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_FIXED, fd, h->offset))
+		{
+			return -1;
+		}
+#if defined(FORTH_GROWABLE_DICTIONARY)
+		if (commit < (h->base + length))
+		{
+			commit = h->base + length;
+		}
+#endif
+	}
+	else
+	{
+#if defined(FORTH_GROWABLE_DICTIONARY)
+		if ((h->extent > commit) && (0 != forth_dictionary_commit(dictionary, h->extent)))
+		{
+			return -1;
+		}
+		commit = dictionary[FORTH_DP_COMMIT_LOCATION];
+#endif
+		for (done = 0; done < FORTH_IMAGE_BYTES(h); done += got)
+		{
+			got = pread(fd, at + done, FORTH_IMAGE_BYTES(h) - done, h->offset + done);
+			if (0 >= got)
+			{
+				return -1;
+			}
+		}
+	}
+
+#if !defined(FORTH_NAME_SPACE)
+	dictionary[FORTH_DP_MAX_LOCATION] = dp_max;
+#endif
+#if defined(FORTH_GROWABLE_DICTIONARY)
+	dictionary[FORTH_DP_COMMIT_LOCATION] = commit;
+	if (((h->extent + FORTH_DICTIONARY_SCRATCH) > commit) && (0 != forth_dictionary_commit(dictionary, h->extent + FORTH_DICTIONARY_SCRATCH)))
+	{
+		return -1;	// PAD and WORD are past HERE.
+	}
+#endif
+	return 0;
+}
+
+// Load an image written by SAVE-IMAGE (see forth_interface.h).
+forth_cell_t forth_load_image(struct forth_runtime_context *rctx, const char *file_name)
+{
+	struct forth_image_header h;
+	forth_cell_t ior = -37;
+	forth_cell_t i;
+	int fd = open(file_name, O_RDONLY);
+#if defined(FORTH_JIT)
+	forth_cell_t page = sysconf(_SC_PAGESIZE);
+	forth_cell_t xt;
+#endif
+
+	if (0 > fd)
+	{
+		return -38;
+	}
+
+	if ((sizeof(h) == pread(fd, &h, sizeof(h), 0)) && forth_image_valid(rctx, &h) && forth_image_checked(fd, &h)
+		&& (0 == forth_image_map(rctx->dictionary, fd, &h, FORTH_IMAGE_SHARED(rctx))))
+	{
+		rctx->wordlist_cnt = h.order_cnt;
+		for (i = 0; i < h.order_cnt; i++)
+		{
+			rctx->wordlists[rctx->wordlist_slots - 1 - i] = h.order[i];
+		}
+		rctx->current = h.current;
+		rctx->peephole = 0;
+#if defined(FORTH_CONSTANT_FOLDING)
+		rctx->literal_cnt = 0;
+#endif
+		FORTH_FIND_CACHE_INVALIDATE(rctx);
+
+#if defined(FORTH_JIT)
+		for (i = 0; i < h.native; i++)
+		{
+			if ((sizeof(xt) == pread(fd, &xt, sizeof(xt), h.offset + FORTH_IMAGE_PAGES(FORTH_IMAGE_BYTES(&h), page) + i * sizeof(xt)))
+				&& (xt >= (h.base / sizeof(forth_cell_t))) && (xt < (h.extent / sizeof(forth_cell_t))))
+			{
+				forth_jit_compile(rctx, xt);
+			}
+		}
+#endif
+		ior = 0;
+	}
+
+	close(fd);
+	return ior;
+}
+
+#endif
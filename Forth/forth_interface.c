@@ -27,13 +27,24 @@
 #include "forth_interface.h"
 #include "forth_dict.h"
 
+#if defined(FORTH_KERNEL_ROM)
+// Copy the kernel and the start of the RAM overlay into dictionary.
+void forth_kernel_copy(forth_cell_t dictionary[])
+{
+	memcpy(dictionary, forth_kernel, sizeof(forth_kernel));
+	memcpy(&dictionary[FORTH_KERNEL_ROM_CELLS], forth_kernel_ram, sizeof(forth_kernel_ram));
+}
+#endif
+
 #if defined(FORTH_EXTERNAL_PRIMITIVES)
+#if !defined(FORTH_NAME_SPACE)
 static forth_cell_t forth_align_dp(forth_cell_t *dictionary)
 {
 	forth_cell_t dp = FORTH_ALIGN(dictionary[FORTH_DP_LOCATION]);
 	dictionary[FORTH_DP_LOCATION] = dp;
 	return dp / sizeof(forth_cell_t);
 }
+#endif
 
 static forth_cell_t forth_allot(forth_cell_t *dictionary, forth_cell_t byte_count)
 {
@@ -52,8 +63,10 @@ static forth_cell_t forth_here(forth_cell_t *dictionary)
 forth_cell_t forth_create_name(struct forth_runtime_context *rctx, const char *name)
 {
 	size_t len;
+#if !defined(FORTH_NAME_SPACE)
 	forth_cell_t start_ix;
 	void *start_address;
+#endif
 	forth_cell_t header_ix;
 	forth_cell_t *dictionary = rctx->dictionary;
 
@@ -74,6 +87,15 @@ forth_cell_t forth_create_name(struct forth_runtime_context *rctx, const char *n
 		return -19;	// Definition name too long.
 	}
 
+#if defined(FORTH_NAME_SPACE)
+	header_ix = forth_name_comma(dictionary, rctx->current, name, len);
+	return (0 == header_ix) ? -8 : 0;	// Dictionary overflow.
+#else
+	if (!FORTH_DICTIONARY_ROOM(dictionary, FORTH_ALIGN(dictionary[FORTH_DP_LOCATION]) + FORTH_ALIGN(len) + (2 * sizeof(forth_cell_t))))
+	{
+		return -8;	// Dictionary overflow.
+	}
+
 	start_ix = forth_align_dp(dictionary);
 	start_address = (void *)&dictionary[forth_here(dictionary)];
 	forth_allot(dictionary, len);
@@ -84,6 +106,7 @@ forth_cell_t forth_create_name(struct forth_runtime_context *rctx, const char *n
 	dictionary[header_ix] = ((struct forth_wordlist *)(&dictionary[rctx->current]))->latest;
 	dictionary[header_ix + 1] = len;
 	return 0;
+#endif
 }
 
 forth_cell_t forth_register_external_primitive(struct forth_runtime_context *rctx, const char *name, forth_cell_t index)
@@ -97,6 +120,11 @@ forth_cell_t forth_register_external_primitive(struct forth_runtime_context *rct
 		return res;
 	}
 
+	if (!FORTH_DICTIONARY_ROOM(dictionary, dictionary[FORTH_DP_LOCATION] + (2 * sizeof(forth_cell_t))))
+	{
+		return -8;	// Dictionary overflow.
+	}
+
 	here = forth_here(dictionary);
 
 	forth_allot(dictionary, 2 * sizeof(forth_cell_t));
@@ -104,6 +132,7 @@ forth_cell_t forth_register_external_primitive(struct forth_runtime_context *rct
 	dictionary[here] = FORTH_PACK_TOKEN(FORTH_TOKEN_doextern);
 	dictionary[here + 1] = index;
 	((struct forth_wordlist *)(&dictionary[rctx->current]))->latest  = here - 2;
+	FORTH_FIND_CACHE_INVALIDATE(rctx);
 	return 0;
 }
 #endif
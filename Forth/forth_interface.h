@@ -64,5 +64,70 @@
 */
 extern forth_cell_t forth_register_external_primitive(struct forth_runtime_context *rctx, const char *name, forth_cell_t index);
 #endif
+
+#if defined(FORTH_KERNEL_ROM)
+/*
+* The kernel is const data: forth_kernel[] (FORTH_KERNEL_ROM_CELLS cells) followed by the initial values of the RAM overlay,
+* forth_kernel_ram[], which holds HERE, the kernel wordlists and the other cells the kernel changes. Together they are the
+* first FORTH_DP_VALUE cells of a dictionary, the host puts them in place with one of the functions below before setting
+* FORTH_DP_MAX_LOCATION (and FORTH_DP_COMMIT_LOCATION).
+*
+* forth_kernel_copy() copies both into dictionary.
+*
+* forth_kernel_share() maps the pages of forth_kernel[] read only from the file it was loaded from (the executable or
+* a shared library) to the start of dictionary and copies forth_kernel_ram[] after them. Every context and every process
+* shares the same pages of the kernel, and a stray store into it faults instead of breaking the kernel.
+* The dictionary has to be page aligned (e.g. from mmap()), returns 0 on success, -1 if the kernel cannot be mapped,
+* then the host can still call forth_kernel_copy().
+*/
+extern void forth_kernel_copy(forth_cell_t dictionary[]);
+extern int forth_kernel_share(forth_cell_t dictionary[]);
+#endif
+
+#if defined(FORTH_IMAGE)
+/*
+* Load a dictionary image written by SAVE-IMAGE into rctx->dictionary, instead of compiling the application again at start up.
+*
+* The host sets up the run time context as usual (the kernel dictionary copied in, FORTH_DP_MAX_LOCATION and with
+* FORTH_GROWABLE_DICTIONARY FORTH_DP_COMMIT_LOCATION set, the search order slots), then calls this before running QUIT.
+* The image restores the dictionary (WID-LINK, HERE, the layout of the USER variables with it), the search order and CURRENT.
+*
+* The image is only accepted by a binary with the same kernel and the same cell size, and the dictionary has to be at the
+* same Forth address as it was when the image was saved (in an arena that is the offset of the dictionary in the arena).
+* If the dictionary is page aligned it is mapped from the file with mmap(MAP_PRIVATE), pages are only read when touched
+* and changes are not written back, otherwise the image is read.
+*
+* Words that were compiled to machine code (FORTH_JIT) are compiled again, words translated by TRANSLATE-C need the
+* same aot_table installed, external primitives need the same external_primitive_table but must not be registered again.
+*
+* Returns 0 on success, -38 if the file cannot be opened, -37 if it is not a valid image for this system.
+* The dictionary is only changed once the image has been checked.
+*/
+extern forth_cell_t forth_load_image(struct forth_runtime_context *rctx, const char *file_name);
+#endif
+
+#if defined(FORTH_FORK)
+/*
+* Copy-on-write copies of a Forth system, e.g. for short lived evaluations that define scratch words.
+*
+* forth_arena_create() reserves size bytes for the arena from a memfd mapped shared, the first commit bytes readable and
+* writable. The host puts the run time context, the stacks, the search order, the heap and the dictionary in it as usual
+* (main_test_stdio.c) and sets rctx->arena to the address it returned. Returns 0 if it fails.
+*
+* forth_fork() maps the memfd again with MAP_PRIVATE and returns the copy of the run time context in it, with its pointers
+* moved to the new arena (the kernel pages of FORTH_KERNEL_ROM are mapped from the executable again). It costs two or three
+* mmap() calls, pages are only copied when the child writes them, the parent never sees what the child does.
+* The child is run with forth() or forth_call() like any other context, it cannot be forked itself.
+* Returns 0 if parent is not in an arena made by forth_arena_create() or the memory cannot be mapped.
+*
+* The pages neither of them wrote yet are still shared, so the parent is a template while it has children: forth() and
+* forth_call() return -21 for it until the last one is released. Children do not compile words to machine code (FORTH_JIT).
+*
+* forth_fork_release() unmaps the arena of a child, the child cannot be used after that.
+*/
+extern char *forth_arena_create(forth_cell_t size, forth_cell_t commit);
+extern struct forth_runtime_context *forth_fork(struct forth_runtime_context *parent);
+extern void forth_fork_release(struct forth_runtime_context *child);
+#endif
 #endif
 
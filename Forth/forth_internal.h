@@ -83,8 +83,8 @@ extern void forth_write_line(struct forth_runtime_context *rctx);
 // CLOSE-FILE ( fid -- ior )
 extern void forth_close_file(struct forth_runtime_context *rctx);
 
-// Map the FID to a file name. If there is no such FID return 0 0, otherwise return c-addr len.
-extern void forth_map_fid_to_name(struct forth_runtime_context *rctx);
+// Map the FID to the file name it was opened with, 0 if there is no such FID.
+extern const char *forth_fid_to_name(forth_cell_t fid);
 
 #endif
 
@@ -102,6 +102,132 @@ extern void forth_free(struct forth_runtime_context *rctx);
 
 #endif
 
+// Colon definitions compiled by the JIT or translated to C keep their body, SEE, inlining and tailcall treat them like nest.
+#define FORTH_IS_COLON_CODE(C)	((FORTH_PACK_TOKEN(FORTH_TOKEN_nest) == (C)) \
+	|| (FORTH_IS_TOKEN(C) && ((FORTH_TOKEN_native == FORTH_EXTRACT_TOKEN(C)) || (FORTH_TOKEN_compiled == FORTH_EXTRACT_TOKEN(C)))))
+
+// FNV-1a over the case folded characters of a name (needs <ctype.h>), gen_dict.c hashes the kernel names the same way.
+// FORTH_HASH_STEP is the same step without the folding, for bytes that are not names (the checksum of an image).
+#define FORTH_NAME_HASH_BASIS		2166136261U
+#define FORTH_HASH_STEP(H, C)		((uint32_t)(((H) ^ (uint32_t)(C)) * 16777619U))
+#define FORTH_NAME_HASH_STEP(H, C)	FORTH_HASH_STEP((H), tolower((unsigned char)(C)))
+
+// The slot (before masking) of the name hash H in a kernel name table where its bucket has the displacement D.
+#define FORTH_KERNEL_SLOT(H, D)		(((uint32_t)(((uint32_t)(H) + (uint32_t)(D) * 0x9E3779B9U) * 0x85EBCA6BU)) >> 16)
+
+// The name of the header at IX in the dictionary D and the header linked before it (0 at the end of the wordlist).
+#if defined(FORTH_NAME_SPACE)
+#	define FORTH_HEADER_NAME(D, IX)	(((const char *)(&(D)[(D)[IX] + (sizeof(struct forth_name) / sizeof(forth_cell_t))])) + 1)
+#	define FORTH_HEADER_NEXT(D, IX)	((0 != ((struct forth_name *)(&(D)[(D)[IX]]))->link) \
+		? (((struct forth_name *)(&(D)[((struct forth_name *)(&(D)[(D)[IX]]))->link]))->xt - 2) : 0)
+
+// Lay down a header for name in the code space with its name in the name space, linked to the latest definition in wid
+// (the header itself is not linked yet). Returns the index of the header, 0 if the dictionary is full.
+extern forth_cell_t forth_name_comma(forth_cell_t dictionary[], forth_cell_t wid, const char *name, forth_cell_t len);
+#else
+#	define FORTH_HEADER_NAME(D, IX)	(((const char *)(&(D)[IX])) - FORTH_ALIGN((D)[(IX) + 1] & (FORTH_HEADER_FLAGS_NAME_LENGTH_MASK)))
+#	define FORTH_HEADER_NEXT(D, IX)	((D)[IX])
+#endif
+
+#if defined(FORTH_KERNEL_ROM) && defined(FORTH_NAME_SPACE)
+#	error "FORTH_KERNEL_ROM does not work with FORTH_NAME_SPACE."
+#endif
+
+// PAD and the buffer of WORD are past HERE: PAD at HERE, the counted string of WORD (up to 255 characters) 4 cells past it.
+#define FORTH_PAD_LENGTH		84
+#define FORTH_DICTIONARY_SCRATCH	((4 * sizeof(forth_cell_t)) + 256 + FORTH_PAD_LENGTH)
+
+// Is there room in the dictionary D below END (bytes)? With FORTH_GROWABLE_DICTIONARY the memory up to END gets committed,
+// with FORTH_DICTIONARY_SCRATCH bytes more for PAD and WORD.
+#if defined(FORTH_GROWABLE_DICTIONARY)
+#	if defined(FORTH_NAME_SPACE)
+#		error "FORTH_GROWABLE_DICTIONARY does not work with FORTH_NAME_SPACE."
+#	endif
+
+// Commit the dictionary up to end bytes and update FORTH_DP_COMMIT_LOCATION, returns 0 on success (forth_posix.c).
+extern int forth_dictionary_commit(forth_cell_t dictionary[], forth_cell_t end);
+
+#	define FORTH_DICTIONARY_ROOM(D, END)	(((END) < (D)[FORTH_DP_MAX_LOCATION]) \
+		&& ((((END) + FORTH_DICTIONARY_SCRATCH) <= (D)[FORTH_DP_COMMIT_LOCATION]) \
+			|| (0 == forth_dictionary_commit((D), (END) + FORTH_DICTIONARY_SCRATCH))))
+#else
+#	define FORTH_DICTIONARY_ROOM(D, END)	((END) < (D)[FORTH_DP_MAX_LOCATION])
+#endif
+
+#if defined(FORTH_FORK)
+// Is arena made by forth_arena_create()? The image loader must not map over it (forth_posix.c).
+extern int forth_arena_shared(const char *arena);
+
+// The number of children forth_fork() made from the context in arena that are not released yet (forth_posix.c).
+extern int forth_arena_children(const char *arena);
+#endif
+
+// A header was linked, a header's flags or the search order changed: FIND-WORD has to look again.
+#if defined(FORTH_FIND_CACHE)
+#	define FORTH_FIND_CACHE_INVALIDATE(RCTX)	((RCTX)->generation++)
+#else
+#	define FORTH_FIND_CACHE_INVALIDATE(RCTX)
+#endif
+
+#if defined(FORTH_JIT)
+// Compile the colon definition xt to machine code if possible, its code field becomes a native token.
+extern void forth_jit_compile(struct forth_runtime_context *rctx, forth_cell_t xt);
+
+// Run a native word with the stacks in rctx->sp and rctx->rp.
+extern void forth_jit_run(struct forth_runtime_context *rctx, forth_cell_t ix);
+
+// The xt native word ix was compiled from, 0 if there is no such native word.
+extern forth_cell_t forth_jit_xt(forth_cell_t ix);
+#endif
+
+#if defined(FORTH_AOT)
+// TRANSLATE-C ( xt c-addr u -- ior )
+extern void forth_translate_c(struct forth_runtime_context *rctx);
+#endif
+
+#if defined(FORTH_IMAGE)
+// SAVE-IMAGE ( c-addr u -- ior )
+extern void forth_save_image(struct forth_runtime_context *rctx);
+#endif
+
+#if defined(FORTH_STACK_EFFECT)
+// The stack effect of xt as FORTH_HEADER_FLAGS_EFFECT... bits, 0 if it cannot be worked out.
+extern forth_cell_t forth_stack_effect(struct forth_runtime_context *rctx, forth_cell_t xt);
+
+// Work out the stack effect of the colon definition xt and record it in its header.
+extern void forth_stack_effect_record(struct forth_runtime_context *rctx, forth_cell_t xt);
+#endif
+
+#if defined(FORTH_COMPACT_CODE)
+// The body of a colon definition with FORTH_TOKEN_compact in its code field is a row of 16 bit units from xt + 1 on.
+// A unit indexes the table in the dictionary (needs forth_dict.h), FORTH_COMPACT_ESCAPE is followed by a whole cell,
+// so are the operands of lit and tailcall, with its low half first. ip counts units in compact code.
+#	define FORTH_COMPACT_ESCAPE		0xFFFF
+#	define FORTH_COMPACT_CELL_UNITS	(sizeof(forth_cell_t) / sizeof(uint16_t))
+#	define FORTH_COMPACT_UNITS(D)		((uint16_t *)(D))
+#	define FORTH_COMPACT_TABLE(D)		(&(D)[(D)[FORTH_COMPACT_TABLE_LOCATION] + 1])
+#	define FORTH_COMPACT_BODY(XT)		(((XT) + 1) * FORTH_COMPACT_CELL_UNITS)
+#	if defined(FORTH_64BIT)
+#		define FORTH_COMPACT_CELL(U)	((forth_cell_t)(U)[0] | ((forth_cell_t)(U)[1] << 16) \
+		| ((forth_cell_t)(U)[2] << 32) | ((forth_cell_t)(U)[3] << 48))
+#	else
+#		define FORTH_COMPACT_CELL(U)	((forth_cell_t)(U)[0] | ((forth_cell_t)(U)[1] << 16))
+#	endif
+
+// Return addresses (and rctx->ip) into compact code are tagged, so that unnest knows which engine runs the caller.
+#	define FORTH_COMPACT_IP_TAG		FORTH_MASK_TOKEN_INDICATOR
+#	define FORTH_COMPACT_TAG(IP)		((IP) | FORTH_COMPACT_IP_TAG)
+#	define FORTH_COMPACT_UNTAG(IP)		((IP) & ~FORTH_COMPACT_IP_TAG)
+#	define FORTH_COMPACT_TAGGED(IP)		(0 != ((IP) & FORTH_COMPACT_IP_TAG))
+
+#	if (FORTH_COMPACT_CODE) >= FORTH_COMPACT_ESCAPE
+#		error "FORTH_COMPACT_CODE has to be less than FORTH_COMPACT_ESCAPE."
+#	endif
+
+// Translate the colon definition xt that ends at HERE into compact code, it stays cell threaded if that cannot be done.
+extern void forth_compact(struct forth_runtime_context *rctx, forth_cell_t xt);
+#endif
+
 
 #endif
 
@@ -0,0 +1,776 @@
+/*
+* Copyright (c) 2026 The Embeddable Forth Command Interpreter contributors
+*
+* Permission is hereby granted, free of charge, to any person obtaining a copy
+* of this software and associated documentation files (the "Software"), to deal
+* in the Software without restriction, including without limitation the rights
+* to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+* copies of the Software, and to permit persons to whom the Software is
+* furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in
+* all copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+* AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+* THE SOFTWARE.
+*
+*/
+
+// http://forth.teleonomix.com/
+
+// Template JIT for x86-64 -- system dependent (needs memfd_create() and mmap() for the code region).
+//
+// A finished colon definition is translated into machine code if every cell of its body has a template:
+// literals, stack, arithmetic, logic, comparison and memory primitives, branches, DO-loops, constants,
+// variables, and calls to words that are already native. Anything else (I/O, EXECUTE, THROW, CATCH,
+// external primitives, calls to token threaded words...) leaves the word to the token interpreter.
+//
+// Register usage in the generated code:
+//	eax	top of the data stack (cached).
+//	rbx	data stack pointer (the rest of the stack).
+//	r13	return stack pointer (DO-loop frames, same layout as in the engine).
+//	r12	struct forth_runtime_context *
+//	r14	rctx->arena, Forth addresses are offsets from it (FORTH_ARENA).
+//	ecx, edx scratch.
+// A native word is called as int f(struct forth_runtime_context *rctx) with rctx->sp and rctx->rp up to date,
+// and it leaves them up to date. It returns 0, or 1 if it stopped early because the stacks went out of bounds,
+// the engine checks the stacks after the call and raises the error.
+//
+// The code region is a memfd mapped twice: ; writes through a read-write view, the words run from a read-execute view,
+// so no page is writable and executable at the same time, and the words already in a page keep running while the
+// next one is written after them.
+// There is one region and one table of native words for the process, every run time context (arenas, forks) uses it.
+// forth_jit_compile() holds forth_jit_lock, so contexts in different threads can run ; at the same time. The tokens
+// in the dictionary index the table, a word is entered in it before its code field is changed.
+
+#if defined(__linux__)
+#define _GNU_SOURCE	// memfd_create()
+#endif
+#include <stddef.h>
+#include <string.h>
+#include <pthread.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include "forth.h"
+#include "forth_internal.h"
+
+#if defined(FORTH_JIT)
+
+#define FORTH_JIT_CODE_SIZE	(256 * 1024)	// Bytes of machine code for all the native words.
+#define FORTH_JIT_MAX_WORDS	4096		// Native words, the index is the parameter of the native token.
+#define FORTH_JIT_MAX_BODY	512		// Cells, longer definitions stay token threaded.
+#define FORTH_JIT_MAX_FIXUPS	(2 * FORTH_JIT_MAX_BODY)
+
+typedef int (*forth_jit_function)(struct forth_runtime_context *rctx);
+
+static pthread_mutex_t forth_jit_lock = PTHREAD_MUTEX_INITIALIZER;
+static unsigned char *forth_jit_code = 0;	// The read-execute view of the region.
+static unsigned char *forth_jit_write = 0;	// The read-write view of the same pages.
+static size_t forth_jit_code_used = 0;
+static forth_jit_function forth_jit_entry[FORTH_JIT_MAX_WORDS];
+static forth_cell_t forth_jit_source[FORTH_JIT_MAX_WORDS];	// The xt each native word was compiled from.
+static forth_cell_t forth_jit_word_cnt = 0;
+
+struct forth_jit
+{
+	unsigned char	*code;		// Start of the word being compiled, in the read-write view.
+	unsigned char	*exec;		// The same place in the read-execute view, where the word will run.
+	size_t		pos;		// Bytes emitted.
+	size_t		room;		// Bytes available.
+	int		failed;
+	forth_cell_t	length;		// Cells in the body, label[length] is the exit, +1 bail out, +2 return.
+	size_t		entry;		// Where a tail call to itself goes.
+	uint32_t	label[FORTH_JIT_MAX_BODY + 3];
+	uint32_t	fixup_at[FORTH_JIT_MAX_FIXUPS];
+	forth_cell_t	fixup_to[FORTH_JIT_MAX_FIXUPS];
+	int		fixups;
+	forth_cell_t	leave_to[FORTH_JIT_MAX_BODY];	// Where LEAVE goes from the innermost DO-loop.
+	int		loops;
+#if defined(FORTH_ARENA)
+	char		*arena;
+#endif
+};
+
+#define JIT_SP		((unsigned char)offsetof(struct forth_runtime_context, sp))
+#define JIT_RP		((unsigned char)offsetof(struct forth_runtime_context, rp))
+#define JIT_SP_MIN	((unsigned char)offsetof(struct forth_runtime_context, sp_min))
+#define JIT_SP_MAX	((unsigned char)offsetof(struct forth_runtime_context, sp_max))
+#define JIT_RP_MIN	((unsigned char)offsetof(struct forth_runtime_context, rp_min))
+#define JIT_RP_MAX	((unsigned char)offsetof(struct forth_runtime_context, rp_max))
+#if defined(FORTH_ARENA)
+#	define JIT_ARENA	((unsigned char)offsetof(struct forth_runtime_context, arena))
+#endif
+
+#define EXIT_LABEL(J)	((J)->length)
+#define BAIL_LABEL(J)	((J)->length + 1)
+#define RETURN_LABEL(J)	((J)->length + 2)
+
+static void forth_jit_emit(struct forth_jit *j, const unsigned char *bytes, size_t n)
+{
+	if ((j->pos + n) > j->room)
+	{
+		j->failed = 1;
+		return;
+	}
+
+	memcpy(j->code + j->pos, bytes, n);
+	j->pos += n;
+}
+
+#define EMIT(...)	do { const unsigned char b_[] = { __VA_ARGS__ }; forth_jit_emit(j, b_, sizeof(b_)); } while (0)
+
+static void forth_jit_emit32(struct forth_jit *j, uint32_t v)
+{
+	EMIT(v & 0xFF, (v >> 8) & 0xFF, (v >> 16) & 0xFF, (v >> 24) & 0xFF);
+}
+
+// A rel32 operand that jumps to a label (a cell of the body or the exit code), patched when the word is done.
+static void forth_jit_label_ref(struct forth_jit *j, forth_cell_t label)
+{
+	if (FORTH_JIT_MAX_FIXUPS <= j->fixups)
+	{
+		j->failed = 1;
+		return;
+	}
+
+	j->fixup_at[j->fixups] = j->pos;
+	j->fixup_to[j->fixups] = label;
+	j->fixups++;
+	forth_jit_emit32(j, 0);
+}
+
+// A rel32 operand to an absolute address in the region (other native words).
+static void forth_jit_address_ref(struct forth_jit *j, const unsigned char *target)
+{
+	forth_jit_emit32(j, (uint32_t)(target - (j->exec + j->pos + 4)));
+}
+
+#define SPILL()		EMIT(0x48, 0x83, 0xEB, 0x04,	/* sub rbx, 4 */ \
+			     0x89, 0x03)		/* mov [rbx], eax */
+#define RELOAD()	EMIT(0x8B, 0x03,		/* mov eax, [rbx] */ \
+			     0x48, 0x83, 0xC3, 0x04)	/* add rbx, 4 */
+#define NIP()		EMIT(0x48, 0x83, 0xC3, 0x04)	/* add rbx, 4 */
+#define DROP2()		EMIT(0x8B, 0x43, 0x04,		/* mov eax, [rbx + 4] */ \
+			     0x48, 0x83, 0xC3, 0x08)	/* add rbx, 8 */
+#define FLAG(SETCC)	EMIT(0x0F, (SETCC), 0xC0,	/* setcc al */ \
+			     0x0F, 0xB6, 0xC0,		/* movzx eax, al */ \
+			     0xF7, 0xD8)		/* neg eax */
+#define STORE_STACKS()	EMIT(0x49, 0x89, 0x5C, 0x24, JIT_SP,	/* mov [r12 + sp], rbx */ \
+			     0x4D, 0x89, 0x6C, 0x24, JIT_RP)	/* mov [r12 + rp], r13 */
+#define LOAD_STACKS()	EMIT(0x49, 0x8B, 0x5C, 0x24, JIT_SP,	/* mov rbx, [r12 + sp] */ \
+			     0x4D, 0x8B, 0x6C, 0x24, JIT_RP)	/* mov r13, [r12 + rp] */
+#if defined(FORTH_ARENA)
+#	define PUSH_REGISTERS()	EMIT(0x53, 0x41, 0x54, 0x41, 0x55, 0x41, 0x56)	/* push rbx; push r12; push r13; push r14 */
+#	define POP_REGISTERS()	EMIT(0x41, 0x5E, 0x41, 0x5D, 0x41, 0x5C, 0x5B)	/* pop r14; pop r13; pop r12; pop rbx */
+#else
+#	define PUSH_REGISTERS()	EMIT(0x53, 0x41, 0x54, 0x41, 0x55)		/* push rbx; push r12; push r13 */
+#	define POP_REGISTERS()	EMIT(0x41, 0x5D, 0x41, 0x5C, 0x5B)		/* pop r13; pop r12; pop rbx */
+#endif
+
+// op reg, [rax] for the memory primitives, a one or two byte (0x0F xx) opcode, with the arena it is op reg, [r14 + rax].
+static void forth_jit_memory(struct forth_jit *j, unsigned op, unsigned char reg)
+{
+#if defined(FORTH_ARENA)
+	EMIT(0x41);					// REX.B, the base is r14
+#endif
+	if (0xFF < op)
+	{
+		EMIT(op >> 8);
+	}
+	EMIT(op & 0xFF);
+#if defined(FORTH_ARENA)
+	EMIT(0x04 | (reg << 3), 0x06);			// [r14 + rax]
+#else
+	EMIT(reg << 3);					// [rax]
+#endif
+}
+
+// The Forth address of a dictionary cell.
+static forth_cell_t forth_jit_address(struct forth_jit *j, forth_cell_t *cell)
+{
+	return FORTH_ADDRESS(j->arena, cell);
+}
+
+// Leave through the bail out code if the return stack is out of bounds, after the templates that move r13.
+static void forth_jit_check_return_stack(struct forth_jit *j)
+{
+#if defined(FORTH_STACK_CHECK_ENABLED)
+	EMIT(0x4D, 0x3B, 0x6C, 0x24, JIT_RP_MIN);	// cmp r13, [r12 + rp_min]
+	EMIT(0x0F, 0x82);				// jb bail
+	forth_jit_label_ref(j, BAIL_LABEL(j));
+	EMIT(0x4D, 0x3B, 0x6C, 0x24, JIT_RP_MAX);	// cmp r13, [r12 + rp_max]
+	EMIT(0x0F, 0x87);				// ja bail
+	forth_jit_label_ref(j, BAIL_LABEL(j));
+#endif
+}
+
+// Leave through the bail out code if the stacks are out of bounds, the same test as the engine's.
+static void forth_jit_check_stacks(struct forth_jit *j)
+{
+#if defined(FORTH_STACK_CHECK_ENABLED)
+	EMIT(0x48, 0x8D, 0x4B, 0xFC);			// lea rcx, [rbx - 4]	-- sp with the top of the stack spilled.
+	EMIT(0x49, 0x3B, 0x4C, 0x24, JIT_SP_MIN);	// cmp rcx, [r12 + sp_min]
+	EMIT(0x0F, 0x82);				// jb bail
+	forth_jit_label_ref(j, BAIL_LABEL(j));
+	EMIT(0x49, 0x3B, 0x4C, 0x24, JIT_SP_MAX);	// cmp rcx, [r12 + sp_max]
+	EMIT(0x0F, 0x87);				// ja bail
+	forth_jit_label_ref(j, BAIL_LABEL(j));
+#endif
+	forth_jit_check_return_stack(j);
+}
+
+// Jump to cell target of the body. If the condition (a jcc opcode, or 0 for jmp) holds.
+// Backward jumps check the stacks first, like branches in the engine, so a runaway loop stops.
+static void forth_jit_jump(struct forth_jit *j, forth_cell_t here, forth_cell_t target, unsigned char jcc)
+{
+	size_t skip = 0;
+
+	if (target > j->length)
+	{
+		j->failed = 1;
+		return;
+	}
+
+	if (target <= here)
+	{
+		if (0 != jcc)
+		{
+			EMIT(0x0F, jcc ^ 1, 0x00, 0x00, 0x00, 0x00);	// j!cc skip
+			skip = j->pos;
+		}
+		forth_jit_check_stacks(j);
+		jcc = 0;
+	}
+
+	if (0 == jcc)
+	{
+		EMIT(0xE9);					// jmp target
+	}
+	else
+	{
+		EMIT(0x0F, jcc);				// jcc target
+	}
+	forth_jit_label_ref(j, target);
+
+	if ((0 != skip) && !j->failed)
+	{
+		uint32_t rel = (uint32_t)(j->pos - skip);
+		memcpy(j->code + skip - 4, &rel, 4);
+	}
+}
+
+// Call another native word: the stacks go back into rctx, and one return stack cell is used like nest does,
+// so deep recursion runs into the return stack limit rather than the machine stack.
+static void forth_jit_call(struct forth_jit *j, const unsigned char *target, int tail)
+{
+	if (!tail)
+	{
+		EMIT(0x49, 0x83, 0xED, 0x04);		// sub r13, 4
+	}
+	SPILL();
+	STORE_STACKS();
+	EMIT(0x4C, 0x89, 0xE7);				// mov rdi, r12
+
+	if (tail)
+	{
+		POP_REGISTERS();
+		EMIT(0xE9);				// jmp target
+		forth_jit_address_ref(j, target);
+		return;
+	}
+
+	EMIT(0xE8);					// call target
+	forth_jit_address_ref(j, target);
+	EMIT(0x85, 0xC0);				// test eax, eax
+	EMIT(0x0F, 0x85);				// jnz return	-- The callee bailed out, the stacks are already stored.
+	forth_jit_label_ref(j, RETURN_LABEL(j));
+	LOAD_STACKS();
+	EMIT(0x49, 0x83, 0xC5, 0x04);			// add r13, 4
+	RELOAD();
+}
+
+static void forth_jit_literal(struct forth_jit *j, forth_cell_t value)
+{
+	SPILL();
+	EMIT(0xB8);					// mov eax, value
+	forth_jit_emit32(j, value);
+}
+
+// The native code of xt if it has been compiled, otherwise 0.
+static const unsigned char *forth_jit_native(forth_cell_t dictionary[], forth_cell_t xt)
+{
+	forth_cell_t code = dictionary[xt];
+
+	if (FORTH_IS_NOT_TOKEN(code) || (FORTH_TOKEN_native != FORTH_EXTRACT_TOKEN(code)))
+	{
+		return 0;
+	}
+
+	return (const unsigned char *)forth_jit_entry[FORTH_PARAM_UNSIGNED(code)];
+}
+
+// Compile a call to the word xt (not a primitive), tail is set for the operand of a tailcall.
+static void forth_jit_word(struct forth_jit *j, forth_cell_t dictionary[], forth_cell_t self, forth_cell_t xt, int tail)
+{
+	const unsigned char *native = forth_jit_native(dictionary, xt);
+
+	if (xt == self)		// Recursion, the word is not native yet.
+	{
+		if (tail)
+		{
+			EMIT(0xE9);				// jmp entry
+			forth_jit_address_ref(j, j->exec + j->entry);
+		}
+		else
+		{
+			forth_jit_call(j, j->exec, 0);
+		}
+		return;
+	}
+
+	if (0 != native)
+	{
+		forth_jit_call(j, native, tail);
+		return;
+	}
+
+	switch (FORTH_IS_TOKEN(dictionary[xt]) ? FORTH_EXTRACT_TOKEN(dictionary[xt]) : FORTH_TOKEN_COUNT)
+	{
+		case FORTH_TOKEN_doconst:
+			forth_jit_literal(j, dictionary[xt + 1]);
+		break;
+
+		case FORTH_TOKEN_dovar:
+			forth_jit_literal(j, forth_jit_address(j, &dictionary[xt + 1]));
+		break;
+
+		case FORTH_TOKEN_docreate:
+			if (FORTH_PACK_TOKEN(FORTH_TOKEN_NOP) != dictionary[xt + 1])	// Words with DOES> stay interpreted.
+			{
+				j->failed = 1;
+				break;
+			}
+			forth_jit_literal(j, forth_jit_address(j, &dictionary[xt + 2]));
+		break;
+
+		default:	// Colon definitions that are not native, synonyms, external primitives, user variables, etc.
+			j->failed = 1;
+		break;
+	}
+
+	if (tail)
+	{
+		EMIT(0xE9);					// jmp exit
+		forth_jit_label_ref(j, EXIT_LABEL(j));
+	}
+}
+
+// Compare and branch: a ( a b -- ) comparison, branch when it is false (jcc is the jump for false).
+static void forth_jit_compare_branch(struct forth_jit *j, forth_cell_t ix, forth_cell_t target, unsigned char jcc)
+{
+	EMIT(0x8B, 0x0B);				// mov ecx, [rbx]
+	EMIT(0x89, 0xC2);				// mov edx, eax
+	DROP2();
+	EMIT(0x39, 0xD1);				// cmp ecx, edx
+	forth_jit_jump(j, ix, target, jcc);
+}
+
+// Zero compare and branch ( n -- ).
+static void forth_jit_zero_branch(struct forth_jit *j, forth_cell_t ix, forth_cell_t target, unsigned char jcc)
+{
+	EMIT(0x89, 0xC1);				// mov ecx, eax
+	RELOAD();
+	EMIT(0x85, 0xC9);				// test ecx, ecx
+	forth_jit_jump(j, ix, target, jcc);
+}
+
+static void forth_jit_do(struct forth_jit *j, forth_cell_t after)
+{
+	EMIT(0x49, 0x83, 0xED, 0x0C);			// sub r13, 12
+	forth_jit_check_return_stack(j);		// Before the frame is written.
+	EMIT(0x41, 0x89, 0x45, 0x00);			// mov [r13], eax		-- I
+	EMIT(0x8B, 0x0B);				// mov ecx, [rbx]
+	EMIT(0x41, 0x89, 0x4D, 0x04);			// mov [r13 + 4], ecx		-- limit
+	EMIT(0x41, 0xC7, 0x45, 0x08);			// mov dword [r13 + 8], after	-- as the engine would have it.
+	forth_jit_emit32(j, after);
+	DROP2();
+}
+
+// Translate one cell of the body, returns the number of cells used.
+static forth_cell_t forth_jit_cell(struct forth_jit *j, forth_cell_t dictionary[], forth_cell_t self, forth_cell_t start, forth_cell_t ix)
+{
+	forth_cell_t xt = dictionary[start + ix];
+	forth_cell_t target = ix + 1 + FORTH_PARAM_SIGNED(xt);	// For branches, relative to the next cell as in the engine.
+	int32_t param = FORTH_PARAM_SIGNED(xt);
+
+	if (FORTH_IS_NOT_TOKEN(xt))
+	{
+		forth_jit_word(j, dictionary, self, xt, 0);
+		return 1;
+	}
+
+	switch (FORTH_EXTRACT_TOKEN(xt))
+	{
+		case FORTH_TOKEN_lit:
+		case FORTH_TOKEN_xtlit:
+			forth_jit_literal(j, dictionary[start + ix + 1]);
+		return 2;
+
+		case FORTH_TOKEN_uslit:		forth_jit_literal(j, FORTH_PARAM_UNSIGNED(xt));	break;
+		case FORTH_TOKEN_sslit:		forth_jit_literal(j, (forth_cell_t)param);	break;
+
+		case FORTH_TOKEN_inlined:	return 2;	// The body follows.
+		case FORTH_TOKEN_NOP:		break;
+
+		case FORTH_TOKEN_tailcall:
+			forth_jit_word(j, dictionary, self, dictionary[start + ix + 1], 1);
+		return 2;
+
+		case FORTH_TOKEN_EXIT:
+			EMIT(0xE9);				// jmp exit
+			forth_jit_label_ref(j, EXIT_LABEL(j));
+		break;
+
+		// Stack.
+		case FORTH_TOKEN_DUP:		SPILL();	break;
+		case FORTH_TOKEN_DROP:		RELOAD();	break;
+		case FORTH_TOKEN_NIP:		NIP();		break;
+		case FORTH_TOKEN_2DROP:		DROP2();	break;
+		case FORTH_TOKEN_SWAP:
+			EMIT(0x8B, 0x0B, 0x89, 0x03, 0x89, 0xC8);		// mov ecx, [rbx]; mov [rbx], eax; mov eax, ecx
+		break;
+		case FORTH_TOKEN_OVER:
+			EMIT(0x8B, 0x0B);					// mov ecx, [rbx]
+			SPILL();
+			EMIT(0x89, 0xC8);					// mov eax, ecx
+		break;
+		case FORTH_TOKEN_ROT:
+			EMIT(0x8B, 0x4B, 0x04, 0x8B, 0x13);			// mov ecx, [rbx + 4]; mov edx, [rbx]
+			EMIT(0x89, 0x53, 0x04, 0x89, 0x03, 0x89, 0xC8);		// mov [rbx + 4], edx; mov [rbx], eax; mov eax, ecx
+		break;
+		case FORTH_TOKEN_TUCK:
+			EMIT(0x8B, 0x0B, 0x48, 0x83, 0xEB, 0x04);		// mov ecx, [rbx]; sub rbx, 4
+			EMIT(0x89, 0x43, 0x04, 0x89, 0x0B);			// mov [rbx + 4], eax; mov [rbx], ecx
+		break;
+		case FORTH_TOKEN_2DUP:
+			EMIT(0x8B, 0x0B, 0x48, 0x83, 0xEB, 0x08);		// mov ecx, [rbx]; sub rbx, 8
+			EMIT(0x89, 0x43, 0x04, 0x89, 0x0B);			// mov [rbx + 4], eax; mov [rbx], ecx
+		break;
+		case FORTH_TOKEN_qDUP:
+			EMIT(0x85, 0xC0, 0x74, 0x06);				// test eax, eax; jz +6
+			SPILL();
+		break;
+
+		// Arithmetic and logic, the second operand is in memory.
+		case FORTH_TOKEN_Plus:		EMIT(0x03, 0x03);	NIP();	break;	// add eax, [rbx]
+		case FORTH_TOKEN_Multiply:	EMIT(0x0F, 0xAF, 0x03);	NIP();	break;	// imul eax, [rbx]
+		case FORTH_TOKEN_AND:		EMIT(0x23, 0x03);	NIP();	break;	// and eax, [rbx]
+		case FORTH_TOKEN_OR:		EMIT(0x0B, 0x03);	NIP();	break;	// or eax, [rbx]
+		case FORTH_TOKEN_XOR:		EMIT(0x33, 0x03);	NIP();	break;	// xor eax, [rbx]
+		case FORTH_TOKEN_OVER_Plus:	EMIT(0x03, 0x03);		break;	// add eax, [rbx]
+		case FORTH_TOKEN_Subtract:
+			EMIT(0x89, 0xC1, 0x8B, 0x03, 0x29, 0xC8);		// mov ecx, eax; mov eax, [rbx]; sub eax, ecx
+			NIP();
+		break;
+		case FORTH_TOKEN_LSHIFT:
+		case FORTH_TOKEN_RSHIFT:
+			EMIT(0x89, 0xC1, 0x8B, 0x03);				// mov ecx, eax; mov eax, [rbx]
+			EMIT(0xD3, (FORTH_TOKEN_LSHIFT == FORTH_EXTRACT_TOKEN(xt)) ? 0xE0 : 0xE8);	// shl/shr eax, cl
+			NIP();
+		break;
+		case FORTH_TOKEN_MIN:
+		case FORTH_TOKEN_MAX:
+			EMIT(0x8B, 0x0B, 0x39, 0xC1);				// mov ecx, [rbx]; cmp ecx, eax
+			EMIT(0x0F, (FORTH_TOKEN_MIN == FORTH_EXTRACT_TOKEN(xt)) ? 0x4C : 0x4F, 0xC1);	// cmovl/cmovg eax, ecx
+			NIP();
+		break;
+		case FORTH_TOKEN_NEGATE:	EMIT(0xF7, 0xD8);		break;	// neg eax
+		case FORTH_TOKEN_INVERT:	EMIT(0xF7, 0xD0);		break;	// not eax
+		case FORTH_TOKEN_2_Star:	EMIT(0xD1, 0xE0);		break;	// shl eax, 1
+		case FORTH_TOKEN_2_Slash:	EMIT(0xD1, 0xE8);		break;	// shr eax, 1
+		case FORTH_TOKEN_CELLS:		EMIT(0xC1, 0xE0, 0x02);		break;	// shl eax, 2
+		case FORTH_TOKEN_ABS:
+			EMIT(0x89, 0xC1, 0xF7, 0xD8, 0x0F, 0x48, 0xC1);		// mov ecx, eax; neg eax; cmovs eax, ecx
+		break;
+
+		// Comparisons.
+		case FORTH_TOKEN_Equal:		EMIT(0x39, 0x03);	FLAG(0x94);	NIP();	break;	// cmp [rbx], eax; sete
+		case FORTH_TOKEN_Notequal:	EMIT(0x39, 0x03);	FLAG(0x95);	NIP();	break;	// setne
+		case FORTH_TOKEN_Less:		EMIT(0x39, 0x03);	FLAG(0x9C);	NIP();	break;	// setl
+		case FORTH_TOKEN_Greater:	EMIT(0x39, 0x03);	FLAG(0x9F);	NIP();	break;	// setg
+		case FORTH_TOKEN_ULess:		EMIT(0x39, 0x03);	FLAG(0x92);	NIP();	break;	// setb
+		case FORTH_TOKEN_UGreater:	EMIT(0x39, 0x03);	FLAG(0x97);	NIP();	break;	// seta
+		case FORTH_TOKEN_0Equal:	EMIT(0x85, 0xC0);	FLAG(0x94);	break;		// test eax, eax; sete
+		case FORTH_TOKEN_0Notequal:	EMIT(0x85, 0xC0);	FLAG(0x95);	break;
+		case FORTH_TOKEN_0Less:		EMIT(0x85, 0xC0);	FLAG(0x9C);	break;
+		case FORTH_TOKEN_0Greater:	EMIT(0x85, 0xC0);	FLAG(0x9F);	break;
+		case FORTH_TOKEN_DUP_0Equal:	SPILL();	EMIT(0x85, 0xC0);	FLAG(0x94);	break;
+
+		// Memory, cells hold 32 bit addresses, writes to eax clear the upper half of rax.
+		case FORTH_TOKEN_Fetch:		forth_jit_memory(j, 0x8B, 0);			break;	// mov eax, [rax]
+		case FORTH_TOKEN_CFetch:	forth_jit_memory(j, 0x0FBE, 0);			break;	// movsx eax, byte [rax] -- char is signed.
+		case FORTH_TOKEN_Fetch_Plus:	forth_jit_memory(j, 0x8B, 0);	EMIT(0x03, 0x03);	NIP();	break;	// mov eax, [rax]; add eax, [rbx]
+		case FORTH_TOKEN_Store:		EMIT(0x8B, 0x0B);	forth_jit_memory(j, 0x89, 1);	DROP2();	break;	// mov ecx, [rbx]; mov [rax], ecx
+		case FORTH_TOKEN_CStore:	EMIT(0x8B, 0x0B);	forth_jit_memory(j, 0x88, 1);	DROP2();	break;	// mov ecx, [rbx]; mov [rax], cl
+		case FORTH_TOKEN_PlusStore:	EMIT(0x8B, 0x0B);	forth_jit_memory(j, 0x01, 1);	DROP2();	break;	// mov ecx, [rbx]; add [rax], ecx
+
+		// Immediate operands.
+		case FORTH_TOKEN_Imm_Plus:	EMIT(0x05);	forth_jit_emit32(j, param);	break;	// add eax, imm
+		case FORTH_TOKEN_Imm_AND:	EMIT(0x25);	forth_jit_emit32(j, param);	break;	// and eax, imm
+		case FORTH_TOKEN_Imm_OR:	EMIT(0x0D);	forth_jit_emit32(j, param);	break;	// or eax, imm
+		case FORTH_TOKEN_Imm_XOR:	EMIT(0x35);	forth_jit_emit32(j, param);	break;	// xor eax, imm
+		case FORTH_TOKEN_Imm_LSHIFT:	EMIT(0xC1, 0xE0, FORTH_PARAM_UNSIGNED(xt) & 0xFF);	break;	// shl eax, imm
+		case FORTH_TOKEN_Imm_RSHIFT:	EMIT(0xC1, 0xE8, FORTH_PARAM_UNSIGNED(xt) & 0xFF);	break;	// shr eax, imm
+		case FORTH_TOKEN_Imm_Equal:	EMIT(0x3D);	forth_jit_emit32(j, param);	FLAG(0x94);	break;	// cmp eax, imm; sete
+		case FORTH_TOKEN_Imm_Less:	EMIT(0x3D);	forth_jit_emit32(j, param);	FLAG(0x9C);	break;	// cmp eax, imm; setl
+		case FORTH_TOKEN_Imm_Fetch:
+			EMIT(0x05);	forth_jit_emit32(j, param);		// add eax, imm
+			forth_jit_memory(j, 0x8B, 0);				// mov eax, [rax]
+		break;
+
+		// Control flow.
+		case FORTH_TOKEN_branch:		forth_jit_jump(j, ix, target, 0);	break;
+		case FORTH_TOKEN_0branch:		forth_jit_zero_branch(j, ix, target, 0x84);	break;	// jz
+		case FORTH_TOKEN_0Equal_0branch:	forth_jit_zero_branch(j, ix, target, 0x85);	break;	// jnz
+		case FORTH_TOKEN_0Notequal_0branch:	forth_jit_zero_branch(j, ix, target, 0x84);	break;	// jz
+		case FORTH_TOKEN_0Less_0branch:		forth_jit_zero_branch(j, ix, target, 0x8D);	break;	// jge
+		case FORTH_TOKEN_0Greater_0branch:	forth_jit_zero_branch(j, ix, target, 0x8E);	break;	// jle
+		case FORTH_TOKEN_Equal_0branch:		forth_jit_compare_branch(j, ix, target, 0x85);	break;	// jne
+		case FORTH_TOKEN_Notequal_0branch:	forth_jit_compare_branch(j, ix, target, 0x84);	break;	// je
+		case FORTH_TOKEN_Less_0branch:		forth_jit_compare_branch(j, ix, target, 0x8D);	break;	// jge
+		case FORTH_TOKEN_Greater_0branch:	forth_jit_compare_branch(j, ix, target, 0x8E);	break;	// jle
+		case FORTH_TOKEN_ULess_0branch:		forth_jit_compare_branch(j, ix, target, 0x83);	break;	// jae
+		case FORTH_TOKEN_UGreater_0branch:	forth_jit_compare_branch(j, ix, target, 0x86);	break;	// jbe
+
+		// DO-loops, the frame on the return stack is the same as the engine's.
+		case FORTH_TOKEN_pDO:
+		case FORTH_TOKEN_pqDO:
+			if ((target <= ix) || (target > j->length) || (FORTH_JIT_MAX_BODY <= j->loops))
+			{
+				j->failed = 1;
+				break;
+			}
+			if (FORTH_TOKEN_pqDO == FORTH_EXTRACT_TOKEN(xt))
+			{
+				EMIT(0x3B, 0x03, 0x75, 0x0C);		// cmp eax, [rbx]; jne do
+				DROP2();
+				EMIT(0xE9);				// jmp after
+				forth_jit_label_ref(j, target);
+			}
+			forth_jit_do(j, start + target);
+			j->leave_to[j->loops++] = target;
+		break;
+
+		case FORTH_TOKEN_pLOOP:
+			EMIT(0x41, 0x83, 0x45, 0x00, 0x01);		// add dword [r13], 1
+			EMIT(0x41, 0x8B, 0x4D, 0x00);			// mov ecx, [r13]
+			EMIT(0x41, 0x3B, 0x4D, 0x04);			// cmp ecx, [r13 + 4]
+			forth_jit_jump(j, ix, target, 0x85);		// jne back
+			EMIT(0x49, 0x83, 0xC5, 0x0C);			// add r13, 12
+			forth_jit_check_return_stack(j);
+		break;
+
+		case FORTH_TOKEN_pPlusLOOP:
+			EMIT(0x89, 0xC1);				// mov ecx, eax
+			RELOAD();
+			EMIT(0x41, 0x01, 0x4D, 0x00);			// add [r13], ecx
+			EMIT(0x41, 0x8B, 0x55, 0x00);			// mov edx, [r13]
+			EMIT(0x41, 0x2B, 0x55, 0x04);			// sub edx, [r13 + 4]
+			EMIT(0x31, 0xCA);				// xor edx, ecx
+			forth_jit_jump(j, ix, target, 0x88);		// js back
+			EMIT(0x49, 0x83, 0xC5, 0x0C);			// add r13, 12
+			forth_jit_check_return_stack(j);
+		break;
+
+		case FORTH_TOKEN_I:		SPILL();	EMIT(0x41, 0x8B, 0x45, 0x00);	break;	// mov eax, [r13]
+		case FORTH_TOKEN_J:		SPILL();	EMIT(0x41, 0x8B, 0x45, 0x0C);	break;	// mov eax, [r13 + 12]
+		case FORTH_TOKEN_I_Plus:	EMIT(0x41, 0x03, 0x45, 0x00);			break;	// add eax, [r13]
+		case FORTH_TOKEN_UNLOOP:	EMIT(0x49, 0x83, 0xC5, 0x0C);	forth_jit_check_return_stack(j);	break;	// add r13, 12
+
+		case FORTH_TOKEN_LEAVE:
+			while ((0 < j->loops) && (j->leave_to[j->loops - 1] <= ix))	// Loops that have ended already.
+			{
+				j->loops--;
+			}
+			if (0 == j->loops)
+			{
+				j->failed = 1;
+				break;
+			}
+			EMIT(0x49, 0x83, 0xC5, 0x0C);			// add r13, 12
+			forth_jit_check_return_stack(j);
+			EMIT(0xE9);					// jmp after
+			forth_jit_label_ref(j, j->leave_to[j->loops - 1]);
+		break;
+
+		default:
+			j->failed = 1;
+		break;
+	}
+
+	return 1;
+}
+
+// Map the two views of the code region, 0 if it cannot be done.
+static int forth_jit_map(void)
+{
+	int fd = memfd_create("forth-jit", MFD_CLOEXEC);
+	void *code = MAP_FAILED;
+	void *write = MAP_FAILED;
+
+	if ((0 <= fd) && (0 == ftruncate(fd, FORTH_JIT_CODE_SIZE)))
+	{
+		write = mmap(0, FORTH_JIT_CODE_SIZE, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+		code = mmap(0, FORTH_JIT_CODE_SIZE, PROT_READ | PROT_EXEC, MAP_SHARED, fd, 0);
+	}
+
+	if (0 <= fd)
+	{
+		close(fd);	// The mappings keep the pages.
+	}
+
+	if ((MAP_FAILED == write) || (MAP_FAILED == code))
+	{
+		if (MAP_FAILED != write)
+		{
+			munmap(write, FORTH_JIT_CODE_SIZE);
+		}
+
+		if (MAP_FAILED != code)
+		{
+			munmap(code, FORTH_JIT_CODE_SIZE);
+		}
+
+		return 0;
+	}
+
+	forth_jit_write = write;
+	forth_jit_code = code;
+	return 1;
+}
+
+// Translate xt into the region with forth_jit_lock held, the word is left alone if any of it has no template.
+static void forth_jit_translate(struct forth_jit *j, struct forth_runtime_context *rctx, forth_cell_t xt)
+{
+	forth_cell_t *dictionary = rctx->dictionary;
+	forth_cell_t start = xt + 1;
+	forth_cell_t ix;
+	int i;
+
+	for (j->length = 0; FORTH_PACK_TOKEN(FORTH_TOKEN_unnest) != dictionary[start + j->length]; j->length++)
+	{
+		if (FORTH_JIT_MAX_BODY <= j->length)
+		{
+			return;
+		}
+	}
+
+	j->code = forth_jit_write + forth_jit_code_used;
+	j->exec = forth_jit_code + forth_jit_code_used;
+	j->room = FORTH_JIT_CODE_SIZE - forth_jit_code_used;
+	j->pos = 0;
+	j->failed = 0;
+	j->fixups = 0;
+	j->loops = 0;
+#if defined(FORTH_ARENA)
+	j->arena = rctx->arena;
+#endif
+
+	PUSH_REGISTERS();
+	EMIT(0x49, 0x89, 0xFC);					// mov r12, rdi
+#if defined(FORTH_ARENA)
+	EMIT(0x4D, 0x8B, 0x74, 0x24, JIT_ARENA);		// mov r14, [r12 + arena]
+#endif
+	LOAD_STACKS();
+	RELOAD();
+	j->entry = j->pos;
+	forth_jit_check_stacks(j);
+
+	for (ix = 0; (ix < j->length) && !j->failed; )
+	{
+		j->label[ix] = j->pos;
+		i = forth_jit_cell(j, dictionary, xt, start, ix);
+		if (2 == i)
+		{
+			j->label[ix + 1] = j->pos;	// Not a target, but keep the table complete.
+		}
+		ix += i;
+	}
+
+	j->label[EXIT_LABEL(j)] = j->pos;
+	SPILL();
+	STORE_STACKS();
+	EMIT(0x31, 0xC0);					// xor eax, eax
+	j->label[RETURN_LABEL(j)] = j->pos;
+	POP_REGISTERS();
+	EMIT(0xC3);						// ret
+	j->label[BAIL_LABEL(j)] = j->pos;
+	SPILL();
+	STORE_STACKS();
+	EMIT(0xB8, 0x01, 0x00, 0x00, 0x00);			// mov eax, 1
+	EMIT(0xE9);						// jmp return
+	forth_jit_emit32(j, (uint32_t)(j->label[RETURN_LABEL(j)] - (j->pos + 4)));
+
+	if (j->failed)
+	{
+		return;
+	}
+
+	for (i = 0; i < j->fixups; i++)
+	{
+		uint32_t rel = j->label[j->fixup_to[i]] - (j->fixup_at[i] + 4);
+		memcpy(j->code + j->fixup_at[i], &rel, 4);
+	}
+
+	forth_jit_code_used += (j->pos + 15) & ~(size_t)15;
+	forth_jit_entry[forth_jit_word_cnt] = (forth_jit_function)(void *)j->exec;
+	forth_jit_source[forth_jit_word_cnt] = xt;
+	dictionary[xt] = FORTH_PACK_TOKEN(FORTH_TOKEN_native) | FORTH_PARAM_PACK(forth_jit_word_cnt);
+	forth_jit_word_cnt++;
+}
+
+// Compile the colon definition xt into machine code, if it is possible.
+// On success the code field of xt becomes a native token, the body is kept for SEE.
+void forth_jit_compile(struct forth_runtime_context *rctx, forth_cell_t xt)
+{
+	static struct forth_jit jit;	// Only used with forth_jit_lock held.
+
+	pthread_mutex_lock(&forth_jit_lock);
+
+	if ((FORTH_PACK_TOKEN(FORTH_TOKEN_nest) == rctx->dictionary[xt]) && (FORTH_JIT_MAX_WORDS > forth_jit_word_cnt)
+#if defined(FORTH_FORK)
+		&& (0 == rctx->forked)	// The code space is never given back, short lived forks would use it up.
+#endif
+		)
+	{
+		if ((0 != forth_jit_code) || forth_jit_map())
+		{
+			forth_jit_translate(&jit, rctx, xt);
+		}
+		else
+		{
+			forth_jit_word_cnt = FORTH_JIT_MAX_WORDS;	// Do not try again.
+		}
+	}
+
+	pthread_mutex_unlock(&forth_jit_lock);
+}
+
+// Run native word number ix, the stacks are in rctx.
+void forth_jit_run(struct forth_runtime_context *rctx, forth_cell_t ix)
+{
+	forth_jit_entry[ix](rctx);
+}
+
+// The xt native word ix was compiled from, 0 if there is no such word (SAVE-IMAGE turns them back into colon definitions).
+forth_cell_t forth_jit_xt(forth_cell_t ix)
+{
+	return (ix < FORTH_JIT_MAX_WORDS) ? forth_jit_source[ix] : 0;
+}
+
+#endif
@@ -0,0 +1,231 @@
+/*
+* Copyright (c) 2026 The Embeddable Forth Command Interpreter contributors
+*
+* Permission is hereby granted, free of charge, to any person obtaining a copy
+* of this software and associated documentation files (the "Software"), to deal
+* in the Software without restriction, including without limitation the rights
+* to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+* copies of the Software, and to permit persons to whom the Software is
+* furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in
+* all copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+* AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+* THE SOFTWARE.
+*
+*/
+
+// http://forth.teleonomix.com/
+
+// The memory allocation wordset for FORTH_ARENA, the memory comes from rctx->heap .. rctx->heap + rctx->heap_size
+// inside the arena, so that the addresses fit in a cell.
+//
+// The heap is a row of blocks, each starts with a cell that holds the length of the block in bytes (header included)
+// with FORTH_HEAP_USED set when it is allocated. First fit, free blocks are merged with the free blocks after them
+// when ALLOCATE or RESIZE walks over them.
+
+#include <string.h>
+#include "forth_internal.h"
+
+#if defined(FORTH_INCLUDE_MEMORY_ALLOCATION_WORDS) && defined(FORTH_ARENA)
+
+#define POP() *(rctx->sp++)
+#define PUSH(X) *(--(rctx->sp)) = (forth_cell_t)(X)
+
+#define FORTH_HEAP_USED		1
+#define FORTH_HEAP_MIN_BLOCK	(2 * sizeof(forth_cell_t))
+
+// The header of the block at offset in the heap.
+#define FORTH_HEAP_BLOCK(RCTX, OFFSET)	(*(forth_cell_t *)FORTH_POINTER((RCTX)->arena, (RCTX)->heap + (OFFSET)))
+
+// Bytes of the heap that can be used, the memory is zeroed so the first header tells if it has been set up yet.
+static forth_cell_t forth_heap_end(struct forth_runtime_context *rctx)
+{
+	forth_cell_t end = rctx->heap_size & ~(sizeof(forth_cell_t) - 1);
+
+	if (end < FORTH_HEAP_MIN_BLOCK)
+	{
+		return 0;
+	}
+
+	if (0 == FORTH_HEAP_BLOCK(rctx, 0))
+	{
+		FORTH_HEAP_BLOCK(rctx, 0) = end;
+	}
+
+	return end;
+}
+
+// Bytes needed for size bytes of user data, 0 if it can never fit.
+static forth_cell_t forth_heap_need(forth_cell_t size, forth_cell_t end)
+{
+	forth_cell_t need;
+
+	if (size > end)
+	{
+		return 0;
+	}
+
+	need = FORTH_ALIGN(size) + sizeof(forth_cell_t);
+	return (need < FORTH_HEAP_MIN_BLOCK) ? FORTH_HEAP_MIN_BLOCK : need;
+}
+
+// The length of the block at offset once the free blocks after it are merged into it.
+static forth_cell_t forth_heap_merge(struct forth_runtime_context *rctx, forth_cell_t offset, forth_cell_t end)
+{
+	forth_cell_t length = FORTH_HEAP_BLOCK(rctx, offset) & ~FORTH_HEAP_USED;
+	forth_cell_t next;
+
+	while ((offset + length) < end)
+	{
+		next = FORTH_HEAP_BLOCK(rctx, offset + length);
+
+		if (FORTH_HEAP_USED & next)
+		{
+			break;
+		}
+
+		length += next;
+	}
+
+	return length;
+}
+
+// Mark need bytes of the block at offset (length bytes long) used, what is left over becomes a free block.
+static void forth_heap_take(struct forth_runtime_context *rctx, forth_cell_t offset, forth_cell_t length, forth_cell_t need)
+{
+	if ((length - need) >= FORTH_HEAP_MIN_BLOCK)
+	{
+		FORTH_HEAP_BLOCK(rctx, offset + need) = length - need;
+		length = need;
+	}
+
+	FORTH_HEAP_BLOCK(rctx, offset) = length | FORTH_HEAP_USED;
+}
+
+// The Forth address of size bytes, 0 if there is not enough memory.
+static forth_cell_t forth_heap_allocate(struct forth_runtime_context *rctx, forth_cell_t size)
+{
+	forth_cell_t end = forth_heap_end(rctx);
+	forth_cell_t need = forth_heap_need(size, end);
+	forth_cell_t offset = 0;
+	forth_cell_t length;
+
+	if (0 == need)
+	{
+		return 0;
+	}
+
+	while (offset < end)
+	{
+		length = FORTH_HEAP_BLOCK(rctx, offset);
+
+		if (0 == (FORTH_HEAP_USED & length))
+		{
+			length = forth_heap_merge(rctx, offset, end);
+			FORTH_HEAP_BLOCK(rctx, offset) = length;
+
+			if (length >= need)
+			{
+				forth_heap_take(rctx, offset, length, need);
+				return rctx->heap + offset + sizeof(forth_cell_t);
+			}
+		}
+
+		offset += length & ~FORTH_HEAP_USED;
+	}
+
+	return 0;
+}
+
+// The offset of the header of an allocated block from its Forth address, end if addr is not one.
+static forth_cell_t forth_heap_find(struct forth_runtime_context *rctx, forth_cell_t addr, forth_cell_t end)
+{
+	forth_cell_t offset = addr - rctx->heap - sizeof(forth_cell_t);
+
+	if ((addr < (rctx->heap + sizeof(forth_cell_t))) || (offset >= end) || (0 != (offset & (sizeof(forth_cell_t) - 1)))
+		|| (0 == (FORTH_HEAP_USED & FORTH_HEAP_BLOCK(rctx, offset))))
+	{
+		return end;
+	}
+
+	return offset;
+}
+
+// ALLOCATE ( size -- addr ior )
+void forth_allocate(struct forth_runtime_context *rctx)
+{
+	forth_cell_t addr = forth_heap_allocate(rctx, POP());
+
+	PUSH(addr);
+	PUSH((0 == addr) ? -9 : 0);
+}
+
+// RESIZE ( addr1 size -- addr2 ior )
+void forth_resize(struct forth_runtime_context *rctx)
+{
+	forth_cell_t size = POP();
+	forth_cell_t addr = POP();
+	forth_cell_t end = forth_heap_end(rctx);
+	forth_cell_t offset = forth_heap_find(rctx, addr, end);
+	forth_cell_t need = forth_heap_need(size, end);
+	forth_cell_t length;
+	forth_cell_t new_addr;
+
+	if ((offset == end) || (0 == need))
+	{
+		PUSH(addr);
+		PUSH(-9);
+		return;
+	}
+
+	length = forth_heap_merge(rctx, offset, end);
+
+	if (length >= need)	// Fits where it is.
+	{
+		forth_heap_take(rctx, offset, length, need);
+		PUSH(addr);
+		PUSH(0);
+		return;
+	}
+
+	FORTH_HEAP_BLOCK(rctx, offset) = length | FORTH_HEAP_USED;
+	new_addr = forth_heap_allocate(rctx, size);
+
+	if (0 == new_addr)
+	{
+		PUSH(addr);
+		PUSH(-9);
+		return;
+	}
+
+	length = FORTH_HEAP_BLOCK(rctx, offset) & ~FORTH_HEAP_USED;
+	memcpy(FORTH_POINTER(rctx->arena, new_addr), FORTH_POINTER(rctx->arena, addr), length - sizeof(forth_cell_t));
+	FORTH_HEAP_BLOCK(rctx, offset) = length;
+	PUSH(new_addr);
+	PUSH(0);
+}
+
+// FREE (addr -- ior )
+void forth_free(struct forth_runtime_context *rctx)
+{
+	forth_cell_t end = forth_heap_end(rctx);
+	forth_cell_t offset = forth_heap_find(rctx, POP(), end);
+
+	if (offset == end)
+	{
+		PUSH(-9);
+		return;
+	}
+
+	FORTH_HEAP_BLOCK(rctx, offset) &= ~FORTH_HEAP_USED;
+	PUSH(0);
+}
+
+#endif
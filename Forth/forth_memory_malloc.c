@@ -26,7 +26,8 @@
 #include <stdlib.h>
 #include "forth_internal.h"
 
-#if defined(FORTH_INCLUDE_MEMORY_ALLOCATION_WORDS)
+// With FORTH_ARENA the memory has to be in the arena, see forth_memory_arena.c.
+#if defined(FORTH_INCLUDE_MEMORY_ALLOCATION_WORDS) && !defined(FORTH_ARENA)
 
 #define POP() *(rctx->sp++)
 #define PUSH(X) *(--(rctx->sp)) = (forth_cell_t)(X)
@@ -23,11 +23,36 @@
 
 // http://forth.teleonomix.com/
 
+#if defined(__linux__)
+#define _GNU_SOURCE	// memfd_create()
+#endif
+
 #include <unistd.h>
 #include <time.h>
 #include "forth.h"
 #include "forth_internal.h"
 
+#if defined(FORTH_GROWABLE_DICTIONARY) || defined(FORTH_KERNEL_ROM)
+#include <stdint.h>
+#include <sys/mman.h>
+#include "forth_dict.h"
+#endif
+
+#if defined(FORTH_KERNEL_ROM)
+#include <stdio.h>
+#include <string.h>
+#include <fcntl.h>
+#include "forth_interface.h"
+#endif
+
+#if defined(FORTH_FORK)
+#include <stddef.h>
+#include <stdlib.h>
+#include <sys/mman.h>
+#include <pthread.h>
+#include "forth_interface.h"
+#endif
+
 #define POP() *(rctx->sp++)
 #define PUSH(X) *(--(rctx->sp)) = (forth_cell_t)(X)
 
@@ -56,3 +81,265 @@ void forth_time_date(struct forth_runtime_context *rctx)
 }
 #endif
 
+#if defined(FORTH_GROWABLE_DICTIONARY)
+// The dictionary grows in steps of this many bytes (a multiple of the page size).
+#define FORTH_DICTIONARY_COMMIT_STEP	(64 * 1024)
+
+// The host reserved the dictionary with mmap(PROT_NONE), make the pages up to end readable and writable.
+int forth_dictionary_commit(forth_cell_t dictionary[], forth_cell_t end)
+{
+	uintptr_t page = sysconf(_SC_PAGESIZE);
+	uintptr_t base = (uintptr_t)dictionary;
+	uintptr_t from = (base + dictionary[FORTH_DP_COMMIT_LOCATION]) & ~(page - 1);
+	uintptr_t to = (base + end + FORTH_DICTIONARY_COMMIT_STEP - 1) & ~((uintptr_t)FORTH_DICTIONARY_COMMIT_STEP - 1);
+	uintptr_t limit = (base + dictionary[FORTH_DP_MAX_LOCATION] + page - 1) & ~(page - 1);
+
+	if (limit < to)
+	{
+		to = limit;
+	}
+
+	if (0 != mprotect((void *)from, to - from, PROT_READ | PROT_WRITE))
+	{
+		return -1;
+	}
+
+	dictionary[FORTH_DP_COMMIT_LOCATION] = to - base;
+	return 0;
+}
+#endif
+
+#if defined(FORTH_KERNEL_ROM)
+// Find the file forth_kernel[] is loaded from and its offset in it in /proc/self/maps, returns 0 if it is not there.
+static int forth_kernel_file(char *path, size_t size, off_t *offset)
+{
+	uintptr_t kernel = (uintptr_t)forth_kernel;
+	unsigned long long from, to, at;
+	char line[512];
+	char format[64];
+	int found = 0;
+	FILE *maps = fopen("/proc/self/maps", "r");
+
+	if (0 == maps)
+	{
+		return 0;
+	}
+
+	snprintf(format, sizeof(format), "%%llx-%%llx %%*s %%llx %%*s %%*s %%%us", (unsigned)(size - 1));
+
+	while (!found && (0 != fgets(line, sizeof(line), maps)))
+	{
+		if ((4 == sscanf(line, format, &from, &to, &at, path)) && (from <= kernel) && (kernel < to) && ('/' == path[0]))
+		{
+			*offset = at + (kernel - from);
+			found = 1;
+		}
+	}
+
+	fclose(maps);
+	return found;
+}
+
+// Map the kernel read only from its file to the start of dictionary (page aligned), returns 0 on success.
+// The file is looked up and opened once, forth_fork() maps the kernel for every child.
+static int forth_kernel_map(forth_cell_t dictionary[])
+{
+	static int fd = -1;
+	static off_t offset;
+	uintptr_t page = sysconf(_SC_PAGESIZE);
+	char path[256];
+	void *rom;
+
+	if ((0 != (FORTH_KERNEL_PAGE % page)) || (0 != ((uintptr_t)dictionary & (page - 1))))
+	{
+		return -1;
+	}
+
+	if ((0 > fd) && (!forth_kernel_file(path, sizeof(path), &offset) || (0 > (fd = open(path, O_RDONLY | O_CLOEXEC)))))
+	{
+		return -1;
+	}
+
+	rom = mmap(dictionary, sizeof(forth_kernel), PROT_READ, MAP_PRIVATE | MAP_FIXED, fd, offset);
+
+	if (rom != (void *)dictionary)
+	{
+		return -1;
+	}
+
+	if (0 != memcmp(rom, forth_kernel, sizeof(forth_kernel)))	// The file changed since it was loaded.
+	{
+		mmap(dictionary, sizeof(forth_kernel), PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_FIXED, -1, 0);
+		return -1;
+	}
+
+	return 0;
+}
+
+// Map the kernel, then copy the RAM overlay after it.
+int forth_kernel_share(forth_cell_t dictionary[])
+{
+	if (0 != forth_kernel_map(dictionary))
+	{
+		return -1;
+	}
+
+	memcpy(&dictionary[FORTH_KERNEL_ROM_CELLS], forth_kernel_ram, sizeof(forth_kernel_ram));
+	return 0;
+}
+#endif
+
+#if defined(FORTH_FORK)
+// An arena made by forth_arena_create(), the memfd behind it stays open for forth_fork().
+struct forth_fork_arena
+{
+	struct forth_fork_arena *next;
+	char *base;
+	forth_cell_t size;	// Bytes.
+	int fd;
+	int children;		// Made by forth_fork() and not released yet, the parent does not run while there are any.
+};
+
+static struct forth_fork_arena *forth_fork_arenas = 0;
+static pthread_mutex_t forth_fork_lock = PTHREAD_MUTEX_INITIALIZER;	// For the children counts, forks can be released in other threads.
+
+static struct forth_fork_arena *forth_fork_find(const char *base)
+{
+	struct forth_fork_arena *fa;
+
+	for (fa = forth_fork_arenas; (0 != fa) && (fa->base != base); fa = fa->next)
+	{
+	}
+
+	return fa;
+}
+
+int forth_arena_shared(const char *arena)
+{
+	return 0 != forth_fork_find(arena);
+}
+
+int forth_arena_children(const char *arena)
+{
+	struct forth_fork_arena *fa = forth_fork_find(arena);
+	int children = 0;
+
+	if (0 != fa)
+	{
+		pthread_mutex_lock(&forth_fork_lock);
+		children = fa->children;
+		pthread_mutex_unlock(&forth_fork_lock);
+	}
+
+	return children;
+}
+
+char *forth_arena_create(forth_cell_t size, forth_cell_t commit)
+{
+	struct forth_fork_arena *fa = malloc(sizeof(*fa));
+	int fd = memfd_create("forth-arena", MFD_CLOEXEC);
+	char *base = MAP_FAILED;
+
+	if ((0 != fa) && (0 <= fd) && (0 == ftruncate(fd, size)))
+	{
+		base = mmap(0, size, PROT_NONE, MAP_SHARED | MAP_NORESERVE, fd, 0);
+	}
+
+	if ((MAP_FAILED == base) || (0 != mprotect(base, commit, PROT_READ | PROT_WRITE)))
+	{
+		if (MAP_FAILED != base)
+		{
+			munmap(base, size);
+		}
+
+		if (0 <= fd)
+		{
+			close(fd);
+		}
+
+		free(fa);
+		return 0;
+	}
+
+	fa->base = base;
+	fa->size = size;
+	fa->fd = fd;
+	fa->children = 0;
+	fa->next = forth_fork_arenas;
+	forth_fork_arenas = fa;
+	return base;
+}
+
+// Pointers of the run time context into the arena of the parent point to the same place in the fork.
+#define FORTH_FORK_MOVE(FA, P, DELTA)	do { \
+		if (((char *)(P) >= (FA)->base) && ((char *)(P) < ((FA)->base + (FA)->size))) \
+		{ \
+			(P) = (void *)((char *)(P) + (DELTA)); \
+		} \
+	} while (0)
+
+struct forth_runtime_context *forth_fork(struct forth_runtime_context *parent)
+{
+	struct forth_fork_arena *fa = forth_fork_find(parent->arena);
+	struct forth_runtime_context *child;
+	ptrdiff_t delta;
+	char *arena;
+
+	if ((0 == fa) || ((char *)parent < fa->base) || (((char *)(parent + 1)) > (fa->base + fa->size)))
+	{
+		return 0;
+	}
+
+	// The pages are shared until one side writes them, the memfd is only read.
+	arena = mmap(0, fa->size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_NORESERVE, fa->fd, 0);
+	if (MAP_FAILED == arena)
+	{
+		return 0;
+	}
+
+	delta = arena - fa->base;
+	child = (struct forth_runtime_context *)(((char *)parent) + delta);
+
+	FORTH_FORK_MOVE(fa, child->dictionary, delta);
+	FORTH_FORK_MOVE(fa, child->sp_max, delta);
+	FORTH_FORK_MOVE(fa, child->sp_min, delta);
+	FORTH_FORK_MOVE(fa, child->sp0, delta);
+	FORTH_FORK_MOVE(fa, child->sp, delta);
+	FORTH_FORK_MOVE(fa, child->rp_max, delta);
+	FORTH_FORK_MOVE(fa, child->rp_min, delta);
+	FORTH_FORK_MOVE(fa, child->rp0, delta);
+	FORTH_FORK_MOVE(fa, child->rp, delta);
+	FORTH_FORK_MOVE(fa, child->source_address, delta);
+	FORTH_FORK_MOVE(fa, child->wordlists, delta);
+	FORTH_FORK_MOVE(fa, child->numbuff_ptr, delta);
+	child->arena = arena;
+	child->forked = fa->base;
+
+#if defined(FORTH_KERNEL_ROM)
+	// The parent's kernel pages are mapped from the executable, the memfd only has zeros under them.
+	if (0 != forth_kernel_map(child->dictionary))
+	{
+		memcpy(child->dictionary, forth_kernel, sizeof(forth_kernel));
+	}
+#endif
+
+	pthread_mutex_lock(&forth_fork_lock);
+	fa->children++;
+	pthread_mutex_unlock(&forth_fork_lock);
+	return child;
+}
+
+void forth_fork_release(struct forth_runtime_context *child)
+{
+	struct forth_fork_arena *fa;
+
+	if (0 != child->forked)
+	{
+		fa = forth_fork_find(child->forked);
+		munmap(child->arena, fa->size);
+		pthread_mutex_lock(&forth_fork_lock);
+		fa->children--;
+		pthread_mutex_unlock(&forth_fork_lock);
+	}
+}
+#endif
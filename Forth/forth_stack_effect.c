@@ -0,0 +1,757 @@
+/*
+* Copyright (c) 2026 The Embeddable Forth Command Interpreter contributors
+*
+* Permission is hereby granted, free of charge, to any person obtaining a copy
+* of this software and associated documentation files (the "Software"), to deal
+* in the Software without restriction, including without limitation the rights
+* to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+* copies of the Software, and to permit persons to whom the Software is
+* furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in
+* all copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+* AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+* THE SOFTWARE.
+*
+*/
+
+// http://forth.teleonomix.com/
+
+// Static stack effect of colon definitions.
+//
+// The body is walked once in the order it was compiled, keeping the data and return stack depth relative to the entry.
+// The depth at every branch target is remembered, paths that meet must agree, and so must every EXIT.
+// Calls use the effect ; has recorded in the callee's header, definitions of the kernel are looked at when called.
+// A definition that calls itself is walked twice: the first time paths through the recursive call are dropped,
+// the second time the call is taken to have the effect found the first time, which then has to come out the same.
+//
+// Anything with a stack effect that depends on the data (?DUP, PICK, EXECUTE, SEARCH-WORDLIST...) makes the effect
+// unknown, and so does taking from the return stack what the definition has not put there.
+
+#include "forth.h"
+#include "forth_internal.h"
+#include "forth_dict.h"
+
+#if defined(FORTH_STACK_EFFECT)
+
+#define FORTH_EFFECT_MAX_BODY	256	// Cells, longer definitions are not analysed.
+#define FORTH_EFFECT_NESTING	6	// Calls followed into definitions that have no recorded effect.
+#define FORTH_EFFECT_UNSET	(-32768)
+
+// The effect of tokens that simply take and leave cells on the data stack, 0 for the rest.
+#define FORTH_EFFECT(IN, OUT)	((unsigned char)(0x80 | ((IN) << 3) | (OUT)))
+#define FORTH_EFFECT_IN(E)	(((E) >> 3) & 0x0F)
+#define FORTH_EFFECT_OUT(E)	((E) & 0x07)
+#define FORTH_EFFECT_MAX(E)	((FORTH_EFFECT_IN(E) > FORTH_EFFECT_OUT(E)) ? FORTH_EFFECT_IN(E) : FORTH_EFFECT_OUT(E))
+
+static const unsigned char forth_token_effects[FORTH_TOKEN_COUNT] =
+{
+	[FORTH_TOKEN_NOP] = FORTH_EFFECT(0, 0),
+	[FORTH_TOKEN_ACCEPT] = FORTH_EFFECT(2, 1),
+	[FORTH_TOKEN_KEY] = FORTH_EFFECT(0, 1),
+	[FORTH_TOKEN_EKEY] = FORTH_EFFECT(0, 1),
+	[FORTH_TOKEN_KEYq] = FORTH_EFFECT(0, 1),
+	[FORTH_TOKEN_EKEYq] = FORTH_EFFECT(0, 1),
+	[FORTH_TOKEN_EKEY2CHAR] = FORTH_EFFECT(1, 2),
+#if defined(FORTH_USER_VARIABLES)
+	[FORTH_TOKEN_USER_ALLOT] = FORTH_EFFECT(1, 1),
+#endif
+	[FORTH_TOKEN_ALIGN] = FORTH_EFFECT(0, 0),
+	[FORTH_TOKEN_ALIGNED] = FORTH_EFFECT(1, 1),
+	[FORTH_TOKEN_ALLOT] = FORTH_EFFECT(1, 0),
+	[FORTH_TOKEN_pHERE] = FORTH_EFFECT(0, 1),
+	[FORTH_TOKEN_pTRACE] = FORTH_EFFECT(0, 1),
+	[FORTH_TOKEN_HERE] = FORTH_EFFECT(0, 1),
+	[FORTH_TOKEN_PAD] = FORTH_EFFECT(0, 1),
+	[FORTH_TOKEN_CComma] = FORTH_EFFECT(1, 0),
+	[FORTH_TOKEN_CompileComma] = FORTH_EFFECT(1, 0),
+	[FORTH_TOKEN_Comma] = FORTH_EFFECT(1, 0),
+	[FORTH_TOKEN_Imm_Plus] = FORTH_EFFECT(1, 1),
+	[FORTH_TOKEN_Imm_AND] = FORTH_EFFECT(1, 1),
+	[FORTH_TOKEN_Imm_OR] = FORTH_EFFECT(1, 1),
+	[FORTH_TOKEN_Imm_XOR] = FORTH_EFFECT(1, 1),
+	[FORTH_TOKEN_Imm_LSHIFT] = FORTH_EFFECT(1, 1),
+	[FORTH_TOKEN_Imm_RSHIFT] = FORTH_EFFECT(1, 1),
+	[FORTH_TOKEN_Imm_Equal] = FORTH_EFFECT(1, 1),
+	[FORTH_TOKEN_Imm_Less] = FORTH_EFFECT(1, 1),
+	[FORTH_TOKEN_Imm_Fetch] = FORTH_EFFECT(1, 1),
+	[FORTH_TOKEN_CELLS] = FORTH_EFFECT(1, 1),
+	[FORTH_TOKEN_DROP] = FORTH_EFFECT(1, 0),
+	[FORTH_TOKEN_DUP] = FORTH_EFFECT(1, 2),
+	[FORTH_TOKEN_NIP] = FORTH_EFFECT(2, 1),
+	[FORTH_TOKEN_TUCK] = FORTH_EFFECT(2, 3),
+	[FORTH_TOKEN_ROT] = FORTH_EFFECT(3, 3),
+	[FORTH_TOKEN_OVER] = FORTH_EFFECT(2, 3),
+	[FORTH_TOKEN_SWAP] = FORTH_EFFECT(2, 2),
+	[FORTH_TOKEN_2ROT] = FORTH_EFFECT(6, 6),
+	[FORTH_TOKEN_2DUP] = FORTH_EFFECT(2, 4),
+	[FORTH_TOKEN_2DROP] = FORTH_EFFECT(2, 0),
+	[FORTH_TOKEN_2OVER] = FORTH_EFFECT(4, 6),
+	[FORTH_TOKEN_2SWAP] = FORTH_EFFECT(4, 4),
+	[FORTH_TOKEN_2Fetch] = FORTH_EFFECT(1, 2),
+	[FORTH_TOKEN_2Store] = FORTH_EFFECT(3, 0),
+	[FORTH_TOKEN_Fetch] = FORTH_EFFECT(1, 1),
+	[FORTH_TOKEN_Store] = FORTH_EFFECT(2, 0),
+	[FORTH_TOKEN_CFetch] = FORTH_EFFECT(1, 1),
+	[FORTH_TOKEN_CStore] = FORTH_EFFECT(2, 0),
+	[FORTH_TOKEN_PlusStore] = FORTH_EFFECT(2, 0),
+	[FORTH_TOKEN_DUMP] = FORTH_EFFECT(2, 0),
+	[FORTH_TOKEN_UNUSED] = FORTH_EFFECT(0, 1),
+	[FORTH_TOKEN_COMPARE] = FORTH_EFFECT(4, 1),
+	[FORTH_TOKEN_LessHash] = FORTH_EFFECT(0, 0),
+#if !defined(FORTH_NO_DOUBLES)
+	[FORTH_TOKEN_Hash] = FORTH_EFFECT(2, 2),
+#endif
+	[FORTH_TOKEN_HashGreater] = FORTH_EFFECT(2, 2),
+	[FORTH_TOKEN_HOLD] = FORTH_EFFECT(1, 0),
+	[FORTH_TOKEN_Hdot] = FORTH_EFFECT(1, 0),
+	[FORTH_TOKEN_Dot] = FORTH_EFFECT(1, 0),
+	[FORTH_TOKEN_DotS] = FORTH_EFFECT(0, 0),
+	[FORTH_TOKEN_Udot] = FORTH_EFFECT(1, 0),
+	[FORTH_TOKEN_DotR] = FORTH_EFFECT(2, 0),
+	[FORTH_TOKEN_UdotR] = FORTH_EFFECT(2, 0),
+	[FORTH_TOKEN_DotName] = FORTH_EFFECT(1, 0),
+	[FORTH_TOKEN_CMOVE] = FORTH_EFFECT(3, 0),
+	[FORTH_TOKEN_CMOVE_down] = FORTH_EFFECT(3, 0),
+	[FORTH_TOKEN_MOVE] = FORTH_EFFECT(3, 0),
+	[FORTH_TOKEN_FILL] = FORTH_EFFECT(3, 0),
+	[FORTH_TOKEN_LATEST] = FORTH_EFFECT(0, 1),
+	[FORTH_TOKEN_pDefining] = FORTH_EFFECT(0, 1),
+	[FORTH_TOKEN_PARSE] = FORTH_EFFECT(1, 2),
+	[FORTH_TOKEN_PARSE_WORD] = FORTH_EFFECT(0, 2),
+	[FORTH_TOKEN_WORD] = FORTH_EFFECT(1, 1),
+	[FORTH_TOKEN_Plus] = FORTH_EFFECT(2, 1),
+	[FORTH_TOKEN_Subtract] = FORTH_EFFECT(2, 1),
+	[FORTH_TOKEN_Divide] = FORTH_EFFECT(2, 1),
+	[FORTH_TOKEN_Multiply] = FORTH_EFFECT(2, 1),
+	[FORTH_TOKEN_MOD] = FORTH_EFFECT(2, 1),
+	[FORTH_TOKEN_Slash_MOD] = FORTH_EFFECT(2, 2),
+#if !defined(FORTH_NO_DOUBLES)
+	[FORTH_TOKEN_StarSlash] = FORTH_EFFECT(3, 1),
+	[FORTH_TOKEN_StarSlash_MOD] = FORTH_EFFECT(3, 2),
+	[FORTH_TOKEN_UM_Star] = FORTH_EFFECT(2, 2),
+	[FORTH_TOKEN_M_Star] = FORTH_EFFECT(2, 2),
+	[FORTH_TOKEN_M_Plus] = FORTH_EFFECT(3, 2),
+	[FORTH_TOKEN_UM_Slash_MOD] = FORTH_EFFECT(3, 2),
+#endif
+	[FORTH_TOKEN_NEGATE] = FORTH_EFFECT(1, 1),
+	[FORTH_TOKEN_ABS] = FORTH_EFFECT(1, 1),
+	[FORTH_TOKEN_MIN] = FORTH_EFFECT(2, 1),
+	[FORTH_TOKEN_MAX] = FORTH_EFFECT(2, 1),
+	[FORTH_TOKEN_LSHIFT] = FORTH_EFFECT(2, 1),
+	[FORTH_TOKEN_RSHIFT] = FORTH_EFFECT(2, 1),
+	[FORTH_TOKEN_2_Star] = FORTH_EFFECT(1, 1),
+	[FORTH_TOKEN_2_Slash] = FORTH_EFFECT(1, 1),
+#if !defined(FORTH_NO_DOUBLES)
+	[FORTH_TOKEN_D2_Star] = FORTH_EFFECT(2, 2),
+	[FORTH_TOKEN_D2_Slash] = FORTH_EFFECT(2, 2),
+	[FORTH_TOKEN_DNEGATE] = FORTH_EFFECT(2, 2),
+	[FORTH_TOKEN_DABS] = FORTH_EFFECT(2, 2),
+	[FORTH_TOKEN_DMIN] = FORTH_EFFECT(4, 2),
+	[FORTH_TOKEN_DMAX] = FORTH_EFFECT(4, 2),
+	[FORTH_TOKEN_D_Plus] = FORTH_EFFECT(4, 2),
+	[FORTH_TOKEN_D_Subtract] = FORTH_EFFECT(4, 2),
+	[FORTH_TOKEN_D_Less] = FORTH_EFFECT(4, 1),
+	[FORTH_TOKEN_D_ULess] = FORTH_EFFECT(4, 1),
+#endif
+	[FORTH_TOKEN_D_Equal] = FORTH_EFFECT(4, 1),
+	[FORTH_TOKEN_AND] = FORTH_EFFECT(2, 1),
+	[FORTH_TOKEN_OR] = FORTH_EFFECT(2, 1),
+	[FORTH_TOKEN_XOR] = FORTH_EFFECT(2, 1),
+	[FORTH_TOKEN_INVERT] = FORTH_EFFECT(1, 1),
+#if !defined(FORTH_NO_DOUBLES)
+	[FORTH_TOKEN_toNUMBER] = FORTH_EFFECT(4, 4),
+#endif
+	[FORTH_TOKEN_TIB] = FORTH_EFFECT(0, 1),
+	[FORTH_TOKEN_HashTIB] = FORTH_EFFECT(0, 1),
+	[FORTH_TOKEN_BLK] = FORTH_EFFECT(0, 1),
+	[FORTH_TOKEN_QUERY] = FORTH_EFFECT(0, 0),
+	[FORTH_TOKEN_REFILL] = FORTH_EFFECT(0, 1),
+	[FORTH_TOKEN_pSOURCE_ID] = FORTH_EFFECT(0, 1),
+	[FORTH_TOKEN_SOURCE] = FORTH_EFFECT(0, 2),
+	[FORTH_TOKEN_SOURCE_Store] = FORTH_EFFECT(2, 0),
+	[FORTH_TOKEN_toIN] = FORTH_EFFECT(0, 1),
+#if defined(FORTH_INCLUDE_FILE_ACCESS_WORDS)
+	[FORTH_TOKEN_LINE_NUMBER] = FORTH_EFFECT(0, 1),
+#endif
+	[FORTH_TOKEN_BASE] = FORTH_EFFECT(0, 1),
+	[FORTH_TOKEN_STATE] = FORTH_EFFECT(0, 1),
+	[FORTH_TOKEN_THROW] = FORTH_EFFECT(1, 0),	// When it returns at all.
+	[FORTH_TOKEN_DotError] = FORTH_EFFECT(1, 0),
+	[FORTH_TOKEN_AT_XY] = FORTH_EFFECT(2, 0),
+	[FORTH_TOKEN_PAGE] = FORTH_EFFECT(0, 0),
+#if defined(FORTH_INCLUDE_MS)
+	[FORTH_TOKEN_MS] = FORTH_EFFECT(1, 0),
+#endif
+#if defined(FORTH_INCLUDE_TIME_DATE)
+	[FORTH_TOKEN_TIME_DATE] = FORTH_EFFECT(0, 6),
+#endif
+#if defined(FORTH_AOT)
+	[FORTH_TOKEN_TRANSLATE_C] = FORTH_EFFECT(3, 1),
+#endif
+#if defined(FORTH_IMAGE)
+	[FORTH_TOKEN_SAVE_IMAGE] = FORTH_EFFECT(2, 1),
+#endif
+	[FORTH_TOKEN_STACK_EFFECT] = FORTH_EFFECT(1, 3),
+#if defined(FORTH_WORDLIST_INDEX)
+	[FORTH_TOKEN_WORDLIST_INDEX] = FORTH_EFFECT(2, 0),
+#endif
+#if defined(FORTH_NAME_SPACE)
+	[FORTH_TOKEN_NAME_COMMA] = FORTH_EFFECT(2, 1),
+#endif
+	[FORTH_TOKEN_CR] = FORTH_EFFECT(0, 0),
+	[FORTH_TOKEN_EMIT] = FORTH_EFFECT(1, 0),
+	[FORTH_TOKEN_TYPE] = FORTH_EFFECT(2, 0),
+	[FORTH_TOKEN_WORDS] = FORTH_EFFECT(0, 0),
+	[FORTH_TOKEN_pSEE] = FORTH_EFFECT(1, 0),
+	[FORTH_TOKEN_ONLY] = FORTH_EFFECT(0, 0),
+	[FORTH_TOKEN_ALSO] = FORTH_EFFECT(0, 0),
+	[FORTH_TOKEN_CURRENT] = FORTH_EFFECT(0, 1),
+	[FORTH_TOKEN_CONTEXT] = FORTH_EFFECT(0, 1),
+	[FORTH_TOKEN_toBODY] = FORTH_EFFECT(1, 1),
+	[FORTH_TOKEN_Equal] = FORTH_EFFECT(2, 1),
+	[FORTH_TOKEN_Notequal] = FORTH_EFFECT(2, 1),
+	[FORTH_TOKEN_Less] = FORTH_EFFECT(2, 1),
+	[FORTH_TOKEN_Greater] = FORTH_EFFECT(2, 1),
+	[FORTH_TOKEN_ULess] = FORTH_EFFECT(2, 1),
+	[FORTH_TOKEN_UGreater] = FORTH_EFFECT(2, 1),
+	[FORTH_TOKEN_0Equal] = FORTH_EFFECT(1, 1),
+	[FORTH_TOKEN_0Notequal] = FORTH_EFFECT(1, 1),
+	[FORTH_TOKEN_0Less] = FORTH_EFFECT(1, 1),
+	[FORTH_TOKEN_0Greater] = FORTH_EFFECT(1, 1),
+	[FORTH_TOKEN_LITERAL] = FORTH_EFFECT(1, 0),
+	[FORTH_TOKEN_sp0] = FORTH_EFFECT(0, 1),
+	[FORTH_TOKEN_sp_fetch] = FORTH_EFFECT(0, 1),
+	[FORTH_TOKEN_rp0] = FORTH_EFFECT(0, 1),
+	[FORTH_TOKEN_rp_fetch] = FORTH_EFFECT(0, 1),
+	[FORTH_TOKEN_handler] = FORTH_EFFECT(0, 1),
+	[FORTH_TOKEN_abort_msg] = FORTH_EFFECT(0, 1),
+#if defined(FORTH_INCLUDE_FILE_ACCESS_WORDS)
+	[FORTH_TOKEN_FILE_CREATE] = FORTH_EFFECT(3, 2),
+	[FORTH_TOKEN_FILE_OPEN] = FORTH_EFFECT(3, 2),
+	[FORTH_TOKEN_FILE_FLUSH] = FORTH_EFFECT(1, 1),
+	[FORTH_TOKEN_FILE_DELETE] = FORTH_EFFECT(2, 1),
+	[FORTH_TOKEN_FILE_REPOSITION] = FORTH_EFFECT(3, 1),
+	[FORTH_TOKEN_FILE_POSITION] = FORTH_EFFECT(1, 3),
+	[FORTH_TOKEN_FILE_SIZE] = FORTH_EFFECT(1, 3),
+	[FORTH_TOKEN_FILE_READ] = FORTH_EFFECT(3, 2),
+	[FORTH_TOKEN_FILE_READ_LINE] = FORTH_EFFECT(3, 3),
+	[FORTH_TOKEN_FILE_WRITE] = FORTH_EFFECT(3, 1),
+	[FORTH_TOKEN_FILE_WRITE_LINE] = FORTH_EFFECT(3, 1),
+	[FORTH_TOKEN_FILE_CLOSE] = FORTH_EFFECT(1, 1),
+#endif
+#if defined(FORTH_INCLUDE_MEMORY_ALLOCATION_WORDS)
+	[FORTH_TOKEN_ALLOCATE] = FORTH_EFFECT(1, 2),
+	[FORTH_TOKEN_RESIZE] = FORTH_EFFECT(2, 2),
+	[FORTH_TOKEN_FREE] = FORTH_EFFECT(1, 1),
+#endif
+	[FORTH_TOKEN_resolve_branch] = FORTH_EFFECT(2, 0),
+	[FORTH_TOKEN_ix2address] = FORTH_EFFECT(1, 1),
+	[FORTH_TOKEN_xtlit] = FORTH_EFFECT(0, 1),
+	[FORTH_TOKEN_lit] = FORTH_EFFECT(0, 1),
+	[FORTH_TOKEN_uslit] = FORTH_EFFECT(0, 1),
+	[FORTH_TOKEN_sslit] = FORTH_EFFECT(0, 1),
+	[FORTH_TOKEN_strlit] = FORTH_EFFECT(0, 2),
+	[FORTH_TOKEN_OVER_Plus] = FORTH_EFFECT(2, 2),
+	[FORTH_TOKEN_DUP_0Equal] = FORTH_EFFECT(1, 2),
+	[FORTH_TOKEN_Fetch_Plus] = FORTH_EFFECT(2, 1),
+};
+
+struct forth_effect
+{
+	int	in;
+	int	out;
+	int	max;	// 15 or more: too deep or unbounded.
+};
+
+struct forth_effect_walk
+{
+	int	d;	// Data stack depth relative to the entry.
+	int	r;	// Return stack depth relative to the entry.
+	int	min;
+	int	max;
+	int	exit_d;	// At EXIT, the same for every one.
+	int	live;	// The cell being looked at can be reached.
+	int	recursive;
+	short	target_d[FORTH_EFFECT_MAX_BODY + 1];
+	short	target_r[FORTH_EFFECT_MAX_BODY + 1];
+	short	leave_to[FORTH_EFFECT_MAX_BODY];	// Where LEAVE goes from the innermost DO-loop.
+	int	loops;
+};
+
+static int forth_effect_of_xt(struct forth_runtime_context *rctx, forth_cell_t xt, struct forth_effect *e, int nesting);
+
+// Take IN cells and leave OUT cells, MAX is the most cells used counting the IN.
+static void forth_effect_apply(struct forth_effect_walk *w, int in, int out, int max)
+{
+	if (w->max < (w->d - in + max))
+	{
+		w->max = w->d - in + max;
+	}
+
+	w->d -= in;
+	if (w->min > w->d)
+	{
+		w->min = w->d;
+	}
+	w->d += out;
+	if (w->max < w->d)
+	{
+		w->max = w->d;
+	}
+}
+
+// Continue at target with the current depths, returns 0 if the depths there disagree.
+static int forth_effect_branch(struct forth_effect_walk *w, forth_cell_t ix, forth_scell_t target, int r)
+{
+	if ((0 > target) || (FORTH_EFFECT_MAX_BODY < target))
+	{
+		return 0;
+	}
+
+	if (FORTH_EFFECT_UNSET == w->target_d[target])
+	{
+		if (target <= (forth_scell_t)ix)	// Backward to a cell that was not reached.
+		{
+			return 0;
+		}
+		w->target_d[target] = w->d;
+		w->target_r[target] = r;
+		return 1;
+	}
+
+	return (w->target_d[target] == w->d) && (w->target_r[target] == r);
+}
+
+static int forth_effect_exit(struct forth_effect_walk *w)
+{
+	if (0 != w->r)	// Loop frames or >R left on the return stack.
+	{
+		return 0;
+	}
+
+	if (FORTH_EFFECT_UNSET == w->exit_d)
+	{
+		w->exit_d = w->d;
+	}
+
+	w->live = 0;
+	return w->exit_d == w->d;
+}
+
+// One walk over the body of xt, SELF is the effect assumed for recursive calls (0 for the first walk).
+static int forth_effect_walk(struct forth_runtime_context *rctx, forth_cell_t xt, struct forth_effect_walk *w,
+	const struct forth_effect *self, int nesting)
+{
+	forth_cell_t *dictionary = rctx->dictionary;
+	forth_cell_t *body = &dictionary[xt + 1];
+	forth_cell_t ix;
+	forth_cell_t cell;
+	forth_cell_t callee;
+	forth_scell_t target;
+	unsigned char effect;
+	struct forth_effect e;
+	int tail;
+
+	w->d = 0;
+	w->r = 0;
+	w->min = 0;
+	w->max = 0;
+	w->exit_d = FORTH_EFFECT_UNSET;
+	w->live = 1;
+	w->recursive = 0;
+	w->loops = 0;
+
+	for (ix = 0; ix <= FORTH_EFFECT_MAX_BODY; ix++)
+	{
+		w->target_d[ix] = FORTH_EFFECT_UNSET;
+	}
+
+	for (ix = 0; ix < FORTH_EFFECT_MAX_BODY; ix++)
+	{
+		cell = body[ix];
+
+		if (FORTH_EFFECT_UNSET != w->target_d[ix])
+		{
+			if (w->live && ((w->target_d[ix] != w->d) || (w->target_r[ix] != w->r)))
+			{
+				return 0;
+			}
+			w->d = w->target_d[ix];
+			w->r = w->target_r[ix];
+			w->live = 1;
+		}
+		else if (w->live)
+		{
+			w->target_d[ix] = w->d;	// Where backward branches have to come back with.
+			w->target_r[ix] = w->r;
+		}
+
+		if (FORTH_PACK_TOKEN(FORTH_TOKEN_unnest) == cell)
+		{
+			return !w->live || forth_effect_exit(w);
+		}
+
+		if (!w->live)	// Not reached, e.g. after EXIT or AGAIN.
+		{
+			if (FORTH_IS_TOKEN(cell) && ((FORTH_TOKEN_lit == FORTH_EXTRACT_TOKEN(cell)) || (FORTH_TOKEN_xtlit == FORTH_EXTRACT_TOKEN(cell))
+				|| (FORTH_TOKEN_tailcall == FORTH_EXTRACT_TOKEN(cell)) || (FORTH_TOKEN_inlined == FORTH_EXTRACT_TOKEN(cell))))
+			{
+				ix++;
+			}
+			else if (FORTH_IS_TOKEN(cell) && (FORTH_TOKEN_strlit == FORTH_EXTRACT_TOKEN(cell)))
+			{
+				ix += FORTH_ALIGN(FORTH_PARAM_UNSIGNED(cell)) / sizeof(forth_cell_t);
+			}
+			continue;
+		}
+
+		tail = 0;
+		callee = cell;
+
+		if (FORTH_IS_TOKEN(cell))
+		{
+			target = ix + 1 + FORTH_PARAM_SIGNED(cell);
+
+			switch (FORTH_EXTRACT_TOKEN(cell))
+			{
+				case FORTH_TOKEN_lit:
+				case FORTH_TOKEN_xtlit:
+					ix++;
+					forth_effect_apply(w, 0, 1, 1);
+				continue;
+
+				case FORTH_TOKEN_strlit:
+					ix += FORTH_ALIGN(FORTH_PARAM_UNSIGNED(cell)) / sizeof(forth_cell_t);
+					forth_effect_apply(w, 0, 2, 2);
+				continue;
+
+				case FORTH_TOKEN_inlined:	// The body follows.
+					ix++;
+				continue;
+
+				case FORTH_TOKEN_tailcall:
+					ix++;
+					callee = body[ix];
+					tail = 1;
+				break;
+
+				case FORTH_TOKEN_EXIT:
+					if (!forth_effect_exit(w))
+					{
+						return 0;
+					}
+				continue;
+
+				case FORTH_TOKEN_branch:
+					if (!forth_effect_branch(w, ix, target, w->r))
+					{
+						return 0;
+					}
+					w->live = 0;
+				continue;
+
+				case FORTH_TOKEN_0branch:
+				case FORTH_TOKEN_0Equal_0branch:
+				case FORTH_TOKEN_0Notequal_0branch:
+				case FORTH_TOKEN_0Less_0branch:
+				case FORTH_TOKEN_0Greater_0branch:
+					forth_effect_apply(w, 1, 0, 1);
+					if (!forth_effect_branch(w, ix, target, w->r))
+					{
+						return 0;
+					}
+				continue;
+
+				case FORTH_TOKEN_Equal_0branch:
+				case FORTH_TOKEN_Notequal_0branch:
+				case FORTH_TOKEN_Less_0branch:
+				case FORTH_TOKEN_Greater_0branch:
+				case FORTH_TOKEN_ULess_0branch:
+				case FORTH_TOKEN_UGreater_0branch:
+					forth_effect_apply(w, 2, 0, 2);
+					if (!forth_effect_branch(w, ix, target, w->r))
+					{
+						return 0;
+					}
+				continue;
+
+				case FORTH_TOKEN_pDO:
+				case FORTH_TOKEN_pqDO:
+					forth_effect_apply(w, 2, 0, 2);
+					if ((FORTH_TOKEN_pqDO == FORTH_EXTRACT_TOKEN(cell)) && !forth_effect_branch(w, ix, target, w->r))
+					{
+						return 0;
+					}
+					w->r += 3;
+					w->leave_to[w->loops++] = target;
+				continue;
+
+				case FORTH_TOKEN_pPlusLOOP:
+					forth_effect_apply(w, 1, 0, 1);
+					// Fall through.
+				case FORTH_TOKEN_pLOOP:
+					if ((3 > w->r) || !forth_effect_branch(w, ix, target, w->r))
+					{
+						return 0;
+					}
+					w->r -= 3;
+				continue;
+
+				case FORTH_TOKEN_LEAVE:
+					while ((0 < w->loops) && (w->leave_to[w->loops - 1] <= (forth_scell_t)ix))	// Loops that have ended already.
+					{
+						w->loops--;
+					}
+					if ((0 == w->loops) || (3 > w->r) || !forth_effect_branch(w, ix, w->leave_to[w->loops - 1], w->r - 3))
+					{
+						return 0;
+					}
+					w->live = 0;
+				continue;
+
+				case FORTH_TOKEN_UNLOOP:
+					if (3 > w->r)
+					{
+						return 0;
+					}
+					w->r -= 3;
+				continue;
+
+				case FORTH_TOKEN_I:
+				case FORTH_TOKEN_J:
+				case FORTH_TOKEN_I_Plus:
+					if (((FORTH_TOKEN_J == FORTH_EXTRACT_TOKEN(cell)) ? 6 : 3) > w->r)
+					{
+						return 0;
+					}
+					forth_effect_apply(w, (FORTH_TOKEN_I_Plus == FORTH_EXTRACT_TOKEN(cell)) ? 1 : 0, 1, 1);
+				continue;
+
+				case FORTH_TOKEN_toR:
+				case FORTH_TOKEN_2toR:
+					forth_effect_apply(w, (FORTH_TOKEN_toR == FORTH_EXTRACT_TOKEN(cell)) ? 1 : 2, 0, 2);
+					w->r += (FORTH_TOKEN_toR == FORTH_EXTRACT_TOKEN(cell)) ? 1 : 2;
+				continue;
+
+				case FORTH_TOKEN_Rfrom:
+				case FORTH_TOKEN_Rfetch:
+				case FORTH_TOKEN_Rfrom_DROP:
+					if (1 > w->r)	// Not ours.
+					{
+						return 0;
+					}
+					if (FORTH_TOKEN_Rfrom_DROP != FORTH_EXTRACT_TOKEN(cell))
+					{
+						forth_effect_apply(w, 0, 1, 1);
+					}
+					if (FORTH_TOKEN_Rfetch != FORTH_EXTRACT_TOKEN(cell))
+					{
+						w->r--;
+					}
+				continue;
+
+				case FORTH_TOKEN_2Rfrom:
+				case FORTH_TOKEN_2Rfetch:
+					if (2 > w->r)
+					{
+						return 0;
+					}
+					forth_effect_apply(w, 0, 2, 2);
+					if (FORTH_TOKEN_2Rfrom == FORTH_EXTRACT_TOKEN(cell))
+					{
+						w->r -= 2;
+					}
+				continue;
+
+				default:
+					effect = forth_token_effects[FORTH_EXTRACT_TOKEN(cell)];
+					if (0 == effect)
+					{
+						return 0;
+					}
+					forth_effect_apply(w, FORTH_EFFECT_IN(effect), FORTH_EFFECT_OUT(effect), FORTH_EFFECT_MAX(effect));
+				continue;
+			}
+		}
+
+		if (callee == xt)	// RECURSE
+		{
+			w->recursive = 1;
+			if (0 == self)
+			{
+				w->live = 0;	// This path is looked at the second time.
+				continue;
+			}
+			forth_effect_apply(w, self->in, self->out, self->max);
+		}
+		else
+		{
+			if (!forth_effect_of_xt(rctx, callee, &e, nesting))
+			{
+				return 0;
+			}
+			forth_effect_apply(w, e.in, e.out, e.max);
+		}
+
+		if (tail && !forth_effect_exit(w))
+		{
+			return 0;
+		}
+	}
+
+	return 0;	// Too long.
+}
+
+static int forth_effect_of_body(struct forth_runtime_context *rctx, forth_cell_t xt, struct forth_effect *e, int nesting)
+{
+	struct forth_effect_walk w;
+	struct forth_effect first;
+
+	if (!forth_effect_walk(rctx, xt, &w, 0, nesting + 1) || (FORTH_EFFECT_UNSET == w.exit_d))
+	{
+		return 0;
+	}
+
+	e->in = -w.min;
+	e->out = w.exit_d + e->in;
+	e->max = w.max + e->in;
+
+	if (w.recursive)
+	{
+		first = *e;
+		if (!forth_effect_walk(rctx, xt, &w, &first, nesting + 1) || (FORTH_EFFECT_UNSET == w.exit_d)
+			|| (first.in != -w.min) || (first.out != (w.exit_d - w.min)))
+		{
+			return 0;
+		}
+		e->max = 15;	// Recursion has no bound we could know of.
+	}
+
+	return 1;
+}
+
+static int forth_effect_of_xt(struct forth_runtime_context *rctx, forth_cell_t xt, struct forth_effect *e, int nesting)
+{
+	forth_cell_t *dictionary = rctx->dictionary;
+	forth_cell_t code;
+	forth_cell_t flags;
+	unsigned char effect;
+	struct forth_effect does;
+
+	if (FORTH_IS_TOKEN(xt) || (2 > xt) || ((dictionary[FORTH_DP_LOCATION] / sizeof(forth_cell_t)) <= xt))
+	{
+		return 0;
+	}
+
+	code = dictionary[xt];
+	flags = dictionary[xt - 1];
+
+	if (FORTH_IS_COLON_CODE(code))
+	{
+		if (FORTH_HEADER_FLAGS_EFFECT_KNOWN & flags)
+		{
+			e->in = FORTH_HEADER_FLAGS_EFFECT_IN(flags);
+			e->out = FORTH_HEADER_FLAGS_EFFECT_OUT(flags);
+			e->max = FORTH_HEADER_FLAGS_EFFECT_MAX(flags);
+			return 1;
+		}
+
+		if ((0 != (FORTH_HEADER_FLAGS_EFFECT_MASK & flags)) || (FORTH_EFFECT_NESTING <= nesting))
+		{
+			return 0;
+		}
+
+		return forth_effect_of_body(rctx, xt, e, nesting);
+	}
+
+	if (!FORTH_IS_TOKEN(code))
+	{
+		return 0;
+	}
+
+	switch (FORTH_EXTRACT_TOKEN(code))
+	{
+		case FORTH_TOKEN_doconst:
+		case FORTH_TOKEN_dovar:
+#if defined(FORTH_USER_VARIABLES)
+		case FORTH_TOKEN_douser:
+#endif
+			e->in = 0;
+			e->out = 1;
+			e->max = 1;
+			return 1;
+
+#if defined(FORTH_COMPACT_CODE)
+		case FORTH_TOKEN_compact:	// Only what ; recorded, the body is no longer cells.
+			if (0 == (FORTH_HEADER_FLAGS_EFFECT_KNOWN & flags))
+			{
+				return 0;
+			}
+			e->in = FORTH_HEADER_FLAGS_EFFECT_IN(flags);
+			e->out = FORTH_HEADER_FLAGS_EFFECT_OUT(flags);
+			e->max = FORTH_HEADER_FLAGS_EFFECT_MAX(flags);
+			return 1;
+#endif
+
+		case FORTH_TOKEN_docreate:	// The body, then what DOES> has set (or NOP).
+			if (FORTH_PACK_TOKEN(FORTH_TOKEN_NOP) == dictionary[xt + 1])
+			{
+				does.in = 0;
+				does.out = 0;
+				does.max = 0;
+			}
+			else if (!forth_effect_of_xt(rctx, dictionary[xt + 1], &does, nesting))
+			{
+				return 0;
+			}
+			e->in = (1 < does.in) ? (does.in - 1) : 0;	// The body is the top one.
+			e->out = e->in + 1 - does.in + does.out;
+			e->max = e->in + 1 - does.in + does.max;
+			if (e->max < (e->in + 1))
+			{
+				e->max = e->in + 1;
+			}
+			return 1;
+
+		default:	// Primitives have the token itself in the code field.
+			effect = forth_token_effects[FORTH_EXTRACT_TOKEN(code)];
+			if ((0 == effect) || (FORTH_PACK_TOKEN(FORTH_EXTRACT_TOKEN(code)) != code))
+			{
+				return 0;
+			}
+			e->in = FORTH_EFFECT_IN(effect);
+			e->out = FORTH_EFFECT_OUT(effect);
+			e->max = FORTH_EFFECT_MAX(effect);
+			return 1;
+	}
+}
+
+forth_cell_t forth_stack_effect(struct forth_runtime_context *rctx, forth_cell_t xt)
+{
+	struct forth_effect e;
+
+	if (!forth_effect_of_xt(rctx, xt, &e, 0) || (15 < e.in) || (15 < e.out))
+	{
+		return 0;
+	}
+
+	return FORTH_HEADER_FLAGS_EFFECT(e.in, e.out, (15 < e.max) ? 15 : e.max);
+}
+
+void forth_stack_effect_record(struct forth_runtime_context *rctx, forth_cell_t xt)
+{
+	forth_cell_t *flags = &rctx->dictionary[xt - 1];
+	forth_cell_t effect;
+
+	*flags &= ~(FORTH_HEADER_FLAGS_EFFECT_MASK);	// A new body, look at it again.
+	effect = forth_stack_effect(rctx, xt);
+	*flags |= (0 != effect) ? effect : FORTH_HEADER_FLAGS_EFFECT_UNKNOWN;
+}
+#endif
@@ -24,7 +24,10 @@
 // http://forth.teleonomix.com/
 
 #include <stdio.h>
+#include <stdlib.h>
 #include <string.h>
+#include <ctype.h>
+#include <inttypes.h>
 #include "forth_config.h"
 #include "forth_features.h"
 #include "forth.h"
@@ -33,26 +36,27 @@
 
 const char *autoHeader ="// Auto generated file.\n// Do NOT edit.\n//To make changes edit gen_dict.c\n\n";
 
-uint32_t ip = 0;
-uint32_t latest = 0;
+forth_cell_t ip = 0;
+forth_cell_t latest = 0;
 
 #if defined(FORTH_32BIT)
-#define CELL_FORMAT "0x%08x"
+#define CELL_HEX	"%08" PRIx32
+#define CELL_UNSIGNED	"%" PRIu32
+#define CELL_SIGNED	"%" PRId32
+#elif defined(FORTH_64BIT)
+#define CELL_HEX	"%016" PRIx64
+#define CELL_UNSIGNED	"%" PRIu64
+#define CELL_SIGNED	"%" PRId64
 #endif
+#define CELL_FORMAT "0x" CELL_HEX
 
-void gen_str(FILE* f, const char *str, size_t len)
+// The characters packed into cells.
+void gen_chars(FILE* f, const char *str, size_t len)
 {
 	size_t l;
 	forth_cell_t chunk = 0;
 	size_t byte_index;
-#if defined(FORTH_32BIT)
-	size_t bytes_per_cell = 4;
-#endif
-
-	if ('\\' != str[len - 1])
-	{
-		fprintf(f, "// %s\n", str);
-	}
+	size_t bytes_per_cell = sizeof(forth_cell_t);
 
 	for (l = 0; l < len; l++)
 	{
@@ -81,30 +85,217 @@ void gen_str(FILE* f, const char *str, size_t len)
 	}
 }
 
+void gen_str(FILE* f, const char *str, size_t len)
+{
+	if ('\\' != str[len - 1])
+	{
+		fprintf(f, "// %s\n", str);
+	}
+
+	gen_chars(f, str, len);
+}
+
+#if defined(FORTH_KERNEL_NAME_HASH)
+#define KERNEL_WORDLISTS	2	// ROOT-WORDLIST, FORTH-WORDLIST
+#define KERNEL_NAMES		1024
+
+struct kernel_name
+{
+	const char *name;
+	forth_cell_t header;
+	uint32_t hash;
+};
+
+struct kernel_name kernel_names[KERNEL_WORDLISTS][KERNEL_NAMES];
+int kernel_name_count[KERNEL_WORDLISTS];
+int kernel_wordlist = 0;
+
+// Remember the header of name for the hash table of the wordlist being generated, the newest of the same name wins.
+static void kernel_name_add(const char *name, forth_cell_t header)
+{
+	struct kernel_name *names = kernel_names[kernel_wordlist];
+	uint32_t hash = FORTH_NAME_HASH_BASIS;
+	const char *p;
+	int i;
+
+	for (p = name; '\0' != *p; p++)
+	{
+		hash = FORTH_NAME_HASH_STEP(hash, *p);
+	}
+
+	for (i = 0; i < kernel_name_count[kernel_wordlist]; i++)
+	{
+		if (0 == strcasecmp(names[i].name, name))
+		{
+			names[i].header = header;
+			return;
+		}
+	}
+
+	if (KERNEL_NAMES == kernel_name_count[kernel_wordlist])
+	{
+		fprintf(stderr, "gen_dict: too many names, increase KERNEL_NAMES\n");
+		exit(1);
+	}
+
+	names[i].name = name;
+	names[i].header = header;
+	names[i].hash = hash;
+	kernel_name_count[kernel_wordlist]++;
+}
+#endif
+
+#if defined(FORTH_NAME_SPACE)
+#define NAMES	2048
+
+// The names are laid down at the top of the dictionary after the code, at is the distance of the entry from the top in cells.
+struct name_entry
+{
+	const char *name;
+	forth_cell_t xt;
+	forth_cell_t link;
+	forth_cell_t at;
+};
+
+struct name_entry names[NAMES];
+int name_count = 0;
+forth_cell_t name_cells = 0;
+forth_cell_t latest_name = 0;
+
+static void name_add(FILE *f, const char *name, uint16_t len)
+{
+	struct name_entry *n = &names[name_count];
+
+	if (NAMES == name_count)
+	{
+		fprintf(stderr, "gen_dict: too many names, increase NAMES\n");
+		exit(1);
+	}
+
+	name_cells += (sizeof(struct forth_name) + FORTH_ALIGN(len + 1)) / sizeof(forth_cell_t);
+	n->name = name;
+	n->xt = ip + 2;
+	n->link = latest_name;
+	n->at = name_cells;
+	latest_name = name_cells;
+	name_count++;
+
+	if ('\\' != name[len - 1])
+	{
+		fprintf(f, "// %s\n", name);
+	}
+
+	fprintf(f, "\t (FORTH_DICTIONARY_SIZE - " CELL_UNSIGNED ")\t,\t// name\n", n->at);
+}
+
+// The name space, newest name (lowest address) first.
+static void gen_names(FILE *f)
+{
+	forth_cell_t saved_ip = ip;
+	struct name_entry *n;
+	char counted[256];
+	size_t len;
+	int i;
+
+	for (i = name_count - 1; i >= 0; i--)
+	{
+		n = &names[i];
+		fprintf(f, "\t[FORTH_DICTIONARY_SIZE - " CELL_UNSIGNED "] =\t// %s\n", n->at, ('\\' != n->name[strlen(n->name) - 1]) ? n->name : "");
+
+		if (0 != n->link)
+		{
+			fprintf(f, "  (FORTH_DICTIONARY_SIZE - " CELL_UNSIGNED "),\t// link\n", n->link);
+		}
+		else
+		{
+			fputs("  0,\t// link\n", f);
+		}
+
+		fprintf(f, "  " CELL_FORMAT ",\t// xt\n", n->xt);
+		len = strlen(n->name);
+		counted[0] = len;
+		memcpy(counted + 1, n->name, len);
+		gen_chars(f, counted, len + 1);
+	}
+
+	ip = saved_ip;
+}
+#endif
+
 void gen_entry(FILE* f, const char *name, uint32_t flags)
 {
 	uint16_t len = strlen(name);
 
+#if defined(FORTH_NAME_SPACE)
+	name_add(f, name, len);
+#else
 	gen_str(f, name, len);
 
 	fprintf(f, "  " CELL_FORMAT ",\t// link\n", latest );
+#endif
 	latest = ip;
+#if defined(FORTH_KERNEL_NAME_HASH)
+	kernel_name_add(name, ip);
+#endif
 	ip++;
 
 	// fprintf(f, "  " CELL_FORMAT ",\t// flags\n", len | (((uint32_t)flags) << 16) );
-	fprintf(f, "  " CELL_FORMAT ",\t// flags\n", len | flags);
+	fprintf(f, "  " CELL_FORMAT ",\t// flags\n", (forth_cell_t)(len | flags));
 	ip++;
 }
 
+#if defined(FORTH_KERNEL_ROM)
+FILE *fr = 0;			// The cells of the RAM overlay, they are written after the ROM.
+forth_cell_t rom_ip = 0;
+forth_cell_t ram_ip = 0;
+int in_ram = 0;
+#endif
+
+// The next cells are variables of the kernel, with FORTH_KERNEL_ROM they start the RAM overlay after the ROM.
+static FILE *kernel_variables(FILE *fc)
+{
+#if defined(FORTH_KERNEL_ROM)
+	rom_ip = ip;
+	ip = ram_ip;
+	in_ram = 1;
+	return fr;
+#else
+	return fc;
+#endif
+}
+
+// Back to the code of the kernel.
+static void kernel_code(void)
+{
+#if defined(FORTH_KERNEL_ROM)
+	ram_ip = ip;
+	ip = rom_ip;
+	in_ram = 0;
+#endif
+}
+
+// Define name as the index of the next cell.
+static void gen_location(FILE *fh, const char *name)
+{
+#if defined(FORTH_KERNEL_ROM)
+	if (in_ram)
+	{
+		fprintf(fh, "#define %s\t(FORTH_KERNEL_ROM_CELLS + " CELL_UNSIGNED ")\n", name, ip);
+		return;
+	}
+#endif
+	fprintf(fh, "#define %s\t" CELL_FORMAT "\n", name, ip);
+}
+
 void output_cell(FILE *f, const char *data)
 {
-	fprintf(f, "\t %s\t,\t// 0x%08x\n", data, ip);
+	fprintf(f, "\t %s\t,\t// " CELL_FORMAT "\n", data, ip);
 	ip++;
 }
 
 void output_token(FILE *f, const char *token)
 {
-	fprintf(f, "\t FORTH_PACK_TOKEN( %s)\t,\t// 0x%08x\n", token, ip);
+	fprintf(f, "\t FORTH_PACK_TOKEN( %s)\t,\t// " CELL_FORMAT "\n", token, ip);
 	ip++;
 }
 
@@ -120,7 +311,7 @@ forth_cell_t target_ix = 0;
 static const char *forth_label(forth_cell_t ix)
 {
 	static char label_buffer[64];
-	sprintf(label_buffer, "FORTH_internal_label_%08x", ix);
+	sprintf(label_buffer, "FORTH_internal_label_" CELL_HEX, ix);
 	return label_buffer;
 }
 
@@ -199,7 +390,7 @@ void Lit(FILE *fc, FILE *fh, forth_cell_t value)
 		ip++;
 	}
 
-	fprintf(fc, "//\tLITERAL value %u %d " CELL_FORMAT "\n", value, value, value);
+	fprintf(fc, "//\tLITERAL value " CELL_UNSIGNED " " CELL_SIGNED " " CELL_FORMAT "\n", value, (forth_scell_t)value, value);
 }
 
 void StrLit(FILE *fc, FILE *fh, char *str)
@@ -211,11 +402,141 @@ void StrLit(FILE *fc, FILE *fh, char *str)
 	gen_str(fc, str, len);
 }
 
+#if defined(FORTH_KERNEL_NAME_HASH)
+// Emit the perfect hash of the names in a kernel wordlist. The buckets are placed largest first,
+// each gets the first displacement that sends all of its names to empty slots.
+static void gen_kernel_hash(FILE *fc, int wordlist, const char *prefix, forth_cell_t *buckets_out, forth_cell_t *slots_out)
+{
+	static forth_cell_t header[4 * KERNEL_NAMES];
+	static uint16_t displacement[KERNEL_NAMES];
+	static int bucket_size[KERNEL_NAMES];
+	static uint32_t taken[KERNEL_NAMES];
+	struct kernel_name *names = kernel_names[wordlist];
+	int count = kernel_name_count[wordlist];
+	forth_cell_t buckets = 1;
+	forth_cell_t slots = 1;
+	forth_cell_t b;
+	forth_cell_t biggest;
+	uint32_t d;
+	uint32_t s;
+	int i;
+	int j;
+	int n;
+
+	while (slots < (forth_cell_t)count)
+	{
+		slots <<= 1;
+	}
+
+	while ((buckets * 4) < (forth_cell_t)count)
+	{
+		buckets <<= 1;
+	}
+
+	memset(header, 0, sizeof(header));
+	memset(displacement, 0, sizeof(displacement));
+	memset(bucket_size, 0, sizeof(bucket_size));
+
+	for (i = 0; i < count; i++)
+	{
+		bucket_size[names[i].hash & (buckets - 1)]++;
+	}
+
+	for (;;)
+	{
+		biggest = buckets;
+
+		for (b = 0; b < buckets; b++)
+		{
+			if ((0 < bucket_size[b]) && ((buckets == biggest) || (bucket_size[b] > bucket_size[biggest])))
+			{
+				biggest = b;
+			}
+		}
+
+		if (buckets == biggest)
+		{
+			break;
+		}
+
+		for (d = 0; d <= UINT16_MAX; d++)
+		{
+			n = 0;
+
+			for (i = 0; i < count; i++)
+			{
+				if (biggest != (names[i].hash & (buckets - 1)))
+				{
+					continue;
+				}
+
+				s = FORTH_KERNEL_SLOT(names[i].hash, d) & (slots - 1);
+
+				for (j = 0; j < n; j++)
+				{
+					if (s == taken[j])
+					{
+						break;
+					}
+				}
+
+				if ((0 != header[s]) || (j < n))
+				{
+					break;
+				}
+
+				taken[n++] = s;
+			}
+
+			if (i == count)
+			{
+				break;
+			}
+		}
+
+		if (UINT16_MAX < d)
+		{
+			fprintf(stderr, "gen_dict: no displacement found for the names in %s\n", prefix);
+			exit(1);
+		}
+
+		for (i = 0; i < count; i++)
+		{
+			if (biggest == (names[i].hash & (buckets - 1)))
+			{
+				header[FORTH_KERNEL_SLOT(names[i].hash, d) & (slots - 1)] = names[i].header;
+			}
+		}
+
+		displacement[biggest] = d;
+		bucket_size[biggest] = 0;
+	}
+
+	fprintf(fc, "\nstatic const uint16_t forth_kernel_%s_displacement[" CELL_UNSIGNED "] =\n{\n", prefix, buckets);
+	for (b = 0; b < buckets; b++)
+	{
+		fprintf(fc, "\t%u,\n", displacement[b]);
+	}
+	fputs("};\n", fc);
+
+	fprintf(fc, "\nstatic const forth_cell_t forth_kernel_%s_header[" CELL_UNSIGNED "] =\n{\n", prefix, slots);
+	for (s = 0; s < slots; s++)
+	{
+		fprintf(fc, "\t" CELL_FORMAT ",\n", header[s]);
+	}
+	fputs("};\n", fc);
+
+	*buckets_out = buckets;
+	*slots_out = slots;
+}
+#endif
+
 int main()
 {
 	FILE *fc;
 	FILE *fh;
 	FILE *fih;
+	FILE *fv;	// Variables of the kernel.
 	fc = fopen("forth_dict.c","w");
 	fh = fopen("forth_dict.h", "w");
 	fih = fh;
@@ -225,25 +546,49 @@ int main()
 
 	fputs("#include \"forth_config.h\"\n", fh);
 	fputs("#include \"forth.h\"\n\n", fh);
+#if !defined(FORTH_KERNEL_ROM)
 	fputs("extern forth_cell_t dictionary[FORTH_DICTIONARY_SIZE];\n\n", fh);	
+#endif
 
 	fputs("#include \"forth_features.h\"\n\n",fh);
 	fputs("#include \"forth_internal.h\"\n", fh);
 
 	fputs("#include \"forth_dict.h\"\n\n", fc);
 
+#if defined(FORTH_KERNEL_ROM)
+	fr = tmpfile();
+	fprintf(fc, "const forth_cell_t forth_kernel[FORTH_KERNEL_ROM_CELLS] __attribute__((aligned(FORTH_KERNEL_PAGE))) =\n{\n");
+#else
 	fputs("forth_cell_t dictionary[FORTH_DICTIONARY_SIZE] =\n{\n", fc);	
+#endif
 	output_token(fc, "FORTH_TOKEN_BYE");
 	
-	fprintf(fh, "#define FORTH_DP_LOCATION\t" CELL_FORMAT "\n", ip);
-	output_cell(fc, "((FORTH_DP_VALUE) * sizeof(forth_cell_t))");		// BYTES
-	fprintf(fh, "#define FORTH_DP_MAX_LOCATION\t" CELL_FORMAT "\n", ip);
-	output_cell(fc, "((FORTH_DICTIONARY_SIZE) * sizeof(forth_cell_t))");	// BYTES
+	fv = kernel_variables(fc);
+	gen_location(fh, "FORTH_DP_LOCATION");
+	output_cell(fv, "((FORTH_DP_VALUE) * sizeof(forth_cell_t))");		// BYTES
+	gen_location(fh, "FORTH_DP_MAX_LOCATION");
+#if defined(FORTH_NAME_SPACE)
+	output_cell(fv, "((FORTH_DICTIONARY_SIZE - FORTH_NAMES_VALUE) * sizeof(forth_cell_t))");	// BYTES
+#else
+	output_cell(fv, "((FORTH_DICTIONARY_SIZE) * sizeof(forth_cell_t))");	// BYTES
+#endif
+#if defined(FORTH_GROWABLE_DICTIONARY)
+	gen_location(fh, "FORTH_DP_COMMIT_LOCATION");
+	output_cell(fv, "((FORTH_DICTIONARY_SIZE) * sizeof(forth_cell_t))");	// BYTES
+#endif
+#if defined(FORTH_COMPACT_CODE)
+	gen_location(fh, "FORTH_COMPACT_TABLE_LOCATION");
+	output_cell(fv, "0");				// Index of the table of compact code (its count), 0 until ; makes it.
+#endif
 // -----------------------------------------------------------------------------------
-	fprintf(fh, "#define FORTH_WID_Root_WORDLIST\t" CELL_FORMAT "\n", ip);
-	output_cell(fc, "FORTH_Root_LATEST_VALUE");	// LATEST
-	output_cell(fc, "0");				// PARENT
-	output_cell(fc, "0");				// LINK
+	gen_location(fh, "FORTH_WID_Root_WORDLIST");
+	output_cell(fv, "FORTH_Root_LATEST_VALUE");	// LATEST
+	output_cell(fv, "0");				// PARENT
+	output_cell(fv, "0");				// LINK
+#if defined(FORTH_WORDLIST_INDEX)
+	output_cell(fv, "0");				// INDEX
+#endif
+	kernel_code();
 
 	gen_entry(fc, "ROOT-WORDLIST", 0);
 	fprintf(fh, "#define FORTH_XT_Root_WORDLIST\t" CELL_FORMAT "\n", ip);
@@ -282,10 +627,15 @@ int main()
 	Then(fc, fih);					// THEN
 	output_token(fc, "FORTH_TOKEN_unnest");		// ;
 
-	fprintf(fh, "#define FORTH_WID_FORTH_WORDLIST\t" CELL_FORMAT "\n", ip);
-	output_cell(fc, "FORTH_LATEST_VALUE");		// LATEST
-	output_cell(fc, "FORTH_WID_Root_WORDLIST");	// PARENT
-	output_cell(fc, "FORTH_WID_Root_WORDLIST");	// LINK
+	fv = kernel_variables(fc);
+	gen_location(fh, "FORTH_WID_FORTH_WORDLIST");
+	output_cell(fv, "FORTH_LATEST_VALUE");		// LATEST
+	output_cell(fv, "FORTH_WID_Root_WORDLIST");	// PARENT
+	output_cell(fv, "FORTH_WID_Root_WORDLIST");	// LINK
+#if defined(FORTH_WORDLIST_INDEX)
+	output_cell(fv, "0");				// INDEX
+#endif
+	kernel_code();
 
 	gen_entry(fc, "FORTH-WORDLIST", 0);
 	fprintf(fh, "#define FORTH_XT_FORTH_WORDLIST\t" CELL_FORMAT "\n", ip);
@@ -339,6 +689,12 @@ int main()
 
 	fprintf(fh, "#define FORTH_Root_LATEST_VALUE\t" CELL_FORMAT "\n", latest);
 	latest = 0;
+#if defined(FORTH_NAME_SPACE)
+	latest_name = 0;
+#endif
+#if defined(FORTH_KERNEL_NAME_HASH)
+	kernel_wordlist = 1;
+#endif
 
 	gen_entry(fc, "FORTH-ENGINE-VERSION", 0);
 	output_token(fc, "FORTH_TOKEN_doconst");
@@ -346,8 +702,20 @@ int main()
 	
 	gen_entry(fc, "WID-LINK", 0);
 	fprintf(fh, "#define FORTH_XT_WID_LINK\t" CELL_FORMAT "\n", ip);
+#if defined(FORTH_KERNEL_ROM)
+	output_token(fc, "FORTH_TOKEN_nest");		// : WID-LINK ( -- addr ) The variable is in the RAM overlay.
+	output_token(fc, "FORTH_TOKEN_lit");
+	output_cell(fc, "FORTH_WID_LINK_LOCATION");
+	output_token(fc, "FORTH_TOKEN_ix2address");	// IX>ADDRESS
+	output_token(fc, "FORTH_TOKEN_unnest");		// ;
+	fv = kernel_variables(fc);
+	gen_location(fh, "FORTH_WID_LINK_LOCATION");
+	output_cell(fv, "FORTH_WID_FORTH_WORDLIST");
+	kernel_code();
+#else
 	output_token(fc, "FORTH_TOKEN_dovar");
 	output_cell(fc, "FORTH_WID_FORTH_WORDLIST");
+#endif
 
 	gen_entry(fc, "CONTEXT", FORTH_HEADER_FLAGS_TOKEN);
 	output_token(fc, "FORTH_TOKEN_CONTEXT");
@@ -362,10 +730,23 @@ int main()
 	output_cell(fc, "FORTH_USER_VARIABLES");		// CELLS
 	
 	gen_entry(fc, "USER-VARIABLES", 0);			// USER-VARIABLES ( -- #user )
+#if defined(FORTH_KERNEL_ROM)
+	output_token(fc, "FORTH_TOKEN_nest");			// The count is in the RAM overlay.
+	output_token(fc, "FORTH_TOKEN_lit");
+	output_cell(fc, "FORTH_UP_LOCATION");
+	output_token(fc, "FORTH_TOKEN_ix2address");		// IX>ADDRESS
+	output_token(fc, "FORTH_TOKEN_Fetch");			// @
+	output_token(fc, "FORTH_TOKEN_unnest");			// ;
+	fv = kernel_variables(fc);
+	gen_location(fh, "FORTH_UP_LOCATION");
+	output_cell(fv, "0");					// CELLS
+	kernel_code();
+#else
 	output_token(fc, "FORTH_TOKEN_doconst");		// CONSTANT
 	fprintf(fh, "#define FORTH_UP_LOCATION\t" CELL_FORMAT "\n", ip);
 	output_cell(fc, "0");					// CELLS
 #endif
+#endif
 // -----------------------------------------------------------------------------------
 	gen_entry(fc, "FIND-WORD", FORTH_HEADER_FLAGS_TOKEN);		// ( caddr len -- 0 | xt 1 | xt -1 )
 	output_token(fc, "FORTH_TOKEN_FIND_WORD");
@@ -406,6 +787,10 @@ int main()
 	output_cell(fc,  "FORTH_XT_WID_LINK");		// WID-LINK
 	output_token(fc, "FORTH_TOKEN_Fetch");		// @
 	output_token(fc, "FORTH_TOKEN_Comma");		// , -- link
+#if defined(FORTH_WORDLIST_INDEX)
+	Lit(fc, fih, 0);				// 0
+	output_token(fc, "FORTH_TOKEN_Comma");		// , -- index
+#endif
 	output_token(fc, "FORTH_TOKEN_DUP");		// DUP
 	output_cell(fc,  "FORTH_XT_WID_LINK");		// WID-LINK
 	output_token(fc, "FORTH_TOKEN_Store");		// !
@@ -579,6 +964,31 @@ int main()
 	output_token(fc, "FORTH_TOKEN_TIME_DATE");
 #endif
 
+#if defined(FORTH_AOT)
+	gen_entry(fc, "TRANSLATE-C", FORTH_HEADER_FLAGS_TOKEN);
+	output_token(fc, "FORTH_TOKEN_TRANSLATE_C");
+#endif
+
+#if defined(FORTH_IMAGE)
+	gen_entry(fc, "SAVE-IMAGE", FORTH_HEADER_FLAGS_TOKEN);
+	output_token(fc, "FORTH_TOKEN_SAVE_IMAGE");
+#endif
+
+#if defined(FORTH_STACK_EFFECT)
+	gen_entry(fc, "STACK-EFFECT", FORTH_HEADER_FLAGS_TOKEN);
+	output_token(fc, "FORTH_TOKEN_STACK_EFFECT");
+#endif
+
+#if defined(FORTH_WORDLIST_INDEX)
+	gen_entry(fc, "WORDLIST-INDEX", FORTH_HEADER_FLAGS_TOKEN);
+	output_token(fc, "FORTH_TOKEN_WORDLIST_INDEX");
+#endif
+
+#if defined(FORTH_NATIVE_INTERPRET)
+	gen_entry(fc, "(INTERPRET)", FORTH_HEADER_FLAGS_TOKEN);
+	output_token(fc, "FORTH_TOKEN_INTERPRET");
+#endif
+
 	gen_entry(fc, "EXECUTE", FORTH_HEADER_FLAGS_TOKEN);
 	output_token(fc, "FORTH_TOKEN_EXECUTE");
 
@@ -811,6 +1221,7 @@ int main()
 	output_token(fc, "FORTH_TOKEN_DotError");
 
 	gen_entry(fc, "BYE", FORTH_HEADER_FLAGS_TOKEN);
+	fprintf(fh, "#define FORTH_XT_BYE\t" CELL_FORMAT "\n", ip);
 	output_token(fc, "FORTH_TOKEN_BYE");
 
 	gen_entry(fc, "(SEE)", FORTH_HEADER_FLAGS_TOKEN);
@@ -1102,12 +1513,13 @@ int main()
 	gen_entry(fc, "IF", FORTH_HEADER_FLAGS_IMMEDIATE);	// IF ( -- orig ) exec: ( flag -- )
 	fprintf(fh, "#define FORTH_XT_IF\t" CELL_FORMAT "\n", ip);
 	output_token(fc, "FORTH_TOKEN_nest");
+	output_token(fc, "FORTH_TOKEN_xtlit");			// xtlit
+	output_token(fc, "FORTH_TOKEN_0branch");		// 0BRANCH
+	output_token(fc, "FORTH_TOKEN_CompileComma");		// COMPILE,	-- Can become a compare and branch token.
 	output_token(fc, "FORTH_TOKEN_pHERE");			// (HERE)
+	output_cell(fc, "FORTH_XT_1_Minus");			// 1-		-- So take the address of the branch afterwards.
 	Lit(fc, fih, FORTH_ORIG_SYS_ID);			// Orig-sys-ID
 	output_token(fc, "FORTH_TOKEN_OR");			// OR
-	output_token(fc, "FORTH_TOKEN_xtlit");			// xtlit
-	output_token(fc, "FORTH_TOKEN_0branch");		// 0BRANCH
-	output_token(fc, "FORTH_TOKEN_CompileComma");		// COMPILE,
 	output_token(fc, "FORTH_TOKEN_unnest");
 
 	gen_entry(fc, "CASE", FORTH_HEADER_FLAGS_IMMEDIATE);	// CASE C:( -- #of-s )
@@ -1186,10 +1598,11 @@ int main()
 	Lit(fc, fih, -22);					// -22
 	output_token(fc, "FORTH_TOKEN_AND");			// AND
 	output_token(fc, "FORTH_TOKEN_THROW");			// THROW
-	output_token(fc, "FORTH_TOKEN_pHERE");			// (HERE)
 	output_token(fc, "FORTH_TOKEN_xtlit");			// xtlit
 	output_token(fc, "FORTH_TOKEN_0branch");		// 0BRANCH
-	output_token(fc, "FORTH_TOKEN_CompileComma");		// COMPILE,
+	output_token(fc, "FORTH_TOKEN_CompileComma");		// COMPILE,	-- Can become a compare and branch token.
+	output_token(fc, "FORTH_TOKEN_pHERE");			// (HERE)
+	output_cell(fc, "FORTH_XT_1_Minus");			// 1-
 	output_token(fc, "FORTH_TOKEN_SWAP");			// SWAP
 	output_token(fc, "FORTH_TOKEN_resolve_branch");		// resolve-branch
 	output_token(fc, "FORTH_TOKEN_unnest");
@@ -1623,6 +2036,9 @@ int main()
 		output_token(fc, "FORTH_TOKEN_TYPE");		//	TYPE
 		output_token(fc, "FORTH_TOKEN_CR");		//	CR
 	Then(fc, fih);						// THEN
+#if defined(FORTH_NAME_SPACE)
+	output_token(fc, "FORTH_TOKEN_NAME_COMMA");		// (NAME,)
+#else
 	output_token(fc, "FORTH_TOKEN_ALIGN");			// ALIGN
 	output_token(fc, "FORTH_TOKEN_HERE");			// HERE
 	output_token(fc, "FORTH_TOKEN_OVER");			// OVER
@@ -1638,6 +2054,7 @@ int main()
 	output_token(fc, "FORTH_TOKEN_Comma");			// ,
 	output_token(fc, "FORTH_TOKEN_Rfrom");			// R>
 	output_token(fc, "FORTH_TOKEN_Comma");			// ,
+#endif
 	output_token(fc, "FORTH_TOKEN_unnest");			// ;
 
 	gen_entry(fc, "CREATE-NAME:", 0);			// CREATE-NAME: ( -- ix )
@@ -1949,6 +2366,13 @@ int main()
 	gen_entry(fc, "INTERPRET", 0);				// : INTERPET
 	fprintf(fh, "#define FORTH_XT_INTERPRET\t" CELL_FORMAT "\n", ip);
 	output_token(fc, "FORTH_TOKEN_nest");
+#if defined(FORTH_NATIVE_INTERPRET)
+	Begin(fc, fih);
+		output_token(fc, "FORTH_TOKEN_INTERPRET");	// (INTERPRET)
+	While(fc, fih);
+		output_token(fc, "FORTH_TOKEN_EXECUTE");	// EXECUTE
+	Repeat(fc, fih);
+#else
 	Begin(fc, fih);
 #if 1
 		output_token(fc, "FORTH_TOKEN_PARSE_WORD");	// PARSE-WORD
@@ -2009,6 +2433,7 @@ int main()
 	Repeat(fc, fih);
  	output_token(fc, "FORTH_TOKEN_DROP");					// DROP
 	output_token(fc, "FORTH_TOKEN_DROP");					// DROP
+#endif
 	output_token(fc, "FORTH_TOKEN_unnest");					// ;
 
 	gen_entry(fc, "EVALUATE", 0);						// : EVALUATE ( caddr cnt -- ??? )
@@ -2280,10 +2705,68 @@ int main()
 #endif
 // -----------------------------------------------------------------------------------
 
+#if defined(FORTH_NAME_SPACE)
+	if ((ip + name_cells) > FORTH_DICTIONARY_SIZE)
+	{
+		fprintf(stderr, "gen_dict: the kernel does not fit, increase FORTH_DICTIONARY_SIZE\n");
+		exit(1);
+	}
+
+	gen_names(fc);
+	fprintf(fh, "#define FORTH_NAMES_VALUE\t" CELL_UNSIGNED "\n", name_cells);
+#endif
 	fputs("};\n",fc);
 
-	fprintf(fh, "#define FORTH_DP_VALUE\t%u\n", ip);
+#if defined(FORTH_KERNEL_ROM)
+	{
+		forth_cell_t rom_cells = (ip + (FORTH_KERNEL_PAGE / sizeof(forth_cell_t)) - 1) & ~((FORTH_KERNEL_PAGE / sizeof(forth_cell_t)) - 1);
+		int c;
+
+		if ((rom_cells + ram_ip) > FORTH_DICTIONARY_SIZE)
+		{
+			fprintf(stderr, "gen_dict: the kernel does not fit, increase FORTH_DICTIONARY_SIZE\n");
+			exit(1);
+		}
+
+		fprintf(fh, "#define FORTH_KERNEL_ROM_CELLS\t" CELL_UNSIGNED "\n", rom_cells);
+		fprintf(fh, "#define FORTH_KERNEL_RAM_CELLS\t" CELL_UNSIGNED "\n", ram_ip);
+		fputs("\nconst forth_cell_t forth_kernel_ram[FORTH_KERNEL_RAM_CELLS] =\n{\n", fc);
+		rewind(fr);
+		while (EOF != (c = fgetc(fr)))
+		{
+			fputc(c, fc);
+		}
+		fclose(fr);
+		fputs("};\n", fc);
+		ip = rom_cells + ram_ip;
+	}
+#endif
+
+	fprintf(fh, "#define FORTH_DP_VALUE\t" CELL_UNSIGNED "\n", ip);
 	fprintf(fh, "#define FORTH_LATEST_VALUE\t" CELL_FORMAT "\n", latest);
+
+#if defined(FORTH_KERNEL_NAME_HASH)
+	{
+		forth_cell_t root_buckets, root_slots, forth_buckets, forth_slots;
+
+		gen_kernel_hash(fc, 0, "Root", &root_buckets, &root_slots);
+		gen_kernel_hash(fc, 1, "FORTH", &forth_buckets, &forth_slots);
+
+		fputs("\nconst struct forth_kernel_wordlist forth_kernel_wordlists[] =\n{\n", fc);
+		fprintf(fc, "\t{ FORTH_WID_Root_WORDLIST, FORTH_Root_LATEST_VALUE, " CELL_UNSIGNED ", " CELL_UNSIGNED
+			", forth_kernel_Root_displacement, forth_kernel_Root_header },\n", root_buckets, root_slots);
+		fprintf(fc, "\t{ FORTH_WID_FORTH_WORDLIST, FORTH_LATEST_VALUE, " CELL_UNSIGNED ", " CELL_UNSIGNED
+			", forth_kernel_FORTH_displacement, forth_kernel_FORTH_header },\n", forth_buckets, forth_slots);
+		fputs("\t{ 0, 0, 0, 0, 0, 0 }\n};\n", fc);
+
+		fputs("\nextern const struct forth_kernel_wordlist forth_kernel_wordlists[];\n", fh);
+	}
+#endif
+#if defined(FORTH_KERNEL_ROM)
+	fputs("\n// The kernel, FORTH_KERNEL_ROM_CELLS cells that are never written, then the start of the RAM overlay.\n", fh);
+	fputs("extern const forth_cell_t forth_kernel[FORTH_KERNEL_ROM_CELLS];\n", fh);
+	fputs("extern const forth_cell_t forth_kernel_ram[FORTH_KERNEL_RAM_CELLS];\n", fh);
+#endif
 	fputs("#endif\n", fh);
 	fclose(fc);
 	fclose(fh);
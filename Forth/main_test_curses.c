@@ -13,17 +13,40 @@
 #include "forth.h"
 #include "forth_internal.h"
 #include "forth_dict.h"
+#include "forth_interface.h"
 
 #include <stdio.h>
 #include <string.h>
 #include <curses.h>
 
+#define STACK_SLACK	8	// Cells at both ends of the stacks, outside sp_min .. sp_max and rp_min .. rp_max.
+
+#if defined(FORTH_ARENA)
+// Everything the Forth system can address has to be in one arena, Forth addresses are offsets from its start.
+struct test_arena
+{
+	struct forth_runtime_context r_ctx;
+	forth_cell_t data_stack[256];
+	forth_cell_t return_stack[256];
+	forth_cell_t search_order[256];
+	forth_cell_t dictionary[FORTH_DICTIONARY_SIZE];	// A copy of the one in forth_dict.c.
+#if defined(FORTH_INCLUDE_MEMORY_ALLOCATION_WORDS)
+	char heap[64 * 1024];
+#endif
+};
+
+struct test_arena arena;
+#else
 forth_cell_t data_stack[256];
 forth_cell_t return_stack[256];
 struct forth_runtime_context r_ctx;
+forth_cell_t search_order[256];
+#if defined(FORTH_KERNEL_ROM)
+forth_cell_t test_dictionary[FORTH_DICTIONARY_SIZE];
+#endif
+#endif
 struct forth_persistent_context p_ctx;
 // forth_cell_t dictionary[1024] = { FORTH_TOKEN_BYE };
-forth_cell_t search_order[256];
 
 int reset_curses(void)
 {
@@ -196,46 +219,73 @@ forth_scell_t accept_str(struct forth_runtime_context *rctx, char *buffer, forth
 int main()
 {
 	// forth_cell_t tmp;
-
-	r_ctx.dictionary = dictionary;
-	r_ctx.sp0 = &data_stack[255];
-	r_ctx.sp = &data_stack[255];
-	r_ctx.sp_max = &data_stack[255];
-	r_ctx.sp_min = data_stack;
-
-	r_ctx.rp0 = &return_stack[255];
-	r_ctx.rp = &return_stack[255];
-	r_ctx.rp_max = &return_stack[255];
-	r_ctx.rp_min = return_stack;
-
-	r_ctx.handler = 0;
-	r_ctx.ip =0;
-	r_ctx.base = 10;
-	// r_ctx.base = 16;
-
-	r_ctx.wordlists = (forth_cell_t *)&search_order;
-	r_ctx.wordlist_slots = 256;
-	r_ctx.wordlist_cnt = 2;
+#if defined(FORTH_ARENA)
+	struct forth_runtime_context *rctx = &arena.r_ctx;
+	forth_cell_t *data_stack = arena.data_stack;
+	forth_cell_t *return_stack = arena.return_stack;
+	forth_cell_t *search_order = arena.search_order;
+
+#if defined(FORTH_KERNEL_ROM)
+	forth_kernel_copy(arena.dictionary);
+#else
+	memcpy(arena.dictionary, dictionary, sizeof(arena.dictionary));
+#endif
+	rctx->dictionary = arena.dictionary;
+	rctx->arena = (char *)&arena;
+#if defined(FORTH_INCLUDE_MEMORY_ALLOCATION_WORDS)
+	rctx->heap = FORTH_ADDRESS(rctx->arena, arena.heap);
+	rctx->heap_size = sizeof(arena.heap);
+#endif
+#else
+	struct forth_runtime_context *rctx = &r_ctx;
+
+#if defined(FORTH_KERNEL_ROM)
+	rctx->dictionary = test_dictionary;
+	forth_kernel_copy(rctx->dictionary);
+#else
+	rctx->dictionary = dictionary;
+#endif
+#endif
+	// Straight line code can go past the limits before the engine checks them (calls, returns, branches, loops),
+	// STACK_SLACK keeps short stretches of it inside the arrays.
+	rctx->sp0 = &data_stack[255 - STACK_SLACK];
+	rctx->sp = &data_stack[255 - STACK_SLACK];
+	rctx->sp_max = &data_stack[255 - STACK_SLACK];
+	rctx->sp_min = &data_stack[STACK_SLACK];
+
+	rctx->rp0 = &return_stack[255 - STACK_SLACK];
+	rctx->rp = &return_stack[255 - STACK_SLACK];
+	rctx->rp_max = &return_stack[255 - STACK_SLACK];
+	rctx->rp_min = &return_stack[STACK_SLACK];
+
+	rctx->handler = 0;
+	rctx->ip =0;
+	rctx->base = 10;
+	// rctx->base = 16;
+
+	rctx->wordlists = search_order;
+	rctx->wordlist_slots = 256;
+	rctx->wordlist_cnt = 2;
 	search_order[255] = FORTH_WID_Root_WORDLIST;
 	search_order[254] = FORTH_WID_FORTH_WORDLIST;
-	r_ctx.current = FORTH_WID_FORTH_WORDLIST;
-	// r_ctx.wordlist_cnt =
-	r_ctx.terminal_width = 80;
-	r_ctx.terminal_height = 25;
-	r_ctx.write_string = &write_str;
-	r_ctx.page = &page;
-	r_ctx.send_cr = &send_cr;
-	r_ctx.accept_string = &accept_str;
-	r_ctx.key = &key;
-	r_ctx.key_q = &key_q;
-	r_ctx.ekey = &ekey;
-	r_ctx.ekey_q = &ekey_q;
-	r_ctx.ekey_to_char = &ekey_to_char;
-	r_ctx.at_xy = &at_xy;
+	rctx->current = FORTH_WID_FORTH_WORDLIST;
+	// rctx->wordlist_cnt =
+	rctx->terminal_width = 80;
+	rctx->terminal_height = 25;
+	rctx->write_string = &write_str;
+	rctx->page = &page;
+	rctx->send_cr = &send_cr;
+	rctx->accept_string = &accept_str;
+	rctx->key = &key;
+	rctx->key_q = &key_q;
+	rctx->ekey = &ekey;
+	rctx->ekey_q = &ekey_q;
+	rctx->ekey_to_char = &ekey_to_char;
+	rctx->at_xy = &at_xy;
 
 	init_curses();
 	
-	forth(&r_ctx, FORTH_XT_QUIT);
+	forth(rctx, FORTH_XT_QUIT);
 
 	close_curses();
 
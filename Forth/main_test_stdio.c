@@ -19,12 +19,53 @@
 #include <stdio.h>
 #include <string.h>
 
+#define TEST_DICTIONARY_SIZE	(FORTH_DICTIONARY_SIZE * sizeof(forth_cell_t))	// Bytes.
+#define STACK_SLACK		8	// Cells at both ends of the stacks, outside sp_min .. sp_max and rp_min .. rp_max.
+
+#if defined(FORTH_GROWABLE_DICTIONARY)
+#include <stdlib.h>
+#include <unistd.h>
+#include <sys/mman.h>
+
+#define TEST_DICTIONARY_RESERVE	(1024 * 1024 * 1024)	// Bytes of address space for the dictionary.
+// Asked for each time, SAVE-IMAGE images only load at the same address (mmap() takes it as a hint).
+#if defined(__LP64__)
+#	define TEST_DICTIONARY_ADDRESS	((void *)0x200000000000)
+#else
+#	define TEST_DICTIONARY_ADDRESS	((void *)0x40000000)
+#endif
+#endif
+
+#if defined(FORTH_ARENA)
+// Everything the Forth system can address has to be in one arena, Forth addresses are offsets from its start.
+struct test_arena
+{
+	struct forth_runtime_context r_ctx;
+	forth_cell_t data_stack[256];
+	forth_cell_t return_stack[256];
+	forth_cell_t search_order[256];
+#if !defined(FORTH_GROWABLE_DICTIONARY)
+	forth_cell_t dictionary[FORTH_DICTIONARY_SIZE];	// A copy of the one in forth_dict.c.
+#endif
+#if defined(FORTH_INCLUDE_MEMORY_ALLOCATION_WORDS)
+	char heap[64 * 1024];
+#endif
+};
+
+#if !defined(FORTH_GROWABLE_DICTIONARY)
+struct test_arena arena;
+#endif
+#else
 forth_cell_t data_stack[256];
 forth_cell_t return_stack[256];
 struct forth_runtime_context r_ctx;
+forth_cell_t search_order[256];
+#if defined(FORTH_KERNEL_ROM) && !defined(FORTH_GROWABLE_DICTIONARY)
+forth_cell_t test_dictionary[FORTH_DICTIONARY_SIZE];
+#endif
+#endif
 struct forth_persistent_context p_ctx;
 // forth_cell_t dictionary[1024] = { FORTH_TOKEN_BYE };
-forth_cell_t search_order[256];
 
 int write_str(struct forth_runtime_context *rctx, const char *str, forth_cell_t length)
 {
@@ -99,8 +140,9 @@ forth_cell_t ekey_to_char(struct forth_runtime_context *rctx, forth_cell_t ek)
 	return ek >> 8;
 }
 
-#if defined(FORTH_EXTERNAL_PRIMITIVES)
 #include "forth_interface.h"
+
+#if defined(FORTH_EXTERNAL_PRIMITIVES)
 forth_cell_t test_square(forth_runtime_context_p rctx)
 {
 	*(rctx->sp) = *(rctx->sp) * *(rctx->sp);
@@ -121,7 +163,7 @@ static void register_primitive(struct forth_runtime_context *rctx, const char *n
 
 	if (0 != res)
 	{
-		printf("Return value = %d at item %d (%s).\n", res, index, name);
+		printf("Return value = %d at item %d (%s).\n", res, (int)index, name);
 	}
 }
 
@@ -148,49 +190,149 @@ static int init_externals(struct forth_runtime_context *rctx)
 }
 #endif
 
-int main()
+#if defined(FORTH_GROWABLE_DICTIONARY)
+// Reserve size bytes of address space (at the address at if it is free), only the first commit bytes are backed by memory.
+// forth_dictionary_commit() (forth_posix.c) commits the rest as the dictionary grows.
+static char *reserve(void *at, size_t size, size_t commit)
+{
+#if defined(FORTH_FORK)
+	char *p = forth_arena_create(size, commit);	// Only used for the arena, forth_fork() can copy it.
+
+	if (0 == p)
+	{
+		perror("forth_arena_create");
+		exit(1);
+	}
+#else
+	char *p = mmap(at, size, PROT_NONE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE, -1, 0);
+
+	if ((MAP_FAILED == p) || (0 != mprotect(p, commit, PROT_READ | PROT_WRITE)))
+	{
+		perror("mmap");
+		exit(1);
+	}
+#endif
+
+	return p;
+}
+
+static size_t whole_pages(size_t size)
+{
+	size_t page = sysconf(_SC_PAGESIZE);
+	return (size + page - 1) & ~(page - 1);
+}
+#endif
+
+// Put the kernel at the start of the dictionary d.
+static void load_kernel(forth_cell_t *d)
+{
+#if defined(FORTH_KERNEL_ROM)
+	if (0 != forth_kernel_share(d))	// Needs a page aligned dictionary.
+	{
+		forth_kernel_copy(d);
+	}
+#else
+	memcpy(d, dictionary, TEST_DICTIONARY_SIZE);
+#endif
+}
+
+int main(int argc, char *argv[])
 {
 	// forth_cell_t tmp;
+#if defined(FORTH_ARENA)
+#if defined(FORTH_GROWABLE_DICTIONARY)
+	// The dictionary follows the arena in the same reservation.
+	size_t offset = whole_pages(sizeof(struct test_arena));
+	struct test_arena *a = (struct test_arena *)reserve(0, offset + TEST_DICTIONARY_RESERVE, offset + whole_pages(TEST_DICTIONARY_SIZE));
+	forth_cell_t *d = (forth_cell_t *)(((char *)a) + offset);
+#else
+	struct test_arena *a = &arena;
+	forth_cell_t *d = arena.dictionary;
+#endif
+	struct forth_runtime_context *rctx = &a->r_ctx;
+	forth_cell_t *data_stack = a->data_stack;
+	forth_cell_t *return_stack = a->return_stack;
+	forth_cell_t *search_order = a->search_order;
+
+	load_kernel(d);
+	rctx->dictionary = d;
+	rctx->arena = (char *)a;
+#if defined(FORTH_INCLUDE_MEMORY_ALLOCATION_WORDS)
+	rctx->heap = FORTH_ADDRESS(rctx->arena, a->heap);
+	rctx->heap_size = sizeof(a->heap);
+#endif
+#else
+	struct forth_runtime_context *rctx = &r_ctx;
 
-	r_ctx.dictionary = dictionary;
-	r_ctx.sp0 = &data_stack[255];
-	r_ctx.sp = &data_stack[255];
-	r_ctx.sp_max = &data_stack[255];
-	r_ctx.sp_min = data_stack;
-
-	r_ctx.rp0 = &return_stack[255];
-	r_ctx.rp = &return_stack[255];
-	r_ctx.rp_max = &return_stack[255];
-	r_ctx.rp_min = return_stack;
-
-	r_ctx.handler = 0;
-	r_ctx.ip =0;
-	r_ctx.base = 10;
-	// r_ctx.base = 16;
-
-	r_ctx.wordlists = (forth_cell_t *)&search_order;
-	r_ctx.wordlist_slots = 256;
-	r_ctx.wordlist_cnt = 2;
+#if defined(FORTH_GROWABLE_DICTIONARY)
+	rctx->dictionary = (forth_cell_t *)reserve(TEST_DICTIONARY_ADDRESS, TEST_DICTIONARY_RESERVE, whole_pages(TEST_DICTIONARY_SIZE));
+	load_kernel(rctx->dictionary);
+#else
+#if defined(FORTH_KERNEL_ROM)
+	rctx->dictionary = test_dictionary;
+	load_kernel(rctx->dictionary);
+#else
+	rctx->dictionary = dictionary;
+#endif
+#endif
+#endif
+#if defined(FORTH_GROWABLE_DICTIONARY)
+	rctx->dictionary[FORTH_DP_MAX_LOCATION] = TEST_DICTIONARY_RESERVE;
+	rctx->dictionary[FORTH_DP_COMMIT_LOCATION] = whole_pages(TEST_DICTIONARY_SIZE);
+#endif
+	// Straight line code can go past the limits before the engine checks them (calls, returns, branches, loops),
+	// STACK_SLACK keeps short stretches of it inside the arrays.
+	rctx->sp0 = &data_stack[255 - STACK_SLACK];
+	rctx->sp = &data_stack[255 - STACK_SLACK];
+	rctx->sp_max = &data_stack[255 - STACK_SLACK];
+	rctx->sp_min = &data_stack[STACK_SLACK];
+
+	rctx->rp0 = &return_stack[255 - STACK_SLACK];
+	rctx->rp = &return_stack[255 - STACK_SLACK];
+	rctx->rp_max = &return_stack[255 - STACK_SLACK];
+	rctx->rp_min = &return_stack[STACK_SLACK];
+
+	rctx->handler = 0;
+	rctx->ip =0;
+	rctx->base = 10;
+	// rctx->base = 16;
+
+	rctx->wordlists = search_order;
+	rctx->wordlist_slots = 256;
+	rctx->wordlist_cnt = 2;
 	search_order[255] = FORTH_WID_Root_WORDLIST;
 	search_order[254] = FORTH_WID_FORTH_WORDLIST;
-	r_ctx.current = FORTH_WID_FORTH_WORDLIST;
-	// r_ctx.wordlist_cnt =
-	r_ctx.terminal_width = 80;
-	r_ctx.terminal_height = 25;
-	r_ctx.write_string = &write_str;
-	r_ctx.page = &page;
-	r_ctx.send_cr = &send_cr;
-	r_ctx.accept_string = &accept_str;
-	r_ctx.key = &key;
-	r_ctx.key_q = &key_q;
-	r_ctx.ekey = &ekey;
-	r_ctx.ekey_q = &ekey_q;
-	r_ctx.ekey_to_char = &ekey_to_char;
+	rctx->current = FORTH_WID_FORTH_WORDLIST;
+	// rctx->wordlist_cnt =
+	rctx->terminal_width = 80;
+	rctx->terminal_height = 25;
+	rctx->write_string = &write_str;
+	rctx->page = &page;
+	rctx->send_cr = &send_cr;
+	rctx->accept_string = &accept_str;
+	rctx->key = &key;
+	rctx->key_q = &key_q;
+	rctx->ekey = &ekey;
+	rctx->ekey_q = &ekey_q;
+	rctx->ekey_to_char = &ekey_to_char;
 #if defined(FORTH_EXTERNAL_PRIMITIVES)
-	r_ctx.external_primitive_table = external_primitive_table;
-	init_externals(&r_ctx);
+	rctx->external_primitive_table = external_primitive_table;
+	init_externals(rctx);
+#endif
+#if defined(FORTH_IMAGE)
+	// ./forth file starts from an image written by SAVE-IMAGE instead of the kernel.
+	if (1 < argc)
+	{
+		forth_cell_t res = forth_load_image(rctx, argv[1]);
+
+		if (0 != res)
+		{
+			printf("Cannot load the image %s (%d).\n", argv[1], (int)res);
+			return 1;
+		}
+	}
 #endif
-	forth(&r_ctx, FORTH_XT_QUIT);
+	forth(rctx, FORTH_XT_QUIT);
 
 	return 0;
 }